@@ -0,0 +1,214 @@
+#ifndef _DG_ADT_ARENA_H_
+#define _DG_ADT_ARENA_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// Bump allocator. Objects are placed one after another into big
+// chunks of memory and all the chunks are released at once when
+// the arena is destroyed. The arena never calls destructors,
+// objects that need them can be kept in ArenaPtr.
+//
+// The arena also gives blocks of memory that are released and allocated
+// again while the arena lives (e.g., the buffers of growing vectors,
+// see ArenaAllocator). The released blocks are kept in free lists
+// by their size rounded up to a power of two and reused.
+class Arena {
+    static const size_t MAX_CHUNK_SIZE = 1 << 20;
+
+    // the sizes of blocks are MIN_BLOCK_SIZE << class, the bigger
+    // blocks are allocated on the heap
+    static const size_t MIN_BLOCK_SIZE = 16;
+    static const unsigned BLOCK_CLASSES = 8;
+
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    char *_cur{nullptr};
+    char *_end{nullptr};
+    // the size of the next chunk, chunks grow up to MAX_CHUNK_SIZE
+    size_t _chunkSize;
+    size_t _allocatedBytes{0};
+
+    // the released blocks, the first word of a block
+    // points to the next block in the list
+    void *_freeBlocks[BLOCK_CLASSES] = {};
+    bool _recycle{true};
+
+    static unsigned getBlockClass(size_t size) {
+        unsigned c = 0;
+        while ((MIN_BLOCK_SIZE << c) < size)
+            ++c;
+        return c;
+    }
+
+    static char *alignUp(char *p, size_t align) {
+        auto addr = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char *>((addr + align - 1) & ~(align - 1));
+    }
+
+    void newChunk(size_t minSize) {
+        size_t size = std::max(_chunkSize, minSize);
+        _chunks.emplace_back(new char[size]);
+        _cur = _chunks.back().get();
+        _end = _cur + size;
+
+        if (_chunkSize < MAX_CHUNK_SIZE)
+            _chunkSize *= 2;
+    }
+
+public:
+    explicit Arena(size_t chunkSize = 4096) : _chunkSize(chunkSize) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    Arena(Arena&& other) : _chunkSize(other._chunkSize) { swap(other); }
+
+    // the memory of this arena is released together with 'other',
+    // so the objects of this arena may be destroyed after the assignment
+    Arena& operator=(Arena&& other) {
+        swap(other);
+        return *this;
+    }
+
+    void swap(Arena& other) {
+        _chunks.swap(other._chunks);
+        std::swap(_cur, other._cur);
+        std::swap(_end, other._end);
+        std::swap(_chunkSize, other._chunkSize);
+        std::swap(_allocatedBytes, other._allocatedBytes);
+        std::swap(_freeBlocks, other._freeBlocks);
+        std::swap(_recycle, other._recycle);
+    }
+
+    void *allocate(size_t size, size_t align) {
+        assert(align > 0 && (align & (align - 1)) == 0 && "Invalid alignment");
+
+        char *p = _cur ? alignUp(_cur, align) : nullptr;
+        if (!p || p + size > _end) {
+            newChunk(size + align);
+            p = alignUp(_cur, align);
+        }
+
+        _cur = p + size;
+        _allocatedBytes += size;
+        return p;
+    }
+
+    template <typename T, typename... Args>
+    T *create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // allocate a block that can be released by releaseBlock()
+    void *allocateBlock(size_t size, size_t align) {
+        unsigned c = getBlockClass(size);
+        if (c >= BLOCK_CLASSES)
+            return ::operator new(size);
+
+        assert(align <= alignof(std::max_align_t) && "Unsupported alignment");
+        if (void *block = _freeBlocks[c]) {
+            _freeBlocks[c] = *static_cast<void **>(block);
+            return block;
+        }
+
+        return allocate(MIN_BLOCK_SIZE << c, std::max(align, sizeof(void *)));
+    }
+
+    // 'size' must be the size that the block was allocated with
+    void releaseBlock(void *block, size_t size) {
+        unsigned c = getBlockClass(size);
+        if (c >= BLOCK_CLASSES) {
+            ::operator delete(block);
+            return;
+        }
+
+        if (!_recycle)
+            return;
+
+        *static_cast<void **>(block) = _freeBlocks[c];
+        _freeBlocks[c] = block;
+    }
+
+    // Do not keep the released blocks for reuse. Call it when
+    // the objects in the arena are being destroyed together
+    // with the arena, so that releasing their blocks costs nothing.
+    void stopRecycling() { _recycle = false; }
+
+    size_t getAllocatedBytes() const { return _allocatedBytes; }
+    size_t getChunksNum() const { return _chunks.size(); }
+};
+
+///
+// Allocator for the standard containers that takes the memory
+// from an arena (see Arena::allocateBlock()), or from the heap
+// if it has no arena. The containers keep the allocator
+// when they are moved or swapped.
+template <typename T>
+class ArenaAllocator {
+    Arena *_arena{nullptr};
+
+    template <typename U> friend class ArenaAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(Arena *arena) : _arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other._arena) {}
+
+    T *allocate(size_t n) {
+        if (!_arena)
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        return static_cast<T *>(_arena->allocateBlock(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {
+        if (!_arena)
+            ::operator delete(p);
+        else
+            _arena->releaseBlock(p, n * sizeof(T));
+    }
+
+    Arena *getArena() const { return _arena; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const {
+        return _arena == other._arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const {
+        return _arena != other._arena;
+    }
+};
+
+// destroys an object that lives in an arena
+// (the memory is released with the arena)
+template <typename T>
+struct ArenaDeleter {
+    void operator()(T *obj) const { obj->~T(); }
+};
+
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDeleter<T>>;
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_ARENA_H_
@@ -1,211 +1,304 @@
 #ifndef _DG_SPARSE_BITVECTOR_H_
 #define _DG_SPARSE_BITVECTOR_H_
 
-#include <map>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
 
 namespace dg {
 namespace ADT {
 
+// The bitvector stores the non-zero words of bits (along with
+// their shift) in an array sorted by the shift. A few words are stored
+// inline in the object, so small bitvectors do not allocate any memory.
+// The number of set bits is kept in a variable.
 template <typename BitsT = uint64_t, typename ShiftT = uint64_t, size_t SCALE = 1>
 class SparseBitvectorImpl {
-    // mapping from shift to bits
-    using BitsContainerT = std::map<ShiftT, BitsT>;
-    BitsContainerT _bits{};
+    struct Word {
+        ShiftT shift;
+        BitsT bits;
+    };
+
+    // the number of words stored in the object itself
+    static const size_t INLINE_WORDS = 2;
+
+    Word _inline[INLINE_WORDS];
+    // the words if there are more than INLINE_WORDS of them
+    Word *_heap{nullptr};
+    size_t _capacity{INLINE_WORDS};
+    // the number of words
+    size_t _size{0};
+    // the number of set bits
+    size_t _count{0};
 
     static size_t _bitsNum() { return sizeof(BitsT) * 8; }
     static ShiftT _shift(size_t i) { return i - (i % _bitsNum()); }
+    static BitsT _bit(size_t i, ShiftT sft) {
+        return static_cast<BitsT>(1) << (i - sft);
+    }
 
     static size_t _countBits(BitsT bits) {
-        size_t num = 0;
-        while (bits) {
-            if (bits & 0x1)
-                ++num;
+        return __builtin_popcountll(static_cast<unsigned long long>(bits));
+    }
+
+    static size_t _firstBit(BitsT bits) {
+        assert(bits != 0);
+        return __builtin_ctzll(static_cast<unsigned long long>(bits));
+    }
 
-            bits = bits >> 1;
+    Word *_words() { return _heap ? _heap : _inline; }
+    const Word *_words() const { return _heap ? _heap : _inline; }
+
+    // find the position of the word with the given shift
+    // (or the position where it should be inserted)
+    size_t _find(ShiftT sft) const {
+        const Word *words = _words();
+        // most of the bitvectors are small
+        if (_size <= INLINE_WORDS) {
+            size_t i = 0;
+            while (i < _size && words[i].shift < sft)
+                ++i;
+            return i;
         }
 
-        return num;
+        return std::lower_bound(words, words + _size, sft,
+                                [](const Word& w, ShiftT s) {
+                                    return w.shift < s;
+                                }) - words;
     }
 
-    void _addBits(size_t i) {
-        // for now we just push it back,
-        // but we would rather do it somehow
-        // more smartly (probably not using the vector)
-        auto sft = _shift(i);
-        _bits.emplace(sft, (1UL << (i - sft)));
+    void _reserve(size_t num) {
+        if (num <= _capacity)
+            return;
+
+        size_t newCap = std::max(num, 2 * _capacity);
+        Word *mem = new Word[newCap];
+        std::copy(_words(), _words() + _size, mem);
+        delete[] _heap;
+        _heap = mem;
+        _capacity = newCap;
+    }
+
+    void _insert(size_t pos, ShiftT sft, BitsT bits) {
+        _reserve(_size + 1);
+        Word *words = _words();
+        std::copy_backward(words + pos, words + _size, words + _size + 1);
+        words[pos].shift = sft;
+        words[pos].bits = bits;
+        ++_size;
+    }
+
+    void _erase(size_t pos) {
+        Word *words = _words();
+        std::copy(words + pos + 1, words + _size, words + pos);
+        --_size;
+    }
+
+    void _copyFrom(const SparseBitvectorImpl& rhs) {
+        _reserve(rhs._size);
+        std::copy(rhs._words(), rhs._words() + rhs._size, _words());
+        _size = rhs._size;
+        _count = rhs._count;
+    }
+
+    void _moveFrom(SparseBitvectorImpl& rhs) {
+        if (rhs._heap) {
+            delete[] _heap;
+            _heap = rhs._heap;
+            _capacity = rhs._capacity;
+            _size = rhs._size;
+            _count = rhs._count;
+            rhs._heap = nullptr;
+            rhs._capacity = INLINE_WORDS;
+        } else {
+            _copyFrom(rhs);
+        }
+
+        rhs._size = 0;
+        rhs._count = 0;
     }
 
 public:
     SparseBitvectorImpl() = default;
     SparseBitvectorImpl(size_t i) { set(i); } // singleton ctor
 
-    SparseBitvectorImpl(const SparseBitvectorImpl&) = default;
-    SparseBitvectorImpl(SparseBitvectorImpl&&) = default;
+    SparseBitvectorImpl(const SparseBitvectorImpl& rhs) { _copyFrom(rhs); }
+    SparseBitvectorImpl(SparseBitvectorImpl&& rhs) { _moveFrom(rhs); }
+
+    SparseBitvectorImpl& operator=(const SparseBitvectorImpl& rhs) {
+        if (this != &rhs)
+            _copyFrom(rhs);
+        return *this;
+    }
+
+    SparseBitvectorImpl& operator=(SparseBitvectorImpl&& rhs) {
+        if (this != &rhs)
+            _moveFrom(rhs);
+        return *this;
+    }
 
-    void reset() { _bits.clear(); }
-    bool empty() const { return _bits.empty(); }
-    void swap(SparseBitvectorImpl& oth) { _bits.swap(oth._bits); }
+    ~SparseBitvectorImpl() { delete[] _heap; }
+
+    void reset() { _size = 0; _count = 0; }
+    bool empty() const { return _count == 0; }
+
+    void swap(SparseBitvectorImpl& oth) {
+        if (_heap && oth._heap) {
+            std::swap(_heap, oth._heap);
+            std::swap(_capacity, oth._capacity);
+            std::swap(_size, oth._size);
+            std::swap(_count, oth._count);
+            return;
+        }
+
+        SparseBitvectorImpl tmp(std::move(oth));
+        oth = std::move(*this);
+        *this = std::move(tmp);
+    }
 
     bool get(size_t i) const {
         auto sft = _shift(i);
         assert(sft % _bitsNum() == 0);
 
-        auto it = _bits.find(sft);
-        if (it == _bits.end()) {
+        auto pos = _find(sft);
+        if (pos == _size || _words()[pos].shift != sft)
             return false;
-        }
 
-        return (it->second & (1UL << (i - sft)));
+        return _words()[pos].bits & _bit(i, sft);
     }
 
     // returns the previous value of the i-th bit
     bool set(size_t i) {
         auto sft = _shift(i);
-        auto it = _bits.find(sft);
-        if (it == _bits.end()) {
-            _addBits(i);
+        auto pos = _find(sft);
+        if (pos == _size || _words()[pos].shift != sft) {
+            _insert(pos, sft, _bit(i, sft));
+            ++_count;
             return false;
         }
 
-        bool prev = (it->second & (1UL << (i - sft)));
-        it->second |= (1UL << (i - sft));
+        auto& bits = _words()[pos].bits;
+        if (bits & _bit(i, sft))
+            return true;
 
-        return prev;
+        bits |= _bit(i, sft);
+        ++_count;
+        return false;
     }
 
-    // union operation
+    // union operation, returns true if the bitvector changed
     bool set(const SparseBitvectorImpl& rhs) {
-        bool changed = false;
-        for (auto& pair : rhs._bits) {
-            auto& B = _bits[pair.first];
-            auto old = B;
-            B |= pair.second;
-            changed |= (old != B);
+        if (rhs.empty() || this == &rhs)
+            return false;
+
+        const Word *R = rhs._words();
+        const size_t rsize = rhs._size;
+
+        // find out how many words are missing in this bitvector
+        size_t missing = 0;
+        {
+            const Word *L = _words();
+            size_t l = 0;
+            for (size_t r = 0; r < rsize; ++r) {
+                while (l < _size && L[l].shift < R[r].shift)
+                    ++l;
+                if (l == _size || L[l].shift != R[r].shift)
+                    ++missing;
+            }
         }
 
-        return changed;
-    }
+        size_t oldCount = _count;
+
+        if (missing == 0) {
+            // just OR the words in place
+            Word *L = _words();
+            size_t l = 0;
+            for (size_t r = 0; r < rsize; ++r) {
+                while (L[l].shift < R[r].shift)
+                    ++l;
+                assert(L[l].shift == R[r].shift);
+                _count += _countBits(R[r].bits & ~L[l].bits);
+                L[l].bits |= R[r].bits;
+            }
 
-    // returns the previous value of the i-th bit
-    bool unset(size_t i) {
-        auto sft = _shift(i);
-        auto it = _bits.find(sft);
-        if (it == _bits.end()) {
-            return false;
+            return _count != oldCount;
         }
 
-        it->second &= ~(1UL << (i - sft));
-        if (it->second == 0) {
-            _bits.erase(it);
+        // merge from the back, so that we do not need
+        // any temporary storage
+        _reserve(_size + missing);
+        Word *L = _words();
+        size_t l = _size;
+        size_t r = rsize;
+        size_t out = _size + missing;
+        while (r > 0) {
+            if (l > 0 && L[l - 1].shift > R[r - 1].shift) {
+                L[--out] = L[--l];
+            } else if (l > 0 && L[l - 1].shift == R[r - 1].shift) {
+                --l; --r;
+                _count += _countBits(R[r].bits & ~L[l].bits);
+                L[--out] = {L[l].shift, L[l].bits | R[r].bits};
+            } else {
+                --r;
+                _count += _countBits(R[r].bits);
+                L[--out] = R[r];
+            }
         }
+        assert(out == l && "Merged incorrectly");
 
+        _size += missing;
+        assert(_count != oldCount);
         return true;
     }
 
-    // FIXME: track the number of elements
-    // in a variable, to avoid this search...
-    size_t size() const {
-        size_t num = 0;
-        for (auto& it : _bits)
-            num += _countBits(it.second);
-
-        return num;
-    }
+    // returns the previous value of the i-th bit
+    bool unset(size_t i) {
+        auto sft = _shift(i);
+        auto pos = _find(sft);
+        if (pos == _size || _words()[pos].shift != sft)
+            return false;
 
-    class const_iterator {
-        typename BitsContainerT::const_iterator container_it;
-        typename BitsContainerT::const_iterator container_end;
-        size_t pos{0};
-
-        const_iterator(const BitsContainerT& cont, bool end = false)
-        :container_it(end ? cont.end() : cont.begin()),
-         container_end(cont.end()) {
-            // set-up the initial position
-            if (!end && !cont.empty())
-                _findClosestBit();
-        }
+        auto& bits = _words()[pos].bits;
+        if (!(bits & _bit(i, sft)))
+            return false;
 
-        void _findClosestBit() {
-            assert(pos < (sizeof(BitsT)*8));
-            while (!(container_it->second & (1UL << pos))) {
-                if (++pos == sizeof(BitsT)*8)
-                    return;
-            }
-        }
+        bits &= ~_bit(i, sft);
+        --_count;
+        if (bits == 0)
+            _erase(pos);
 
-        /*
-         * This implementation seems less efficient,
-         * but let's keep it commented here for
-         * further experiments
-        void _findClosestBit() {
-            assert(pos < (sizeof(BitsT)*8));
-            BitsT tmp = container_it->second;
-
-            // shift tmp to start at position pos
-            tmp >>= pos;
-
-            if (tmp == 0) {
-                pos = sizeof(BitsT)*8;
-                assert(pos <= (sizeof(BitsT)*8));
-                return;
-            }
+        return true;
+    }
 
-            int i = 0;
-            while (tmp) {
-                // pos bit set
-                if (tmp & 0x1) {
-                    pos += i;
-                    assert(pos < (sizeof(BitsT)*8));
-                    assert(container_it->second & (1UL << pos));
-                    return;
-                }
+    size_t size() const { return _count; }
 
-                if (tmp & 0xff) {
-                    if (tmp & 0xf) {
-                        // we tested this condition
-                        // before entering this code
-                        assert(!(tmp & 0x1));
-                        if (tmp & 0x2) {
-                            pos += i + 1;
-                            assert(pos < (sizeof(BitsT)*8));
-                            assert(container_it->second & (1UL << pos));
-                            return;
-                        } else {
-                            assert(!(tmp & 0x3));
-                            tmp >>= 2;
-                            i += 2;
-                        }
-                    } else {
-                        tmp >>= 4;
-                        i += 4;
-                    }
-                } else {
-                    tmp >>= 8;
-                    i += 8;
-                }
+    class const_iterator {
+        const Word *word{nullptr};
+        const Word *word_end{nullptr};
+        // the bits of the current word that were not visited yet
+        BitsT bits{0};
+
+        const_iterator(const Word *w, const Word *end)
+        : word(w), word_end(end) {
+            if (word != word_end) {
+                bits = word->bits;
+                assert(bits != 0 && "Empty word in a bitvector");
             }
-
-            // not found
-            pos = sizeof(BitsT)*8;
         }
-        */
 
     public:
         const_iterator() = default;
         const_iterator& operator++() {
-            // shift to the next bit in the current bits
-            assert(pos < (sizeof(BitsT)*8));
-            assert(container_it != container_end && "operator++ called on end");
-            if (++pos != 64)
-                _findClosestBit();
-
-            if (pos == 64) {
-                ++container_it;
-                pos = 0;
-                if (container_it != container_end) {
-                    assert(container_it->second != 0 && "Empty bucket in a bitvector");
-                    _findClosestBit();
+            assert(word != word_end && "operator++ called on end");
+            // clear the lowest set bit
+            bits &= bits - 1;
+            if (bits == 0) {
+                ++word;
+                if (word != word_end) {
+                    bits = word->bits;
+                    assert(bits != 0 && "Empty word in a bitvector");
                 }
             }
             return *this;
@@ -218,11 +311,11 @@ public:
         }
 
         size_t operator*() const {
-            return container_it->first + pos;
+            return word->shift + _firstBit(bits);
         }
 
         bool operator==(const const_iterator& rhs) const {
-            return pos == rhs.pos && (container_it == rhs.container_it);
+            return word == rhs.word && bits == rhs.bits;
         }
 
         bool operator!=(const const_iterator& rhs) const {
@@ -232,8 +325,13 @@ public:
         friend class SparseBitvectorImpl;
     };
 
-    const_iterator begin() const { return const_iterator(_bits); }
-    const_iterator end() const { return const_iterator(_bits, true /* end */); }
+    const_iterator begin() const {
+        return const_iterator(_words(), _words() + _size);
+    }
+
+    const_iterator end() const {
+        return const_iterator(_words() + _size, _words() + _size);
+    }
 
     friend class const_iterator;
 };
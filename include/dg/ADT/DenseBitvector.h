@@ -0,0 +1,367 @@
+#ifndef _DG_DENSE_BITVECTOR_H_
+#define _DG_DENSE_BITVECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#if !defined(DG_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define DG_DENSE_BITVECTOR_AVX2
+#elif !defined(DG_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define DG_DENSE_BITVECTOR_SSE2
+#endif
+
+namespace dg {
+namespace ADT {
+
+namespace dense_bits {
+
+using WordT = uint64_t;
+
+inline size_t countBits(WordT w) {
+    return __builtin_popcountll(w);
+}
+
+// L |= R for n words, returns the number of newly set bits
+inline size_t orWordsScalar(WordT *L, const WordT *R, size_t n) {
+    size_t added = 0;
+    for (size_t i = 0; i < n; ++i) {
+        WordT diff = R[i] & ~L[i];
+        if (diff) {
+            L[i] |= diff;
+            added += countBits(diff);
+        }
+    }
+    return added;
+}
+
+// L &= R for n words, returns the number of removed bits
+inline size_t andWordsScalar(WordT *L, const WordT *R, size_t n) {
+    size_t removed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        WordT diff = L[i] & ~R[i];
+        if (diff) {
+            L[i] &= R[i];
+            removed += countBits(diff);
+        }
+    }
+    return removed;
+}
+
+// The vector kernels compute the bits that change for a whole block
+// of words and fall back to counting the bits only if something changed
+// (that is rare once the analysis approaches the fixpoint).
+#if defined(DG_DENSE_BITVECTOR_AVX2)
+
+inline size_t orWords(WordT *L, const WordT *R, size_t n) {
+    size_t added = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(L + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(R + i));
+        // r & ~l
+        __m256i diff = _mm256_andnot_si256(l, r);
+        if (_mm256_testz_si256(diff, diff))
+            continue;
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(L + i),
+                            _mm256_or_si256(l, r));
+        added += countBits(_mm256_extract_epi64(diff, 0)) +
+                 countBits(_mm256_extract_epi64(diff, 1)) +
+                 countBits(_mm256_extract_epi64(diff, 2)) +
+                 countBits(_mm256_extract_epi64(diff, 3));
+    }
+    return added + orWordsScalar(L + i, R + i, n - i);
+}
+
+inline size_t andWords(WordT *L, const WordT *R, size_t n) {
+    size_t removed = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(L + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(R + i));
+        // l & ~r
+        __m256i diff = _mm256_andnot_si256(r, l);
+        if (_mm256_testz_si256(diff, diff))
+            continue;
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(L + i),
+                            _mm256_and_si256(l, r));
+        removed += countBits(_mm256_extract_epi64(diff, 0)) +
+                   countBits(_mm256_extract_epi64(diff, 1)) +
+                   countBits(_mm256_extract_epi64(diff, 2)) +
+                   countBits(_mm256_extract_epi64(diff, 3));
+    }
+    return removed + andWordsScalar(L + i, R + i, n - i);
+}
+
+#elif defined(DG_DENSE_BITVECTOR_SSE2)
+
+inline bool _isZero(__m128i v) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xffff;
+}
+
+inline size_t _countBits(__m128i v) {
+    alignas(16) WordT w[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(w), v);
+    return countBits(w[0]) + countBits(w[1]);
+}
+
+inline size_t orWords(WordT *L, const WordT *R, size_t n) {
+    size_t added = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(L + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(R + i));
+        __m128i diff = _mm_andnot_si128(l, r);
+        if (_isZero(diff))
+            continue;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(L + i), _mm_or_si128(l, r));
+        added += _countBits(diff);
+    }
+    return added + orWordsScalar(L + i, R + i, n - i);
+}
+
+inline size_t andWords(WordT *L, const WordT *R, size_t n) {
+    size_t removed = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(L + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(R + i));
+        __m128i diff = _mm_andnot_si128(r, l);
+        if (_isZero(diff))
+            continue;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(L + i), _mm_and_si128(l, r));
+        removed += _countBits(diff);
+    }
+    return removed + andWordsScalar(L + i, R + i, n - i);
+}
+
+#else
+
+inline size_t orWords(WordT *L, const WordT *R, size_t n) {
+    return orWordsScalar(L, R, n);
+}
+
+inline size_t andWords(WordT *L, const WordT *R, size_t n) {
+    return andWordsScalar(L, R, n);
+}
+
+#endif
+
+} // namespace dense_bits
+
+// Bitvector that stores all the words between the lowest and
+// the highest set bit in a contiguous array. Unions and intersections
+// are done by the vector kernels above. It is meant for dense sets
+// of small numbers (e.g., IDs of nodes or pointers), a sparse set
+// with far apart elements wastes memory.
+// The interface is the same as of the SparseBitvector.
+class DenseBitvector {
+    using WordT = dense_bits::WordT;
+
+    std::vector<WordT> _words;
+    // the index of the word _words[0]
+    size_t _base{0};
+    // the number of set bits
+    size_t _count{0};
+
+    static const size_t BITS = sizeof(WordT) * 8;
+
+    static WordT _bit(size_t i) { return static_cast<WordT>(1) << (i % BITS); }
+
+    // make the array cover the words [from, to)
+    void _cover(size_t from, size_t to) {
+        assert(from < to);
+        if (_words.empty()) {
+            _base = from;
+            _words.resize(to - from, 0);
+            return;
+        }
+
+        if (from < _base) {
+            _words.insert(_words.begin(), _base - from, 0);
+            _base = from;
+        }
+
+        if (to > _base + _words.size())
+            _words.resize(to - _base, 0);
+    }
+
+    WordT *_find(size_t i) {
+        size_t w = i / BITS;
+        if (w < _base || w >= _base + _words.size())
+            return nullptr;
+        return &_words[w - _base];
+    }
+
+    const WordT *_find(size_t i) const {
+        return const_cast<DenseBitvector *>(this)->_find(i);
+    }
+
+public:
+    DenseBitvector() = default;
+    DenseBitvector(size_t i) { set(i); } // singleton ctor
+
+    void reset() { _words.clear(); _base = 0; _count = 0; }
+    bool empty() const { return _count == 0; }
+    size_t size() const { return _count; }
+
+    void swap(DenseBitvector& oth) {
+        _words.swap(oth._words);
+        std::swap(_base, oth._base);
+        std::swap(_count, oth._count);
+    }
+
+    bool get(size_t i) const {
+        auto w = _find(i);
+        return w && (*w & _bit(i));
+    }
+
+    // returns the previous value of the i-th bit
+    bool set(size_t i) {
+        auto w = _find(i);
+        if (!w) {
+            _cover(i / BITS, i / BITS + 1);
+            w = _find(i);
+        }
+
+        if (*w & _bit(i))
+            return true;
+
+        *w |= _bit(i);
+        ++_count;
+        return false;
+    }
+
+    // returns the previous value of the i-th bit
+    bool unset(size_t i) {
+        auto w = _find(i);
+        if (!w || !(*w & _bit(i)))
+            return false;
+
+        *w &= ~_bit(i);
+        --_count;
+        if (_count == 0)
+            reset();
+        return true;
+    }
+
+    // union operation, returns true if the bitvector changed
+    bool set(const DenseBitvector& rhs) {
+        if (rhs.empty() || this == &rhs)
+            return false;
+
+        _cover(rhs._base, rhs._base + rhs._words.size());
+        size_t added = dense_bits::orWords(_words.data() + (rhs._base - _base),
+                                           rhs._words.data(),
+                                           rhs._words.size());
+        _count += added;
+        return added > 0;
+    }
+
+    // intersection, returns true if the bitvector changed
+    bool intersect(const DenseBitvector& rhs) {
+        if (empty() || this == &rhs)
+            return false;
+
+        if (rhs.empty()) {
+            reset();
+            return true;
+        }
+
+        // the words out of the range of rhs are cleared
+        size_t from = std::max(_base, rhs._base);
+        size_t to = std::min(_base + _words.size(),
+                             rhs._base + rhs._words.size());
+        size_t removed = 0;
+        for (size_t w = _base; w < _base + _words.size(); ++w) {
+            if (w >= from && w < to)
+                continue;
+            removed += dense_bits::countBits(_words[w - _base]);
+            _words[w - _base] = 0;
+        }
+
+        if (from < to) {
+            removed += dense_bits::andWords(_words.data() + (from - _base),
+                                            rhs._words.data() + (from - rhs._base),
+                                            to - from);
+        }
+
+        _count -= removed;
+        if (_count == 0)
+            reset();
+        return removed > 0;
+    }
+
+    class const_iterator {
+        const WordT *word{nullptr};
+        const WordT *word_end{nullptr};
+        size_t shift{0};
+        // the bits of the current word that were not visited yet
+        WordT bits{0};
+
+        void _skipEmpty() {
+            while (bits == 0 && ++word != word_end) {
+                shift += BITS;
+                bits = *word;
+            }
+        }
+
+        const_iterator(const WordT *w, const WordT *end, size_t sft)
+        : word(w), word_end(end), shift(sft) {
+            if (word != word_end) {
+                bits = *word;
+                _skipEmpty();
+            }
+        }
+
+    public:
+        const_iterator() = default;
+        const_iterator& operator++() {
+            assert(word != word_end && "operator++ called on end");
+            bits &= bits - 1;
+            _skipEmpty();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        size_t operator*() const {
+            return shift + __builtin_ctzll(bits);
+        }
+
+        bool operator==(const const_iterator& rhs) const {
+            return word == rhs.word && bits == rhs.bits;
+        }
+
+        bool operator!=(const const_iterator& rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class DenseBitvector;
+    };
+
+    const_iterator begin() const {
+        return const_iterator(_words.data(), _words.data() + _words.size(),
+                              _base * BITS);
+    }
+
+    const_iterator end() const {
+        auto e = _words.data() + _words.size();
+        return const_iterator(e, e, (_base + _words.size()) * BITS);
+    }
+
+    friend class const_iterator;
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_DENSE_BITVECTOR_H_
@@ -0,0 +1,101 @@
+#ifndef _DG_SMALL_SORTED_SET_H_
+#define _DG_SMALL_SORTED_SET_H_
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+// A set of elements kept in a sorted array. Up to 'InlineNum' elements
+// are stored inline in the object, more elements are moved
+// to a vector on the heap. The elements cannot be modified
+// through the iterators (it would break the order).
+template <typename T, unsigned InlineNum = 4>
+class SmallSortedSet {
+    T _inline[InlineNum]{};
+    // the number of inline elements
+    unsigned _size{0};
+    // the elements if there is more than InlineNum of them
+    std::vector<T> _large;
+
+    bool isLarge() const { return !_large.empty(); }
+
+public:
+    using iterator = const T *;
+    using const_iterator = const T *;
+    using value_type = T;
+
+    SmallSortedSet() = default;
+    SmallSortedSet(std::initializer_list<T> elems) {
+        for (const T& e : elems)
+            insert(e);
+    }
+
+    const_iterator begin() const { return isLarge() ? _large.data() : _inline; }
+    const_iterator end() const { return begin() + size(); }
+
+    size_t size() const { return isLarge() ? _large.size() : _size; }
+    bool empty() const { return size() == 0; }
+
+    const_iterator find(const T& elem) const {
+        auto it = std::lower_bound(begin(), end(), elem);
+        if (it != end() && *it == elem)
+            return it;
+        return end();
+    }
+
+    size_t count(const T& elem) const { return find(elem) != end(); }
+
+    std::pair<const_iterator, bool> insert(const T& elem) {
+        auto it = std::lower_bound(begin(), end(), elem);
+        if (it != end() && *it == elem)
+            return {it, false};
+
+        size_t pos = it - begin();
+        if (isLarge()) {
+            _large.insert(_large.begin() + pos, elem);
+        } else if (_size < InlineNum) {
+            std::move_backward(_inline + pos, _inline + _size,
+                               _inline + _size + 1);
+            _inline[pos] = elem;
+            ++_size;
+        } else {
+            // move the elements to the heap
+            _large.reserve(2 * InlineNum);
+            _large.assign(_inline, _inline + _size);
+            _large.insert(_large.begin() + pos, elem);
+            _size = 0;
+        }
+
+        assert(std::is_sorted(begin(), end()));
+        return {begin() + pos, true};
+    }
+
+    template <typename IteratorT>
+    void insert(IteratorT b, IteratorT e) {
+        for (; b != e; ++b)
+            insert(*b);
+    }
+
+    void clear() {
+        _large.clear();
+        _size = 0;
+    }
+
+    bool operator==(const SmallSortedSet& rhs) const {
+        return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+    }
+
+    bool operator!=(const SmallSortedSet& rhs) const {
+        return !operator==(rhs);
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_SMALL_SORTED_SET_H_
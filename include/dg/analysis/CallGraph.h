@@ -1,6 +1,7 @@
 #ifndef _DG_GENERIC_CALLGRAPH_H_
 #define _DG_GENERIC_CALLGRAPH_H_
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -13,7 +14,7 @@ public:
         std::vector<FuncNode *> _callers;
 
         template <typename Cont>
-        bool _contains(FuncNode *x, const Cont& C) const {
+        bool _contains(const FuncNode *x, const Cont& C) const {
             for (auto s : C) {
                 if (s == x)
                     return true;
@@ -27,8 +28,8 @@ public:
         FuncNode(unsigned id, ValueT& nd) : _id(id), value(nd) {};
         FuncNode(FuncNode&&) = default;
 
-        bool calls(FuncNode *x) const { return _contains(x, _calls); }
-        bool isCalledBy(FuncNode *x) const { return _contains(x, _callers); }
+        bool calls(const FuncNode *x) const { return _contains(x, _calls); }
+        bool isCalledBy(const FuncNode *x) const { return _contains(x, _callers); }
         unsigned getID() const { return _id; }
 
         bool addCall(FuncNode *x) {
@@ -42,6 +43,30 @@ public:
 
         const std::vector<FuncNode *>& getCalls() const { return _calls; }
         const std::vector<FuncNode *>& getCallers() const { return _callers; }
+
+        // remove the call of x (if any)
+        bool removeCall(FuncNode *x) {
+            if (!calls(x))
+                return false;
+            _erase(x, _calls);
+            _erase(this, x->_callers);
+            return true;
+        }
+
+        // remove all the calls from and to this node
+        void removeCalls() {
+            for (auto c : _calls)
+                _erase(this, c->_callers);
+            for (auto c : _callers)
+                _erase(this, c->_calls);
+            _calls.clear();
+            _callers.clear();
+        }
+
+    private:
+        static void _erase(FuncNode *x, std::vector<FuncNode *>& C) {
+            C.erase(std::remove(C.begin(), C.end(), x), C.end());
+        }
     };
 
     // a calls b
@@ -51,6 +76,26 @@ public:
         return A->addCall(B);
     }
 
+    // a does not call b anymore
+    bool removeCall(const ValueT& a, const ValueT& b) {
+        auto A = _mapping.find(a);
+        auto B = _mapping.find(b);
+        if (A == _mapping.end() || B == _mapping.end())
+            return false;
+        return A->second.removeCall(&B->second);
+    }
+
+    // remove the function (and all calls from and to it)
+    bool remove(const ValueT& v) {
+        auto it = _mapping.find(v);
+        if (it == _mapping.end())
+            return false;
+
+        it->second.removeCalls();
+        _mapping.erase(it);
+        return true;
+    }
+
 private:
     unsigned last_id{0};
 
@@ -68,6 +113,67 @@ private:
     //std::vector<FuncNode> _nodes;
 
 public:
+    // The strongly connected components of the call graph (the sets
+    // of mutually recursive functions). The callees go before
+    // the callers, so the components are in the bottom-up order.
+    std::vector<std::vector<const FuncNode *>> getSCCs() const {
+        std::vector<std::vector<const FuncNode *>> sccs;
+        // Tarjan's algorithm, the indices are numbered from 1
+        std::map<const FuncNode *, std::pair<unsigned, unsigned>> info; // index, lowpt
+        std::vector<const FuncNode *> stack;
+        std::map<const FuncNode *, bool> onStack;
+        unsigned index = 0;
+
+        // the explicit stack of the DFS: node and the next call to visit
+        std::vector<std::pair<const FuncNode *, size_t>> dfs;
+        for (const auto& it : _mapping) {
+            if (info.count(&it.second) > 0)
+                continue;
+
+            dfs.emplace_back(&it.second, 0);
+            while (!dfs.empty()) {
+                const FuncNode *cur = dfs.back().first;
+                size_t& next = dfs.back().second;
+                if (next == 0 && info.count(cur) == 0) {
+                    ++index;
+                    info[cur] = {index, index};
+                    stack.push_back(cur);
+                    onStack[cur] = true;
+                }
+
+                if (next < cur->getCalls().size()) {
+                    const FuncNode *succ = cur->getCalls()[next++];
+                    if (info.count(succ) == 0)
+                        dfs.emplace_back(succ, 0);
+                    else if (onStack[succ])
+                        info[cur].second = std::min(info[cur].second,
+                                                    info[succ].first);
+                    continue;
+                }
+
+                dfs.pop_back();
+                if (!dfs.empty()) {
+                    const FuncNode *parent = dfs.back().first;
+                    info[parent].second = std::min(info[parent].second,
+                                                   info[cur].second);
+                }
+
+                if (info[cur].first == info[cur].second) {
+                    sccs.emplace_back();
+                    const FuncNode *w;
+                    do {
+                        w = stack.back();
+                        stack.pop_back();
+                        onStack[w] = false;
+                        sccs.back().push_back(w);
+                    } while (w != cur);
+                }
+            }
+        }
+
+        return sccs;
+    }
+
     auto begin() -> decltype(_mapping.begin()) { return _mapping.begin(); }
     auto end() -> decltype(_mapping.end()) { return _mapping.end(); }
     auto begin() const -> decltype(_mapping.begin()) { return _mapping.begin(); }
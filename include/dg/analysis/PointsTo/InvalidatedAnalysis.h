@@ -8,7 +8,6 @@
 #include <memory>
 #include <sstream>
 #include <fstream>
-#include <llvm/ADT/STLExtras.h>
 
 namespace dg {
 namespace analysis {
@@ -240,7 +239,7 @@ class InvalidatedAnalysis {
         }
 
         bool changed = false;
-        auto preds = node->getPredecessors();
+        std::vector<PSNode *> preds = node->getPredecessors();
         State* st = getState(node);
 
         if ( auto* alloc = PSNodeAlloc::get(node)) {
@@ -362,7 +361,7 @@ public:
     explicit InvalidatedAnalysis(PointerGraph *ps)
     : PS(ps), _mapping(ps->size()), _states(ps->size()) {
         for (size_t i = 1; i < ps->size(); ++i) {
-            _states[i] = llvm::make_unique<State>();
+            _states[i].reset(new State());
             _mapping[i] = _states[i].get();
         }
     }
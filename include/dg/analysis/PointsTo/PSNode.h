@@ -1,6 +1,7 @@
 #ifndef _DG_PS_NODE_H_
 #define _DG_PS_NODE_H_
 
+#include <algorithm>
 #include <cassert>
 #include <cstdarg>
 #include <string>
@@ -130,6 +131,10 @@ class PSNode : public SubgraphNode<PSNode>
     // in some cases we need to know from which function the node is
     PointerSubgraph *_parent = nullptr;
 
+    // numbering of nodes and pointers of the graph the node belongs to
+    // (used by the points-to sets that are represented by bitvectors)
+    PointerIdTable *_idTable = nullptr;
+
     unsigned int dfsid = 0;
 
 protected:
@@ -182,22 +187,10 @@ protected:
     //               invalidates memory after returning from a function
     // FREE:         invalidates memory after calling free function on a pointer
 
+    // NOTE: ALLOC and FUNCTION nodes always point to themselves,
+    // the pointer is added by PointerGraph when the node is registered
     PSNode(unsigned id, PSNodeType t)
-    : SubgraphNode<PSNode>(id), type(t) {
-        switch(type) {
-            case PSNodeType::ALLOC:
-            case PSNodeType::FUNCTION:
-                // these always points-to itself
-                // (they points to the node where the memory was allocated)
-                addPointsTo(this, 0);
-                break;
-            case PSNodeType::CALL:
-                // the call without arguments
-                break;
-            default:
-                break;
-        }
-    }
+    : SubgraphNode<PSNode>(id), type(t) {}
 
     // ctor for memcpy
     PSNode(unsigned id, PSNodeType t, PSNode *op1, PSNode *op2)
@@ -236,8 +229,7 @@ protected:
             case PSNodeType::FUNCTION:
             case PSNodeType::FORK:
             case PSNodeType::JOIN:
-                // no operands (and FUNCTION has been set up
-                // in the super ctor)
+                // no operands
                 break;
             case PSNodeType::CAST:
             case PSNodeType::LOAD:
@@ -300,6 +292,8 @@ public:
     PointerSubgraph *getParent() { return _parent; }
     const PointerSubgraph *getParent() const { return _parent; }
 
+    PointerIdTable *getIdTable() const { return _idTable; }
+
     PSNode *getPairedNode() const { return pairedNode; }
     void setPairedNode(PSNode *n) { pairedNode = n; }
 
@@ -370,6 +364,24 @@ public:
     friend void getNodes(std::set<PSNode *>& cont, PSNode *n, PSNode* exit, unsigned int dfsnum);
 };
 
+inline size_t PointerIdTable::getNodeIndex(PSNode *node) {
+    // special nodes do not belong to any graph and have ID 0
+    if (node->getID() == 0) {
+        if (node == NULLPTR)
+            return 0;
+        if (node == UNKNOWN_MEMORY)
+            return 1;
+        assert(node == INVALIDATED && "A node without ID");
+        return 2;
+    }
+
+    return node->getID() - 1 + SPECIAL_NODES_NUM;
+}
+
+inline PointerIdTable *PointerIdTable::get(PSNode *node) {
+    return node->getIdTable();
+}
+
 
 // check type of node
 template <PSNodeType T> bool isa(const PSNode *n) {
@@ -509,6 +521,15 @@ public:
         callers.push_back(n);
         return true;
     }
+
+    bool removeCaller(PSNode *n) {
+        auto it = std::find(callers.begin(), callers.end(), n);
+        if (it == callers.end())
+            return false;
+
+        callers.erase(it);
+        return true;
+    }
 };
 
 class PSNodeCall : public PSNode {
@@ -546,6 +567,15 @@ public:
         return true;
     }
 
+    bool removeCallee(PointerSubgraph *ps) {
+        auto it = std::find(callees.begin(), callees.end(), ps);
+        if (it == callees.end())
+            return false;
+
+        callees.erase(it);
+        return true;
+    }
+
 #ifndef NDEBUG
     // verbose dump
     void dumpv() const override {
@@ -602,6 +632,15 @@ public:
         return true;
     }
 
+    bool removeReturn(PSNode *p) {
+        auto it = std::find(returns.begin(), returns.end(), p);
+        if (it == returns.end())
+            return false;
+
+        returns.erase(it);
+        return true;
+    }
+
 #ifndef NDEBUG
     // verbose dump
     void dumpv() const override {
@@ -646,6 +685,15 @@ public:
         return true;
     }
 
+    bool removeReturnSite(PSNode *r) {
+        auto it = std::find(returns.begin(), returns.end(), r);
+        if (it == returns.end())
+            return false;
+
+        returns.erase(it);
+        return true;
+    }
+
 #ifndef NDEBUG
     // verbose dump
     void dumpv() const override {
@@ -37,6 +37,18 @@ protected:
 
     const PointerAnalysisOptions options{};
 
+    // statistics
+    unsigned _iterationsNum{0};
+    size_t _processedNodesNum{0};
+
+    // the positions of nodes in the topological order
+    // of the graph of operands (indexed by IDs of nodes)
+    std::vector<unsigned> _priority;
+
+    void computePriorities();
+    // sort the nodes to process with the topological worklist order
+    void orderToProcess();
+
 public:
 
     PointerAnalysis(PointerGraph *ps,
@@ -78,6 +90,11 @@ public:
 
     PointerGraph *getPS() const { return PS; }
 
+    // the number of rounds of the iterative solver
+    unsigned getNumOfIterations() const { return _iterationsNum; }
+    // how many times were the nodes processed (in all rounds)
+    size_t getNumOfProcessedNodes() const { return _processedNodesNum; }
+
 
     virtual void enqueue(PSNode *n)
     {
@@ -93,6 +110,7 @@ public:
         assert(root && "Do not have root of PS");
         // rely on C++11 move semantics
         to_process = PS->getNodes(root);
+        orderToProcess();
     }
 
     void queue_globals() {
@@ -105,6 +123,9 @@ public:
     bool iteration() {
         assert(changed.empty());
 
+        ++_iterationsNum;
+        _processedNodesNum += to_process.size();
+
         for (PSNode *cur : to_process) {
             bool enq = false;
             enq |= beforeProcessed(cur);
@@ -133,11 +154,17 @@ public:
             assert(!to_process.empty());
             assert(to_process.size() >= changed.size());
             changed.clear();
+            orderToProcess();
         }
     }
 
     virtual void run();
 
+    // make sure that the points-to set of the node is computed,
+    // the analyses that compute all the sets in run() have nothing to do
+    // (see PointerAnalysisOptions::demandDriven)
+    virtual void demand(PSNode * /* node */) {}
+
     // generic error
     // @msg - message for the user
     // XXX: maybe create some enum that will represent the error
@@ -179,14 +206,31 @@ public:
     // we do not need to pass this to the LLVM part...
     virtual bool handleJoin(PSNode *) { return false; }
 
-private:
+protected:
 
     // check the sanity of results of pointer analysis
     void sanityCheck();
 
+    // process global nodes, these must reach fixpoint after one iteration
+    void processGlobals();
+
+    // Return true if it makes sense to dereference this pointer.
+    static bool canBeDereferenced(const Pointer& ptr);
+
     bool processNode(PSNode *);
     bool processLoad(PSNode *node);
     bool processGep(PSNode *node);
+    // Load (or shift) the pointers from 'pointers' (that are a subset
+    // of the operand's points-to set) and put the result into 'out'.
+    // The solvers that track the changes use these to process
+    // only the newly added pointers.
+    bool processLoad(PSNode *node, const PointsToSetT& pointers,
+                     PointsToSetT& out);
+    bool processGep(PSNode *node, const PointsToSetT& pointers,
+                    PointsToSetT& out);
+    // load from one of the memory objects that the pointer points to
+    bool processLoad(PSNode *node, const Pointer& ptr, MemoryObject *o,
+                     bool single, PointsToSetT& out);
     bool processMemcpy(PSNode *node);
     bool processMemcpy(std::vector<MemoryObject *>& srcObjects,
                        std::vector<MemoryObject *>& destObjects,
@@ -4,6 +4,9 @@
 #include <cassert>
 #include <vector>
 #include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "PointerAnalysis.h"
 
@@ -16,45 +19,130 @@ namespace pta {
 //
 class PointerAnalysisFI : public PointerAnalysis
 {
-    std::vector<std::unique_ptr<MemoryObject>> memory_objects;
+    ///
+    // Data of the difference propagation solver.
+    // The vectors are indexed by the IDs of nodes.
+    //
+    // Pointers that were added to the node, but have not
+    // been propagated to the users of the node yet
+    std::vector<PointsToSetT> _delta;
 
-    void preprocessGEPs()
+    enum DiffFlags : uint8_t {
+        // the node is in the worklist
+        IN_QUEUE = 1,
+        // the node must be processed with the whole points-to
+        // sets of the operands (not only with the deltas)
+        NEEDS_FULL = 1 << 1,
+        // the node is reachable from the entry and takes part in the
+        // fixpoint computation (the same set of nodes that
+        // the iterative solver processes)
+        ACTIVE = 1 << 2,
+        // the points-to set of the node was retracted (see retract())
+        RETRACTED = 1 << 3,
+        // the node is reachable from the entry, but the demand-driven
+        // analysis solves it only when it is demanded (then it is ACTIVE)
+        REACHABLE = 1 << 4,
+    };
+
+    std::vector<uint8_t> _flags;
+    ADT::QueueFIFO<PSNode *> _worklist;
+    // nodes that read the contents of a memory object (loads and memcpy),
+    // these must be processed again whenever the object changes
+    std::unordered_map<MemoryObject *, std::set<PSNode *>> _readers;
+    // register the readers in getMemoryObjects()
+    bool _trackReaders{false};
+
+    // Nodes on a cycle of copy edges (casts, phis and zero-offset GEPs)
+    // must end up with the same points-to set, so such cycles are collapsed
+    // into one representative node while the solver runs. The points-to
+    // sets of the collapsed nodes are filled in when the analysis finishes.
+    //
+    // the representative of the node (indexed by IDs, nullptr if none)
+    std::vector<PSNode *> _rep;
+    // nodes that were collapsed into the representative
+    std::unordered_map<PSNode *, std::vector<PSNode *>> _collapsed;
+    // copy edges that were already used to search for a cycle
+    std::set<std::pair<PSNode *, PSNode *>> _checkedEdges;
+    unsigned _collapsedNodesNum{0};
+
+    void preprocessGEPs(PointerSubgraph& sg)
     {
         // if a node is in a loop (a scc that has more than one node),
         // then every GEP that is also stored to the same memory afterwards
         // in the loop will end up with Offset::UNKNOWN after some
         // number of iterations (in FI analysis), so we can do that right now
         // and save iterations
-
-        assert(getPS() && "Must have PG");
-        for (auto& sg : getPS()->getSubgraphs()) {
-            for (auto& loop : sg->getLoops()) {
-                for (PSNode *n : loop) {
-                    if (PSNodeGep *gep = PSNodeGep::get(n))
-                        gep->setOffset(Offset::UNKNOWN);
-                }
+        for (auto& loop : sg.getLoops()) {
+            for (PSNode *n : loop) {
+                if (PSNodeGep *gep = PSNodeGep::get(n))
+                    gep->setOffset(Offset::UNKNOWN);
             }
         }
     }
 
-public:
-    PointerAnalysisFI(PointerGraph *ps)
-    : PointerAnalysis(ps) {
-        memory_objects.reserve(std::max(ps->size() / 100, static_cast<size_t>(8)));
+    void preprocessGEPs()
+    {
+        assert(getPS() && "Must have PG");
+        for (auto& sg : getPS()->getSubgraphs())
+            preprocessGEPs(*sg);
     }
 
-    void preprocess() override {
-        if (options.preprocessGeps)
-            preprocessGEPs();
-    }
+    // difference propagation solver
+    void runDiffPropagation();
+    void diffSolve();
+    void diffResize();
+    void diffSchedule(PSNode *n, bool full);
+    void diffScheduleReachable(PSNode *from);
+    void diffProcess(PSNode *n);
+    void diffProcessFull(PSNode *n);
+    void diffProcessOther(PSNode *n);
+    bool diffPropagate(PSNode *n, unsigned idx, const PointsToSetT& pointers);
+    void diffMemoryChanged(MemoryObject *mo);
+    bool diffAddPointsTo(PSNode *n, const PointsToSetT& pointers);
 
-    void getMemoryObjects(PSNode *where, const Pointer& pointer,
-                          std::vector<MemoryObject *>& objects) override
-    {
-        // irrelevant in flow-insensitive
-        (void) where;
-        PSNode *n = pointer.target;
+    // cycle collapsing
+    PSNode *diffFind(PSNode *n);
+    void diffCopyUsers(PSNode *rep, std::vector<PSNode *>& users);
+    void diffCollapseCycles(PSNode *from);
+    void diffCollapse(const std::vector<PSNode *>& cycle);
+    void diffFinish();
 
+    // incremental analysis (see PointerAnalysisFIIncremental.cpp)
+    //
+    // memory nodes whose objects were cleared by the retraction
+    std::unordered_set<PSNode *> _retractedMemory;
+    // the nodes with lower IDs existed when the analysis finished
+    size_t _solvedNodesNum{0};
+    void diffMarkActive();
+    bool diffRetract(const std::vector<PSNode *>& from,
+                     const std::unordered_set<PSNode *>& removed);
+
+    // demand-driven analysis (see PointerAnalysisFIDemand.cpp)
+    //
+    // the analysis did not solve the whole graph yet
+    bool _demanding{false};
+    // nodes whose operands must be demanded
+    std::vector<PSNode *> _demandQueue;
+    // reachable stores and memcpys that were not demanded
+    std::vector<PSNode *> _pendingWriters;
+    size_t _demandedNodesNum{0};
+    void runDemand();
+    void diffReach(PSNode *n);
+    void diffDemand(PSNode *n);
+    bool diffDemandOperands();
+    bool diffDemandWriters();
+    bool diffDemandTargets(PSNode *n, std::vector<PSNode *>& targets);
+    void diffDemandFixpoint();
+    void diffDemandAll();
+
+    // parallel solver (see PointerAnalysisFIParallel.cpp)
+    class ParallelSolver;
+    void runParallel();
+    // how many nodes processed the threads of the parallel solver
+    std::vector<size_t> _threadProcessedNodes;
+
+    // the node whose memory object holds the memory that 'n' points to
+    static PSNode *getMemoryNode(PSNode *n) {
         // we want to have memory in allocation sites
         if (n->getType() == PSNodeType::CAST || n->getType() == PSNodeType::GEP)
             n = n->getOperand(0);
@@ -63,6 +151,87 @@ public:
             n = (*n->pointsTo.begin()).target;
         }
 
+        return n;
+    }
+
+public:
+    PointerAnalysisFI(PointerGraph *ps, const PointerAnalysisOptions& opts)
+    : PointerAnalysis(ps, opts) {}
+
+    PointerAnalysisFI(PointerGraph *ps) : PointerAnalysisFI(ps, {}) {}
+
+    void preprocess() override {
+        if (options.preprocessGeps)
+            preprocessGEPs();
+    }
+
+    void run() override {
+        if (options.isDemandDriven())
+            runDemand();
+        else if (options.isParallel()) {
+            runParallel();
+            diffMarkActive();
+        } else if (options.isDiffPropagation())
+            runDiffPropagation();
+        else
+            PointerAnalysis::run();
+    }
+
+    ///
+    // Incremental analysis. The graph that was analyzed by the difference
+    // propagation (or by the parallel solver) may be changed and
+    // the analysis run again only on the part of the graph that
+    // is affected by the change. The results are the same as if
+    // the analysis run on the changed graph from scratch.
+    //
+    // Before removing nodes from the graph, call retract() with the nodes.
+    // This resets the points-to sets of the nodes (and the memory objects)
+    // that may depend on the removed nodes. Then change the graph (remove
+    // the nodes, add new nodes and edges) and call reanalyze().
+    // Every new edge (an operand or a CFG edge) must go from or to
+    // a new node. The GEPs in the new subgraphs are preprocessed
+    // like in preprocess(), if the options say so.
+    //
+    // Both return false if the changes cannot be handled incrementally
+    // (i.e., a call via a pointer or a thread that was already resolved
+    // may be affected, as the analysis cannot take back the changes
+    // of the graph made on these nodes). Then the analysis must be run
+    // from scratch on a new graph. retract() does not change anything
+    // in that case.
+    bool retract(const std::vector<PSNode *>& nodes);
+    bool reanalyze(const std::vector<PointerSubgraph *>& newSubgraphs = {});
+
+    ///
+    // Demand-driven analysis (see PointerAnalysisOptions::demandDriven).
+    // run() only resolves the calls via pointers and the points-to set
+    // of a node is computed when the node is demanded. Only the nodes
+    // that the demanded node depends on are solved: its operands and
+    // the stores (memcpys) that may write to the memory that the loads
+    // among them read. The solved nodes are not solved again by the next
+    // queries. The results are the same as the results of run()
+    // without this option.
+    void demand(PSNode *n) override;
+
+    // are some points-to sets still not computed?
+    bool isDemanding() const { return _demanding; }
+
+    // the number of nodes solved by the demand-driven analysis
+    size_t getNumOfDemandedNodes() const { return _demandedNodesNum; }
+
+    // the number of nodes that were collapsed into
+    // a representative of a cycle (difference propagation only)
+    unsigned getNumOfCollapsedNodes() const { return _collapsedNodesNum; }
+
+    // the number of nodes processed by every thread
+    // of the parallel solver
+    const std::vector<size_t>& getNumOfProcessedNodesPerThread() const {
+        return _threadProcessedNodes;
+    }
+
+    void getMemoryObjects(PSNode *where, const Pointer& pointer,
+                          std::vector<MemoryObject *>& objects) override
+    {
+        PSNode *n = getMemoryNode(pointer.target);
         if (n->getType() == PSNodeType::FUNCTION)
             return;
 
@@ -71,11 +240,19 @@ public:
 
         MemoryObject *mo = n->getData<MemoryObject>();
         if (!mo) {
-            mo = new MemoryObject(n);
-            memory_objects.emplace_back(mo);
+            // the objects live with the graph
+            mo = PS->createMemoryObject(n);
             n->setData<MemoryObject>(mo);
         }
 
+        // the location is irrelevant in flow-insensitive analysis,
+        // but the difference propagation needs to know who
+        // reads from the object
+        if (_trackReaders &&
+            (where->getType() == PSNodeType::LOAD ||
+             where->getType() == PSNodeType::MEMCPY))
+            _readers[mo].insert(where);
+
         objects.push_back(mo);
     }
 };
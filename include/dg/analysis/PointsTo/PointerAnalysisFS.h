@@ -3,9 +3,12 @@
 
 #include <cassert>
 #include <memory>
+#include <map>
+#include <vector>
 
 #include "MemoryObject.h"
 #include "PointerGraph.h"
+#include "dg/util/cow_shared_ptr.h"
 
 namespace dg {
 namespace analysis {
@@ -18,7 +21,16 @@ class PointerAnalysisFS : public PointerAnalysis
 {
 public:
     //using MemoryObjectsSetT = std::set<MemoryObject *>;
-    using MemoryMapT = std::map<PSNode *, std::unique_ptr<MemoryObject>>;
+    // memory objects are shared between the memory maps
+    // and copied only when a map writes to the object
+    using MemoryObjectPtrT = cow_shared_ptr<MemoryObject>;
+
+    struct MemoryMapT : public std::map<PSNode *, MemoryObjectPtrT> {
+        // increased whenever the map may have changed,
+        // so that the joins can skip maps that they have
+        // already merged
+        unsigned version{0};
+    };
 
     // this is an easy but not very efficient implementation,
     // works for testing
@@ -56,6 +68,11 @@ public:
             // to this map
             PSNode *pred = n->getSinglePredecessor();
             mm = pred->getData<MemoryMapT>();
+            // the predecessor may not have been processed yet
+            // if the nodes are not processed in the order
+            // of the control flow
+            if (!mm)
+                mm = initPredecessorsMaps(pred);
             assert(mm && "No memory map in the predecessor");
         }
 
@@ -94,7 +111,7 @@ public:
             for (PSNode *p : n->getPredecessors()) {
                 if (MemoryMapT *pm = p->getData<MemoryMapT>()) {
                     // merge pm to mm (but only if pm was already created)
-                    changed |= mergeMaps(mm, pm, overwritten);
+                    changed |= mergePredecessorMap(n, mm, pm, overwritten);
                 }
             }
 
@@ -103,7 +120,7 @@ public:
                 for (auto p : CR->getReturns()) {
                     if (MemoryMapT *pm = p->getData<MemoryMapT>()) {
                         // merge pm to mm (but only if pm was already created)
-                        changed |= mergeMaps(mm, pm, overwritten);
+                        changed |= mergePredecessorMap(n, mm, pm, overwritten);
                     }
                 }
             }
@@ -111,7 +128,7 @@ public:
                 for (auto p : E->getCallers()) {
                     if (MemoryMapT *pm = p->getData<MemoryMapT>()) {
                         // merge pm to mm (but only if pm was already created)
-                        changed |= mergeMaps(mm, pm, overwritten);
+                        changed |= mergePredecessorMap(n, mm, pm, overwritten);
                     }
                 }
             }
@@ -125,6 +142,18 @@ public:
         return false;
     }
 
+    // the node is enqueued if anything changed on it,
+    // so also its memory map may have changed
+    void enqueue(PSNode *n) override
+    {
+        if (needsMerge(n)) {
+            if (MemoryMapT *mm = n->getData<MemoryMapT>())
+                ++mm->version;
+        }
+
+        PointerAnalysis::enqueue(n);
+    }
+
     void getMemoryObjects(PSNode *where, const Pointer& pointer,
                           std::vector<MemoryObject *>& objects) override
     {
@@ -133,7 +162,13 @@ public:
 
         auto I = mm->find(pointer.target);
         if (I != mm->end()) {
-            objects.push_back(I->second.get());
+            // nodes that can write to memory have their own map,
+            // so they get their own copy of the object. The other
+            // nodes only read the object.
+            if (canChangeMM(where))
+                objects.push_back(I->second.getWritable());
+            else
+                objects.push_back(const_cast<MemoryObject *>(I->second.get()));
         }
 
         // if we haven't found any memory object, but this psnode
@@ -141,11 +176,52 @@ public:
         // the write has something to write to
         if (objects.empty() && canChangeMM(where)) {
             MemoryObject *mo = new MemoryObject(pointer.target);
-            mm->emplace(pointer.target, std::unique_ptr<MemoryObject>(mo));
+            (*mm)[pointer.target].reset(mo);
             objects.push_back(mo);
         }
     }
 
+    // merge the contents of 'from' to 'to', skip the offsets
+    // of the pointers that are in 'overwritten' (strong update)
+    static bool mergeObjects(PSNode *node,
+                             MemoryObject *to,
+                             const MemoryObject *from,
+                             PointsToSetT *overwritten) {
+        bool changed = false;
+
+        for (auto& fromIt : from->pointsTo) {
+            if (overwritten &&
+                overwritten->count(Pointer(node, fromIt.first)))
+                continue;
+
+            auto& S = to->pointsTo[fromIt.first];
+            for (const auto& ptr : fromIt.second)
+                changed |= S.add(ptr);
+        }
+
+        return changed;
+    }
+
+    // the loops must be computed
+    static bool isOnLoop(const PSNode *n) {
+        // if the scc's size > 1, the node is in loop
+        return n->getParent() ?
+                (n->getParent()->getLoop(n) != nullptr) : false;
+    }
+
+    static bool pointsToAllocationInLoop(PSNode *n) {
+        for (const auto& ptr : n->pointsTo) {
+            // skip invalidated, null and unknown memory
+            if (!ptr.isValid() || ptr.isInvalidated())
+                continue;
+
+            if (isOnLoop(ptr.target))
+                return true;
+        }
+        return false;
+
+    }
+
 protected:
 
     static bool canChangeMM(PSNode *n) {
@@ -172,25 +248,6 @@ protected:
             return false;
     }
 
-    static bool mergeObjects(PSNode *node,
-                             MemoryObject *to,
-                             MemoryObject *from,
-                             PointsToSetT *overwritten) {
-        bool changed = false;
-
-        for (auto& fromIt : from->pointsTo) {
-            if (overwritten &&
-                overwritten->count(Pointer(node, fromIt.first)))
-                continue;
-
-            auto& S = to->pointsTo[fromIt.first];
-            for (const auto& ptr : fromIt.second)
-                changed |= S.add(ptr);
-        }
-
-        return changed;
-    }
-
     // Merge two Memory maps, return true if any new information was created,
     // otherwise return false
     static bool mergeMaps(MemoryMapT *mm, MemoryMapT *from,
@@ -198,40 +255,106 @@ protected:
         bool changed = false;
         for (auto& it : *from) {
             PSNode *fromTarget = it.first;
-            std::unique_ptr<MemoryObject>& toMo = (*mm)[fromTarget];
-            if (toMo == nullptr)
-                toMo.reset(new MemoryObject(fromTarget));
+            const MemoryObjectPtrT& fromMo = it.second;
+            // the strong update may drop some contents of the object
+            bool filter = overwritten && overwritten->pointsToTarget(fromTarget);
+
+            auto toIt = mm->find(fromTarget);
+            if (toIt == mm->end()) {
+                if (!filter) {
+                    // just share the object, it gets copied on write
+                    mm->emplace(fromTarget, fromMo);
+                    changed |= !isSubset(fromMo.get(), nullptr);
+                    continue;
+                }
+
+                toIt = mm->emplace(fromTarget, MemoryObjectPtrT()).first;
+                toIt->second.reset(new MemoryObject(fromTarget));
+            } else if (toIt->second.get() == fromMo.get()) {
+                // we already share the object
+                continue;
+            }
 
-            changed |= mergeObjects(fromTarget, toMo.get(),
-                                    it.second.get(), overwritten);
+            if (!filter) {
+                // do not copy the object if the merge would not change it
+                if (isSubset(fromMo.get(), toIt->second.get()))
+                    continue;
+                // the merge would yield the contents of 'from',
+                // so share it instead
+                if (isSubset(toIt->second.get(), fromMo.get())) {
+                    toIt->second = fromMo;
+                    changed = true;
+                    continue;
+                }
+            }
+
+            changed |= mergeObjects(fromTarget, toIt->second.getWritable(),
+                                    fromMo.get(), overwritten);
         }
 
         return changed;
     }
 
-    MemoryMapT *createMM() {
-        MemoryMapT *mm = new MemoryMapT();
-        memoryMaps.emplace_back(mm);
-        return mm;
+    // are all the pointers from 'mo' also in 'of'?
+    // (nullptr 'of' is an empty object)
+    static bool isSubset(const MemoryObject *mo, const MemoryObject *of) {
+        for (const auto& it : mo->pointsTo) {
+            if (it.second.empty())
+                continue;
+            if (!of)
+                return false;
+            auto ofIt = of->pointsTo.find(it.first);
+            if (ofIt == of->pointsTo.end())
+                return false;
+            for (const auto& ptr : it.second) {
+                if (!ofIt->second.pointsTo(ptr))
+                    return false;
+            }
+        }
+        return true;
     }
 
-    bool isOnLoop(const PSNode *n) const {
-        // if the scc's size > 1, the node is in loop
-        return n->getParent() ?
-                (n->getParent()->getLoop(n) != nullptr) : false;
-    }
+    // merge the map of a predecessor of the node 'n' to the map of 'n',
+    // skip the predecessor's map if it did not change since the last merge
+    bool mergePredecessorMap(PSNode *n, MemoryMapT *mm, MemoryMapT *from,
+                             PointsToSetT *overwritten) {
+        if (_mergedVersions.size() <= n->getID())
+            _mergedVersions.resize(n->getID() + 1);
 
-    bool pointsToAllocationInLoop(PSNode *n) const {
-        for (const auto& ptr : n->pointsTo) {
-            // skip invalidated, null and unknown memory
-            if (!ptr.isValid() || ptr.isInvalidated())
-                continue;
+        auto& merged = _mergedVersions[n->getID()];
+        auto it = merged.find(from);
+        if (it != merged.end() && it->second == from->version)
+            return false;
 
-            if (isOnLoop(ptr.target))
-                return true;
+        bool changed = mergeMaps(mm, from, overwritten);
+        // the version of 'from' is increased only after
+        // its node is processed, so we will not miss any change
+        merged[from] = from->version;
+        return changed;
+    }
+
+    // initialize the memory map of 'n' and of its predecessors
+    // that share the map with 'n'
+    MemoryMapT *initPredecessorsMaps(PSNode *n) {
+        std::vector<PSNode *> sharing;
+        while (!n->getData<MemoryMapT>() && !needsMerge(n)) {
+            sharing.push_back(n);
+            n = n->getSinglePredecessor();
         }
-        return false;
 
+        if (!n->getData<MemoryMapT>())
+            beforeProcessed(n);
+
+        MemoryMapT *mm = n->getData<MemoryMapT>();
+        for (PSNode *s : sharing)
+            s->setData<MemoryMapT>(mm);
+        return mm;
+    }
+
+    MemoryMapT *createMM() {
+        MemoryMapT *mm = new MemoryMapT();
+        memoryMaps.emplace_back(mm);
+        return mm;
     }
 
     static inline bool needsMerge(PSNode *n) {
@@ -253,6 +376,9 @@ private:
 
     // keep all the maps in order to free the memory
     std::vector<std::unique_ptr<MemoryMapT>> memoryMaps;
+    // the versions of the maps of predecessors that were merged
+    // to the map of a node the last time (indexed by IDs of nodes)
+    std::vector<std::map<const MemoryMapT *, unsigned>> _mergedVersions;
 };
 
 } // namespace pta
@@ -19,8 +19,53 @@ struct PointerAnalysisOptions : AnalysisOptions {
     // INVALIDATED object.
     bool invalidateNodes{false};
 
+    // How to compute the fixpoint in the flow-insensitive analysis.
+    // 'iterative' processes in every round all nodes that are reachable
+    // from the nodes changed in the previous round (the reference solver).
+    // 'diffprop' keeps a worklist of nodes and propagates only
+    // the newly added pointers from a node to its users.
+    // 'parallel' computes the same fixpoint as 'diffprop' with more
+    // threads that share the worklist (by stealing the work).
+    enum class SolverType { iterative, diffprop, parallel } solverType{SolverType::iterative};
+
+    // The number of threads of the parallel solver
+    // (0 means the number of hardware threads).
+    unsigned solverThreads{0};
+
+    // Detect cycles of copy nodes (casts, phis, zero GEPs)
+    // during the difference propagation and collapse them
+    // into one node.
+    bool collapseCycles{true};
+
+    // In which order the iterative solver processes the nodes of one round.
+    // 'bfs' is the order in which the nodes are found from the changed nodes,
+    // 'topological' processes the operands of a node before the node
+    // (the SCCs of the graph of operands in topological order
+    // and the nodes of one SCC in reverse post-order).
+    enum class WorklistOrder { bfs, topological } worklistOrder{WorklistOrder::bfs};
+
+    // Compute the points-to sets of the flow-insensitive analysis
+    // only on demand (see PointerAnalysisFI::demand()). Every query
+    // solves only the part of the graph that the queried node depends on.
+    // When the queries need more than 'demandBudget' nodes, the rest
+    // of the graph is solved the same way as with 'diffprop'
+    // (0 means a half of the nodes of the graph).
+    bool demandDriven{false};
+    unsigned demandBudget{0};
+
     PointerAnalysisOptions& setInvalidateNodes(bool b) { invalidateNodes = b; return *this;}
     PointerAnalysisOptions& setPreprocessGeps(bool b)  { preprocessGeps = b; return *this;}
+    PointerAnalysisOptions& setSolverType(SolverType t) { solverType = t; return *this;}
+    PointerAnalysisOptions& setCollapseCycles(bool b)  { collapseCycles = b; return *this;}
+    PointerAnalysisOptions& setSolverThreads(unsigned n) { solverThreads = n; return *this;}
+    PointerAnalysisOptions& setWorklistOrder(WorklistOrder o) { worklistOrder = o; return *this;}
+    PointerAnalysisOptions& setDemandDriven(bool b) { demandDriven = b; return *this;}
+    PointerAnalysisOptions& setDemandBudget(unsigned n) { demandBudget = n; return *this;}
+
+    bool isDiffPropagation() const { return solverType == SolverType::diffprop; }
+    bool isParallel() const { return solverType == SolverType::parallel; }
+    bool isTopologicalOrder() const { return worklistOrder == WorklistOrder::topological; }
+    bool isDemandDriven() const { return demandDriven; }
 };
 
 } // namespace analysis
@@ -0,0 +1,103 @@
+#ifndef _DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+#define _DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+
+#include <cassert>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "PointerAnalysisFI.h"
+#include "PointerAnalysisFS.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+///
+// Sparse flow-sensitive pointer analysis
+//
+// The analysis runs the flow-insensitive analysis first and uses its
+// results to find out which nodes may write (stores and memcpy) and read
+// (loads and memcpy) which memory objects. Then it connects every write
+// to an object with the reads and writes of the same object that the write
+// reaches in the control flow (def-use chains over memory). The second,
+// flow-sensitive, phase propagates the contents of the objects only along
+// these chains. A write keeps its own copy of the written objects, so there
+// are no memory maps of whole program states like in PointerAnalysisFS.
+//
+// The results are the same as the results of PointerAnalysisFS
+// (with the same strong updates), only the points-to sets of calls via
+// function pointers are kept from the flow-insensitive phase,
+// because the graph must not change in the flow-sensitive phase.
+class PointerAnalysisSFS : public PointerAnalysisFI
+{
+    // the state of one memory object on one node
+    struct ObjectState {
+        // the writes of the object that reach this node
+        std::vector<PSNode *> defs;
+        // the reads and writes that this write reaches
+        // (empty if this node is not a write of the object)
+        std::vector<PSNode *> uses;
+        // the contents of the object after the write
+        // or the contents merged from 'defs' for a read
+        // that is reached by more writes. A read reached
+        // by a single write uses the object of the write.
+        std::unique_ptr<MemoryObject> object;
+        bool isDef{false};
+    };
+
+    using ObjectStatesT = std::unordered_map<PSNode *, ObjectState>;
+
+    // the states of memory objects on nodes, indexed by node IDs
+    std::vector<ObjectStatesT> _states;
+    // successors in the control flow as seen by the memory
+    // (including call and return edges), indexed by node IDs
+    std::vector<std::vector<PSNode *>> _memSuccs;
+
+    enum SparseFlags : uint8_t {
+        // the node is reachable and takes part in the analysis
+        ACTIVE = 1,
+        IN_QUEUE = 1 << 1,
+    };
+
+    ADT::QueueFIFO<PSNode *> _queue;
+    std::vector<uint8_t> _sparseFlags;
+
+    // are we in the flow-sensitive phase?
+    bool _sparse{false};
+    size_t _defUseEdgesNum{0};
+
+    std::vector<PSNode *> sparseGetNodes();
+    void sparseBuildDefUse(const std::vector<PSNode *>& nodes);
+    void sparseAddAccesses(PSNode *n, PSNode *ptrNode, bool def);
+    void sparseConnect(PSNode *def, PSNode *target, std::vector<unsigned>& visited,
+                       unsigned mark);
+    void sparseResetPointsTo(const std::vector<PSNode *>& nodes);
+    void sparseSchedule(PSNode *n);
+    void sparseProcess(PSNode *n);
+    MemoryObject *sparseGetObject(PSNode *n, PSNode *target);
+    void runSparse();
+
+public:
+    PointerAnalysisSFS(PointerGraph *ps, PointerAnalysisOptions opts)
+    : PointerAnalysisFI(ps, opts.setPreprocessGeps(false)) {}
+
+    PointerAnalysisSFS(PointerGraph *ps) : PointerAnalysisSFS(ps, {}) {}
+
+    void run() override {
+        PointerAnalysisFI::run();
+        runSparse();
+    }
+
+    // the number of def-use edges between writes and reads of memory
+    size_t getNumOfDefUseEdges() const { return _defUseEdgesNum; }
+
+    void getMemoryObjects(PSNode *where, const Pointer& pointer,
+                          std::vector<MemoryObject *>& objects) override;
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
@@ -1,14 +1,17 @@
 #ifndef _DG_POINTER_GRAPH_H_
 #define _DG_POINTER_GRAPH_H_
 
+#include "dg/ADT/Arena.h"
 #include "dg/ADT/Queue.h"
 #include "dg/analysis/SubgraphNode.h"
 #include "dg/analysis/CallGraph.h"
 #include "dg/analysis/PointsTo/PSNode.h"
+#include "dg/analysis/PointsTo/MemoryObject.h"
 #include "dg/analysis/BFS.h"
 #include "dg/analysis/SCC.h"
 #include "dg/util/debug.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdarg>
 #include <vector>
@@ -126,18 +129,42 @@ class PointerGraph
     // FIXME: this should be PointerSubgraph, not PSNode...
     PointerSubgraph *_entry{nullptr};
 
-    using NodesT = std::vector<std::unique_ptr<PSNode>>;
+public:
+    // the nodes live in the arena of the graph
+    using NodesT = std::vector<ADT::ArenaPtr<PSNode>>;
     using SubgraphsT = std::vector<std::unique_ptr<PointerSubgraph>>;
 
+private:
+    // the memory of the nodes, their edges and the memory objects,
+    // it is released at once with the graph (keep it before the nodes,
+    // so that it is destroyed after them). The nodes keep the pointer
+    // to the arena, so it does not move with the graph.
+    std::unique_ptr<ADT::Arena> _arena{new ADT::Arena(1 << 16)};
+    // the memory of the removed nodes (by the type of the node),
+    // it is reused for the new nodes of the same type (the nodes
+    // of the same type are objects of the same class)
+    std::unordered_map<unsigned, std::vector<void *>> _freeNodes;
+
+    // numbering of nodes for points-to sets, it is shared by all
+    // the nodes of this graph (keep it before the nodes, so that
+    // it is destroyed after them)
+    std::unique_ptr<PointerIdTable> _idTable{new PointerIdTable()};
+
     NodesT nodes;
     SubgraphsT _subgraphs;
 
+    // the memory objects of the flow-insensitive analysis
+    std::vector<ADT::ArenaPtr<MemoryObject>> _memoryObjects;
+
     // Take care of assigning ids to new nodes
     unsigned int last_node_id = 0;
     unsigned int getNewNodeId() {
         return ++last_node_id;
     }
 
+    // the subgraphs may be removed, so do not use their count for IDs
+    unsigned int last_subgraph_id = 0;
+
     GenericCallGraph<PSNode *> callGraph;
 
     void initStaticNodes() {
@@ -149,58 +176,124 @@ class PointerGraph
 
     NodesT _globals;
 
+    // the edges of the nodes packed by freezeEdges()
+    std::unique_ptr<FrozenEdges<PSNode>> _frozenEdges;
+
+    // the position of a (non-global) node in 'nodes'. The global nodes
+    // share the numbering with the other nodes and they are never removed,
+    // so skip the global nodes created before the node
+    size_t _getIndex(const PSNode *nd) const {
+        auto it = std::lower_bound(_globals.begin(), _globals.end(), nd->getID(),
+                                   [](const ADT::ArenaPtr<PSNode>& g, unsigned id) {
+                                       return g->getID() < id;
+                                   });
+        return nd->getID() - (it - _globals.begin());
+    }
+
+    std::vector<PSNode *> _getAllNodes() const {
+        std::vector<PSNode *> all;
+        all.reserve(size());
+        for (auto& n : _globals)
+            all.push_back(n.get());
+        for (auto& n : nodes) {
+            if (n)
+                all.push_back(n.get());
+        }
+        return all;
+    }
+
+    // the constructors of nodes are not public,
+    // so we cannot use Arena::create here
+    template <typename T, typename... Args>
+    T *_createNode(PSNodeType t, Args&&... args) {
+        void *mem;
+        auto& freeNodes = _freeNodes[static_cast<unsigned>(t)];
+        if (freeNodes.empty()) {
+            mem = _arena->allocate(sizeof(T), alignof(T));
+        } else {
+            mem = freeNodes.back();
+            freeNodes.pop_back();
+        }
+
+        T *node = new (mem) T(std::forward<Args>(args)...);
+        assert(node->getType() == t && "Reused memory of a different node");
+        return node;
+    }
+
     PSNode *_create(PSNodeType t, va_list args) {
         PSNode *node = nullptr;
 
         switch (t) {
             case PSNodeType::ALLOC:
-                node = new PSNodeAlloc(getNewNodeId());
+                node = _createNode<PSNodeAlloc>(t, getNewNodeId());
                 break;
             case PSNodeType::GEP:
-                node = new PSNodeGep(getNewNodeId(),
-                                     va_arg(args, PSNode *),
-                                     va_arg(args, Offset::type));
+                {
+                    // the order of evaluation of arguments is unspecified,
+                    // so take the variadic arguments one by one
+                    PSNode *src = va_arg(args, PSNode *);
+                    Offset::type off = va_arg(args, Offset::type);
+                    node = _createNode<PSNodeGep>(t, getNewNodeId(), src, off);
+                }
                 break;
             case PSNodeType::MEMCPY:
-                node = new PSNodeMemcpy(getNewNodeId(),
-                                        va_arg(args, PSNode *),
-                                        va_arg(args, PSNode *),
-                                        va_arg(args, Offset::type));
+                {
+                    PSNode *src = va_arg(args, PSNode *);
+                    PSNode *dest = va_arg(args, PSNode *);
+                    Offset::type len = va_arg(args, Offset::type);
+                    node = _createNode<PSNodeMemcpy>(t, getNewNodeId(),
+                                                          src, dest, len);
+                }
                 break;
             case PSNodeType::CONSTANT:
-                node = new PSNode(getNewNodeId(), PSNodeType::CONSTANT,
-                                  va_arg(args, PSNode *),
-                                  va_arg(args, Offset::type));
+                {
+                    PSNode *target = va_arg(args, PSNode *);
+                    Offset::type off = va_arg(args, Offset::type);
+                    node = _createNode<PSNode>(t, getNewNodeId(),
+                                                    PSNodeType::CONSTANT,
+                                                    target, off);
+                }
                 break;
             case PSNodeType::ENTRY:
-                node = new PSNodeEntry(getNewNodeId());
+                node = _createNode<PSNodeEntry>(t, getNewNodeId());
                 break;
             case PSNodeType::CALL:
-                node = new PSNodeCall(t, getNewNodeId());
+                node = _createNode<PSNodeCall>(t, t, getNewNodeId());
                 break;
             case PSNodeType::CALL_FUNCPTR:
-                node = new PSNodeCall(t, getNewNodeId());
+                node = _createNode<PSNodeCall>(t, t, getNewNodeId());
                 node->addOperand(va_arg(args, PSNode *));
                 break;
             case PSNodeType::FORK:
-                node = new PSNodeFork(getNewNodeId());
+                node = _createNode<PSNodeFork>(t, getNewNodeId());
                 node->addOperand(va_arg(args, PSNode *));
                 break;
             case PSNodeType::JOIN:
-                node = new PSNodeJoin(getNewNodeId());
+                node = _createNode<PSNodeJoin>(t, getNewNodeId());
                 break;
             case PSNodeType::RETURN:
-                node = new PSNodeRet(getNewNodeId(), args);
+                node = _createNode<PSNodeRet>(t, getNewNodeId(), args);
                 break;
             case PSNodeType::CALL_RETURN:
-                node = new PSNodeCallRet(getNewNodeId(), args);
+                node = _createNode<PSNodeCallRet>(t, getNewNodeId(), args);
                 break;
             default:
-                node = new PSNode(getNewNodeId(), t, args);
+                node = _createNode<PSNode>(t, getNewNodeId(), t, args);
                 break;
         }
 
         assert(node && "Didn't create node");
+        node->setEdgesArena(_arena.get());
+        node->_idTable = _idTable.get();
+        _idTable->addNode(node);
+
+        // these always points-to itself
+        // (they points to the node where the memory was allocated).
+        // The points-to set may need the number of the node,
+        // so this can be done only after the node is registered
+        if (t == PSNodeType::ALLOC || t == PSNodeType::FUNCTION)
+            node->addPointsTo(node, 0);
+
         return node;
     }
 
@@ -213,13 +306,27 @@ public:
 
     PointerSubgraph *createSubgraph(PSNode *root,
                                     PSNode *vararg = nullptr) {
-        // NOTE: id of the subgraph is always index in _subgraphs + 1
         _subgraphs.emplace_back(
-            new PointerSubgraph(static_cast<unsigned>(_subgraphs.size()) + 1,
-                                                      root, vararg));
+            new PointerSubgraph(++last_subgraph_id, root, vararg));
         return _subgraphs.back().get();
     }
 
+    // Remove the subgraph (and its calls from the call graph).
+    // The nodes of the subgraph must be removed separately.
+    void removeSubgraph(PointerSubgraph *subg) {
+        assert(subg && "nullptr passed as subg");
+        callGraph.remove(subg->root);
+        if (_entry == subg)
+            _entry = nullptr;
+
+        auto it = std::find_if(_subgraphs.begin(), _subgraphs.end(),
+                               [subg](const std::unique_ptr<PointerSubgraph>& s) {
+                                   return s.get() == subg;
+                               });
+        assert(it != _subgraphs.end() && "The subgraph is not in the graph");
+        _subgraphs.erase(it);
+    }
+
     PSNode *create(PSNodeType t, ...) {
         va_list args;
 
@@ -250,13 +357,45 @@ public:
         return callGraph.addCall(a, b);
     }
 
+    bool unregisterCall(PSNode *a, PSNode *b) {
+        return callGraph.removeCall(a, b);
+    }
+
     const GenericCallGraph<PSNode *>& getCallGraph() const { return callGraph; }
     const SubgraphsT& getSubgraphs() const { return _subgraphs; }
 
     const NodesT& getNodes() const { return nodes; }
+
+    // Create the memory object of the allocation 'n' for the flow-insensitive
+    // analysis (see PointerAnalysisFI). The objects are kept in the arena
+    // of the graph and they are destroyed together with the graph.
+    MemoryObject *createMemoryObject(PSNode *n) {
+        _memoryObjects.emplace_back(_arena->create<MemoryObject>(n));
+        return _memoryObjects.back().get();
+    }
     const NodesT& getGlobals() const { return _globals; }
     size_t size() const { return nodes.size() + _globals.size(); }
 
+    // Pack the edges of all nodes into continuous arrays.
+    // The graph can be changed also after freezing,
+    // the changed nodes then use their own edges again
+    // (until the edges are frozen again).
+    void freezeEdges() {
+        auto all = _getAllNodes();
+        std::unique_ptr<FrozenEdges<PSNode>>
+            edges(new FrozenEdges<PSNode>(all, last_node_id + 1));
+        edges->freeze(all);
+        // the old packed edges are not used by any node now
+        _frozenEdges = std::move(edges);
+    }
+
+    void unfreezeEdges() {
+        FrozenEdges<PSNode>::thaw(_getAllNodes());
+        _frozenEdges.reset();
+    }
+
+    bool edgesFrozen() const { return _frozenEdges != nullptr; }
+
     void computeLoops() {
         DBG(pta, "Computing information about loops for the whole graph");
 
@@ -266,6 +405,12 @@ public:
         }
     }
 
+    ~PointerGraph() {
+        // everything in the arena is released with it
+        if (_arena)
+            _arena->stopRecycling();
+    }
+
     PointerGraph(PointerGraph&&) = default;
     PointerGraph& operator=(PointerGraph&&) = default;
     PointerGraph(const PointerGraph&) = delete;
@@ -289,19 +434,51 @@ public:
     void remove(PSNode *nd) {
         assert(nd && "nullptr passed as nd");
         // the node must be isolated
-        assert(nd->successors.empty() && "The node is still in graph");
-        assert(nd->predecessors.empty() && "The node is still in graph");
+        assert(nd->getSuccessors().empty() && "The node is still in graph");
+        assert(nd->getPredecessors().empty() && "The node is still in graph");
         assert(nd->getID() < size() && "Invalid ID");
         assert(nd->getID() > 0 && "Invalid ID");
-        assert(nd->users.empty() && "This node is used by other nodes");
+        assert(nd->getUsers().empty() && "This node is used by other nodes");
         // if the node has operands, it means that the operands
         // have a reference (an user edge to this node).
         // We do not want to create dangling references.
-        assert(nd->operands.empty() && "This node uses other nodes");
-        assert(nodes[nd->getID()].get() == nd && "Inconsistency in nodes");
+        assert(nd->getOperands().empty() && "This node uses other nodes");
+        assert(nodes[_getIndex(nd)].get() == nd && "Inconsistency in nodes");
+
+        // clear the nodes entry and keep the memory for new nodes
+        auto t = static_cast<unsigned>(nd->getType());
+        nodes[_getIndex(nd)].reset();
+        _freeNodes[t].push_back(nd);
+    }
+
+    // Remove the node from the graph together with all its edges
+    // (the CFG edges, the operands and users and the call and return edges)
+    void erase(PSNode *nd) {
+        assert(nd && "nullptr passed as nd");
+
+        if (PSNodeEntry *entry = PSNodeEntry::get(nd)) {
+            for (PSNode *caller : entry->getCallers()) {
+                PSNodeCall *call = PSNodeCall::cast(caller);
+                for (PointerSubgraph *subg : call->getCallees()) {
+                    if (subg->root == nd) {
+                        call->removeCallee(subg);
+                        break;
+                    }
+                }
+            }
+        } else if (PSNodeCall *call = PSNodeCall::get(nd)) {
+            for (PointerSubgraph *subg : call->getCallees())
+                PSNodeEntry::cast(subg->root)->removeCaller(call);
+        } else if (PSNodeCallRet *callRet = PSNodeCallRet::get(nd)) {
+            for (PSNode *ret : callRet->getReturns())
+                PSNodeRet::get(ret)->removeReturnSite(callRet);
+        } else if (PSNodeRet *ret = PSNodeRet::get(nd)) {
+            for (PSNode *site : ret->getReturnSites())
+                PSNodeCallRet::cast(site)->removeReturn(ret);
+        }
 
-        // clear the nodes entry
-        nodes[nd->getID()].reset();
+        nd->disconnect();
+        remove(nd);
     }
 
     // get nodes in BFS order and store them into
@@ -1,31 +1,98 @@
 #ifndef _DG_POINTER_SUBGRAPH_OPTIMIZATIONS_H_
 #define _DG_POINTER_SUBGRAPH_OPTIMIZATIONS_H_
 
-#include "PointsToMapping.h"
+#include <unordered_set>
+
+#include "dg/analysis/PointsTo/PointerGraph.h"
+#include "dg/analysis/PointsTo/PointsToMapping.h"
 
 namespace dg {
 namespace analysis {
 namespace pta {
 
-class PSNoopRemover {
+using PSNodesSetT = std::unordered_set<const PSNode *>;
+
+// The base of the passes that remove nodes from the graph.
+// A removed node that has an equivalent node in the graph
+// is mapped to this node.
+class PointerGraphPass {
+public:
+    using MappingT = PointsToMapping<PSNode *>;
+
+    // the 'pinned' nodes are never removed
+    // (e.g., the nodes that may get new operands later)
+    PointerGraphPass(PointerGraph *PS, const PSNodesSetT *pinned = nullptr)
+    : PS(PS), pinned(pinned) {}
+
+    MappingT& getMapping() { return mapping; }
+    const MappingT& getMapping() const { return mapping; }
+
+    const PSNodesSetT& getRemovedNodes() const { return removed; }
+    unsigned getNumOfRemovedNodes() const { return removed.size(); }
+
+protected:
     PointerGraph *PS;
+    const PSNodesSetT *pinned;
+
+    // map removed nodes to their equivalent nodes
+    MappingT mapping;
+    PSNodesSetT removed;
+
+    bool isPinned(const PSNode *nd) const {
+        return pinned && pinned->count(nd) > 0;
+    }
+
+    bool canRemove(PSNode *nd) const {
+        if (isPinned(nd))
+            return false;
+
+        // isolate() cannot handle the self-loops
+        for (PSNode *succ : nd->getSuccessors()) {
+            if (succ == nd)
+                return false;
+        }
+
+        return true;
+    }
+
+    // remove the node that has no users
+    void remove(PSNode *nd) {
+        assert(canRemove(nd) && "Cannot remove the node");
+        assert(nd->getUsers().empty() && "The node is still used");
+
+        nd->isolate();
+        nd->removeAllOperands();
+        PS->remove(nd);
+        removed.insert(nd);
+    }
+
+    // replace the uses of 'node1' by 'node2' and remove 'node1'
+    // (the mapping is set to node1 -> node2)
+    void merge(PSNode *node1, PSNode *node2) {
+        assert(node1 != node2 && "Merging a node with itself");
+
+        node1->replaceAllUsesWith(node2);
+        remove(node1);
+        mapping.add(node1, node2);
+    }
+};
+
+class PSNoopRemover : public PointerGraphPass {
 public:
-    PSNoopRemover(PointerGraph *PS) : PS(PS) {}
+    PSNoopRemover(PointerGraph *PS, const PSNodesSetT *pinned = nullptr)
+    : PointerGraphPass(PS, pinned) {}
 
     unsigned run() {
-        unsigned removed = 0;
         for (const auto &nd : PS->getNodes()) {
             if (!nd)
                 continue;
 
-            if (nd->getType() == PSNodeType::NOOP) {
-                nd->isolate();
+            if (nd->getType() == PSNodeType::NOOP && canRemove(nd.get())) {
                 // this should not break the iterator
-                PS->remove(nd.get());
-                ++removed;
+                remove(nd.get());
             }
         }
-        return removed;
+        return getNumOfRemovedNodes();
     };
 };
 
@@ -62,95 +129,89 @@ static inline bool allOperandsAreSame(PSNode *nd) {
 
 // try to remove loads/stores that are provably
 // loads and stores of unknown memory
-// (these usually correspond to integers)
-class PSUnknownsReducer {
-    using MappingT = PointsToMapping<PSNode *>;
-
-    PointerGraph *PS;
-    MappingT mapping;
-
-    unsigned removed = 0;
-
+// (these usually correspond to integers).
+// The loads then yield the unknown pointer only
+// in the flow-insensitive analysis.
+class PSUnknownsReducer : public PointerGraphPass {
     void processAllocs() {
         for (const auto& nd : PS->getNodes()) {
             if (!nd)
                 continue;
 
-            if (nd->getType() == PSNodeType::ALLOC) {
-                // this is an allocation that has only stores of unknown memory to it
-                // (and its address is not stored anywhere) and there are only loads
-                // from this memory (that must result to unknown)
-                if (usersImplyUnknown(nd.get())) {
-                    for (PSNode *user : nd->getUsers()) {
-                        if (user->getType() == PSNodeType::LOAD) {
-                            // replace the uses of the load value by unknown
-                            // (this is what would happen in the analysis)
-                            user->replaceAllUsesWith(UNKNOWN_MEMORY);
-                            mapping.add(user, UNKNOWN_MEMORY);
-                        }
-                        // store can be removed directly
-                        user->isolate();
-                        PS->remove(user);
-                        ++removed;
-                    }
-
-                    // NOTE: keep the alloca, as it contains the
-                    // pointer to itself and may be queried for this pointer
-                }
-            } else if (nd->getType() == PSNodeType::PHI && nd->getOperandsNum() == 0) {
-                for (PSNode *user : nd->getUsers()) {
-                    // replace the uses of this value with unknown
-                    user->replaceAllUsesWith(UNKNOWN_MEMORY);
-                    mapping.add(user, UNKNOWN_MEMORY);
+            PSNodeAlloc *alloc = PSNodeAlloc::get(nd.get());
+            // zeroed memory contains also the null pointer
+            if (!alloc || alloc->isZeroInitialized())
+                continue;
+
+            // this is an allocation that has only stores of unknown memory to it
+            // (and its address is not stored anywhere) and there are only loads
+            // from this memory (that must result to unknown)
+            if (!usersImplyUnknown(alloc))
+                continue;
+
+            // the users are removed below
+            std::vector<PSNode *> users = alloc->getUsers();
+            bool hasStore = false;
+            bool removable = true;
+            for (PSNode *user : users) {
+                hasStore |= user->getType() == PSNodeType::STORE;
+                removable &= canRemove(user);
+            }
 
+            // without stores the loads read nothing
+            if (!hasStore || !removable)
+                continue;
+
+            for (PSNode *user : users) {
+                if (user->getType() == PSNodeType::LOAD) {
+                    // replace the uses of the load value by unknown
+                    // (this is what would happen in the analysis)
+                    merge(user, UNKNOWN_MEMORY);
+                } else {
                     // store can be removed directly
-                    user->isolate();
-                    PS->remove(user);
-                    ++removed;
+                    remove(user);
                 }
-
-                nd->isolate();
-                PS->remove(nd.get());
-                assert(nd.get() == nullptr);
-                ++removed;
             }
+
+            // NOTE: keep the alloca, as it contains the
+            // pointer to itself and may be queried for this pointer
         }
     }
 
 public:
-    PSUnknownsReducer(PointerGraph *PS) : PS(PS) {}
-
-    MappingT& getMapping() { return mapping; }
-    const MappingT& getMapping() const { return mapping; }
+    PSUnknownsReducer(PointerGraph *PS, const PSNodesSetT *pinned = nullptr)
+    : PointerGraphPass(PS, pinned) {}
 
     unsigned run() {
         processAllocs();
-        return removed;
+        return getNumOfRemovedNodes();
     };
 };
 
-class PSEquivalentNodesMerger {
+class PSEquivalentNodesMerger : public PointerGraphPass {
 public:
-    using MappingT = PointsToMapping<PSNode *>;
-
-    PSEquivalentNodesMerger(PointerGraph *S)
-    : PS(S), merged_nodes_num(0) {
+    PSEquivalentNodesMerger(PointerGraph *S, const PSNodesSetT *pinned = nullptr)
+    : PointerGraphPass(S, pinned) {
         mapping.reserve(32);
     }
 
-    MappingT& getMapping() { return mapping; }
-    const MappingT& getMapping() const { return mapping; }
-
     unsigned getNumOfMergedNodes() const {
-        return merged_nodes_num;
+        return getNumOfRemovedNodes();
     }
 
     unsigned run() {
         mergeCasts();
-        return merged_nodes_num;
+        return getNumOfMergedNodes();
     }
 
 private:
+    // merge the node to its equivalent node
+    // (the node will be removed)
+    void mergeTo(PSNode *node, PSNode *repr) {
+        if (node != repr && canRemove(node))
+            merge(node, repr);
+    }
+
     // get rid of all casts
     void mergeCasts() {
         for (const auto& nodeptr : PS->getNodes()) {
@@ -162,37 +223,37 @@ private:
             // cast is always 'a proxy' to the real value,
             // it does not change the pointers
             if (node->getType() == PSNodeType::CAST)
-                merge(node, node->getOperand(0));
+                mergeTo(node, node->getOperand(0));
             else if (PSNodeGep *GEP = PSNodeGep::get(node)) {
                 if (GEP->getOffset().isZero()) // GEP with 0 offest is cast
-                    merge(node, GEP->getSource());
+                    mergeTo(node, GEP->getSource());
             } else if (node->getType() == PSNodeType::PHI &&
                         node->getOperandsNum() > 0 && allOperandsAreSame(node)) {
-                merge(node, node->getOperand(0));
+                mergeTo(node, node->getOperand(0));
             }
         }
     }
+};
 
-    // merge node1 and node2 (node2 will be
-    // the representant and node1 will be removed,
-    // mapping will be set to  node1 -> node2)
-    void merge(PSNode *node1, PSNode *node2) {
-        // remove node1
-        node1->replaceAllUsesWith(node2);
-        node1->isolate();
-        PS->remove(node1);
-
-        // update the mapping
-        mapping.add(node1, node2);
-
-        ++merged_nodes_num;
-    }
-
-    PointerGraph *PS;
-    // map nodes to its equivalent representant
-    MappingT mapping;
+// Offline variable substitution (hash-based value numbering
+// with the union of the operands, HVN/HU): label the nodes in
+// the topological order of the graph of operands so that the nodes
+// with the same label have the same points-to sets. A cast or a phi
+// gets the union of the labels of its operands, a load (a GEP) gets
+// a label given by the label of its operand (and the offset).
+// The nodes with the same label are then merged to the first such node.
+// The cycles of copies are collapsed to a phi node.
+//
+// The loads are equivalent only in the flow-insensitive analysis.
+// Moreover, the merged nodes may get their points-to sets from nodes
+// from which they are not reachable in the CFG, so this is only for
+// the solvers that propagate the points-to sets along the uses.
+class PSPointerEquivalenceMerger : public PointerGraphPass {
+public:
+    PSPointerEquivalenceMerger(PointerGraph *S, const PSNodesSetT *pinned = nullptr)
+    : PointerGraphPass(S, pinned) {}
 
-    unsigned merged_nodes_num;
+    unsigned run();
 };
 
 class PointerGraphOptimizer {
@@ -200,31 +261,29 @@ class PointerGraphOptimizer {
 
     PointerGraph *PS;
     MappingT mapping;
+    PSNodesSetT pinned;
+    PSNodesSetT removed;
+
+    template <typename PassT>
+    void runPass() {
+        PassT pass(PS, &pinned);
+        if (pass.run() > 0) {
+            mapping.merge(std::move(pass.getMapping()));
+            removed.insert(pass.getRemovedNodes().begin(),
+                           pass.getRemovedNodes().end());
+        }
+    }
 
-    unsigned removed = 0;
 public:
     PointerGraphOptimizer(PointerGraph *PS) : PS(PS) {}
 
-    void removeNoops() {
-        PSNoopRemover remover(PS);
-        removed += remover.run();
-    }
+    // do not remove this node
+    void pin(const PSNode *nd) { pinned.insert(nd); }
 
-    void removeUnknowns() {
-        PSUnknownsReducer reducer(PS);
-        if (auto r = reducer.run()) {
-            mapping.merge(std::move(reducer.getMapping()));
-            removed += r;
-        }
-    }
-
-    void removeEquivalentNodes() {
-        PSEquivalentNodesMerger merger(PS);
-        if (auto r = merger.run()) {
-                mapping.merge(std::move(merger.getMapping()));
-                removed += r;
-        }
-    }
+    void removeNoops() { runPass<PSNoopRemover>(); }
+    void removeUnknowns() { runPass<PSUnknownsReducer>(); }
+    void removeEquivalentNodes() { runPass<PSEquivalentNodesMerger>(); }
+    void removeEquivalentPointers() { runPass<PSPointerEquivalenceMerger>(); }
 
     unsigned run() {
         removeNoops();
@@ -236,10 +295,11 @@ public:
         // which breaks the validity of the graph
         removeEquivalentNodes();
 
-        return removed;
+        return getNumOfRemovedNodes();
     }
 
-    unsigned getNumOfRemovedNodes() const { return removed; }
+    unsigned getNumOfRemovedNodes() const { return removed.size(); }
+    const PSNodesSetT& getRemovedNodes() const { return removed; }
     MappingT& getMapping() { return mapping; }
     const MappingT& getMapping() const { return mapping; }
 };
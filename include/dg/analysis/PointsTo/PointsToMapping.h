@@ -1,6 +1,7 @@
 #ifndef _DG_POINTS_TO_MAPPING_H_
 #define _DG_POINTS_TO_MAPPING_H_
 
+#include <cassert>
 #include <unordered_map>
 #include "PSNode.h"
 
@@ -44,6 +45,22 @@ public:
         mapping[val] = nd;
     }
 
+    // follow the mapping from the node until a node that is not mapped
+    // (the nodes may be mapped to nodes that were mapped later again).
+    // Returns nullptr if the node itself is not mapped.
+    PSNode *resolve(PSNode *nd) const {
+        PSNode *cur = get(nd);
+        if (!cur)
+            return nullptr;
+
+        while (PSNode *next = get(cur)) {
+            assert(next != nd && "Cycle in the mapping");
+            cur = next;
+        }
+
+        return cur;
+    }
+
     // merge some other points-to mapping to this one
     // (destroying the other one). If there are
     // duplicates values, than the ones from 'rhs'
@@ -58,10 +75,11 @@ public:
 
     // compose this mapping with some other mapping:
     // (PSNode * -> PSNode *) o (ValT -> PSNode *)
-    // leads to (ValT -> PSNode *).
+    // leads to (ValT -> PSNode *). The chains of mapped nodes
+    // in 'rhs' are followed to the end.
     void compose(PointsToMapping<PSNode *>&& rhs) {
         for (auto& it : mapping) {
-            if (PSNode *rhs_node = rhs.get(it.second)) {
+            if (PSNode *rhs_node = rhs.resolve(it.second)) {
                 it.second = rhs_node;
             }
         }
@@ -1,6 +1,9 @@
 #ifndef _DG_POINTS_TO_SET_H_
 #define _DG_POINTS_TO_SET_H_
 
+#include <type_traits>
+
+#include "dg/analysis/PointsTo/PointsToSets/PointerIdTable.h"
 #include "dg/analysis/PointsTo/PointsToSets/OffsetsSetPointsToSet.h"
 #include "dg/analysis/PointsTo/PointsToSets/SimplePointsToSet.h"
 #include "dg/analysis/PointsTo/PointsToSets/SeparateOffsetsPointsToSet.h"
@@ -8,14 +11,52 @@
 #include "dg/analysis/PointsTo/PointsToSets/SmallOffsetsPointsToSet.h"
 #include "dg/analysis/PointsTo/PointsToSets/AlignedSmallOffsetsPointsToSet.h"
 #include "dg/analysis/PointsTo/PointsToSets/AlignedPointerIdPointsToSet.h"
+#include "dg/analysis/PointsTo/PointsToSets/HashConsedPointsToSet.h"
 
 namespace dg {
 namespace analysis {
 namespace pta {
 
-using PointsToSetT = OffsetsSetPointsToSet;
+// The representation of points-to sets is selected when configuring
+// the project (cmake -DPTA_POINTS_TO_SET=<class>). The code that is linked
+// together must be compiled with the same representation. The pointer
+// analysis libraries for other representations (cmake
+// -DPTA_EXTRA_POINTS_TO_SETS=<classes>) and the code that uses them
+// are compiled with DG_POINTS_TO_SET set to the representation.
+#ifndef DG_POINTS_TO_SET
+#ifdef DG_DEFAULT_POINTS_TO_SET
+#define DG_POINTS_TO_SET DG_DEFAULT_POINTS_TO_SET
+#else
+#define DG_POINTS_TO_SET OffsetsSetPointsToSet
+#endif
+#endif
+
+#define _DG_PTSET_STR(x) #x
+#define _DG_PTSET_NAME(x) _DG_PTSET_STR(x)
+
+using PointsToSetT = DG_POINTS_TO_SET;
 using PointsToMapT = std::map<Offset, PointsToSetT>;
 
+// Does the representation change the PointerIdTable of the graph
+// when the sets change? Such sets of one graph can not be changed
+// from more threads at once, even if every thread works with other sets.
+template <typename SetT>
+struct ChangesPointerIdTable : std::false_type {};
+template <typename BitvectorT>
+struct ChangesPointerIdTable<PointerIdPointsToSetImpl<BitvectorT>> : std::true_type {};
+template <>
+struct ChangesPointerIdTable<AlignedPointerIdPointsToSet> : std::true_type {};
+template <>
+struct ChangesPointerIdTable<HashConsedPointsToSet> : std::true_type {};
+
+// the name of the representation of points-to sets
+inline const char *getPointsToSetName() {
+    return _DG_PTSET_NAME(DG_POINTS_TO_SET);
+}
+
+#undef _DG_PTSET_NAME
+#undef _DG_PTSET_STR
+
 } // namespace pta
 } // namespace analysis
 } // namespace dg
@@ -3,8 +3,8 @@
 
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/ADT/Bitvector.h"
+#include "dg/analysis/PointsTo/PointsToSets/PointerIdTable.h"
 
-#include <map>
 #include <vector>
 #include <set>
 #include <cassert>
@@ -20,18 +20,26 @@ class AlignedPointerIdPointsToSet {
     static const unsigned int multiplier = 4;
 
     ADT::SparseBitvector pointers;
+    // pointers with unaligned offsets and pointers
+    // to special nodes that have no fixed ID
     std::set<Pointer> overflowSet;
-    static std::map<Pointer, size_t> ids; //pointers are numbered 1, 2, ...
-    static std::vector<Pointer> idVector; //starts from 0 (pointer = idVector[id - 1])
-
-    //if the pointer doesn't have ID, it's assigned one
-    size_t getPointerID(const Pointer& ptr) const {
-        auto it = ids.find(ptr);
-        if(it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(ptr);
-        return ids.emplace_hint(it, ptr, ids.size() + 1)->second;
+    // numbering of pointers of the graph
+    // (nullptr if the set contains only special nodes)
+    PointerIdTable *_table = nullptr;
+
+    void setTable(PSNode *node) {
+        if (!_table)
+            _table = PointerIdTable::get(node);
+        assert((!PointerIdTable::get(node) || PointerIdTable::get(node) == _table)
+               && "Nodes from different graphs in one set");
+    }
+
+    // the pointer is assigned an ID if it doesn't have one
+    size_t getPointerID(const Pointer& ptr) {
+        setTable(ptr.target);
+        if (PointerIdTable::isSpecialNode(ptr.target))
+            return PointerIdTable::findPointerId(_table, ptr);
+        return _table->getPointerId(ptr);
     }
 
     bool addWithUnknownOffset(PSNode* node) {
@@ -43,6 +51,12 @@ class AlignedPointerIdPointsToSet {
         return off.isUnknown() || *off % multiplier == 0;
     }
 
+    bool isIdPointer(const Pointer& ptr) const {
+        return isOffsetValid(ptr.offset) &&
+               (!PointerIdTable::isSpecialNode(ptr.target)
+                || PointerIdTable::hasFixedId(ptr));
+    }
+
 public:
     AlignedPointerIdPointsToSet() = default;
     AlignedPointerIdPointsToSet(std::initializer_list<Pointer> elems) { add(elems); }
@@ -58,13 +72,17 @@ public:
         if(ptr.offset.isUnknown()) {
             return addWithUnknownOffset(ptr.target);
         }
-        if(isOffsetValid(ptr.offset)) {
+        if(isIdPointer(ptr)) {
             return !pointers.set(getPointerID(ptr));
         }
         return overflowSet.insert(ptr).second;
     }
 
     bool add(const AlignedPointerIdPointsToSet& S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table)
+               && "Nodes from different graphs in one set");
         bool changed = pointers.set(S.pointers);
         for (const auto& ptr : S.overflowSet) {
             changed |= overflowSet.insert(ptr).second;
@@ -73,8 +91,9 @@ public:
     }
 
     bool remove(const Pointer& ptr) {
-        if(isOffsetValid(ptr.offset)) {
-            return pointers.unset(getPointerID(ptr));
+        if(isIdPointer(ptr)) {
+            auto id = PointerIdTable::findPointerId(_table, ptr);
+            return id != PointerIdTable::NO_ID && pointers.unset(id);
         }
         return overflowSet.erase(ptr) != 0;
     }
@@ -86,7 +105,7 @@ public:
     bool removeAny(PSNode *target) {
         std::vector<size_t> toRemove;
         for (const auto& ptrID : pointers) {
-            if(idVector[ptrID - 1].target == target) {
+            if(PointerIdTable::getPointer(_table, ptrID).target == target) {
                 toRemove.push_back(ptrID);
             }
         }
@@ -115,8 +134,9 @@ public:
     }
 
     bool pointsTo(const Pointer& ptr) const {
-        if(isOffsetValid(ptr.offset)) {
-            return pointers.get(getPointerID(ptr));
+        if(isIdPointer(ptr)) {
+            auto id = PointerIdTable::findPointerId(_table, ptr);
+            return id != PointerIdTable::NO_ID && pointers.get(id);
         }
         return overflowSet.find(ptr) != overflowSet.end();
     }
@@ -132,8 +152,8 @@ public:
     }
 
     bool pointsToTarget(PSNode *target) const {
-        for(const auto& kv : ids) {
-            if(kv.first.target == target && pointers.get(kv.second)) {
+        for (const auto& ptrID : pointers) {
+            if(PointerIdTable::getPointer(_table, ptrID).target == target) {
                 return true;
             }
         }
@@ -181,6 +201,7 @@ public:
     void swap(AlignedPointerIdPointsToSet& rhs) {
         pointers.swap(rhs.pointers);
         overflowSet.swap(rhs.overflowSet);
+        std::swap(_table, rhs._table);
     }
 
     size_t overflowSetSize() const {
@@ -196,12 +217,15 @@ public:
         typename ADT::SparseBitvector::const_iterator bitvector_it;
         typename ADT::SparseBitvector::const_iterator bitvector_end;
         typename std::set<Pointer>::const_iterator set_it;
+        const PointerIdTable *table;
         bool secondContainer;
 
-        const_iterator(const ADT::SparseBitvector& pointers, const std::set<Pointer>& overflow, bool end = false) :
+        const_iterator(const ADT::SparseBitvector& pointers, const std::set<Pointer>& overflow,
+                       const PointerIdTable *table, bool end = false) :
         bitvector_it(end ? pointers.end() : pointers.begin()),
         bitvector_end(pointers.end()),
         set_it(end ? overflow.end() : overflow.begin()),
+        table(table),
         secondContainer(end) {
             if(bitvector_it == bitvector_end) {
                 secondContainer = true;
@@ -229,7 +253,7 @@ public:
 
         Pointer operator*() const {
             if(!secondContainer) {
-                return Pointer(idVector[*bitvector_it - 1]);
+                return PointerIdTable::getPointer(table, *bitvector_it);
             }
             return *set_it;
         }
@@ -246,8 +270,8 @@ public:
         friend class AlignedPointerIdPointsToSet;
     };
 
-    const_iterator begin() const { return const_iterator(pointers, overflowSet); }
-    const_iterator end() const { return const_iterator(pointers, overflowSet, true /* end */); }
+    const_iterator begin() const { return const_iterator(pointers, overflowSet, _table); }
+    const_iterator end() const { return const_iterator(pointers, overflowSet, _table, true /* end */); }
 
     friend class const_iterator;
 };
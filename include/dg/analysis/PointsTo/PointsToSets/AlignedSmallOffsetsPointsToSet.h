@@ -3,8 +3,8 @@
 
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/ADT/Bitvector.h"
+#include "dg/analysis/PointsTo/PointsToSets/PointerIdTable.h"
 
-#include <map>
 #include <set>
 #include <vector>
 #include <cassert>
@@ -21,21 +21,19 @@ class AlignedSmallOffsetsPointsToSet {
 
     ADT::SparseBitvector pointers;
     std::set<Pointer> oddPointers;
-    static std::map<PSNode*,size_t> ids;  //nodes are numbered 1,2, ...
-    static std::vector<PSNode*> idVector; //starts from 0 (node = idVector[id - 1])
-
-    //if the node doesn't have ID, it's assigned one
-    size_t getNodeID(PSNode *node) const {
-        auto it = ids.find(node);
-        if(it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(node);
-        return ids.emplace_hint(it, node, ids.size() + 1)->second;
+    // numbering of nodes of the graph
+    // (nullptr if the set contains only special nodes)
+    PointerIdTable *_table = nullptr;
+
+    void setTable(PSNode *node) {
+        if (!_table)
+            _table = PointerIdTable::get(node);
+        assert((!PointerIdTable::get(node) || PointerIdTable::get(node) == _table)
+               && "Nodes from different graphs in one set");
     }
 
     size_t getNodePosition(PSNode *node) const {
-        return ((getNodeID(node) - 1) * 64);
+        return PointerIdTable::getNodeIndex(node) * 64;
     }
 
     size_t getPosition(PSNode *node, Offset off) const {
@@ -60,6 +58,7 @@ public:
     AlignedSmallOffsetsPointsToSet(std::initializer_list<Pointer> elems) { add(elems); }
 
     bool add(PSNode *target, Offset off) {
+        setTable(target);
         if(has({target, Offset::UNKNOWN})) {
             return false;
         }
@@ -77,6 +76,10 @@ public:
     }
 
     bool add(const AlignedSmallOffsetsPointsToSet& S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table)
+               && "Nodes from different graphs in one set");
         bool changed = pointers.set(S.pointers);
         for (const auto& ptr : S.oddPointers) {
             changed |= oddPointers.insert(ptr).second;
@@ -186,6 +189,7 @@ public:
     void swap(AlignedSmallOffsetsPointsToSet& rhs) {
         pointers.swap(rhs.pointers);
         oddPointers.swap(rhs.oddPointers);
+        std::swap(_table, rhs._table);
     }
 
     size_t overflowSetSize() const {
@@ -202,12 +206,15 @@ public:
         typename ADT::SparseBitvector::const_iterator bitvector_it;
         typename ADT::SparseBitvector::const_iterator bitvector_end;
         typename std::set<Pointer>::const_iterator set_it;
+        const PointerIdTable *table;
         bool secondContainer;
 
-        const_iterator(const ADT::SparseBitvector& pointers, const std::set<Pointer>& oddPointers, bool end = false)
+        const_iterator(const ADT::SparseBitvector& pointers, const std::set<Pointer>& oddPointers,
+                       const PointerIdTable *table, bool end = false)
         : bitvector_it(end ? pointers.end() : pointers.begin()),
         bitvector_end(pointers.end()),
         set_it(end ? oddPointers.end() : oddPointers.begin()),
+        table(table),
         secondContainer(end) {
             if(bitvector_it == bitvector_end) {
                 secondContainer = true;
@@ -236,8 +243,8 @@ public:
         Pointer operator*() const {
             if(!secondContainer) {
                 size_t offsetPosition = (*bitvector_it % 64);
-                size_t nodeID = ((*bitvector_it - offsetPosition) / 64) + 1;
-                return offsetPosition == 63 ? Pointer(idVector[nodeID - 1], Offset::UNKNOWN) : Pointer(idVector[nodeID - 1], offsetPosition * multiplier);
+                PSNode *node = PointerIdTable::getNode(table, *bitvector_it / 64);
+                return offsetPosition == 63 ? Pointer(node, Offset::UNKNOWN) : Pointer(node, offsetPosition * multiplier);
             }
             return *set_it;
         }
@@ -254,8 +261,8 @@ public:
         friend class AlignedSmallOffsetsPointsToSet;
     };
 
-    const_iterator begin() const { return const_iterator(pointers, oddPointers); }
-    const_iterator end() const { return const_iterator(pointers, oddPointers, true /* end */); }
+    const_iterator begin() const { return const_iterator(pointers, oddPointers, _table); }
+    const_iterator end() const { return const_iterator(pointers, oddPointers, _table, true /* end */); }
 
     friend class const_iterator;
 };
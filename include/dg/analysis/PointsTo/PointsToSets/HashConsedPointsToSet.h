@@ -0,0 +1,313 @@
+#ifndef _DG_HASH_CONSED_POINTS_TO_SET_H_
+#define _DG_HASH_CONSED_POINTS_TO_SET_H_
+
+#include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/PointsToSets/PointerIdTable.h"
+#include "dg/analysis/PointsTo/PointsToSets/PointsToSetPool.h"
+
+#include <set>
+#include <cstdint>
+#include <cassert>
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+class PSNode;
+
+// Points-to set that is a reference to an immutable set interned
+// in the pool of the graph (see PointsToSetPool). Copying the set
+// and comparing two sets is cheap and the same sets share the memory.
+// The result of a union is memoized in the pool, so propagating
+// the same set along many edges computes the union only once.
+//
+// Pointers to the special nodes are shared by all graphs, so they
+// are kept aside: the ones with a fixed ID (see PointerIdTable) in
+// a bitmask and the rest in an (usually empty) overflow set.
+class HashConsedPointsToSet {
+    using SetT = PointsToSetPool::Set;
+
+    // the interned set of pointers to non-special nodes
+    // (nullptr if there are none)
+    const SetT *_set{nullptr};
+    // the pool of the graph (nullptr until we add a non-special node)
+    PointsToSetPool *_pool{nullptr};
+    // bit i is set if the set contains the special pointer with the ID i
+    uint8_t _special{0};
+    std::set<Pointer> _overflow;
+
+    static_assert(PointerIdTable::SPECIAL_POINTERS_NUM <= 8,
+                  "The special pointers do not fit into the mask");
+
+    static uint8_t _specialBit(const Pointer& ptr) {
+        return static_cast<uint8_t>(1) <<
+                PointerIdTable::findPointerId(nullptr, ptr);
+    }
+
+    void setPool(PSNode *node) {
+        if (!_pool) {
+            auto table = PointerIdTable::get(node);
+            assert(table && "A non-special node without a graph");
+            _pool = &table->getSetPool();
+        }
+        assert((!PointerIdTable::get(node) ||
+                &PointerIdTable::get(node)->getSetPool() == _pool)
+               && "Nodes from different graphs in one set");
+    }
+
+    // replace the interned set, returns true if it changed
+    bool _update(const SetT *S) {
+        if (S == _set)
+            return false;
+        _set = S;
+        return true;
+    }
+
+    bool _addSpecial(const Pointer& ptr) {
+        if (ptr.offset.isUnknown()) {
+            // the UNKNOWN offset subsumes the other offsets
+            removeAny(ptr.target);
+            _special |= _specialBit(ptr);
+            return true;
+        }
+
+        if (PointerIdTable::hasFixedId(ptr)) {
+            uint8_t bit = _specialBit(ptr);
+            if (_special & bit)
+                return false;
+            _special |= bit;
+            return true;
+        }
+
+        return _overflow.insert(ptr).second;
+    }
+
+public:
+    HashConsedPointsToSet() = default;
+    HashConsedPointsToSet(std::initializer_list<Pointer> elems) { add(elems); }
+
+    bool add(PSNode *target, Offset off) {
+        return add(Pointer(target, off));
+    }
+
+    bool add(const Pointer& ptr) {
+        if (PointerIdTable::isSpecialNode(ptr.target)) {
+            if (pointsTo(Pointer(ptr.target, Offset::UNKNOWN)))
+                return false;
+            return _addSpecial(ptr);
+        }
+
+        setPool(ptr.target);
+        return _update(_pool->insert(_set, ptr));
+    }
+
+    // union (unite S into this set)
+    bool add(const HashConsedPointsToSet& S) {
+        if (this == &S)
+            return false;
+
+        bool changed = false;
+        if (S._set) {
+            if (!_pool)
+                _pool = S._pool;
+            assert(_pool == S._pool && "Nodes from different graphs in one set");
+            changed |= _update(_pool->unite(_set, S._set));
+        }
+
+        for (uint8_t bits = S._special & ~_special; bits != 0; bits &= bits - 1) {
+            changed |= add(PointerIdTable::getPointer(nullptr,
+                                                      __builtin_ctz(bits)));
+        }
+        for (const auto& ptr : S._overflow) {
+            changed |= add(ptr);
+        }
+
+        return changed;
+    }
+
+    bool add(std::initializer_list<Pointer> elems) {
+        bool changed = false;
+        for (const auto& e : elems) {
+            changed |= add(e);
+        }
+        return changed;
+    }
+
+    bool remove(const Pointer& ptr) {
+        if (PointerIdTable::isSpecialNode(ptr.target)) {
+            if (PointerIdTable::hasFixedId(ptr)) {
+                uint8_t bit = _specialBit(ptr);
+                bool had = _special & bit;
+                _special &= ~bit;
+                return had;
+            }
+            return _overflow.erase(ptr) != 0;
+        }
+
+        return _pool && _update(_pool->remove(_set, ptr));
+    }
+
+    bool remove(PSNode *target, Offset offset) {
+        return remove(Pointer(target, offset));
+    }
+
+    bool removeAny(PSNode *target) {
+        if (PointerIdTable::isSpecialNode(target)) {
+            bool changed = remove(Pointer(target, 0));
+            changed |= remove(Pointer(target, Offset::UNKNOWN));
+            auto it = _overflow.lower_bound(Pointer(target, 0));
+            while (it != _overflow.end() && it->target == target) {
+                it = _overflow.erase(it);
+                changed = true;
+            }
+            return changed;
+        }
+
+        return _pool && _update(_pool->removeAny(_set, target));
+    }
+
+    void clear() {
+        _set = nullptr;
+        _special = 0;
+        _overflow.clear();
+    }
+
+    bool pointsTo(const Pointer& ptr) const {
+        if (PointerIdTable::isSpecialNode(ptr.target)) {
+            if (PointerIdTable::hasFixedId(ptr))
+                return _special & _specialBit(ptr);
+            return _overflow.count(ptr) > 0;
+        }
+
+        return PointsToSetPool::contains(_set, ptr);
+    }
+
+    bool mayPointTo(const Pointer& ptr) const {
+        return pointsTo(ptr) ||
+                pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer& ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        if (PointerIdTable::isSpecialNode(target)) {
+            if (pointsTo(Pointer(target, 0)) ||
+                pointsTo(Pointer(target, Offset::UNKNOWN)))
+                return true;
+            auto it = _overflow.lower_bound(Pointer(target, 0));
+            return it != _overflow.end() && it->target == target;
+        }
+
+        return PointsToSetPool::containsTarget(_set, target);
+    }
+
+    bool isSingleton() const { return size() == 1; }
+
+    bool empty() const {
+        return !_set && _special == 0 && _overflow.empty();
+    }
+
+    size_t count(const Pointer& ptr) const {
+        return pointsTo(ptr);
+    }
+
+    bool has(const Pointer& ptr) const {
+        return count(ptr) > 0;
+    }
+
+    bool hasUnknown() const { return pointsToTarget(UNKNOWN_MEMORY); }
+    bool hasNull() const { return pointsToTarget(NULLPTR); }
+    bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
+
+    size_t size() const {
+        return (_set ? _set->pointers.size() : 0) +
+               __builtin_popcount(_special) + _overflow.size();
+    }
+
+    void swap(HashConsedPointsToSet& rhs) {
+        std::swap(_set, rhs._set);
+        std::swap(_pool, rhs._pool);
+        std::swap(_special, rhs._special);
+        _overflow.swap(rhs._overflow);
+    }
+
+    // two sets are the same iff they share the interned set
+    bool operator==(const HashConsedPointsToSet& rhs) const {
+        return _set == rhs._set && _special == rhs._special &&
+               _overflow == rhs._overflow;
+    }
+
+    bool operator!=(const HashConsedPointsToSet& rhs) const {
+        return !operator==(rhs);
+    }
+
+    class const_iterator {
+        // the interned pointers, then the special bits,
+        // then the overflow set
+        const Pointer *ptr_it{nullptr};
+        const Pointer *ptr_end{nullptr};
+        uint8_t special{0};
+        std::set<Pointer>::const_iterator set_it;
+
+        const_iterator(const HashConsedPointsToSet& S, bool end = false)
+        : set_it(end ? S._overflow.end() : S._overflow.begin()) {
+            if (S._set) {
+                ptr_end = S._set->pointers.data() + S._set->pointers.size();
+                ptr_it = end ? ptr_end : S._set->pointers.data();
+            }
+            if (!end)
+                special = S._special;
+        }
+
+    public:
+        const_iterator& operator++() {
+            if (ptr_it != ptr_end)
+                ++ptr_it;
+            else if (special != 0)
+                special &= special - 1;
+            else
+                ++set_it;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const {
+            if (ptr_it != ptr_end)
+                return *ptr_it;
+            if (special != 0)
+                return PointerIdTable::getPointer(nullptr,
+                                                  __builtin_ctz(special));
+            return *set_it;
+        }
+
+        bool operator==(const const_iterator& rhs) const {
+            return ptr_it == rhs.ptr_it && special == rhs.special &&
+                   set_it == rhs.set_it;
+        }
+
+        bool operator!=(const const_iterator& rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class HashConsedPointsToSet;
+    };
+
+    const_iterator begin() const { return const_iterator(*this); }
+    const_iterator end() const { return const_iterator(*this, true /* end */); }
+
+    friend class const_iterator;
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_HASH_CONSED_POINTS_TO_SET_H_
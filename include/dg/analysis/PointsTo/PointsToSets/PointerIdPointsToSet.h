@@ -3,8 +3,10 @@
 
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/ADT/Bitvector.h"
+#include "dg/ADT/DenseBitvector.h"
+#include "dg/analysis/PointsTo/PointsToSets/PointerIdTable.h"
 
-#include <map>
+#include <set>
 #include <vector>
 #include <cassert>
 
@@ -14,20 +16,38 @@ namespace pta {
 
 class PSNode;
 
-class PointerIdPointsToSet {
+// Points-to set that stores the IDs of pointers (see PointerIdTable)
+// in a bitvector. BitvectorT is ADT::SparseBitvector
+// or ADT::DenseBitvector.
+template <typename BitvectorT>
+class PointerIdPointsToSetImpl {
+
+    BitvectorT pointers;
+    // pointers to special nodes that have no fixed ID
+    // (the special nodes are shared by all graphs)
+    std::set<Pointer> overflowSet;
+    // numbering of pointers of the graph
+    // (nullptr if the set contains only special nodes)
+    PointerIdTable *_table = nullptr;
+
+    void setTable(PSNode *node) {
+        if (!_table)
+            _table = PointerIdTable::get(node);
+        assert((!PointerIdTable::get(node) || PointerIdTable::get(node) == _table)
+               && "Nodes from different graphs in one set");
+    }
 
-    ADT::SparseBitvector pointers;
-    static std::map<Pointer, size_t> ids; //pointers are numbered 1, 2, ...
-    static std::vector<Pointer> idVector; //starts from 0 (pointer = idVector[id - 1])
+    // the pointer is assigned an ID if it doesn't have one
+    size_t getPointerID(const Pointer& ptr) {
+        setTable(ptr.target);
+        if (PointerIdTable::isSpecialNode(ptr.target))
+            return PointerIdTable::findPointerId(_table, ptr);
+        return _table->getPointerId(ptr);
+    }
 
-    //if the pointer doesn't have ID, it's assigned one
-    size_t getPointerID(const Pointer& ptr) const {
-        auto it = ids.find(ptr);
-        if(it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(ptr);
-        return ids.emplace_hint(it, ptr, ids.size() + 1)->second;
+    bool isIdPointer(const Pointer& ptr) const {
+        return !PointerIdTable::isSpecialNode(ptr.target)
+                || PointerIdTable::hasFixedId(ptr);
     }
 
     bool addWithUnknownOffset(PSNode* node) {
@@ -36,8 +56,8 @@ class PointerIdPointsToSet {
     }
 
 public:
-    PointerIdPointsToSet() = default;
-    PointerIdPointsToSet(std::initializer_list<Pointer> elems) { add(elems); }
+    PointerIdPointsToSetImpl() = default;
+    PointerIdPointsToSetImpl(std::initializer_list<Pointer> elems) { add(elems); }
 
     bool add(PSNode *target, Offset off) {
         return add(Pointer(target,off));
@@ -50,15 +70,30 @@ public:
         if(ptr.offset.isUnknown()) {
             return addWithUnknownOffset(ptr.target);
         }
-        return !pointers.set(getPointerID(ptr));
+        if(isIdPointer(ptr)) {
+            return !pointers.set(getPointerID(ptr));
+        }
+        return overflowSet.insert(ptr).second;
     }
 
-    bool add(const PointerIdPointsToSet& S) {
-        return pointers.set(S.pointers);
+    bool add(const PointerIdPointsToSetImpl& S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table)
+               && "Nodes from different graphs in one set");
+        bool changed = pointers.set(S.pointers);
+        for (const auto& ptr : S.overflowSet) {
+            changed |= overflowSet.insert(ptr).second;
+        }
+        return changed;
     }
 
     bool remove(const Pointer& ptr) {
-        return pointers.unset(getPointerID(ptr));
+        if(isIdPointer(ptr)) {
+            auto id = PointerIdTable::findPointerId(_table, ptr);
+            return id != PointerIdTable::NO_ID && pointers.unset(id);
+        }
+        return overflowSet.erase(ptr) != 0;
     }
 
     bool remove(PSNode *target, Offset offset) {
@@ -68,7 +103,7 @@ public:
     bool removeAny(PSNode *target) {
         std::vector<size_t> toRemove;
         for (const auto& ptrID : pointers) {
-            if(idVector[ptrID - 1].target == target) {
+            if(PointerIdTable::getPointer(_table, ptrID).target == target) {
                 toRemove.push_back(ptrID);
             }
         }
@@ -76,15 +111,31 @@ public:
         for (auto ptrID : toRemove)  {
             pointers.unset(ptrID);
         }
-        return !toRemove.empty();
+
+        bool changed = false;
+        auto it = overflowSet.begin();
+        while(it != overflowSet.end()) {
+            if(it->target == target) {
+                it = overflowSet.erase(it);
+                changed = true;
+            } else {
+                it++;
+            }
+        }
+        return changed || !toRemove.empty();
     }
 
     void clear() {
         pointers.reset();
+        overflowSet.clear();
     }
 
     bool pointsTo(const Pointer& ptr) const {
-        return pointers.get(getPointerID(ptr));
+        if(isIdPointer(ptr)) {
+            auto id = PointerIdTable::findPointerId(_table, ptr);
+            return id != PointerIdTable::NO_ID && pointers.get(id);
+        }
+        return overflowSet.find(ptr) != overflowSet.end();
     }
 
     bool mayPointTo(const Pointer& ptr) const {
@@ -98,20 +149,25 @@ public:
     }
 
     bool pointsToTarget(PSNode *target) const {
-        for(const auto& kv : ids) {
-            if(kv.first.target == target && pointers.get(kv.second)) {
+        for (const auto& ptrID : pointers) {
+            if(PointerIdTable::getPointer(_table, ptrID).target == target) {
                 return true;
             }
         }
+        for (const auto& ptr : overflowSet) {
+            if (ptr.target == target)
+                return true;
+        }
         return false;
     }
 
     bool isSingleton() const {
-        return pointers.size() == 1;
+        return (pointers.size() == 1 && overflowSet.empty())
+                || (pointers.empty() && overflowSet.size() == 1);
     }
 
     bool empty() const {
-        return pointers.empty();
+        return pointers.empty() && overflowSet.empty();
     }
 
     size_t count(const Pointer& ptr) const {
@@ -136,23 +192,49 @@ public:
     }
 
     size_t size() const {
-        return pointers.size();
+        return pointers.size() + overflowSet.size();
     }
 
-    void swap(PointerIdPointsToSet& rhs) {
+    void swap(PointerIdPointsToSetImpl& rhs) {
         pointers.swap(rhs.pointers);
+        overflowSet.swap(rhs.overflowSet);
+        std::swap(_table, rhs._table);
     }
 
-    class const_iterator {
+    size_t overflowSetSize() const {
+        return overflowSet.size();
+    }
 
-        typename ADT::SparseBitvector::const_iterator container_it;
+    class const_iterator {
 
-        const_iterator(const ADT::SparseBitvector& pointers, bool end = false) :
-        container_it(end ? pointers.end() : pointers.begin()) {}
+        typename BitvectorT::const_iterator bitvector_it;
+        typename BitvectorT::const_iterator bitvector_end;
+        typename std::set<Pointer>::const_iterator set_it;
+        const PointerIdTable *table;
+        bool secondContainer;
+
+        const_iterator(const BitvectorT& pointers, const std::set<Pointer>& overflow,
+                       const PointerIdTable *table, bool end = false) :
+        bitvector_it(end ? pointers.end() : pointers.begin()),
+        bitvector_end(pointers.end()),
+        set_it(end ? overflow.end() : overflow.begin()),
+        table(table),
+        secondContainer(end) {
+            if(bitvector_it == bitvector_end) {
+                secondContainer = true;
+            }
+        }
 
     public:
         const_iterator& operator++() {
-            container_it++;
+            if(!secondContainer) {
+                bitvector_it++;
+                if(bitvector_it == bitvector_end) {
+                    secondContainer = true;
+                }
+            } else {
+                set_it++;
+            }
             return *this;
         }
 
@@ -163,26 +245,35 @@ public:
         }
 
         Pointer operator*() const {
-            return Pointer(idVector[*container_it - 1]);
+            if(!secondContainer) {
+                return PointerIdTable::getPointer(table, *bitvector_it);
+            }
+            return *set_it;
         }
 
         bool operator==(const const_iterator& rhs) const {
-            return container_it == rhs.container_it;
+            return bitvector_it == rhs.bitvector_it
+                    && set_it == rhs.set_it;
         }
 
         bool operator!=(const const_iterator& rhs) const {
             return !operator==(rhs);
         }
 
-        friend class PointerIdPointsToSet;
+        friend class PointerIdPointsToSetImpl;
     };
 
-    const_iterator begin() const { return const_iterator(pointers); }
-    const_iterator end() const { return const_iterator(pointers, true /* end */); }
+    const_iterator begin() const { return const_iterator(pointers, overflowSet, _table); }
+    const_iterator end() const { return const_iterator(pointers, overflowSet, _table, true /* end */); }
 
     friend class const_iterator;
 };
 
+using PointerIdPointsToSet = PointerIdPointsToSetImpl<ADT::SparseBitvector>;
+// the IDs are stored in a contiguous array of words, the unions
+// use vector instructions. Good for large points-to sets.
+using DensePointerIdPointsToSet = PointerIdPointsToSetImpl<ADT::DenseBitvector>;
+
 } // namespace pta
 } // namespace analysis
 } // namespace dg
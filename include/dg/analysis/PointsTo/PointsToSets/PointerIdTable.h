@@ -0,0 +1,155 @@
+#ifndef _DG_POINTER_ID_TABLE_H_
+#define _DG_POINTER_ID_TABLE_H_
+
+#include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/PointsToSets/PointsToSetPool.h"
+
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include <cassert>
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+class PSNode;
+
+///
+// Numbering of nodes and pointers for the points-to sets that are
+// represented by bitvectors. Every PointerGraph has its own table,
+// so the sets of different graphs do not share any state and analyses
+// of different graphs can run in parallel.
+//
+// The index of a node is derived from its ID (IDs are dense in a graph),
+// so it is computed without any lookup. The special nodes (nullptr,
+// unknown memory and invalidated) are shared by all graphs and have
+// the same fixed indices in every table. Pointers to special nodes
+// with offset 0 or UNKNOWN have fixed IDs too.
+class PointerIdTable {
+    // node index -> node
+    std::vector<PSNode *> _nodes;
+    // node index -> (offset -> pointer ID)
+    std::vector<std::unordered_map<Offset::type, size_t>> _pointerIds;
+    // pointer ID - SPECIAL_POINTERS_NUM -> pointer
+    std::vector<Pointer> _pointers;
+    // interned sets of the HashConsedPointsToSet
+    PointsToSetPool _setPool;
+
+public:
+    // nullptr, unknown memory and invalidated
+    static const size_t SPECIAL_NODES_NUM = 3;
+    // pointers to special nodes with offset 0 or UNKNOWN
+    static const size_t SPECIAL_POINTERS_NUM = 2 * SPECIAL_NODES_NUM;
+    // returned when a pointer has no ID
+    static const size_t NO_ID = ~static_cast<size_t>(0);
+
+    PointerIdTable() = default;
+    PointerIdTable(const PointerIdTable&) = delete;
+    PointerIdTable& operator=(const PointerIdTable&) = delete;
+
+    // these need the definition of PSNode, they are defined in PSNode.h
+    static inline size_t getNodeIndex(PSNode *node);
+    // get the table of the graph that the node belongs to
+    // (nullptr for special nodes)
+    static inline PointerIdTable *get(PSNode *node);
+
+    PointsToSetPool& getSetPool() { return _setPool; }
+    const PointsToSetPool& getSetPool() const { return _setPool; }
+
+    static bool isSpecialNode(PSNode *node) {
+        return node == NULLPTR || node == UNKNOWN_MEMORY || node == INVALIDATED;
+    }
+
+    static PSNode *getSpecialNode(size_t idx) {
+        assert(idx < SPECIAL_NODES_NUM);
+        switch (idx) {
+            case 0: return NULLPTR;
+            case 1: return UNKNOWN_MEMORY;
+            default: return INVALIDATED;
+        }
+    }
+
+    // the table may be nullptr if the set contains only special nodes
+    static PSNode *getNode(const PointerIdTable *table, size_t idx) {
+        if (idx < SPECIAL_NODES_NUM)
+            return getSpecialNode(idx);
+
+        assert(table && "Have no table for a non-special node");
+        assert(idx < table->_nodes.size() && table->_nodes[idx]);
+        return table->_nodes[idx];
+    }
+
+    void addNode(PSNode *node) {
+        auto idx = getNodeIndex(node);
+        if (_nodes.size() <= idx)
+            _nodes.resize(idx + 1, nullptr);
+        _nodes[idx] = node;
+    }
+
+    static bool hasFixedId(const Pointer& ptr) {
+        return isSpecialNode(ptr.target) &&
+               (ptr.offset.isUnknown() || ptr.offset.isZero());
+    }
+
+    // get the ID of the pointer, the pointer gets a new ID
+    // if it has none. Pointers to special nodes must have a fixed ID.
+    size_t getPointerId(const Pointer& ptr) {
+        if (isSpecialNode(ptr.target))
+            return getFixedId(ptr);
+
+        auto idx = getNodeIndex(ptr.target);
+        if (_pointerIds.size() <= idx)
+            _pointerIds.resize(idx + 1);
+
+        auto& ids = _pointerIds[idx];
+        auto it = ids.find(*ptr.offset);
+        if (it != ids.end())
+            return it->second;
+
+        size_t id = SPECIAL_POINTERS_NUM + _pointers.size();
+        _pointers.push_back(ptr);
+        ids.emplace(*ptr.offset, id);
+        return id;
+    }
+
+    // get the ID of the pointer or NO_ID if the pointer has no ID yet
+    static size_t findPointerId(const PointerIdTable *table, const Pointer& ptr) {
+        if (isSpecialNode(ptr.target))
+            return hasFixedId(ptr) ? getFixedId(ptr) : NO_ID;
+
+        if (!table)
+            return NO_ID;
+
+        auto idx = getNodeIndex(ptr.target);
+        if (table->_pointerIds.size() <= idx)
+            return NO_ID;
+
+        const auto& ids = table->_pointerIds[idx];
+        auto it = ids.find(*ptr.offset);
+        return it == ids.end() ? NO_ID : it->second;
+    }
+
+    static Pointer getPointer(const PointerIdTable *table, size_t id) {
+        if (id < SPECIAL_POINTERS_NUM) {
+            return Pointer(getSpecialNode(id / 2),
+                           id % 2 ? Offset::UNKNOWN : 0);
+        }
+
+        assert(table && "Have no table for a non-special pointer");
+        assert(id - SPECIAL_POINTERS_NUM < table->_pointers.size());
+        return table->_pointers[id - SPECIAL_POINTERS_NUM];
+    }
+
+private:
+    static size_t getFixedId(const Pointer& ptr) {
+        assert(hasFixedId(ptr) && "The pointer has no fixed ID");
+        return 2 * getNodeIndex(ptr.target) + (ptr.offset.isUnknown() ? 1 : 0);
+    }
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_POINTER_ID_TABLE_H_
@@ -0,0 +1,239 @@
+#ifndef _DG_POINTS_TO_SET_POOL_H_
+#define _DG_POINTS_TO_SET_POOL_H_
+
+#include "dg/analysis/PointsTo/Pointer.h"
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+#include <unordered_map>
+#include <cassert>
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+///
+// The pool of hash-consed (interned) points-to sets. Every distinct
+// set of pointers is stored in the pool only once and the points-to sets
+// (HashConsedPointsToSet) share it. The interned sets are immutable,
+// an operation on a set yields another interned set. The results
+// of unions and insertions are memoized, so repeating an operation
+// is just a lookup.
+//
+// The sets are kept until the pool is destroyed (every PointerGraph
+// has its own pool). The pool is not thread-safe.
+class PointsToSetPool {
+public:
+    struct Set {
+        // sorted, a target with UNKNOWN offset has no other offsets
+        std::vector<Pointer> pointers;
+        size_t hash;
+    };
+
+private:
+    struct SetHash {
+        size_t operator()(const Set *S) const { return S->hash; }
+    };
+
+    struct SetEq {
+        bool operator()(const Set *A, const Set *B) const {
+            return A->hash == B->hash && A->pointers == B->pointers;
+        }
+    };
+
+    template <typename T>
+    struct PairHash {
+        size_t operator()(const std::pair<const Set *, T>& P) const {
+            return _combine(std::hash<const Set *>()(P.first), _hash(P.second));
+        }
+    };
+
+    std::vector<std::unique_ptr<Set>> _storage;
+    std::unordered_set<Set *, SetHash, SetEq> _sets;
+    std::unordered_map<std::pair<const Set *, const Set *>, const Set *,
+                       PairHash<const Set *>> _unions;
+    std::unordered_map<std::pair<const Set *, Pointer>, const Set *,
+                       PairHash<Pointer>> _inserts;
+
+    size_t _hits{0};
+    size_t _misses{0};
+
+    static size_t _combine(size_t seed, size_t h) {
+        return seed ^ (h + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+
+    static size_t _hash(const Set *S) { return std::hash<const Set *>()(S); }
+    static size_t _hash(const Pointer& ptr) {
+        return _combine(std::hash<PSNode *>()(ptr.target),
+                        std::hash<Offset::type>()(*ptr.offset));
+    }
+
+    // get the interned set with the given pointers
+    const Set *_intern(std::vector<Pointer>&& pointers) {
+        if (pointers.empty())
+            return nullptr;
+
+        std::unique_ptr<Set> S(new Set{std::move(pointers), 0});
+        size_t h = 0;
+        for (const auto& ptr : S->pointers)
+            h = _combine(h, _hash(ptr));
+        S->hash = h;
+
+        auto it = _sets.find(S.get());
+        if (it != _sets.end())
+            return *it;
+
+        _sets.insert(S.get());
+        _storage.push_back(std::move(S));
+        return _storage.back().get();
+    }
+
+    static const Pointer *_begin(const Set *S) {
+        return S ? S->pointers.data() : nullptr;
+    }
+
+    static const Pointer *_end(const Set *S) {
+        return S ? S->pointers.data() + S->pointers.size() : nullptr;
+    }
+
+    // append the pointers with the same target as *it to out
+    // and move it after them. If there is the UNKNOWN offset
+    // in any of the two ranges, only the UNKNOWN offset is appended.
+    static void _mergeTarget(const Pointer *& a, const Pointer *aend,
+                             const Pointer *& b, const Pointer *bend,
+                             PSNode *target, std::vector<Pointer>& out) {
+        auto aE = a, bE = b;
+        while (aE != aend && aE->target == target) ++aE;
+        while (bE != bend && bE->target == target) ++bE;
+
+        if ((aE != a && (aE - 1)->offset.isUnknown()) ||
+            (bE != b && (bE - 1)->offset.isUnknown())) {
+            out.emplace_back(target, Offset::UNKNOWN);
+        } else {
+            std::set_union(a, aE, b, bE, std::back_inserter(out));
+        }
+
+        a = aE;
+        b = bE;
+    }
+
+public:
+    PointsToSetPool() = default;
+    PointsToSetPool(const PointsToSetPool&) = delete;
+    PointsToSetPool& operator=(const PointsToSetPool&) = delete;
+
+    static bool contains(const Set *S, const Pointer& ptr) {
+        return std::binary_search(_begin(S), _end(S), ptr);
+    }
+
+    static bool containsTarget(const Set *S, PSNode *target) {
+        auto it = std::lower_bound(_begin(S), _end(S), Pointer(target, 0));
+        return it != _end(S) && it->target == target;
+    }
+
+    const Set *unite(const Set *A, const Set *B) {
+        if (!A || A == B)
+            return B;
+        if (!B)
+            return A;
+
+        // union is commutative
+        if (B < A)
+            std::swap(A, B);
+
+        auto key = std::make_pair(A, B);
+        auto it = _unions.find(key);
+        if (it != _unions.end()) {
+            ++_hits;
+            return it->second;
+        }
+        ++_misses;
+
+        std::vector<Pointer> pointers;
+        pointers.reserve(A->pointers.size() + B->pointers.size());
+        const Pointer *a = _begin(A), *aend = _end(A);
+        const Pointer *b = _begin(B), *bend = _end(B);
+        while (a != aend || b != bend) {
+            PSNode *target;
+            if (a == aend)
+                target = b->target;
+            else if (b == bend)
+                target = a->target;
+            else
+                target = std::min(a->target, b->target);
+            _mergeTarget(a, aend, b, bend, target, pointers);
+        }
+
+        const Set *R = _intern(std::move(pointers));
+        _unions.emplace(key, R);
+        return R;
+    }
+
+    const Set *insert(const Set *A, const Pointer& ptr) {
+        auto key = std::make_pair(A, ptr);
+        auto it = _inserts.find(key);
+        if (it != _inserts.end()) {
+            ++_hits;
+            return it->second;
+        }
+        ++_misses;
+
+        const Set *R = A;
+        if (!contains(A, Pointer(ptr.target, Offset::UNKNOWN)) &&
+            !contains(A, ptr)) {
+            std::vector<Pointer> pointers;
+            if (ptr.offset.isUnknown()) {
+                // the UNKNOWN offset subsumes the other offsets
+                for (auto p = _begin(A); p != _end(A); ++p)
+                    if (p->target != ptr.target)
+                        pointers.push_back(*p);
+            } else if (A) {
+                pointers = A->pointers;
+            }
+            pointers.insert(std::upper_bound(pointers.begin(),
+                                             pointers.end(), ptr), ptr);
+            R = _intern(std::move(pointers));
+        }
+
+        _inserts.emplace(key, R);
+        return R;
+    }
+
+    const Set *remove(const Set *A, const Pointer& ptr) {
+        if (!contains(A, ptr))
+            return A;
+
+        std::vector<Pointer> pointers;
+        for (auto p = _begin(A); p != _end(A); ++p)
+            if (!(*p == ptr))
+                pointers.push_back(*p);
+        return _intern(std::move(pointers));
+    }
+
+    const Set *removeAny(const Set *A, PSNode *target) {
+        if (!containsTarget(A, target))
+            return A;
+
+        std::vector<Pointer> pointers;
+        for (auto p = _begin(A); p != _end(A); ++p)
+            if (p->target != target)
+                pointers.push_back(*p);
+        return _intern(std::move(pointers));
+    }
+
+    // the number of distinct sets in the pool
+    size_t size() const { return _storage.size(); }
+    // the number of memoized operations that were (not) reused
+    size_t getHits() const { return _hits; }
+    size_t getMisses() const { return _misses; }
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_POINTS_TO_SET_POOL_H_
@@ -3,9 +3,11 @@
 
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/ADT/Bitvector.h"
+#include "dg/analysis/PointsTo/PointsToSets/PointerIdTable.h"
 
-#include <map>
 #include <vector>
+#include <cassert>
+#include <cstdlib> // abort()
 
 namespace dg {
 namespace analysis {
@@ -17,17 +19,19 @@ class SeparateOffsetsPointsToSet {
 
     ADT::SparseBitvector nodes;
     ADT::SparseBitvector offsets;
-    static std::map<PSNode*,size_t> ids;  //nodes are numbered 1, 2, ...
-    static std::vector<PSNode*> idVector; //starts from 0 (node = idVector[id - 1])
+    // numbering of nodes of the graph
+    // (nullptr if the set contains only special nodes)
+    PointerIdTable *_table = nullptr;
+
+    void setTable(PSNode *node) {
+        if (!_table)
+            _table = PointerIdTable::get(node);
+        assert((!PointerIdTable::get(node) || PointerIdTable::get(node) == _table)
+               && "Nodes from different graphs in one set");
+    }
 
-    //if the node doesn't have ID, it is assigned one
     size_t getNodeID(PSNode *node) const {
-        auto it = ids.find(node);
-        if(it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(node);
-        return ids.emplace_hint(it, node, ids.size() + 1)->second;
+        return PointerIdTable::getNodeIndex(node);
     }
 
 public:
@@ -35,6 +39,7 @@ public:
     SeparateOffsetsPointsToSet(std::initializer_list<Pointer> elems) { add(elems); }
 
     bool add(PSNode *target, Offset off) {
+        setTable(target);
         if(offsets.get(Offset::UNKNOWN)) {
             return !nodes.set(getNodeID(target));
         }
@@ -50,6 +55,10 @@ public:
     }
 
     bool add(const SeparateOffsetsPointsToSet& S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table)
+               && "Nodes from different graphs in one set");
         bool changed = nodes.set(S.nodes);
         return offsets.set(S.offsets) || changed;
     }
@@ -125,6 +134,7 @@ public:
     void swap(SeparateOffsetsPointsToSet& rhs) {
         nodes.swap(rhs.nodes);
         offsets.swap(rhs.offsets);
+        std::swap(_table, rhs._table);
     }
 
     //iterates through all the possible combinations of nodes and their offsets stored in this points-to set
@@ -135,13 +145,16 @@ public:
         typename ADT::SparseBitvector::const_iterator offsets_it;
         typename ADT::SparseBitvector::const_iterator offsets_begin;
         typename ADT::SparseBitvector::const_iterator offsets_end;
+        const PointerIdTable *table;
 
-        const_iterator(const ADT::SparseBitvector& nodes, const ADT::SparseBitvector& offsets, bool end = false) :
+        const_iterator(const ADT::SparseBitvector& nodes, const ADT::SparseBitvector& offsets,
+                       const PointerIdTable *table, bool end = false) :
         nodes_it(end ? nodes.end() : nodes.begin()),
         nodes_end(nodes.end()),
         offsets_it(offsets.begin()),
         offsets_begin(offsets.begin()),
-        offsets_end(offsets.end()) {
+        offsets_end(offsets.end()),
+        table(table) {
             if(nodes_it == nodes_end) {
                 offsets_it = offsets_end;
             }
@@ -166,7 +179,7 @@ public:
         }
 
         Pointer operator*() const {
-            return Pointer(idVector[*nodes_it - 1], *offsets_it);
+            return Pointer(PointerIdTable::getNode(table, *nodes_it), *offsets_it);
         }
 
         bool operator==(const const_iterator& rhs) const {
@@ -181,8 +194,8 @@ public:
         friend class SeparateOffsetsPointsToSet;
     };
 
-    const_iterator begin() const { return const_iterator(nodes, offsets); }
-    const_iterator end() const { return const_iterator(nodes, offsets, true /* end */); }
+    const_iterator begin() const { return const_iterator(nodes, offsets, _table); }
+    const_iterator end() const { return const_iterator(nodes, offsets, _table, true /* end */); }
 
     friend class const_iterator;
 };
@@ -3,8 +3,8 @@
 
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/ADT/Bitvector.h"
+#include "dg/analysis/PointsTo/PointsToSets/PointerIdTable.h"
 
-#include <map>
 #include <set>
 #include <vector>
 #include <cassert>
@@ -19,21 +19,19 @@ class SmallOffsetsPointsToSet {
 
     ADT::SparseBitvector pointers;
     std::set<Pointer> largePointers;
-    static std::map<PSNode*,size_t> ids;  //nodes are numbered 1,2, ...
-    static std::vector<PSNode*> idVector; //starts from 0 (node = idVector[id - 1])
-
-    //if the node doesn't have ID, it's assigned one
-    size_t getNodeID(PSNode *node) const {
-        auto it = ids.find(node);
-        if(it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(node);
-        return ids.emplace_hint(it, node, ids.size() + 1)->second;
+    // numbering of nodes of the graph
+    // (nullptr if the set contains only special nodes)
+    PointerIdTable *_table = nullptr;
+
+    void setTable(PSNode *node) {
+        if (!_table)
+            _table = PointerIdTable::get(node);
+        assert((!PointerIdTable::get(node) || PointerIdTable::get(node) == _table)
+               && "Nodes from different graphs in one set");
     }
 
     size_t getNodePosition(PSNode *node) const {
-        return ((getNodeID(node) - 1) * 64);
+        return PointerIdTable::getNodeIndex(node) * 64;
     }
 
     size_t getPosition(PSNode *node, Offset off) const {
@@ -58,6 +56,7 @@ public:
     SmallOffsetsPointsToSet(std::initializer_list<Pointer> elems) { add(elems); }
 
     bool add(PSNode *target, Offset off) {
+        setTable(target);
         if(has({target, Offset::UNKNOWN})) {
             return false;
         } else if(off.isUnknown()) {
@@ -74,6 +73,10 @@ public:
     }
 
     bool add(const SmallOffsetsPointsToSet& S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table)
+               && "Nodes from different graphs in one set");
         bool changed = pointers.set(S.pointers);
         for (const auto& ptr : S.largePointers) {
             changed |= largePointers.insert(ptr).second;
@@ -183,6 +186,7 @@ public:
     void swap(SmallOffsetsPointsToSet& rhs) {
         pointers.swap(rhs.pointers);
         largePointers.swap(rhs.largePointers);
+        std::swap(_table, rhs._table);
     }
 
     size_t overflowSetSize() const {
@@ -195,12 +199,15 @@ public:
         typename ADT::SparseBitvector::const_iterator bitvector_it;
         typename ADT::SparseBitvector::const_iterator bitvector_end;
         typename std::set<Pointer>::const_iterator set_it;
+        const PointerIdTable *table;
         bool secondContainer;
 
-        const_iterator(const ADT::SparseBitvector& pointers, const std::set<Pointer>& largePointers, bool end = false)
+        const_iterator(const ADT::SparseBitvector& pointers, const std::set<Pointer>& largePointers,
+                       const PointerIdTable *table, bool end = false)
         : bitvector_it(end ? pointers.end() : pointers.begin()),
         bitvector_end(pointers.end()),
         set_it(end ? largePointers.end() : largePointers.begin()),
+        table(table),
         secondContainer(end) {
             if(bitvector_it == bitvector_end) {
                 secondContainer = true;
@@ -229,8 +236,8 @@ public:
         Pointer operator*() const {
             if(!secondContainer) {
                 size_t offsetID = *bitvector_it % 64;
-                size_t nodeID = ((*bitvector_it - offsetID) / 64) + 1;
-                return offsetID == 63 ? Pointer(idVector[nodeID - 1], Offset::UNKNOWN) : Pointer(idVector[nodeID - 1], offsetID);
+                PSNode *node = PointerIdTable::getNode(table, *bitvector_it / 64);
+                return offsetID == 63 ? Pointer(node, Offset::UNKNOWN) : Pointer(node, offsetID);
             }
             return *set_it;
         }
@@ -247,8 +254,8 @@ public:
         friend class SmallOffsetsPointsToSet;
     };
 
-    const_iterator begin() const { return const_iterator(pointers, largePointers); }
-    const_iterator end() const { return const_iterator(pointers, largePointers, true /* end */); }
+    const_iterator begin() const { return const_iterator(pointers, largePointers, _table); }
+    const_iterator end() const { return const_iterator(pointers, largePointers, _table, true /* end */); }
 
     friend class const_iterator;
 };
@@ -6,6 +6,7 @@
 
 #include "dg/analysis/Offset.h"
 #include "DisjunctiveIntervalMap.h"
+#include "FlatDisjunctiveIntervalMap.h"
 
 namespace dg {
 namespace analysis {
@@ -14,10 +15,13 @@ namespace rd {
 class RDNode;
 class ReachingDefinitionsAnalysis;
 
-template <typename NodeT = RDNode>
+// The definitions of memory objects. 'OffsetsT' maps the intervals
+// of bytes of an object to the definitions, it is DisjunctiveIntervalMap
+// or FlatDisjunctiveIntervalMap.
+template <typename NodeT = RDNode,
+          typename OffsetsT = DisjunctiveIntervalMap<NodeT *>>
 class DefinitionsMap {
 
-    using OffsetsT = DisjunctiveIntervalMap<NodeT *>;
     using IntervalT = typename OffsetsT::IntervalT;
 
     std::map<NodeT *, OffsetsT> _definitions{};
@@ -3,6 +3,7 @@
 
 #include "dg/analysis/Offset.h"
 #include <cassert>
+#include <cstddef>
 #include <map>
 #include <set>
 #include <vector>
@@ -127,13 +128,8 @@ public:
         if (_mapping.empty())
             return false;
 
-        auto ge = _find_ge(I);
-        if (ge == _mapping.end()) {
-            auto last = _get_last();
-            return last->first.end >= I.start;
-        } else {
-            return ge->first.start <= I.end;
-        }
+        // NOTE: the interval that starts before I may overlap I too
+        return le(I) != end();
     }
 
     bool overlaps(IntervalValueT start, IntervalValueT end) const {
@@ -157,6 +153,9 @@ public:
                     return false;
                 auto prev = ge;
                 --prev;
+                // the previous interval covers the whole I
+                if (prev->first.end >= I.end)
+                    return true;
                 if (prev->first.end != ge->first.start - 1)
                     return false;
             }
@@ -242,6 +241,12 @@ public:
 
         while (true) {
             assert(cur.start <= it->first.start);
+            // the rest of I lies before the next interval
+            if (it->first.start > I.end) {
+                ret.push_back(cur);
+                break;
+            }
+
             if (cur.start != it->first.start &&
                 cur.start < it->first.start) {
                 assert(it->first.start != 0 && "Underflow");
@@ -338,6 +343,9 @@ private:
         // find the element that starts at the same value
         // as I or later (i.e. I.start >= it.start)
         if (startge == end()) {
+            if (_mapping.empty())
+                return end();
+
             auto last = _get_last();
             if (last->first.end >= I.start) {
                 assert(last->first.overlaps(I));
@@ -0,0 +1,299 @@
+#ifndef _DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
+#define _DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "dg/ADT/SmallSortedSet.h"
+#include "dg/analysis/Offset.h"
+#include "dg/analysis/ReachingDefinitions/DisjunctiveIntervalMap.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+///
+// Mapping of disjunctive discrete intervals of values
+// to sets of ValueT. It has the same interface and splits
+// the intervals in the same way as DisjunctiveIntervalMap,
+// but the intervals are kept in a sorted vector and the
+// values of an interval are stored inline (up to ValuesNum
+// values). That is cheaper for the maps with only few intervals,
+// which is the common case for the definitions of memory objects.
+template <typename ValueT, typename IntervalValueT = Offset,
+          unsigned ValuesNum = 4>
+class FlatDisjunctiveIntervalMap {
+public:
+    using IntervalT = DiscreteInterval<IntervalValueT>;
+    using ValuesT = ADT::SmallSortedSet<ValueT, ValuesNum>;
+    using MappingT = std::vector<std::pair<IntervalT, ValuesT>>;
+    using iterator = typename MappingT::iterator;
+    using const_iterator = typename MappingT::const_iterator;
+
+    ///
+    // Return true if the mapping is updated anyhow
+    // (intervals split, value added).
+    bool add(const IntervalValueT start, const IntervalValueT end,
+             const ValueT& val) {
+        return add(IntervalT(start, end), val);
+    }
+
+    bool add(const IntervalT& I, const ValueT& val) {
+        return _add(I, val, false);
+    }
+
+    template <typename ContT>
+    bool add(const IntervalT& I, const ContT& vals) {
+        bool changed = false;
+        for (const ValueT& val : vals) {
+            changed |= _add(I, val, false);
+        }
+        return changed;
+    }
+
+    bool update(const IntervalValueT start, const IntervalValueT end,
+                const ValueT& val) {
+        return update(IntervalT(start, end), val);
+    }
+
+    bool update(const IntervalT& I, const ValueT& val) {
+        return _add(I, val, true);
+    }
+
+    template <typename ContT>
+    bool update(const IntervalT& I, const ContT& vals) {
+        bool changed = false;
+        for (const ValueT& val : vals) {
+            changed |= _add(I, val, true);
+        }
+        return changed;
+    }
+
+    // add the value 'val' to all intervals
+    bool addAll(const ValueT& val) {
+        bool changed = false;
+        for (auto& it : _mapping) {
+            changed |= it.second.insert(val).second;
+        }
+        return changed;
+    }
+
+    // return true if some intervals from the map
+    // has a overlap with I
+    bool overlaps(const IntervalT& I) const {
+        return le(I) != end();
+    }
+
+    bool overlaps(IntervalValueT start, IntervalValueT end) const {
+        return overlaps(IntervalT(start, end));
+    }
+
+    // return true if the map has an entry for
+    // each single byte from the interval I
+    bool overlapsFull(const IntervalT& I) const {
+        auto it = le(I);
+        if (it == end() || it->first.start > I.start)
+            return false;
+
+        while (it->first.end < I.end) {
+            auto last_end = it->first.end;
+            ++it;
+            if (it == end() || it->first.start != last_end + 1)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool overlapsFull(IntervalValueT start, IntervalValueT end) const {
+        return overlapsFull(IntervalT(start, end));
+    }
+
+    ///
+    // Gather all values that are covered by the interval I
+    std::set<ValueT> gather(IntervalValueT start, IntervalValueT end) const {
+        return gather(IntervalT(start, end));
+    }
+
+    std::set<ValueT> gather(const IntervalT& I) const {
+        std::set<ValueT> ret;
+        for (auto it = le(I); it != end() && it->first.start <= I.end; ++it) {
+            ret.insert(it->second.begin(), it->second.end());
+        }
+
+        return ret;
+    }
+
+    std::vector<IntervalT> uncovered(IntervalValueT start, IntervalValueT end) const {
+        return uncovered(IntervalT(start, end));
+    }
+
+    std::vector<IntervalT> uncovered(const IntervalT& I) const {
+        std::vector<IntervalT> ret;
+        // the start of the part of I that we have not handled yet
+        auto cur = I.start;
+        for (auto it = le(I); it != end() && it->first.start <= I.end; ++it) {
+            if (cur < it->first.start)
+                ret.push_back(IntervalT{cur, it->first.start - 1});
+            // the rest of I is covered
+            if (it->first.end >= I.end)
+                return ret;
+
+            cur = it->first.end + 1;
+        }
+
+        ret.push_back(IntervalT{cur, I.end});
+        return ret;
+    }
+
+    bool empty() const { return _mapping.empty(); }
+    size_t size() const { return _mapping.size(); }
+
+    iterator begin() { return _mapping.begin(); }
+    const_iterator begin() const { return _mapping.begin(); }
+    iterator end() { return _mapping.end(); }
+    const_iterator end() const { return _mapping.end(); }
+
+    // return the iterator to an element that is the first
+    // that overlaps the interval I or end() if there is
+    // no such interval
+    iterator le(const IntervalT& I) {
+        auto it = _find_end_ge(I.start);
+        if (it != end() && it->first.start > I.end)
+            return end();
+        return it;
+    }
+
+    const_iterator le(const IntervalT& I) const {
+        auto it = _find_end_ge(I.start);
+        if (it != end() && it->first.start > I.end)
+            return end();
+        return it;
+    }
+
+    iterator le(const IntervalValueT start, const IntervalValueT end) {
+        return le(IntervalT(start, end));
+    }
+
+    const_iterator le(const IntervalValueT start, const IntervalValueT end) const {
+        return le(IntervalT(start, end));
+    }
+
+private:
+    // find the first interval that ends at 'val' or later
+    // (the intervals are disjunctive, so also their ends are sorted)
+    iterator _find_end_ge(IntervalValueT val) {
+        return std::lower_bound(_mapping.begin(), _mapping.end(), val,
+                                [](const typename MappingT::value_type& e,
+                                   IntervalValueT v) { return e.first.end < v; });
+    }
+
+    const_iterator _find_end_ge(IntervalValueT val) const {
+        return std::lower_bound(_mapping.begin(), _mapping.end(), val,
+                                [](const typename MappingT::value_type& e,
+                                   IntervalValueT v) { return e.first.end < v; });
+    }
+
+    // Split interval [a,b] on the index 'idx' to two intervals
+    // [a, where] and [where + 1, b]. Each of the new intervals
+    // has a copy of the original set associated to the original interval.
+    void _split(size_t idx, IntervalValueT where) {
+        auto interval = _mapping[idx].first;
+        assert(interval.start <= where && where < interval.end
+               && "Value 'where' must lie inside the interval");
+
+        ValuesT values = _mapping[idx].second;
+        _mapping[idx].first = IntervalT(where + 1, interval.end);
+        _mapping.emplace(_mapping.begin() + idx,
+                         IntervalT(interval.start, where), std::move(values));
+    }
+
+    bool _addValue(ValuesT& values, const ValueT& val, bool update) {
+        if (update) {
+            if (values.size() == 1 && values.count(val) > 0)
+                return false;
+
+            values.clear();
+            values.insert(val);
+            return true;
+        }
+
+        return values.insert(val).second;
+    }
+
+    // If the boolean 'update' is set to true, the value
+    // is not added, but rewritten
+    bool _add(const IntervalT& I, const ValueT& val, bool update = false) {
+        bool changed = false;
+        size_t idx = _find_end_ge(I.start) - _mapping.begin();
+
+        // split the interval that overlaps the start of I
+        if (idx < _mapping.size() && _mapping[idx].first.start < I.start) {
+            _split(idx, I.start - 1);
+            ++idx;
+            changed = true;
+        }
+
+        // now create new intervals in the gaps and add the value
+        // to the intervals that we have, 'cur' is the start
+        // of the part of I that we have not handled yet
+        auto cur = I.start;
+        while (true) {
+            if (idx == _mapping.size() || _mapping[idx].first.start > I.end) {
+                _mapping.emplace(_mapping.begin() + idx,
+                                 IntervalT(cur, I.end), ValuesT{val});
+                changed = true;
+                break;
+            }
+
+            // NOTE: use a const copy, Offset has also
+            // the operator- that modifies the object
+            const auto next_start = _mapping[idx].first.start;
+            if (cur < next_start) {
+                _mapping.emplace(_mapping.begin() + idx,
+                                 IntervalT(cur, next_start - 1), ValuesT{val});
+                ++idx;
+                cur = next_start;
+                changed = true;
+            }
+
+            assert(_mapping[idx].first.start == cur);
+            // split the interval that overlaps the end of I
+            if (_mapping[idx].first.end > I.end) {
+                _split(idx, I.end);
+                changed = true;
+            }
+
+            changed |= _addValue(_mapping[idx].second, val, update);
+            if (_mapping[idx].first.end == I.end)
+                break;
+
+            cur = _mapping[idx].first.end + 1;
+            ++idx;
+        }
+
+        _check();
+        return changed;
+    }
+
+    void _check() const {
+#ifndef NDEBUG
+        // check that the keys are disjunctive
+        for (size_t i = 1; i < _mapping.size(); ++i) {
+            assert(_mapping[i - 1].first.start <= _mapping[i - 1].first.end);
+            assert(_mapping[i - 1].first.end < _mapping[i].first.start);
+        }
+#endif // NDEBUG
+    }
+
+    MappingT _mapping;
+};
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
@@ -171,6 +171,9 @@ public:
     BasicRDMap(const BasicRDMap& o) {
         merge(&o);
     }
+    BasicRDMap(BasicRDMap&&) = default;
+    BasicRDMap& operator=(const BasicRDMap&) = default;
+    BasicRDMap& operator=(BasicRDMap&&) = default;
 
     bool merge(const BasicRDMap *o,
                DefSiteSetT *without = nullptr,
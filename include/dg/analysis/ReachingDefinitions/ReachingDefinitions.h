@@ -3,10 +3,14 @@
 
 #include <vector>
 #include <list>
+#include <map>
 #include <set>
+#include <tuple>
 #include <cassert>
 #include <memory>
+#include <unordered_map>
 
+#include "dg/ADT/Arena.h"
 #include "dg/analysis/Offset.h"
 #include "dg/analysis/BFS.h"
 
@@ -25,6 +29,10 @@ namespace rd {
 // here the types are for type-checking (optional - user can do it
 // when building the graph) and for later optimizations
 
+// most memory objects have only few defined intervals
+// with few definitions, so keep them in flat maps
+using RDDefinitionsMap = DefinitionsMap<RDNode, FlatDisjunctiveIntervalMap<RDNode *>>;
+
 class RDBBlock {
     void _check() {
 #ifndef NDEBUG
@@ -77,15 +85,23 @@ public:
 
     const NodesT& getNodes() const { return _nodes; }
 
-    DefinitionsMap<RDNode> definitions;
+    RDDefinitionsMap definitions;
 
     // override the operator* method in the successor/predecessor iterator of the node
-    struct edge_iterator : public NodeSuccIterator {
+    struct edge_iterator {
+        NodeSuccIterator it{};
+
         edge_iterator() = default;
-        edge_iterator(const NodeSuccIterator& I) : NodeSuccIterator(I) {}
+        edge_iterator(const NodeSuccIterator& I) : it(I) {}
+
+        RDBBlock *operator*() { return (*it)->getBBlock(); }
+        RDBBlock *operator->() { return (*it)->getBBlock(); }
 
-        RDBBlock *operator*() { return NodeSuccIterator::operator*()->getBBlock(); }
-        RDBBlock *operator->() { return NodeSuccIterator::operator*()->getBBlock(); }
+        edge_iterator& operator++() { ++it; return *this; }
+        edge_iterator operator++(int) { auto tmp = *this; ++it; return tmp; }
+
+        bool operator==(const edge_iterator& rhs) const { return it == rhs.it; }
+        bool operator!=(const edge_iterator& rhs) const { return it != rhs.it; }
     };
 
     edge_iterator pred_begin() { return edge_iterator(_nodes.front()->getPredecessors().begin()); }
@@ -94,12 +110,12 @@ public:
     edge_iterator succ_end() { return edge_iterator(_nodes.back()->getSuccessors().end()); }
 
     RDBBlock *getSinglePredecessor() {
-        auto& preds = _nodes.front()->getPredecessors();
+        auto preds = _nodes.front()->getPredecessors();
         return preds.size() == 1 ? (*preds.begin())->getBBlock() : nullptr;
     }
 
     RDBBlock *getSingleSuccessor() {
-        auto& succs = _nodes.back()->getSuccessors();
+        auto succs = _nodes.back()->getSuccessors();
         return succs.size() == 1 ? (*succs.begin())->getBBlock() : nullptr;
     }
 
@@ -118,7 +134,8 @@ class ReachingDefinitionsGraph {
     size_t lastNodeID{0};
     RDNode *root{nullptr};
     using BBlocksVecT = std::vector<std::unique_ptr<RDBBlock>>;
-    using NodesT = std::vector<std::unique_ptr<RDNode>>;
+    // the nodes live in the arenas of the graph
+    using NodesT = std::vector<ADT::ArenaPtr<RDNode>>;
 
     // iterator over the bblocks that returns the bblock,
     // not the unique_ptr to the bblock
@@ -146,9 +163,41 @@ class ReachingDefinitionsGraph {
         block_iterator end() { return block_iterator(blocks.end()); }
     };
 
+    // the arenas must outlive the nodes
+    ADT::Arena _arena{1 << 16};
+    // the arenas taken from NodesArena objects
+    std::vector<ADT::Arena> _mergedArenas;
+
     NodesT _nodes;
 
+    // the edges of the nodes packed by freezeEdges()
+    std::unique_ptr<FrozenEdges<RDNode>> _frozenEdges;
+
+    std::vector<RDNode *> _getAllNodes() const {
+        std::vector<RDNode *> all;
+        all.reserve(_nodes.size());
+        for (auto& n : _nodes) {
+            if (n)
+                all.push_back(n.get());
+        }
+        return all;
+    }
+
 public:
+    // Creates nodes outside of the graph (e.g., in other threads
+    // than the one that owns the graph). A node gets its ID when
+    // it is added to the graph by addNode() and the graph takes
+    // the memory of the nodes by merge().
+    class NodesArena {
+        ADT::Arena _arena{1 << 12};
+        friend class ReachingDefinitionsGraph;
+
+    public:
+        RDNode *create(RDNodeType t) {
+            return _arena.create<RDNode>(0u, t);
+        }
+    };
+
     ReachingDefinitionsGraph() = default;
     ReachingDefinitionsGraph(RDNode *r) : root(r) {};
     ReachingDefinitionsGraph(ReachingDefinitionsGraph&&) = default;
@@ -171,10 +220,41 @@ public:
     }
 
     RDNode *create(RDNodeType t) {
-      _nodes.emplace_back(new RDNode(++lastNodeID, t));
+      _nodes.emplace_back(_arena.create<RDNode>(++lastNodeID, t));
       return _nodes.back().get();
     }
 
+    // add a node created by a NodesArena to the graph
+    void addNode(RDNode *n) {
+        assert(n->getID() == 0 && "The node is already in a graph");
+        n->setID(++lastNodeID);
+        _nodes.emplace_back(n);
+    }
+
+    void merge(NodesArena&& nodes) {
+        _mergedArenas.push_back(std::move(nodes._arena));
+    }
+
+    // Pack the edges of all nodes into continuous arrays.
+    // The graph can be changed also after freezing,
+    // the changed nodes then use their own edges again
+    // (until the edges are frozen again).
+    void freezeEdges() {
+        auto all = _getAllNodes();
+        std::unique_ptr<FrozenEdges<RDNode>>
+            edges(new FrozenEdges<RDNode>(all, lastNodeID + 1));
+        edges->freeze(all);
+        // the old packed edges are not used by any node now
+        _frozenEdges = std::move(edges);
+    }
+
+    void unfreezeEdges() {
+        FrozenEdges<RDNode>::thaw(_getAllNodes());
+        _frozenEdges.reset();
+    }
+
+    bool edgesFrozen() const { return _frozenEdges != nullptr; }
+
     // Build blocks for the nodes. If 'dce' is set to true,
     // the dead code is eliminated after building the blocks.
     void buildBBlocks(bool dce = false);
@@ -218,6 +298,10 @@ protected:
 
     const ReachingDefinitionsAnalysisOptions options;
 
+    // statistics
+    unsigned _roundsNum{0};
+    size_t _processedNodesNum{0};
+
 public:
     ReachingDefinitionsAnalysis(ReachingDefinitionsGraph&& graph,
                                 const ReachingDefinitionsAnalysisOptions& opts)
@@ -248,6 +332,15 @@ public:
     bool processNode(RDNode *n);
     virtual void run();
 
+    // the number of rounds of the fixpoint computation
+    unsigned getNumOfRounds() const { return _roundsNum; }
+    // how many times were the nodes processed (in all rounds)
+    size_t getNumOfProcessedNodes() const { return _processedNodesNum; }
+
+    // return the map of the definitions that reach the location
+    // right after the node 'where'
+    virtual RDMap& getDefinitionsMap(RDNode *where) { return where->def_map; }
+
     // return the reaching definitions of ('mem', 'off', 'len')
     // at the location 'where'
     virtual std::vector<RDNode *>
@@ -260,9 +353,59 @@ public:
     virtual std::vector<RDNode *> getReachingDefinitions(RDNode *use);
 };
 
+// The data-flow reaching definitions analysis that keeps the maps
+// of definitions only at the entry and the exit of basic blocks.
+// Each block is summarized by the definitions made in the block
+// that reach its end and by the strong updates in the block.
+// The map at a node is computed from the entry map of its block
+// only when it is queried.
+class BlockReachingDefinitionsAnalysis : public ReachingDefinitionsAnalysis {
+    struct BlockInfo {
+        RDMap in;
+        RDMap out;
+        // the definitions overwritten in the block
+        DefSiteSetT kill;
+    };
+
+    std::unordered_map<const RDBBlock *, BlockInfo> _blocks;
+
+    // the map after the last queried node (and the position
+    // of the node in its block), so that the queries of nodes
+    // in the same block do not start from the entry of the block
+    RDMap _current;
+    RDBBlock *_currentBlock{nullptr};
+    RDNode *_currentNode{nullptr};
+    RDBBlock::NodesT::const_iterator _nextNode;
+
+    // apply the definitions of the node to the map
+    void transfer(RDNode *node, RDMap& map);
+    void computeSummary(RDBBlock *block, BlockInfo& info);
+    bool processBlock(RDBBlock *block, BlockInfo& info);
+
+public:
+    BlockReachingDefinitionsAnalysis(ReachingDefinitionsGraph&& graph,
+                                     const ReachingDefinitionsAnalysisOptions& opts)
+    : ReachingDefinitionsAnalysis(std::move(graph), opts) {}
+
+    BlockReachingDefinitionsAnalysis(ReachingDefinitionsGraph&& graph)
+    : ReachingDefinitionsAnalysis(std::move(graph)) {}
+
+    void run() override;
+
+    // NOTE: the returned map is valid only until the next query
+    RDMap& getDefinitionsMap(RDNode *where) override;
+};
+
 class SSAReachingDefinitionsAnalysis : public ReachingDefinitionsAnalysis {
+    using NodesArena = ReachingDefinitionsGraph::NodesArena;
+
+    // LVN processes the blocks in parallel. The phi nodes created for
+    // a block are stored to 'phis' and are added to the graph (and to
+    // the block) when all blocks are processed, in the order of blocks,
+    // so the IDs of the nodes do not depend on the number of threads.
     void performLvn();
-    void performLvn(RDBBlock *block);
+    void performLvn(RDBBlock *block, NodesArena& arena,
+                    std::vector<RDNode *>& phis);
     void performGvn();
 
     ////
@@ -272,7 +415,9 @@ class SSAReachingDefinitionsAnalysis : public ReachingDefinitionsAnalysis {
     // Find definitions of the def site and return def-use edges.
     // For the (possibly) uncovered bytes create phi nodes (which are also returned
     // as the definitions) in _this very block_. It is important for LVN.
-    std::vector<RDNode *> findDefinitionsInBlock(RDBBlock *, const DefSite&);
+    std::vector<RDNode *> findDefinitionsInBlock(RDBBlock *, const DefSite&,
+                                                 NodesArena& arena,
+                                                 std::vector<RDNode *>& phis);
 
     ////
     // GVN
@@ -285,13 +430,38 @@ class SSAReachingDefinitionsAnalysis : public ReachingDefinitionsAnalysis {
     /// Finding definitions for unknown memory
     // Must be called after LVN proceeded - ideally only when the client is getting the definitions
     std::vector<RDNode *> findAllReachingDefinitions(RDNode *from);
-    void findAllReachingDefinitions(DefinitionsMap<RDNode>& defs, RDBBlock *from,
-                                    std::set<RDNode *>& nodes,
-                                    std::set<RDBBlock *>& visitedBlocks);
+    // search the predecessors of 'from' for the definitions
+    // of the memory that is not defined in 'defs'
+    void findAllReachingDefinitions(RDDefinitionsMap&& defs, RDBBlock *from,
+                                    std::set<RDNode *>& nodes);
+
+    // replace the phi nodes by the non-phi definitions that reach them
+    template <typename ContT>
+    std::vector<RDNode *> gatherNonPhisDefs(const ContT& nodes);
+    const std::vector<RDNode *>& getNonPhisDefs(RDNode *phi);
 
     // all phi nodes added during transformation to SSA
     std::vector<RDNode *> _phis;
 
+    // The definitions found by GVN for a def-site in a block.
+    // The definitions in a block change only by adding phi nodes
+    // for the uncovered bytes, so the found definitions stay valid.
+    using DefSiteKeyT = std::tuple<const RDBBlock *, const RDNode *,
+                                   Offset::type, Offset::type>;
+    std::map<DefSiteKeyT, std::vector<RDNode *>> _definitionsCache;
+    // the non-phi definitions that reach a phi node
+    std::unordered_map<const RDNode *, std::vector<RDNode *>> _phiDefsCache;
+    // the definitions that reach a use of unknown memory
+    std::unordered_map<const RDNode *, std::vector<RDNode *>> _unknownUsesCache;
+
+    // the numbers of lookups and hits of the caches (for debugging)
+    size_t _definitionsLookups{0};
+    size_t _definitionsHits{0};
+    size_t _phiDefsLookups{0};
+    size_t _phiDefsHits{0};
+    size_t _unknownUsesLookups{0};
+    size_t _unknownUsesHits{0};
+
 public:
     SSAReachingDefinitionsAnalysis(ReachingDefinitionsGraph&& graph,
                                    const ReachingDefinitionsAnalysisOptions& opts)
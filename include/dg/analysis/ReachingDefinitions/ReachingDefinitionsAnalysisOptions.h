@@ -103,6 +103,10 @@ struct ReachingDefinitionsAnalysisOptions : AnalysisOptions {
     // or just objects?
     bool fieldInsensitive{false};
 
+    // The number of threads of the local value numbering
+    // in the SSA analysis (0 means the number of hardware threads).
+    unsigned lvnThreads{0};
+
     ReachingDefinitionsAnalysisOptions& setStrongUpdateUnknown(bool b) {
         strongUpdateUnknown = b; return *this;
     }
@@ -119,6 +123,10 @@ struct ReachingDefinitionsAnalysisOptions : AnalysisOptions {
         fieldInsensitive = b; return *this;
     }
 
+    ReachingDefinitionsAnalysisOptions& setLvnThreads(unsigned n) {
+        lvnThreads = n; return *this;
+    }
+
     std::map<const std::string, FunctionModel> functionModels;
 
     const FunctionModel *getFunctionModel(const std::string& name) const {
@@ -8,15 +8,168 @@
 #include <iostream>
 #endif // not NDEBUG
 
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <algorithm>
 
+#include "dg/ADT/Arena.h"
+
 namespace dg {
 namespace analysis {
 
 namespace pta { class PSNode; }
 namespace rd { class RDNode; }
 
+///
+// A read-only view of the edges of a node.
+template <typename NodeT>
+class EdgesRange {
+    NodeT * const *_begin{nullptr};
+    NodeT * const *_end{nullptr};
+
+public:
+    using value_type = NodeT *;
+    using const_iterator = NodeT * const *;
+    using iterator = const_iterator;
+
+    EdgesRange() = default;
+    EdgesRange(const_iterator b, const_iterator e) : _begin(b), _end(e) {}
+    template <typename Alloc>
+    EdgesRange(const std::vector<NodeT *, Alloc>& v)
+    : _begin(v.data()), _end(v.data() + v.size()) {}
+
+    const_iterator begin() const { return _begin; }
+    const_iterator end() const { return _end; }
+    size_t size() const { return _end - _begin; }
+    bool empty() const { return _begin == _end; }
+
+    NodeT *operator[](size_t idx) const {
+        assert(idx < size() && "Index out of range");
+        return _begin[idx];
+    }
+
+    NodeT *front() const { assert(!empty()); return *_begin; }
+    NodeT *back() const { assert(!empty()); return *(_end - 1); }
+
+    // copy the edges (e.g., if the caller wants to modify them)
+    operator std::vector<NodeT *>() const {
+        return std::vector<NodeT *>(_begin, _end);
+    }
+};
+
+///
+// The edges of nodes of a graph packed into arrays indexed
+// by the IDs of the nodes (compressed sparse row format).
+// A graph freezes its edges once it is built, so that
+// the analyses iterate over continuous memory instead of
+// four vectors in every node. A frozen node that changes
+// its edges copies them back to its own vectors
+// (the other nodes stay frozen).
+template <typename NodeT>
+class FrozenEdges {
+public:
+    enum Kind { SUCCESSORS = 0, PREDECESSORS, OPERANDS, USERS, KINDS_NUM };
+
+private:
+    // the edges of kind 'k' of the node with ID 'id' are
+    // _edges[k][_offsets[k][id]] ... _edges[k][_offsets[k][id + 1] - 1]
+    std::vector<unsigned> _offsets[KINDS_NUM];
+    std::vector<NodeT *> _edges[KINDS_NUM];
+
+    static EdgesRange<NodeT> getEdges(const NodeT *n, Kind k) {
+        switch (k) {
+            case SUCCESSORS: return n->getSuccessors();
+            case PREDECESSORS: return n->getPredecessors();
+            case OPERANDS: return n->getOperands();
+            case USERS: return n->getUsers();
+            default: break;
+        }
+
+        assert(false && "Invalid kind of edges");
+        abort();
+    }
+
+public:
+    // pack the edges of the given nodes,
+    // the IDs of the nodes must be less than 'idsNum'
+    FrozenEdges(const std::vector<NodeT *>& nodes, size_t idsNum) {
+        for (int k = 0; k < KINDS_NUM; ++k) {
+            auto& offsets = _offsets[k];
+            auto& edges = _edges[k];
+            offsets.resize(idsNum + 1, 0);
+
+            for (NodeT *n : nodes) {
+                assert(n->getID() < idsNum && "Invalid ID of a node");
+                offsets[n->getID() + 1] = getEdges(n, static_cast<Kind>(k)).size();
+            }
+
+            for (size_t i = 1; i <= idsNum; ++i)
+                offsets[i] += offsets[i - 1];
+
+            edges.resize(offsets[idsNum]);
+            for (NodeT *n : nodes) {
+                auto E = getEdges(n, static_cast<Kind>(k));
+                std::copy(E.begin(), E.end(), edges.begin() + offsets[n->getID()]);
+            }
+        }
+    }
+
+    FrozenEdges(const FrozenEdges&) = delete;
+    FrozenEdges& operator=(const FrozenEdges&) = delete;
+
+    EdgesRange<NodeT> get(Kind k, unsigned id) const {
+        assert(id + 1 < _offsets[k].size() && "The node is not frozen");
+        const auto& edges = _edges[k];
+        return EdgesRange<NodeT>(edges.data() + _offsets[k][id],
+                                 edges.data() + _offsets[k][id + 1]);
+    }
+
+    // make the nodes use the packed edges and release their own edges
+    void freeze(const std::vector<NodeT *>& nodes) const {
+        for (NodeT *n : nodes)
+            n->_freeze(this);
+    }
+
+    // copy the edges back to the nodes, after this the packed
+    // edges are not used by any node and can be destroyed
+    static void thaw(const std::vector<NodeT *>& nodes) {
+        for (NodeT *n : nodes)
+            n->_thaw();
+    }
+};
+
+///
+// A hash table that is allocated only when needed
+// (and that is copied together with its owner).
+template <typename TableT>
+class LazyTable {
+    std::unique_ptr<TableT> _table;
+
+public:
+    LazyTable() = default;
+    LazyTable(LazyTable&&) = default;
+    LazyTable(const LazyTable& o)
+    : _table(o._table ? new TableT(*o._table) : nullptr) {}
+
+    LazyTable& operator=(LazyTable&&) = default;
+    LazyTable& operator=(const LazyTable& o) {
+        _table.reset(o._table ? new TableT(*o._table) : nullptr);
+        return *this;
+    }
+
+    void create() { _table.reset(new TableT()); }
+    void reset() { _table.reset(); }
+
+    explicit operator bool() const { return _table != nullptr; }
+    TableT *operator->() const { return _table.get(); }
+    TableT& operator*() const { return *_table; }
+};
+
 template <typename NodeT>
 class SubgraphNode {
     // id of the node. Every node from a graph has a unique ID;
@@ -35,8 +188,28 @@ class SubgraphNode {
     // than one pointer, we can change this design.
     void *user_data{nullptr};
 
+    // the packed edges of the graph if the node is frozen,
+    // then the vectors with edges below are empty
+    const FrozenEdges<NodeT> *_frozen{nullptr};
+
+    friend class FrozenEdges<NodeT>;
+
+    // The nodes with many operands (users) keep them also in a hash table,
+    // so that checking for duplicates does not scan the whole vector
+    // (e.g., the formal arguments of functions called from thousands
+    // of call sites get an operand from every call site).
+    // The operands are counted, since a node may have an operand
+    // multiple times. The tables are built once the vectors
+    // are longer than HASHED_EDGES_THRESHOLD.
+    static const size_t HASHED_EDGES_THRESHOLD = 16;
+    LazyTable<std::unordered_map<NodeT *, unsigned>> _operandsCount;
+    LazyTable<std::unordered_set<NodeT *>> _usersSet;
+
 public:
-    using NodesVec = std::vector<NodeT *>;
+    // the edges may be allocated in an arena (see setEdgesArena())
+    using NodesVec = std::vector<NodeT *, ADT::ArenaAllocator<NodeT *>>;
+    using EdgesT = EdgesRange<NodeT>;
+    using FrozenEdgesT = FrozenEdges<NodeT>;
 
 protected:
     // XXX: make those private!
@@ -50,6 +223,10 @@ protected:
     // size of the memory
     size_t size{0};
 
+    // for the nodes that are created outside of a graph
+    // and get their ID when the graph takes them
+    void setID(unsigned int i) { id = i; }
+
 public:
     // FIXME: get rid of these things
     unsigned int dfs_id{0};
@@ -71,6 +248,19 @@ public:
 
     unsigned int getID() const { return id; }
 
+    // Allocate the edges of this node in the arena (e.g., in the arena
+    // of the graph that owns the node, then the edges are released
+    // together with the graph). Call it before the node gets
+    // the edges to other nodes, except for the edges from the constructor.
+    void setEdgesArena(ADT::Arena *arena) {
+        assert(!_frozen && "Setting the arena of a frozen node");
+        ADT::ArenaAllocator<NodeT *> alloc(arena);
+        for (NodesVec *vec : {&successors, &predecessors, &operands, &users}) {
+            NodesVec tmp(vec->begin(), vec->end(), alloc);
+            vec->swap(tmp);
+        }
+    }
+
     void setSize(size_t s) { size = s; }
     size_t getSize() const { return size; }
     unsigned getSCCId() const { return scc_id; }
@@ -102,33 +292,50 @@ public:
     }
 
     NodeT *getOperand(int idx) const {
-        assert(idx >= 0 && static_cast<size_t>(idx) < operands.size()
+        assert(idx >= 0 && static_cast<size_t>(idx) < getOperandsNum()
                && "Operand index out of range");
 
-        return operands[idx];
+        return getOperands()[idx];
     }
 
     void setOperand(int idx, NodeT *nd) {
+        _thaw();
         assert(idx >= 0 && static_cast<size_t>(idx) < operands.size()
                && "Operand index out of range");
 
+        if (_operandsCount) {
+            auto it = _operandsCount->find(operands[idx]);
+            assert(it != _operandsCount->end() && "Operand is not counted");
+            if (--it->second == 0)
+                _operandsCount->erase(it);
+            ++(*_operandsCount)[nd];
+        }
+
         operands[idx] = nd;
     }
 
     size_t getOperandsNum() const {
-        return operands.size();
+        return getOperands().size();
     }
 
     void removeAllOperands() {
+        _thaw();
         for (auto o : operands) {
             o->removeUser(static_cast<NodeT *>(this));
         }
         operands.clear();
+        _operandsCount.reset();
     }
 
     size_t addOperand(NodeT *n) {
         assert(n && "Passed nullptr as the operand");
+        _thaw();
         operands.push_back(n);
+        if (_operandsCount)
+            ++(*_operandsCount)[n];
+        else if (operands.size() > HASHED_EDGES_THRESHOLD)
+            _hashOperands();
+
         n->addUser(static_cast<NodeT *>(this));
         assert(n->users.size() > 0);
 
@@ -136,7 +343,10 @@ public:
     }
 
     bool hasOperand(NodeT *n) const {
-        for (NodeT *x : operands) {
+        if (_operandsCount)
+            return _operandsCount->count(n) > 0;
+
+        for (NodeT *x : getOperands()) {
             if (x == n) {
                 return true;
             }
@@ -147,16 +357,32 @@ public:
 
     void addSuccessor(NodeT *succ) {
         assert(succ && "Passed nullptr as the successor");
+        _thaw();
+        succ->_thaw();
         successors.push_back(succ);
         succ->predecessors.push_back(static_cast<NodeT *>(this));
     }
 
     // return const only, so that we cannot change them
     // other way then addSuccessor()
-    const NodesVec& getSuccessors() const { return successors; }
-    const NodesVec& getPredecessors() const { return predecessors; }
-    const NodesVec& getOperands() const { return operands; }
-    const NodesVec& getUsers() const { return users; }
+    EdgesT getSuccessors() const {
+        return _frozen ? _frozen->get(FrozenEdgesT::SUCCESSORS, id)
+                       : EdgesT(successors);
+    }
+    EdgesT getPredecessors() const {
+        return _frozen ? _frozen->get(FrozenEdgesT::PREDECESSORS, id)
+                       : EdgesT(predecessors);
+    }
+    EdgesT getOperands() const {
+        return _frozen ? _frozen->get(FrozenEdgesT::OPERANDS, id)
+                       : EdgesT(operands);
+    }
+    EdgesT getUsers() const {
+        return _frozen ? _frozen->get(FrozenEdgesT::USERS, id)
+                       : EdgesT(users);
+    }
+
+    bool isFrozen() const { return _frozen != nullptr; }
 
     void replaceSingleSuccessor(NodeT *succ) {
         assert(succ && "Passed nullptr as the successor");
@@ -165,6 +391,7 @@ public:
     }
 
     void removeSingleSuccessor() {
+        _thaw();
         assert(successors.size() == 1);
 
         // we need to remove this node from
@@ -178,30 +405,32 @@ public:
 
     // get the successor when we know there's only one of them
     NodeT *getSingleSuccessor() const {
-        assert(successors.size() == 1);
-        return successors.front();
+        assert(successorsNum() == 1);
+        return getSuccessors().front();
     }
 
     // get the successor when there's only one of them,
     // otherwise get null
     NodeT *getSingleSuccessorOrNull() const {
-        if (successors.size() == 1)
-            return successors.front();
+        auto succs = getSuccessors();
+        if (succs.size() == 1)
+            return succs.front();
 
         return nullptr;
     }
 
     // get the predecessor when we know there's only one of them
     NodeT *getSinglePredecessor() const {
-        assert(predecessors.size() == 1);
-        return predecessors.front();
+        assert(predecessorsNum() == 1);
+        return getPredecessors().front();
     }
 
     // get the predecessor when there's only one of them,
     // or get null
     NodeT *getSinglePredecessorOrNull() const {
-        if (predecessors.size() == 1)
-            return predecessors.front();
+        auto preds = getPredecessors();
+        if (preds.size() == 1)
+            return preds.front();
 
         return nullptr;
     }
@@ -212,6 +441,8 @@ public:
         assert(n && "Passed nullptr as the node");
         assert(predecessorsNum() == 0);
         assert(successorsNum() == 0);
+        _thaw();
+        n->_thaw();
 
         // take over successors
         successors.swap(n->successors);
@@ -221,6 +452,7 @@ public:
 
         // replace the reference to n in successors
         for (NodeT *succ : successors) {
+            succ->_thaw();
             for (unsigned i = 0; i < succ->predecessorsNum(); ++i) {
                 if (succ->predecessors[i] == n)
                     succ->predecessors[i] = static_cast<NodeT *>(this);
@@ -234,6 +466,8 @@ public:
         assert(n && "Passed nullptr as the node");
         assert(predecessorsNum() == 0);
         assert(successorsNum() == 0);
+        _thaw();
+        n->_thaw();
 
         // take over predecessors
         predecessors.swap(n->predecessors);
@@ -243,6 +477,7 @@ public:
 
         // replace the reference to n in predecessors
         for (NodeT *pred : predecessors) {
+            pred->_thaw();
             for (unsigned i = 0; i < pred->successorsNum(); ++i) {
                 if (pred->successors[i] == n)
                     pred->successors[i] = static_cast<NodeT *>(this);
@@ -256,6 +491,8 @@ public:
         // the sequence must not be inserted in any PointerGraph
         assert(seq.first->predecessorsNum() == 0);
         assert(seq.second->successorsNum() == 0);
+        _thaw();
+        seq.first->_thaw();
 
         // first node of the sequence takes over predecessors
         // this also clears 'this->predecessors' since seq.first
@@ -264,6 +501,7 @@ public:
 
         // replace the reference to 'this' in predecessors
         for (NodeT *pred : seq.first->predecessors) {
+            pred->_thaw();
             for (unsigned i = 0; i < pred->successorsNum(); ++i) {
                 if (pred->successors[i] == this)
                     pred->successors[i] = seq.first;
@@ -275,9 +513,12 @@ public:
     }
 
     void isolate() {
+        _thaw();
+
         // Remove this node from successors of the predecessors
         for (NodeT *pred : predecessors) {
-            std::vector<NodeT *> new_succs;
+            pred->_thaw();
+            NodesVec new_succs(pred->successors.get_allocator());
             new_succs.reserve(pred->successors.size());
 
             for (NodeT *n : pred->successors) {
@@ -290,7 +531,8 @@ public:
 
         // remove this nodes from successors' predecessors
         for (NodeT *succ : successors) {
-            std::vector<NodeT *> new_preds;
+            succ->_thaw();
+            NodesVec new_preds(succ->predecessors.get_allocator());
             new_preds.reserve(succ->predecessors.size());
 
             for (NodeT *n : succ->predecessors) {
@@ -313,8 +555,42 @@ public:
         predecessors.clear();
     }
 
+    // remove all edges of this node (the CFG edges, the operands
+    // and the uses of this node), e.g., before removing the node
+    // from the graph. Unlike isolate(), the predecessors are not
+    // connected to the successors.
+    void disconnect() {
+        _thaw();
+
+        for (NodeT *pred : NodesVec(predecessors)) {
+            pred->_thaw();
+            auto& succs = pred->successors;
+            succs.erase(std::remove(succs.begin(), succs.end(), this),
+                        succs.end());
+        }
+
+        for (NodeT *succ : NodesVec(successors))
+            _removeThisFromSuccessorsPredecessors(succ);
+
+        removeAllOperands();
+
+        for (NodeT *user : NodesVec(users)) {
+            user->_thaw();
+            auto& ops = user->operands;
+            ops.erase(std::remove(ops.begin(), ops.end(), this), ops.end());
+            if (user->_operandsCount)
+                user->_operandsCount->erase(static_cast<NodeT *>(this));
+        }
+
+        successors.clear();
+        predecessors.clear();
+        users.clear();
+        _usersSet.reset();
+    }
+
     void replaceAllUsesWith(NodeT *nd, bool removeDupl = false) {
         assert(nd != this && "Replacing uses of 'this' with 'this'");
+        _thaw();
 
         // Replace 'this' in every user with 'nd'.
         for (NodeT *user : users) {
@@ -331,14 +607,15 @@ public:
         }
 
         users.clear();
+        _usersSet.reset();
     }
 
     size_t predecessorsNum() const {
-        return predecessors.size();
+        return getPredecessors().size();
     }
 
     size_t successorsNum() const {
-        return successors.size();
+        return getSuccessors().size();
     }
 
 #ifndef NDEBUG
@@ -358,8 +635,38 @@ public:
 
 private:
 
+    void _freeze(const FrozenEdgesT *edges) {
+        assert(edges->get(FrozenEdgesT::SUCCESSORS, id).size()
+               == getSuccessors().size() && "Packed wrong edges");
+        _frozen = edges;
+        // release the memory of the vectors
+        for (NodesVec *vec : {&successors, &predecessors, &operands, &users}) {
+            vec->clear();
+            vec->shrink_to_fit();
+        }
+    }
+
+    // copy the edges from the frozen graph back to the vectors
+    // of this node, so that they can be changed
+    void _thaw() {
+        if (!_frozen)
+            return;
+
+        auto thawEdges = [this](NodesVec& vec, typename FrozenEdgesT::Kind k) {
+            auto E = _frozen->get(k, id);
+            vec.assign(E.begin(), E.end());
+        };
+
+        thawEdges(successors, FrozenEdgesT::SUCCESSORS);
+        thawEdges(predecessors, FrozenEdgesT::PREDECESSORS);
+        thawEdges(operands, FrozenEdgesT::OPERANDS);
+        thawEdges(users, FrozenEdgesT::USERS);
+        _frozen = nullptr;
+    }
+
     void _removeThisFromSuccessorsPredecessors(NodeT *succ) {
-        std::vector<NodeT *> tmp;
+        succ->_thaw();
+        NodesVec tmp(succ->predecessors.get_allocator());
         tmp.reserve(succ->predecessorsNum());
         for (NodeT *p : succ->predecessors) {
             if (p != this)
@@ -370,6 +677,7 @@ private:
     }
 
     bool removeDuplicitOperands() {
+        _thaw();
         std::set<NodeT *> ops;
         bool duplicated = false;
         for (auto op : getOperands()) {
@@ -385,24 +693,47 @@ private:
             // (as we just remove the duplicated ones)
             for (auto op : ops)
                 operands.push_back(op);
+
+            if (_operandsCount)
+                _hashOperands();
         }
 
         return duplicated;
     }
 
+    void _hashOperands() {
+        _operandsCount.create();
+        for (NodeT *op : operands)
+            ++(*_operandsCount)[op];
+    }
+
     void addUser(NodeT *nd) {
+        _thaw();
         // do not add duplicate users
-        for (auto u : users)
-            if (u == nd)
+        if (_usersSet) {
+            if (!_usersSet->insert(nd).second)
                 return;
+        } else {
+            for (auto u : users)
+                if (u == nd)
+                    return;
+        }
 
         users.push_back(nd);
+        if (!_usersSet && users.size() > HASHED_EDGES_THRESHOLD) {
+            _usersSet.create();
+            _usersSet->insert(users.begin(), users.end());
+        }
     }
 
     void removeUser(NodeT *node) {
+        _thaw();
         using std::find;
         NodesVec &u = users;
 
+        if (_usersSet && _usersSet->erase(node) == 0)
+            return;
+
         auto nodeToRemove = find(u.begin(), u.end(), node);
         if (nodeToRemove != u.end()) {
             u.erase(nodeToRemove);
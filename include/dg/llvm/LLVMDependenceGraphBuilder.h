@@ -31,6 +31,7 @@
 #include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFS.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFSInv.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/analysis/Offset.h"
 
@@ -100,6 +101,8 @@ class LLVMDependenceGraphBuilder {
             _PTA->run<analysis::pta::PointerAnalysisFI>();
         else if (_options.PTAOptions.isFSInv())
             _PTA->run<analysis::pta::PointerAnalysisFSInv>();
+        else if (_options.PTAOptions.isSFS())
+            _PTA->run<analysis::pta::PointerAnalysisSFS>();
         else {
             assert(0 && "Wrong pointer analysis");
             abort();
@@ -115,6 +118,8 @@ class LLVMDependenceGraphBuilder {
 
         if (_options.RDAOptions.isDataFlow()) {
             _RD->run<dg::analysis::rd::ReachingDefinitionsAnalysis>();
+        } else if (_options.RDAOptions.isBlockDataFlow()) {
+            _RD->run<dg::analysis::rd::BlockReachingDefinitionsAnalysis>();
         } else if (_options.RDAOptions.isSSA()) {
             _RD->run<dg::analysis::rd::SSAReachingDefinitionsAnalysis>();
         } else {
@@ -1,6 +1,9 @@
 #ifndef _DG_LLVM_POINTER_ANALYSIS_OPTIONS_H_
 #define _DG_LLVM_POINTER_ANALYSIS_OPTIONS_H_
 
+#include <set>
+#include <string>
+
 #include "dg/llvm/analysis/LLVMAnalysisOptions.h"
 #include "dg/analysis/PointsTo/PointerAnalysisOptions.h"
 
@@ -9,12 +12,51 @@ namespace analysis {
 
 struct LLVMPointerAnalysisOptions : public LLVMAnalysisOptions, PointerAnalysisOptions
 {
-    enum class AnalysisType { fi, fs, inv } analysisType{AnalysisType::fi};
+    enum class AnalysisType { fi, fs, inv, sfs } analysisType{AnalysisType::fi};
 
     bool threads;
+
+    // The directory where the results of the analysis are cached
+    // between runs (see LLVMPointerAnalysisCache). Empty means
+    // no caching.
+    std::string cacheDir;
+
+    // Keep the analysis after run(), so that the results can be updated
+    // after some functions of the module were changed
+    // (see LLVMPointerAnalysis::update())
+    bool incremental{false};
+
+    // Analyze the small non-recursive functions bottom-up and instantiate
+    // their summaries at the call sites instead of connecting the calls
+    // to one shared subgraph. The pointers in these functions are then
+    // computed separately for each call site. Only with the flow-insensitive
+    // analysis that is not demand-driven (see Summaries.cpp).
+    bool functionSummaries{false};
+    // the maximal number of nodes of a summarized function
+    unsigned summaryMaxNodes{32};
+
+    // Heap cloning. The allocator wrappers are summarized (see above)
+    // and their instances get their own copies of the allocations,
+    // so the memory allocated via a wrapper at different call sites
+    // is not merged. The value is the number of call sites (k)
+    // that distinguish the copies, 0 turns the cloning off.
+    // The wrappers are the defined functions that are listed
+    // in allocationFunctions or in allocationWrappers and the small
+    // functions that return a pointer and allocate memory on heap.
+    unsigned heapCloning{0};
+    std::set<std::string> allocationWrappers;
+
+    // Reduce the built graph before running the analysis: remove the noops,
+    // merge the casts and the other nodes with equivalent points-to sets
+    // and remove the loads and stores of integers (see Optimizations.cpp).
+    // The points-to sets of the removed values are taken from the equivalent
+    // nodes. Not done in the incremental mode.
+    bool optimizeGraph{true};
+
     bool isFS() const { return analysisType == AnalysisType::fs; }
     bool isFSInv() const { return analysisType == AnalysisType::inv; }
     bool isFI() const { return analysisType == AnalysisType::fi; }
+    bool isSFS() const { return analysisType == AnalysisType::sfs; }
 };
 
 } // namespace analysis
@@ -29,10 +29,18 @@
 #include "dg/llvm/analysis/PointsTo/LLVMPointerAnalysisOptions.h"
 #include "dg/llvm/analysis/PointsTo/PointerGraph.h"
 #include "dg/llvm/analysis/PointsTo/LLVMPointsToSet.h"
+#include "dg/llvm/analysis/PointsTo/PointerAnalysisCache.h"
 
 
 namespace dg {
 
+namespace analysis {
+namespace pta {
+class PointerAnalysisFI;
+class PointerAnalysisSFS;
+} // namespace pta
+} // namespace analysis
+
 using analysis::LLVMPointerAnalysisOptions;
 using analysis::pta::PointerGraph;
 using analysis::pta::PSNode;
@@ -45,10 +53,36 @@ class LLVMPointerAnalysisImpl : public PTType
 {
     LLVMPointerGraphBuilder *builder;
 
+    using ChangeKind = LLVMPointerGraphBuilder::AdHocChange::Kind;
+
 public:
     LLVMPointerAnalysisImpl(PointerGraph *PS, LLVMPointerGraphBuilder *b)
     : PTType(PS), builder(b) {}
 
+    LLVMPointerAnalysisImpl(PointerGraph *PS, LLVMPointerGraphBuilder *b,
+                            const LLVMPointerAnalysisOptions& opts)
+    : PTType(PS, getSolverOptions(b, opts)), builder(b) {}
+
+    // The instances of function summaries are not on the CFG paths
+    // to the uses of their values. The iterative solver reprocesses only
+    // the nodes that are reachable from the changed nodes in the CFG,
+    // so solve such graph by the difference propagation that follows the uses.
+    static LLVMPointerAnalysisOptions
+    getSolverOptions(const LLVMPointerGraphBuilder *b,
+                     const LLVMPointerAnalysisOptions& opts) {
+        LLVMPointerAnalysisOptions ret = opts;
+        if (b->getNumOfSummarizedFunctions() > 0 &&
+            !ret.isDiffPropagation() && !ret.isParallel())
+            ret.solverType = LLVMPointerAnalysisOptions::SolverType::diffprop;
+        return ret;
+    }
+
+    void run() override {
+        PTType::run();
+        // the summarized functions were analyzed in their instances
+        builder->fillSummarizedFunctions();
+    }
+
     // build new subgraphs on calls via pointer
     bool functionPointerCall(PSNode *callsite, PSNode *called) override {
         using namespace analysis::pta;
@@ -62,9 +96,11 @@ public:
         if (F->isDeclaration()) {
             if (builder->threads()) {
                 if (F->getName() == "pthread_create") {
+                    builder->recordAdHocChange(ChangeKind::PTHREAD_CREATE, callsite);
                     builder->insertPthreadCreateByPtrCall(callsite);
                     return true;
                 } else if (F->getName() == "pthread_join") {
+                    builder->recordAdHocChange(ChangeKind::PTHREAD_JOIN, callsite);
                     builder->insertPthreadJoinByPtrCall(callsite);
                     return true;
                 }
@@ -76,6 +112,7 @@ public:
             return false;
         }
 
+        builder->recordAdHocChange(ChangeKind::CALL, callsite, called);
         builder->insertFunctionCall(callsite, called);
 
         // call the original handler that works on generic graphs
@@ -103,6 +140,7 @@ public:
                 && "The called value is not a function");
 
         PSNodeFork *fork = PSNodeFork::get(forkNode);
+        builder->recordAdHocChange(ChangeKind::FORK_FUNCTION, forkNode, called);
         builder->addFunctionToFork(called, fork);
 
 #ifndef NDEBUG
@@ -128,8 +166,21 @@ public:
 
 class LLVMPointerAnalysis
 {
+    using Cache = analysis::pta::LLVMPointerAnalysisCache;
+
+    const llvm::Module *_module;
     PointerGraph *PS = nullptr;
     std::unique_ptr<LLVMPointerGraphBuilder> _builder;
+    LLVMPointerAnalysisOptions _options;
+
+    std::unique_ptr<Cache> _cache;
+    bool _fromCache{false};
+
+    // the analysis that computed the results and its name
+    // (see getCacheName()), kept with the incremental option
+    // and with the demand-driven analysis
+    std::unique_ptr<analysis::pta::PointerAnalysis> _pta;
+    const char *_ptaName{nullptr};
 
     LLVMPointerAnalysisOptions createOptions(const char *entry_func,
                                              uint64_t field_sensitivity,
@@ -148,6 +199,55 @@ class LLVMPointerAnalysis
         return _unknownPTSet;
     }
 
+    // the names of analyses under which their results are cached
+    static const char *getCacheName(const analysis::pta::PointerAnalysisFI *) { return "fi"; }
+    static const char *getCacheName(const analysis::pta::PointerAnalysisFS *) { return "fs"; }
+    static const char *getCacheName(const analysis::pta::PointerAnalysisFSInv *) { return "inv"; }
+    static const char *getCacheName(const analysis::pta::PointerAnalysisSFS *) { return "sfs"; }
+
+    // build the pointer graph and fill in the points-to sets
+    // from the cache if the results of the analysis are there
+    template <typename PTType>
+    void buildSubgraphFromCache()
+    {
+        buildSubgraph();
+
+        _fromCache = false;
+        if (_options.cacheDir.empty())
+            return;
+
+        _cache.reset(new Cache(_options,
+                               getCacheName(static_cast<PTType *>(nullptr)),
+                               _module, _builder.get()));
+        auto result = _cache->load(_builder.get());
+        if (result == Cache::LoadResult::LOADED) {
+            _fromCache = true;
+        } else if (result == Cache::LoadResult::GRAPH_CHANGED) {
+            // the graph was changed by the cached changes,
+            // we must start from scratch
+            bool invalidateNodes = _builder->getInvalidateNodesFlag();
+            _builder.reset(new LLVMPointerGraphBuilder(_module, _options));
+            _builder->setInvalidateNodesFlag(invalidateNodes);
+            buildSubgraph();
+        }
+    }
+
+    // build the graph again and run the analysis from scratch
+    template <typename PTType>
+    void rerun()
+    {
+        // the analysis uses the graph of the builder
+        _pta.reset();
+        _ptaName = nullptr;
+
+        bool invalidateNodes = _builder->getInvalidateNodesFlag();
+        _builder.reset(new LLVMPointerGraphBuilder(_module, _options));
+        _builder->setInvalidateNodesFlag(invalidateNodes);
+        run<PTType>();
+    }
+
+    bool updateFI(const std::vector<const llvm::Function *>& changed);
+
 public:
 
     LLVMPointerAnalysis(const llvm::Module *m,
@@ -157,13 +257,18 @@ public:
         : LLVMPointerAnalysis(m, createOptions(entry_func, field_sensitivity, threads)) {}
 
     LLVMPointerAnalysis(const llvm::Module *m, const LLVMPointerAnalysisOptions opts)
-        : _builder(new LLVMPointerGraphBuilder(m, opts)) {}
+        : _module(m), _builder(new LLVMPointerGraphBuilder(m, opts)), _options(opts) {}
 
     ///
     // Get the node from pointer analysis that holds the points-to set.
+    // With the demand-driven analysis, the points-to set is computed
+    // when it is asked for the first time.
     // See: getLLVMPointsTo()
     PSNode *getPointsTo(const llvm::Value *val) const {
-        return _builder->getPointsTo(val);
+        PSNode *node = _builder->getPointsTo(val);
+        if (node && _pta)
+            _pta->demand(node);
+        return node;
     }
 
     inline bool threads() const { return _builder->threads(); }
@@ -217,7 +322,7 @@ public:
         return _builder->findJoin(callInst);
     }
 
-    const std::vector<std::unique_ptr<PSNode>>& getNodes()
+    const PointerGraph::NodesT& getNodes()
     {
         return PS->getNodes();
     }
@@ -226,9 +331,48 @@ public:
         return _builder->getFunctionNodes(F);
     }
 
+    // the number of functions whose summaries were instantiated
+    // at the call sites (see LLVMPointerAnalysisOptions::functionSummaries)
+    unsigned getNumOfSummarizedFunctions() const {
+        return _builder->getNumOfSummarizedFunctions();
+    }
+
+    bool isSummarized(const llvm::Function *F) const {
+        return _builder->isSummarized(F);
+    }
+
+    // the number of copies of allocations made by the heap cloning
+    // (see LLVMPointerAnalysisOptions::heapCloning)
+    unsigned getNumOfClonedAllocations() const {
+        return _builder->getNumOfClonedAllocations();
+    }
+
+    // the number of nodes removed from the built graph
+    // (see LLVMPointerAnalysisOptions::optimizeGraph)
+    unsigned getNumOfRemovedNodes() const {
+        return _builder->getNumOfRemovedNodes();
+    }
+
     PointerGraph *getPS() { return PS; }
     const PointerGraph *getPS() const { return PS; }
 
+    ///
+    // Were the points-to sets loaded from the cache (see
+    // LLVMPointerAnalysisOptions::cacheDir)? In that case,
+    // the analysis created by createPTA() must not be run.
+    bool resultsFromCache() const { return _fromCache; }
+
+    ///
+    // Store the results of the analysis created by createPTA()
+    // into the cache (run() does it itself). Returns false if
+    // there is no cache or the results could not be stored.
+    bool storeCachedResults() const
+    {
+        if (!_cache || _fromCache)
+            return false;
+        return _cache->store(_builder.get());
+    }
+
     void buildSubgraph()
     {
         // run the analysis itself
@@ -240,36 +384,46 @@ public:
             abort();
         }
 
-/*
-        analysis::pta::PointerGraphOptimizer optimizer(PS);
-        optimizer.run();
+        // NOTE: the builder has reduced the graph already
+        // (see LLVMPointerAnalysisOptions::optimizeGraph)
+    }
 
-        if (optimizer.getNumOfRemovedNodes() > 0)
-            _builder->composeMapping(std::move(optimizer.getMapping()));
+    template <typename PTType>
+    void run()
+    {
+        buildSubgraphFromCache<PTType>();
+        if (_fromCache)
+            return;
 
-        llvm::errs() << "PS optimization removed " << optimizer.getNumOfRemovedNodes() << " nodes\n";
+        std::unique_ptr<analysis::pta::PointerAnalysis>
+            PTA(new LLVMPointerAnalysisImpl<PTType>(PS, _builder.get(), _options));
+        PTA->run();
 
-#ifndef NDEBUG
-        analysis::pta::debug::LLVMPointerGraphValidator validator(_builder->getPS());
-        if (validator.validate()) {
-            llvm::errs() << "Pointer Subgraph is broken!\n";
-            llvm::errs() << "This happend after optimizing the graph.";
-            assert(!validator.getErrors().empty());
-            llvm::errs() << validator.getErrors();
-            abort();
-        }
-#endif // NDEBUG
-*/
+        // the demand-driven analysis did not compute everything
+        if (!_options.isDemandDriven())
+            storeCachedResults();
 
+        if (_options.incremental || _options.isDemandDriven()) {
+            _pta = std::move(PTA);
+            _ptaName = getCacheName(static_cast<PTType *>(nullptr));
+        }
     }
 
+    ///
+    // Update the results of run() after the given functions of the module
+    // were changed (the instructions of the functions may have been
+    // added or removed, but not the functions themselves).
+    // With the incremental option and the flow-insensitive analysis
+    // with the diffprop or the parallel solver, only the subgraphs
+    // of the functions are built again and only the points-to sets
+    // that may depend on them are computed again. Otherwise,
+    // the whole analysis runs again. The results are the same
+    // as when running the analysis on the changed module from scratch.
     template <typename PTType>
-    void run()
+    void update(const std::vector<const llvm::Function *>& changed)
     {
-        buildSubgraph();
-
-        LLVMPointerAnalysisImpl<PTType> PTA(PS, _builder.get());
-        PTA.run();
+        (void) changed;
+        rerun<PTType>();
     }
 
     // this method creates PointerAnalysis object and returns it.
@@ -279,8 +433,8 @@ public:
     template <typename PTType>
     analysis::pta::PointerAnalysis *createPTA()
     {
-        buildSubgraph();
-        return new LLVMPointerAnalysisImpl<PTType>(PS, _builder.get());
+        buildSubgraphFromCache<PTType>();
+        return new LLVMPointerAnalysisImpl<PTType>(PS, _builder.get(), _options);
     }
 };
 
@@ -290,21 +444,35 @@ inline void LLVMPointerAnalysis::run<analysis::pta::PointerAnalysisFSInv>()
     // build the subgraph
     assert(_builder && "Incorrectly constructed PTA, missing builder");
     _builder->setInvalidateNodesFlag(true);
-    buildSubgraph();
-
-    LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv> PTA(PS, _builder.get());
-    PTA.run();
+    buildSubgraphFromCache<analysis::pta::PointerAnalysisFSInv>();
+    if (_fromCache)
+        return;
+
+    std::unique_ptr<analysis::pta::PointerAnalysis>
+        PTA(new LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv>(PS, _builder.get(), _options));
+    PTA->run();
+    if (!_options.isDemandDriven())
+        storeCachedResults();
+
+    if (_options.incremental || _options.isDemandDriven()) {
+        _pta = std::move(PTA);
+        _ptaName = getCacheName(static_cast<analysis::pta::PointerAnalysisFSInv *>(nullptr));
+    }
 }
 
+template <>
+void LLVMPointerAnalysis::update<analysis::pta::PointerAnalysisFI>(
+                const std::vector<const llvm::Function *>& changed);
+
 template <>
 inline analysis::pta::PointerAnalysis *LLVMPointerAnalysis::createPTA<analysis::pta::PointerAnalysisFSInv>()
 {
     // build the subgraph
     assert(_builder && "Incorrectly constructed PTA, missing builder");
     _builder->setInvalidateNodesFlag(true);
-    buildSubgraph();
+    buildSubgraphFromCache<analysis::pta::PointerAnalysisFSInv>();
 
-    return new LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv>(PS, _builder.get());
+    return new LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv>(PS, _builder.get(), _options);
 }
 
 } // namespace dg
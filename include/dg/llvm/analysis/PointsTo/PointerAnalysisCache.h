@@ -0,0 +1,122 @@
+#ifndef _DG_LLVM_POINTER_ANALYSIS_CACHE_H_
+#define _DG_LLVM_POINTER_ANALYSIS_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/llvm/analysis/PointsTo/LLVMPointerAnalysisOptions.h"
+#include "dg/llvm/analysis/PointsTo/PointerGraph.h"
+
+namespace llvm {
+class Module;
+class Value;
+}
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+///
+// On-disk cache of the results of pointer analysis.
+//
+// The pointer graph is built from the module deterministically,
+// so the cache does not store the graph itself. It stores the changes
+// of the graph that were made while the analysis was running (calls
+// via function pointers, threads) and the points-to sets of all nodes
+// indexed by the IDs of nodes. Loading the results means building
+// the graph again, replaying the changes and filling in the points-to
+// sets. The mapping of LLVM values to nodes is created by the builder
+// as usual.
+//
+// The file is a flat binary image (native byte order), it is mapped
+// into memory and used without any parsing:
+//
+//   Header
+//   AdHocChange changes[changesNum]       (padded to 8 bytes)
+//   uint64_t offsets[nodesNum + 1]        (into the pointers array)
+//   StoredPointer pointers[pointersNum]
+//
+// The file is named by the hash of the module and the hash of the options
+// of the analysis. The results are used only if also the fingerprint
+// (the types of nodes and the LLVM values that they represent) of the built
+// graph and of the graph after replaying the changes match.
+class LLVMPointerAnalysisCache {
+public:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        // the number of nodes of the graph before the analysis
+        // and after the analysis (the highest ID + 1)
+        uint32_t initialNodesNum;
+        uint32_t nodesNum;
+        uint32_t changesNum;
+        uint64_t moduleHash;
+        uint64_t optionsHash;
+        uint64_t initialGraphHash;
+        uint64_t graphHash;
+        uint64_t pointersNum;
+        // the hash of the rest of the file (a corrupted file
+        // could have valid, but wrong points-to sets)
+        uint64_t dataHash;
+    };
+
+    struct StoredPointer {
+        // the ID of the target or one of the IDs of static nodes below
+        uint32_t target;
+        uint32_t reserved;
+        uint64_t offset;
+    };
+
+    static const uint32_t VERSION = 2;
+
+    static const uint32_t NULLPTR_ID = ~static_cast<uint32_t>(0);
+    static const uint32_t UNKNOWN_MEMORY_ID = NULLPTR_ID - 1;
+    static const uint32_t INVALIDATED_ID = NULLPTR_ID - 2;
+
+    enum class LoadResult {
+        // there are no usable results in the cache,
+        // the graph did not change
+        NOT_FOUND,
+        LOADED,
+        // the results do not fit to the graph, but the graph was
+        // already changed while replaying the changes, so it must
+        // be built again
+        GRAPH_CHANGED
+    };
+
+    // The graph of the builder must be built (and not changed
+    // by the analysis yet). 'analysis' identifies the analysis
+    // whose results are cached.
+    LLVMPointerAnalysisCache(const LLVMPointerAnalysisOptions& opts,
+                             const std::string& analysis,
+                             const llvm::Module *M,
+                             const LLVMPointerGraphBuilder *builder);
+
+    LoadResult load(LLVMPointerGraphBuilder *builder);
+
+    // store the results of the analysis that run on the graph of the builder
+    bool store(const LLVMPointerGraphBuilder *builder) const;
+
+    const std::string& getPath() const { return _path; }
+
+private:
+    std::string _path;
+    uint64_t _moduleHash;
+    uint64_t _optionsHash;
+    uint64_t _initialGraphHash;
+    uint32_t _initialNodesNum;
+
+    // LLVM values numbered in the order in which they are in the module
+    std::unordered_map<const llvm::Value *, uint32_t> _valueIds;
+
+    void numberValues(const llvm::Module *M);
+    uint64_t hashGraph(const std::vector<PSNode *>& nodesById) const;
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_LLVM_POINTER_ANALYSIS_CACHE_H_
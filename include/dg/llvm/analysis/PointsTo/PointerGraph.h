@@ -1,7 +1,10 @@
 #ifndef _LLVM_DG_POINTER_SUBGRAPH_H_
 #define _LLVM_DG_POINTER_SUBGRAPH_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <unordered_map>
+#include <unordered_set>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -29,6 +32,7 @@
 
 #include "dg/analysis/PointsTo/PointerGraph.h"
 #include "dg/analysis/PointsTo/PointsToMapping.h"
+#include "dg/analysis/PointsTo/PointerGraphOptimizations.h"
 #include "dg/analysis/PointsTo/Pointer.h"
 
 
@@ -74,8 +78,12 @@ class LLVMPointerGraphBuilder
         }
 
         void setRepresentant(PSNode *r) { _repr = r; }
-        PSNode *getRepresentant() { return _repr ? _repr : _nodes.back(); }
-        const PSNode *getRepresentant() const { return _repr ? _repr : _nodes.back(); }
+        PSNode *getRepresentant() {
+            return _repr ? _repr : (_nodes.empty() ? nullptr : _nodes.back());
+        }
+        const PSNode *getRepresentant() const {
+            return _repr ? _repr : (_nodes.empty() ? nullptr : _nodes.back());
+        }
 
         PSNode *getSingleNode() { assert(_nodes.size() == 1); return _nodes.front(); }
         const PSNode *getSingleNode() const { assert(_nodes.size() == 1); return _nodes.front(); }
@@ -83,6 +91,17 @@ class LLVMPointerGraphBuilder
         void append(PSNode *n) { _nodes.push_back(n); }
         bool empty() const { return _nodes.empty(); }
 
+        // forget the nodes that were removed from the graph
+        void erase(const PSNodesSetT& removed) {
+            _nodes.erase(std::remove_if(_nodes.begin(), _nodes.end(),
+                                        [&removed](PSNode *n) {
+                                            return removed.count(n) > 0;
+                                        }),
+                         _nodes.end());
+        }
+
+        void clear() { _nodes.clear(); _repr = nullptr; }
+
         PSNode *getFirst() {assert(!_nodes.empty()); return _nodes.front(); }
         PSNode *getLast() { assert(!_nodes.empty()); return _nodes.back(); }
 
@@ -192,6 +211,49 @@ class LLVMPointerGraphBuilder
     std::vector<PSNodeFork *> forkNodes;
     std::vector<PSNodeJoin *> joinNodes;
 
+    // functions whose subgraphs were built while the analysis was running
+    std::unordered_set<const llvm::Function *> _adHocFunctions;
+
+    // the nodes of the summarized functions and their instances
+    // at the call sites, in the order in which they were created
+    // (see Summaries.cpp)
+    std::vector<std::pair<PSNode *, PSNode *>> _summaryInstances;
+    std::unordered_set<const llvm::Function *> _summarizedFunctions;
+    unsigned _clonedAllocationsNum{0};
+    unsigned _removedNodesNum{0};
+
+    // remove the nodes that are not needed to compute
+    // the points-to sets (see Optimizations.cpp)
+    void optimizeGraph();
+
+public:
+    // A change of the graph made while the analysis is running.
+    // The changes are recorded, so that the graph can be built again
+    // without running the analysis (see PointerAnalysisCache.h).
+    struct AdHocChange {
+        enum class Kind : uint32_t {
+            // insertFunctionCall(node, arg)
+            CALL,
+            // insertPthreadCreateByPtrCall(node)
+            PTHREAD_CREATE,
+            // insertPthreadJoinByPtrCall(node)
+            PTHREAD_JOIN,
+            // addFunctionToFork(arg, node)
+            FORK_FUNCTION,
+            // addFunctionToJoin(arg, node)
+            JOIN_FUNCTION,
+            // node->addFork(arg) on a join node
+            JOIN_FORK
+        } kind;
+
+        // the IDs of the nodes
+        uint32_t node;
+        uint32_t arg;
+    };
+
+private:
+    std::vector<AdHocChange> _adHocChanges;
+
 public:
     const PointerGraph *getPS() const { return &PS; }
 
@@ -231,6 +293,21 @@ public:
                            PSNodeJoin * joinNode);
 
     bool matchJoinToRightCreate(PSNode *pthreadJoinCall);
+
+    void recordAdHocChange(AdHocChange::Kind kind, PSNode *node,
+                           PSNode *arg = nullptr) {
+        _adHocChanges.push_back({kind, node->getID(), arg ? arg->getID() : 0});
+    }
+
+    const std::vector<AdHocChange>& getAdHocChanges() const {
+        return _adHocChanges;
+    }
+
+    // Make the recorded change again on a newly built graph.
+    // Return false if the change does not fit to the graph.
+    bool replayAdHocChange(const AdHocChange& change,
+                           const std::vector<PSNode *>& nodesById);
+
     // let the user get the nodes map, so that we can
     // map the points-to informatio back to LLVM nodes
     const std::unordered_map<const llvm::Value *, PSNodesSeq>&
@@ -258,6 +335,7 @@ public:
     const std::vector<PSNodeFork *>& getForks() const { return forkNodes; }
 
     PSNodeJoin * findJoin(const llvm::CallInst * callInst) const;
+    bool getInvalidateNodesFlag() const { return invalidate_nodes; }
     void setInvalidateNodesFlag(bool value) 
     {
         assert(PS.getEntry() == nullptr &&
@@ -265,14 +343,77 @@ public:
         this->invalidate_nodes = value;
     }
 
-    void composeMapping(PointsToMapping<PSNode *>&& rhs) {
-        mapping.compose(std::move(rhs));
-    }
+    // the nodes 'removed' were removed from the graph and 'rhs'
+    // maps them to their equivalent nodes (see Optimizations.cpp)
+    void composeMapping(PointsToMapping<PSNode *>&& rhs,
+                        const PSNodesSetT& removed);
 
     PointerSubgraph *getSubgraph(const llvm::Function *);
 
+    ///
+    // Rebuilding subgraphs of changed functions (see Incremental.cpp).
+    //
+    // Can the subgraph of the (changed) function be thrown away
+    // and built again? It cannot if the subgraph may be connected
+    // to calls via pointers or to threads.
+    bool canRebuild(const llvm::Function *F) const;
+
+    // the nodes of the built subgraphs of the functions
+    std::vector<PSNode *>
+    getFunctionsNodes(const std::vector<const llvm::Function *>& functions) const;
+
+    // remove the subgraphs of the functions together with their nodes
+    void removeFunctions(const std::vector<const llvm::Function *>& functions);
+
+    // build the removed functions again (and the functions that are newly
+    // called from them) and connect them to the rest of the graph.
+    // Returns the new subgraphs.
+    std::vector<PointerSubgraph *>
+    rebuildFunctions(const std::vector<const llvm::Function *>& functions);
+
+    // the built functions that cannot be called from the entry function
+    // anymore (the full build would not build them)
+    std::vector<const llvm::Function *> getUnreachableFunctions() const;
+
+    ///
+    // Function summaries (see Summaries.cpp).
+    //
+    // The number of functions whose calls were replaced
+    // by the instances of their summaries.
+    unsigned getNumOfSummarizedFunctions() const { return _summarizedFunctions.size(); }
+    // were the calls of the function replaced by the instances of its summary?
+    bool isSummarized(const llvm::Function *F) const {
+        return _summarizedFunctions.count(F) > 0;
+    }
+    // the number of copies of allocations created by the heap cloning
+    unsigned getNumOfClonedAllocations() const { return _clonedAllocationsNum; }
+
+    // Set the points-to sets of the nodes of the summarized functions
+    // to the union of the points-to sets of their instances.
+    // Call it after the analysis finished.
+    void fillSummarizedFunctions();
+
+    // The number of nodes that were removed from the built graph
+    // (see LLVMPointerAnalysisOptions::optimizeGraph).
+    unsigned getNumOfRemovedNodes() const { return _removedNodesNum; }
+
 private:
 
+    bool canSummarize(const llvm::Function *F, PointerSubgraph *subg,
+                      const std::vector<PSNode *>& nodes,
+                      unsigned maxNodes) const;
+    bool isAllocationWrapper(const llvm::Function *F,
+                             const std::vector<PSNode *>& nodes) const;
+    // 'allocDepth' are the numbers of call sites that distinguish
+    // the copies of allocations (if 'cloneAllocs' is set)
+    void instantiateSummary(const llvm::Function *F, PointerSubgraph *subg,
+                            const std::vector<PSNode *>& nodes,
+                            PSNodeCall *callNode,
+                            std::vector<PSNode *>& callerNodes,
+                            bool cloneAllocs,
+                            std::unordered_map<const PSNode *, unsigned>& allocDepth);
+    void instantiateSummaries();
+
     // create subgraph of function @F (the nodes)
     // and call+return nodes to/from it. This function
     // won't add the CFG edges if not 'ad_hoc_building'
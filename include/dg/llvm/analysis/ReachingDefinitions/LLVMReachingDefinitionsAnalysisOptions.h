@@ -10,10 +10,13 @@ namespace analysis {
 struct LLVMReachingDefinitionsAnalysisOptions :
     public LLVMAnalysisOptions, ReachingDefinitionsAnalysisOptions
 {
-    enum class AnalysisType { dataflow, ssa } analysisType{AnalysisType::dataflow};
+    // dataflow_blocks is the data-flow analysis that keeps
+    // the maps of definitions only for basic blocks
+    enum class AnalysisType { dataflow, dataflow_blocks, ssa } analysisType{AnalysisType::dataflow};
 
     bool threads{false};
     bool isDataFlow() const { return analysisType == AnalysisType::dataflow; }
+    bool isBlockDataFlow() const { return analysisType == AnalysisType::dataflow_blocks; }
     bool isSSA() const { return analysisType == AnalysisType::ssa; }
 
     LLVMReachingDefinitionsAnalysisOptions() {
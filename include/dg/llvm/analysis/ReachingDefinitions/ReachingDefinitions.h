@@ -43,7 +43,7 @@ class LLVMReachingDefinitions
     const LLVMReachingDefinitionsAnalysisOptions _options;
 
     void initializeSparseRDA();
-    void initializeDenseRDA();
+    void initializeDenseRDA(bool blocks = false);
 
 public:
 
@@ -67,6 +67,8 @@ public:
 
         if (std::is_same<RdaType, SSAReachingDefinitionsAnalysis>::value) {
             initializeSparseRDA();
+        } else if (std::is_same<RdaType, BlockReachingDefinitionsAnalysis>::value) {
+            initializeDenseRDA(true /* blocks */);
         } else {
             initializeDenseRDA();
         }
@@ -79,6 +81,10 @@ public:
     }
 
     RDNode *getRoot() { return RDA->getRoot(); }
+
+    // the statistics of the (data-flow) analysis
+    unsigned getNumOfRounds() const { return RDA->getNumOfRounds(); }
+    size_t getNumOfProcessedNodes() const { return RDA->getNumOfProcessedNodes(); }
     ReachingDefinitionsGraph *getGraph() { return RDA->getGraph(); }
     RDNode *getNode(const llvm::Value *val);
     const RDNode *getNode(const llvm::Value *val) const;
@@ -119,6 +125,12 @@ public:
         return RDA->getReachingDefinitions(use);
     }
 
+    // the map of definitions that reach the location after 'where'
+    // (for the data-flow analyses)
+    RDMap& getDefinitionsMap(RDNode *where) {
+        return RDA->getDefinitionsMap(where);
+    }
+
     std::vector<RDNode *> getReachingDefinitions(llvm::Value *use) {
         auto node = getNode(use);
         assert(node);
@@ -2,6 +2,7 @@
 #define _COW_SHARED_PTR_H_
 
 #include <memory>
+#include <cassert>
 
 ///
 // Shared pointer with copy-on-write support
@@ -17,6 +18,12 @@ class cow_shared_ptr : public std::shared_ptr<T> {
     cow_shared_ptr(const cow_shared_ptr& rhs)
         : std::shared_ptr<T>(rhs), owner(false) {}
 
+    cow_shared_ptr& operator=(const cow_shared_ptr& rhs) {
+        std::shared_ptr<T>::operator=(rhs);
+        owner = false;
+        return *this;
+    }
+
     void reset(T *p) {
         owner = true;
         std::shared_ptr<T>::reset(p);
@@ -26,12 +33,18 @@ class cow_shared_ptr : public std::shared_ptr<T> {
     const T *operator->() const { return get(); }
     const T *operator*() const { return get(); }
 
+    // is the object shared with another pointer?
+    bool isShared() const { return std::shared_ptr<T>::use_count() > 1; }
+
     T *getWritable() {
-        if (owner)
+        // nobody else sees the object, we can write to it
+        // (even if we got it by copying)
+        if (!isShared() && get() != nullptr) {
+            owner = true;
             return std::shared_ptr<T>::get();
+        }
 
         // create a copy of the object and claim the ownership
-        assert(!owner);
         if (get() != nullptr) {
             reset(new T(*get()));
         } else {
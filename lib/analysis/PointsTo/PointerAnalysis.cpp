@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/analysis/PointsTo/PointsToSet.h"
 #include "dg/analysis/PointsTo/PointerGraph.h"
@@ -24,7 +26,7 @@ const Pointer NullPointer(NULLPTR, 0);
 
 // Return true if it makes sense to dereference this pointer.
 // PTA is over-approximation, so this is a filter.
-static inline bool canBeDereferenced(const Pointer& ptr)
+bool PointerAnalysis::canBeDereferenced(const Pointer& ptr)
 {
     if (!ptr.isValid() || ptr.isInvalidated() || ptr.isUnknown())
         return false;
@@ -38,16 +40,23 @@ static inline bool canBeDereferenced(const Pointer& ptr)
 
 bool PointerAnalysis::processLoad(PSNode *node)
 {
-    bool changed = false;
     PSNode *operand = node->getOperand(0);
 
     if (operand->pointsTo.empty())
         return error(operand, "Load's operand has no points-to set");
 
-    for (const Pointer& ptr : operand->pointsTo) {
+    return processLoad(node, operand->pointsTo, node->pointsTo);
+}
+
+bool PointerAnalysis::processLoad(PSNode *node, const PointsToSetT& pointers,
+                                  PointsToSetT& out)
+{
+    bool changed = false;
+
+    for (const Pointer& ptr : pointers) {
         if (ptr.isUnknown()) {
             // load from unknown pointer yields unknown pointer
-            changed |= node->addPointsTo(UnknownPointer);
+            changed |= out.add(UnknownPointer);
             continue;
         }
 
@@ -68,64 +77,78 @@ bool PointerAnalysis::processLoad(PSNode *node)
             if (target->isZeroInitialized())
                 // if the memory is zero initialized, then everything
                 // is fine, we add nullptr
-                changed |= node->addPointsTo(NullPointer);
+                changed |= out.add(NullPointer);
             else
                 changed |= errorEmptyPointsTo(node, target);
 
             continue;
         }
 
-        for (MemoryObject *o : objects) {
-            // is the offset to the memory unknown?
-            // In that case everything can be referenced,
-            // so we need to copy the whole points-to
-            if (ptr.offset.isUnknown()) {
-                // we should load from memory that has
-                // no pointers in it - it may be an error
-                // FIXME: don't duplicate the code
-                if (o->pointsTo.empty()) {
-                    if (target->isZeroInitialized())
-                        changed |= node->addPointsTo(NullPointer);
-                    else if (objects.size() == 1)
-                        changed |= errorEmptyPointsTo(node, target);
-                }
-
-                // we have some pointers - copy them all,
-                // since the offset is unknown
-                for (auto& it : o->pointsTo) {
-                    changed |= node->addPointsTo(it.second);
-                }
+        for (MemoryObject *o : objects)
+            changed |= processLoad(node, ptr, o, objects.size() == 1, out);
+    }
 
-                // this is all that we can do here...
-                continue;
-            }
+    return changed;
+}
 
-            // load from empty points-to set
-            // - that is load from unknown memory
-            auto it = o->pointsTo.find(ptr.offset);
-            if (it == o->pointsTo.end()) {
-                // if the memory is zero initialized, then everything
-                // is fine, we add nullptr
-                if (target->isZeroInitialized())
-                    changed |= node->addPointsTo(NullPointer);
-                // if we don't have a definition even with unknown offset
-                // it is an error
-                // FIXME: don't triplicate the code!
-                else if (!o->pointsTo.count(Offset::UNKNOWN))
-                    changed |= errorEmptyPointsTo(node, target);
-            } else {
-                // we have pointers on that memory, so we can
-                // do the work
-                changed |= node->addPointsTo(it->second);
-            }
+// Load the pointers from the memory object 'o' that the pointer 'ptr'
+// points to ('single' is true if 'o' is the only object of the pointer).
+bool PointerAnalysis::processLoad(PSNode *node, const Pointer& ptr,
+                                  MemoryObject *o, bool single,
+                                  PointsToSetT& out)
+{
+    bool changed = false;
+    PSNodeAlloc *target = PSNodeAlloc::get(ptr.target);
+    assert(target && "Target is not memory allocation");
+
+    // is the offset to the memory unknown?
+    // In that case everything can be referenced,
+    // so we need to copy the whole points-to
+    if (ptr.offset.isUnknown()) {
+        // we should load from memory that has
+        // no pointers in it - it may be an error
+        // FIXME: don't duplicate the code
+        if (o->pointsTo.empty()) {
+            if (target->isZeroInitialized())
+                changed |= out.add(NullPointer);
+            else if (single)
+                changed |= errorEmptyPointsTo(node, target);
+        }
 
-            // plus always add the pointers at unknown offset,
-            // since these can be what we need too
-            it = o->pointsTo.find(Offset::UNKNOWN);
-            if (it != o->pointsTo.end()) {
-                changed |= node->addPointsTo(it->second);
-            }
+        // we have some pointers - copy them all,
+        // since the offset is unknown
+        for (auto& it : o->pointsTo) {
+            changed |= out.add(it.second);
         }
+
+        // this is all that we can do here...
+        return changed;
+    }
+
+    // load from empty points-to set
+    // - that is load from unknown memory
+    auto it = o->pointsTo.find(ptr.offset);
+    if (it == o->pointsTo.end()) {
+        // if the memory is zero initialized, then everything
+        // is fine, we add nullptr
+        if (target->isZeroInitialized())
+            changed |= out.add(NullPointer);
+        // if we don't have a definition even with unknown offset
+        // it is an error
+        // FIXME: don't triplicate the code!
+        else if (!o->pointsTo.count(Offset::UNKNOWN))
+            changed |= errorEmptyPointsTo(node, target);
+    } else {
+        // we have pointers on that memory, so we can
+        // do the work
+        changed |= out.add(it->second);
+    }
+
+    // plus always add the pointers at unknown offset,
+    // since these can be what we need too
+    it = o->pointsTo.find(Offset::UNKNOWN);
+    if (it != o->pointsTo.end()) {
+        changed |= out.add(it->second);
     }
 
     return changed;
@@ -264,12 +287,20 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *>& srcObjects,
 }
 
 bool PointerAnalysis::processGep(PSNode *node) {
+    PSNodeGep *gep = PSNodeGep::get(node);
+    assert(gep && "Non-GEP given");
+
+    return processGep(node, gep->getSource()->pointsTo, node->pointsTo);
+}
+
+bool PointerAnalysis::processGep(PSNode *node, const PointsToSetT& pointers,
+                                 PointsToSetT& out) {
     bool changed = false;
 
     PSNodeGep *gep = PSNodeGep::get(node);
     assert(gep && "Non-GEP given");
 
-    for (const Pointer& ptr : gep->getSource()->pointsTo) {
+    for (const Pointer& ptr : pointers) {
         Offset::type new_offset;
         if (ptr.offset.isUnknown() || gep->getOffset().isUnknown())
             // set it like this to avoid overflow when adding
@@ -282,9 +313,9 @@ bool PointerAnalysis::processGep(PSNode *node) {
         // to the begining of the memory - therefore make 0 exception
         if ((new_offset == 0 || new_offset < ptr.target->getSize())
             && new_offset < *options.fieldSensitivity)
-            changed |= node->addPointsTo(ptr.target, new_offset);
+            changed |= out.add(ptr.target, new_offset);
         else
-            changed |= node->addPointsTo(ptr.target, Offset::UNKNOWN);
+            changed |= out.add(ptr.target, Offset::UNKNOWN);
     }
 
     return changed;
@@ -346,7 +377,7 @@ bool PointerAnalysis::processNode(PSNode *node)
             // gather pointers returned from subprocedure - the same way
             // as PHI works
         case PSNodeType::PHI:
-            for (PSNode *op : node->operands)
+            for (PSNode *op : node->getOperands())
                 changed |= node->addPointsTo(op->pointsTo);
             break;
         case PSNodeType::CALL_FUNCPTR:
@@ -455,6 +486,115 @@ void PointerAnalysis::sanityCheck() {
 #endif // not NDEBUG
 }
 
+void PointerAnalysis::processGlobals() {
+    DBG(pta, "Processing global nodes");
+    queue_globals();
+    iteration();
+    assert((to_process.clear(), changed.clear(), queue_globals(), !iteration()) && "Globals did not reach fixpoint");
+    to_process.clear();
+    changed.clear();
+}
+
+// Compute the topological order of SCCs of the graph of operands
+// (edges go from operands to their users) by the Tarjan's algorithm
+// and order the nodes of one SCC in reverse post-order.
+// Nodes that are not connected keep the order of their IDs.
+void PointerAnalysis::computePriorities() {
+    std::vector<PSNode *> nodes;
+    for (auto& glob : PS->getGlobals())
+        nodes.push_back(glob.get());
+    for (auto& nd : PS->getNodes()) {
+        if (nd)
+            nodes.push_back(nd.get());
+    }
+
+    size_t size = PS->size() + 1;
+    std::vector<unsigned> index(size, 0);
+    std::vector<unsigned> lowpt(size, 0);
+    std::vector<unsigned> scc(size, 0);
+    std::vector<unsigned> postorder(size, 0);
+    std::vector<bool> onStack(size, false);
+    std::vector<PSNode *> stack;
+    // the DFS stack of nodes and the index of the next user to visit
+    std::vector<std::pair<PSNode *, size_t>> dfs;
+    unsigned dfsnum = 0, sccnum = 0, postnum = 0;
+
+    auto visit = [&](PSNode *n) {
+        index[n->getID()] = lowpt[n->getID()] = ++dfsnum;
+        stack.push_back(n);
+        onStack[n->getID()] = true;
+        dfs.emplace_back(n, 0);
+    };
+
+    // start from the last nodes, so that the nodes that are not
+    // connected get the SCCs with higher numbers the lower their ID is
+    for (auto it = nodes.rbegin(), et = nodes.rend(); it != et; ++it) {
+        PSNode *start = *it;
+        if (index[start->getID()] != 0)
+            continue;
+
+        visit(start);
+        while (!dfs.empty()) {
+            PSNode *n = dfs.back().first;
+            unsigned id = n->getID();
+            const auto& users = n->getUsers();
+            if (dfs.back().second < users.size()) {
+                PSNode *user = users[dfs.back().second++];
+                if (index[user->getID()] == 0)
+                    visit(user);
+                else if (onStack[user->getID()])
+                    lowpt[id] = std::min(lowpt[id], index[user->getID()]);
+                continue;
+            }
+
+            dfs.pop_back();
+            postorder[id] = ++postnum;
+            if (!dfs.empty()) {
+                unsigned parent = dfs.back().first->getID();
+                lowpt[parent] = std::min(lowpt[parent], lowpt[id]);
+            }
+
+            if (lowpt[id] == index[id]) {
+                PSNode *w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w->getID()] = false;
+                    scc[w->getID()] = sccnum;
+                } while (w != n);
+                ++sccnum;
+            }
+        }
+    }
+
+    // the SCCs are found in reverse topological order
+    // and the reverse post-order is the descending post-order
+    std::sort(nodes.begin(), nodes.end(),
+              [&scc, &postorder](PSNode *a, PSNode *b) {
+                    if (scc[a->getID()] != scc[b->getID()])
+                        return scc[a->getID()] > scc[b->getID()];
+                    return postorder[a->getID()] > postorder[b->getID()];
+              });
+
+    _priority.assign(size, 0);
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        _priority[nodes[i]->getID()] = i;
+}
+
+void PointerAnalysis::orderToProcess() {
+    if (!options.isTopologicalOrder())
+        return;
+
+    // the graph grows when calls via function pointers are resolved
+    if (_priority.size() != PS->size() + 1)
+        computePriorities();
+
+    std::sort(to_process.begin(), to_process.end(),
+              [this](PSNode *a, PSNode *b) {
+                    return _priority[a->getID()] < _priority[b->getID()];
+              });
+}
+
 void PointerAnalysis::run() {
     DBG_SECTION_BEGIN(pta, "Running pointer analysis");
     
@@ -463,14 +603,8 @@ void PointerAnalysis::run() {
     // check that the current state of pointer analysis makes sense
     sanityCheck();
     
-    // process global nodes, these must reach fixpoint after one iteration
-    DBG(pta, "Processing global nodes");
-    queue_globals();
-    iteration();
-    assert((to_process.clear(), changed.clear(), queue_globals(), !iteration()) && "Globals did not reach fixpoint");
-    to_process.clear();
-    changed.clear();
-    
+    processGlobals();
+
     initialize_queue();
 
 #if DEBUG_ENABLED
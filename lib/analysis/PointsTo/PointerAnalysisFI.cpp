@@ -0,0 +1,500 @@
+#include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/PointsToSet.h"
+#include "dg/analysis/PointsTo/PointerGraph.h"
+#include "dg/analysis/PointsTo/PointerAnalysisFI.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+// Difference propagation: every node keeps the pointers that were
+// added to its points-to set since it was processed last time (delta).
+// When a node is taken from the worklist, only its delta is pushed
+// to the users of the node. Memory objects do not have deltas,
+// so the nodes that read the memory are processed again (with
+// the whole points-to set of the pointer operand) when the object changes.
+//
+// Cycles of copy nodes are detected lazily: when propagating along a copy
+// edge does not bring anything new into the target node, the nodes may be
+// on a cycle (and so have the same points-to sets), so we search
+// for cycles from that node. Every edge is used for the search at most once.
+// Nodes on a cycle are collapsed into a representative that holds
+// the points-to set of all of them.
+
+static inline bool isCopyNode(PSNode *n) {
+    switch (n->getType()) {
+        case PSNodeType::CAST:
+        case PSNodeType::PHI:
+            return true;
+        case PSNodeType::GEP:
+            // GEP with 0 offset is cast (see PSEquivalentNodesMerger)
+            return PSNodeGep::get(n)->getOffset().isZero();
+        default:
+            return false;
+    }
+}
+
+void PointerAnalysisFI::diffResize() {
+    // IDs of nodes are dense, new nodes may have been created
+    // when building subgraphs for function pointer calls
+    size_t size = PS->size() + 1;
+    if (_flags.size() < size) {
+        _flags.resize(size, 0);
+        _delta.resize(size);
+        _rep.resize(size, nullptr);
+    }
+}
+
+PSNode *PointerAnalysisFI::diffFind(PSNode *n) {
+    PSNode *rep = n;
+    while (PSNode *r = _rep[rep->getID()])
+        rep = r;
+
+    // compress the path
+    while (n != rep) {
+        PSNode *next = _rep[n->getID()];
+        _rep[n->getID()] = rep;
+        n = next;
+    }
+
+    return rep;
+}
+
+void PointerAnalysisFI::diffSchedule(PSNode *n, bool full) {
+    assert(n->getID() < _flags.size());
+    _flags[n->getID()] |= ACTIVE;
+
+    n = diffFind(n);
+    auto& flags = _flags[n->getID()];
+    flags |= ACTIVE;
+    if (full)
+        flags |= NEEDS_FULL;
+
+    if (!(flags & IN_QUEUE)) {
+        flags |= IN_QUEUE;
+        _worklist.push(n);
+    }
+}
+
+void PointerAnalysisFI::diffScheduleReachable(PSNode *from) {
+    diffResize();
+
+    // the graph has changed (or it is the initial run), process
+    // all the nodes again and propagate their whole points-to sets,
+    // since new nodes or edges may have been added
+    for (PSNode *n : PS->getNodes(from)) {
+        if (_demanding) {
+            diffReach(n);
+            // the node is solved when it is demanded
+            if (!(_flags[n->getID()] & ACTIVE))
+                continue;
+            // it may have new operands
+            _demandQueue.push_back(n);
+        }
+
+        if (!n->pointsTo.empty())
+            _delta[diffFind(n)->getID()].add(n->pointsTo);
+        diffSchedule(n, true /* full */);
+    }
+}
+
+bool PointerAnalysisFI::diffAddPointsTo(PSNode *n, const PointsToSetT& pointers) {
+    n = diffFind(n);
+
+    bool changed = false;
+    for (const Pointer& ptr : pointers) {
+        if (n->addPointsTo(ptr)) {
+            _delta[n->getID()].add(ptr);
+            changed = true;
+        }
+    }
+
+    if (changed)
+        diffSchedule(n, false);
+
+    return changed;
+}
+
+void PointerAnalysisFI::diffMemoryChanged(MemoryObject *mo) {
+    auto it = _readers.find(mo);
+    if (it == _readers.end())
+        return;
+
+    for (PSNode *reader : it->second) {
+        if (_flags[reader->getID()] & ACTIVE)
+            diffSchedule(reader, true /* full */);
+    }
+}
+
+// Process the node 'n' given that 'pointers' were added
+// to the points-to set of its idx-th operand.
+// Returns true if the points-to set of the node changed.
+bool PointerAnalysisFI::diffPropagate(PSNode *n, unsigned idx,
+                                      const PointsToSetT& pointers) {
+    std::vector<MemoryObject *> objects;
+    PointsToSetT tmp;
+
+    switch (n->getType()) {
+        case PSNodeType::CAST:
+        case PSNodeType::PHI:
+        case PSNodeType::RETURN:
+        case PSNodeType::CALL_RETURN:
+            return diffAddPointsTo(n, pointers);
+        case PSNodeType::GEP:
+            processGep(n, pointers, tmp);
+            return diffAddPointsTo(n, tmp);
+        case PSNodeType::LOAD:
+            processLoad(n, pointers, tmp);
+            return diffAddPointsTo(n, tmp);
+        case PSNodeType::STORE:
+            if (idx == 0) {
+                // new pointers are stored to the old memory
+                for (const Pointer& ptr : diffFind(n->getOperand(1))->pointsTo) {
+                    if (!canBeDereferenced(ptr))
+                        continue;
+
+                    objects.clear();
+                    getMemoryObjects(n, ptr, objects);
+                    for (MemoryObject *o : objects) {
+                        if (o->addPointsTo(ptr.offset, pointers))
+                            diffMemoryChanged(o);
+                    }
+                }
+            }
+            if (idx == 1) {
+                // old pointers are stored to the new memory
+                for (const Pointer& ptr : pointers) {
+                    if (!canBeDereferenced(ptr))
+                        continue;
+
+                    objects.clear();
+                    getMemoryObjects(n, ptr, objects);
+                    for (MemoryObject *o : objects) {
+                        if (o->addPointsTo(ptr.offset,
+                                           diffFind(n->getOperand(0))->pointsTo))
+                            diffMemoryChanged(o);
+                    }
+                }
+            }
+            return false;
+        default:
+            diffProcessOther(n);
+            return false;
+    }
+}
+
+// Process nodes that are not worth the difference propagation
+// (or that may change the graph) the same way as the iterative solver does
+void PointerAnalysisFI::diffProcessOther(PSNode *n) {
+    std::vector<MemoryObject *> destObjects;
+
+    // the node reads the points-to sets of its operands directly,
+    // so give the collapsed operands the points-to set of their cycle
+    for (PSNode *op : n->getOperands()) {
+        PSNode *rep = diffFind(op);
+        if (rep != op)
+            op->addPointsTo(rep->pointsTo);
+    }
+
+    if (n->getType() == PSNodeType::MEMCPY) {
+        // gather the objects that can be changed by the memcpy
+        for (const Pointer& ptr : PSNodeMemcpy::get(n)->getDestination()->pointsTo) {
+            if (canBeDereferenced(ptr))
+                getMemoryObjects(n, ptr, destObjects);
+        }
+    }
+
+    bool changed = processNode(n);
+    // processing the node may have created new nodes
+    diffResize();
+
+    if (!changed)
+        return;
+
+    for (MemoryObject *o : destObjects)
+        diffMemoryChanged(o);
+
+    switch (n->getType()) {
+        case PSNodeType::CALL_FUNCPTR:
+        case PSNodeType::FORK:
+        case PSNodeType::JOIN:
+            // the graph may have changed
+            diffScheduleReachable(n);
+            break;
+        default:
+            if (!n->pointsTo.empty()) {
+                _delta[n->getID()].add(n->pointsTo);
+                diffSchedule(n, false);
+            }
+    }
+}
+
+void PointerAnalysisFI::diffProcessFull(PSNode *n) {
+    switch (n->getType()) {
+        case PSNodeType::CAST:
+        case PSNodeType::PHI:
+        case PSNodeType::RETURN:
+        case PSNodeType::CALL_RETURN:
+        case PSNodeType::GEP:
+        case PSNodeType::LOAD:
+        case PSNodeType::STORE:
+            for (unsigned i = 0, e = n->getOperandsNum(); i < e; ++i) {
+                PSNode *op = diffFind(n->getOperand(i));
+                // the node cannot get anything new from itself
+                if (op == diffFind(n) && isCopyNode(n))
+                    continue;
+                diffPropagate(n, i, op->pointsTo);
+            }
+            break;
+        default:
+            diffProcessOther(n);
+    }
+}
+
+void PointerAnalysisFI::diffProcess(PSNode *n) {
+    auto& flags = _flags[n->getID()];
+    bool full = flags & NEEDS_FULL;
+    flags &= ~(IN_QUEUE | NEEDS_FULL);
+
+    // the node was collapsed into a cycle after it had been queued,
+    // its representative takes care of it
+    if (diffFind(n) != n)
+        return;
+
+    auto collapsed = _collapsed.find(n);
+    if (full) {
+        diffProcessFull(n);
+        if (collapsed != _collapsed.end()) {
+            for (PSNode *c : collapsed->second)
+                diffProcessFull(c);
+        }
+    }
+
+    // take the delta away, so that pointers added
+    // while propagating it are gathered into a new delta
+    PointsToSetT delta;
+    delta.swap(_delta[n->getID()]);
+    if (delta.empty())
+        return;
+
+    // the users of the collapsed nodes are the users of the representative
+    std::vector<PSNode *> nodes{n};
+    if (collapsed != _collapsed.end())
+        nodes.insert(nodes.end(), collapsed->second.begin(),
+                                  collapsed->second.end());
+
+    for (PSNode *m : nodes) {
+        // processing a call via a pointer may add new users to the node
+        // (and move its edges), so get the users again in every iteration
+        for (size_t k = 0; k < m->getUsers().size(); ++k) {
+            PSNode *user = m->getUsers()[k];
+            if (!(_flags[user->getID()] & ACTIVE))
+                continue;
+
+            // the edge is inside the cycle
+            if (isCopyNode(user) && diffFind(user) == n)
+                continue;
+
+            for (unsigned i = 0, e = user->getOperandsNum(); i < e; ++i) {
+                if (user->getOperand(i) != m)
+                    continue;
+
+                bool changed = diffPropagate(user, i, delta);
+                // nothing new came through the copy edge,
+                // the nodes may be on a cycle
+                if (!changed && isCopyNode(user) && options.collapseCycles &&
+                    _checkedEdges.emplace(m, user).second)
+                    diffCollapseCycles(diffFind(user));
+            }
+
+            // we collapsed the cycle, the rest of the delta
+            // will be propagated when processing the representative
+            if (diffFind(n) != n)
+                return;
+        }
+    }
+}
+
+void PointerAnalysisFI::diffCopyUsers(PSNode *rep, std::vector<PSNode *>& users) {
+    auto propagateTo = [&](PSNode *m) {
+        for (PSNode *user : m->getUsers()) {
+            if (!(_flags[user->getID()] & ACTIVE) || !isCopyNode(user))
+                continue;
+
+            PSNode *r = diffFind(user);
+            if (r != rep)
+                users.push_back(r);
+        }
+    };
+
+    propagateTo(rep);
+    auto it = _collapsed.find(rep);
+    if (it != _collapsed.end()) {
+        for (PSNode *c : it->second)
+            propagateTo(c);
+    }
+}
+
+// Tarjan's algorithm on the graph of copy edges between the representatives.
+// We do not use the SCC class here, since it walks the successors in the
+// control flow and it is recursive, while the copy chains may be very long.
+void PointerAnalysisFI::diffCollapseCycles(PSNode *from) {
+    struct Frame {
+        PSNode *node;
+        std::vector<PSNode *> users;
+        size_t pos;
+    };
+
+    // dfs id and lowpt of visited nodes
+    std::unordered_map<PSNode *, std::pair<unsigned, unsigned>> visited;
+    std::set<PSNode *> onStack;
+    std::vector<PSNode *> stack;
+    std::vector<Frame> frames;
+    std::vector<std::vector<PSNode *>> cycles;
+    unsigned index = 0;
+
+    auto visit = [&](PSNode *n) {
+        ++index;
+        visited.emplace(n, std::make_pair(index, index));
+        stack.push_back(n);
+        onStack.insert(n);
+        frames.push_back(Frame{n, {}, 0});
+        diffCopyUsers(n, frames.back().users);
+    };
+
+    visit(from);
+    while (!frames.empty()) {
+        Frame& frame = frames.back();
+        auto& info = visited[frame.node];
+
+        if (frame.pos < frame.users.size()) {
+            PSNode *user = frame.users[frame.pos++];
+            auto it = visited.find(user);
+            if (it == visited.end()) {
+                // invalidates 'frame'
+                visit(user);
+            } else if (onStack.count(user) > 0) {
+                info.second = std::min(info.second, it->second.first);
+            }
+            continue;
+        }
+
+        if (info.first == info.second) {
+            std::vector<PSNode *> component;
+            PSNode *w;
+            do {
+                w = stack.back();
+                stack.pop_back();
+                onStack.erase(w);
+                component.push_back(w);
+            } while (w != frame.node);
+
+            if (component.size() > 1)
+                cycles.push_back(std::move(component));
+        }
+
+        unsigned lowpt = info.second;
+        frames.pop_back();
+        if (!frames.empty()) {
+            auto& parent = visited[frames.back().node];
+            parent.second = std::min(parent.second, lowpt);
+        }
+    }
+
+    for (auto& cycle : cycles)
+        diffCollapse(cycle);
+}
+
+void PointerAnalysisFI::diffCollapse(const std::vector<PSNode *>& cycle) {
+    PSNode *rep = cycle[0];
+    auto& repCollapsed = _collapsed[rep];
+
+    for (PSNode *n : cycle) {
+        if (n == rep)
+            continue;
+
+        assert(diffFind(n) == n && "Collapsing a non-representative");
+        _rep[n->getID()] = rep;
+        rep->addPointsTo(n->pointsTo);
+
+        auto& flags = _flags[n->getID()];
+        if (flags & NEEDS_FULL)
+            _flags[rep->getID()] |= NEEDS_FULL;
+
+        repCollapsed.push_back(n);
+        auto it = _collapsed.find(n);
+        if (it != _collapsed.end()) {
+            repCollapsed.insert(repCollapsed.end(),
+                                it->second.begin(), it->second.end());
+            _collapsed.erase(it);
+        }
+
+        _delta[n->getID()].clear();
+        ++_collapsedNodesNum;
+    }
+
+    // the users of the nodes from the cycle may have not seen
+    // the points-to sets of the other nodes from the cycle
+    _delta[rep->getID()].add(rep->pointsTo);
+    diffSchedule(rep, false);
+
+    DBG(pta, "Collapsed a cycle of " << cycle.size() << " nodes into "
+             << rep->getID());
+}
+
+// give the collapsed nodes the points-to sets of their cycles
+void PointerAnalysisFI::diffFinish() {
+    for (auto& it : _collapsed) {
+        for (PSNode *n : it.second) {
+            n->pointsTo.clear();
+            n->pointsTo.add(it.first->pointsTo);
+        }
+    }
+}
+
+void PointerAnalysisFI::diffSolve() {
+#if DEBUG_ENABLED
+    size_t n = 0;
+#endif
+    while (!_worklist.empty()) {
+#if DEBUG_ENABLED
+        if (++n % 10000 == 0) {
+            DBG(pta, "Processed " << n << " nodes, worklist size " << _worklist.size());
+        }
+#endif
+        diffProcess(_worklist.pop());
+        ++_processedNodesNum;
+    }
+}
+
+void PointerAnalysisFI::runDiffPropagation() {
+    DBG_SECTION_BEGIN(pta, "Running pointer analysis (difference propagation)");
+
+    preprocess();
+
+    // check that the current state of pointer analysis makes sense
+    sanityCheck();
+
+    _trackReaders = true;
+    processGlobals();
+
+    PSNode *root = PS->getEntry()->getRoot();
+    assert(root && "Do not have root of PS");
+    diffScheduleReachable(root);
+    diffSolve();
+
+    diffFinish();
+    _solvedNodesNum = PS->size();
+
+    DBG(pta, "Collapsed " << _collapsedNodesNum << " nodes on cycles");
+
+    sanityCheck();
+
+    DBG_SECTION_END(pta, "Running pointer analysis (difference propagation) done");
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
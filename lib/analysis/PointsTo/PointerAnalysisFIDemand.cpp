@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <unordered_set>
+
+#include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/PointsToSet.h"
+#include "dg/analysis/PointsTo/PointerGraph.h"
+#include "dg/analysis/PointsTo/PointerAnalysisFI.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+// The demand-driven analysis runs the difference propagation only
+// on the ACTIVE nodes. A node becomes ACTIVE when it is demanded,
+// together with its operands (transitively). A load then needs the stores
+// (and memcpys) that may write to the memory that it reads. Such stores
+// are found like in the CFL-reachability formulation of the analysis:
+// a store is matched with a load if the pointer of the store may point
+// to the memory that the load reads. The pointer of the store is resolved
+// without solving it if it is only a cast, GEP or PHI of allocations,
+// otherwise it is demanded first. The matched stores are demanded and
+// everything repeats until no store matches. The ACTIVE nodes then have
+// the same points-to sets as when the whole graph is solved, since nothing
+// else can add a pointer to them.
+//
+// The calls via pointers (and threads) change the graph, so they are demanded
+// as soon as they are reachable, in order to find the whole graph.
+
+// the nodes of these types are resolved without solving them
+static bool isStaticTarget(PSNode *n) {
+    switch (n->getType()) {
+        case PSNodeType::ALLOC:
+        case PSNodeType::FUNCTION:
+        case PSNodeType::CONSTANT:
+        case PSNodeType::NULL_ADDR:
+        case PSNodeType::UNKNOWN_MEM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// how many nodes may be searched when resolving
+// a pointer without solving it
+static const size_t STATIC_TARGETS_LIMIT = 32;
+
+// the node is reachable from the entry
+void PointerAnalysisFI::diffReach(PSNode *n) {
+    auto& flags = _flags[n->getID()];
+    if (flags & REACHABLE)
+        return;
+
+    flags |= REACHABLE;
+    switch (n->getType()) {
+        case PSNodeType::CALL_FUNCPTR:
+        case PSNodeType::FORK:
+        case PSNodeType::JOIN:
+            _demandQueue.push_back(n);
+            break;
+        case PSNodeType::STORE:
+        case PSNodeType::MEMCPY:
+            _pendingWriters.push_back(n);
+            break;
+        default:
+            break;
+    }
+}
+
+void PointerAnalysisFI::diffDemand(PSNode *n) {
+    assert((_flags[n->getID()] & REACHABLE) && "Demanded unreachable node");
+    if (_flags[n->getID()] & ACTIVE)
+        return;
+
+    if (!n->pointsTo.empty())
+        _delta[n->getID()].add(n->pointsTo);
+    diffSchedule(n, true /* full */);
+    ++_demandedNodesNum;
+}
+
+// Demand the nodes from the queue and their operands.
+// Returns false if the budget was exceeded.
+bool PointerAnalysisFI::diffDemandOperands() {
+    size_t budget = options.demandBudget;
+    if (budget == 0)
+        budget = PS->size() / 2;
+
+    while (!_demandQueue.empty()) {
+        PSNode *n = _demandQueue.back();
+        _demandQueue.pop_back();
+
+        diffDemand(n);
+        for (PSNode *op : n->getOperands()) {
+            auto flags = _flags[op->getID()];
+            if ((flags & REACHABLE) && !(flags & ACTIVE))
+                _demandQueue.push_back(op);
+        }
+
+        if (_demandedNodesNum > budget)
+            return false;
+    }
+
+    return true;
+}
+
+// Find the memory nodes that the pointer 'n' may point to without solving it.
+// Returns false if the pointer must be solved.
+bool PointerAnalysisFI::diffDemandTargets(PSNode *n, std::vector<PSNode *>& targets) {
+    std::unordered_set<PSNode *> visited;
+    std::vector<PSNode *> stack{n};
+
+    while (!stack.empty()) {
+        PSNode *cur = stack.back();
+        stack.pop_back();
+
+        if (!visited.insert(cur).second)
+            continue;
+        if (visited.size() > STATIC_TARGETS_LIMIT)
+            return false;
+
+        auto flags = _flags[cur->getID()];
+        // the points-to set of the node is known
+        if ((flags & ACTIVE) || !(flags & REACHABLE) || isStaticTarget(cur)) {
+            for (const Pointer& ptr : diffFind(cur)->pointsTo) {
+                if (canBeDereferenced(ptr))
+                    targets.push_back(getMemoryNode(ptr.target));
+            }
+            continue;
+        }
+
+        switch (cur->getType()) {
+            case PSNodeType::CAST:
+            case PSNodeType::GEP:
+                stack.push_back(cur->getOperand(0));
+                break;
+            case PSNodeType::PHI:
+                for (PSNode *op : cur->getOperands())
+                    stack.push_back(op);
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Demand the writers that may write to the memory read by the ACTIVE nodes.
+// Returns true if something was demanded.
+bool PointerAnalysisFI::diffDemandWriters() {
+    bool demanded = false;
+    std::vector<PSNode *> targets;
+
+    for (size_t i = 0; i < _pendingWriters.size();) {
+        PSNode *w = _pendingWriters[i];
+        PSNode *dest = w->getType() == PSNodeType::STORE ?
+                            w->getOperand(1) : PSNodeMemcpy::get(w)->getDestination();
+
+        targets.clear();
+        bool matched = false;
+        if (!diffDemandTargets(dest, targets)) {
+            // solve the pointer first, the writer is matched in the next round
+            _demandQueue.push_back(dest);
+            demanded = true;
+        } else {
+            matched = std::any_of(targets.begin(), targets.end(),
+                                  [this](PSNode *target) {
+                                      MemoryObject *mo = target->getData<MemoryObject>();
+                                      return mo && _readers.count(mo) > 0;
+                                  });
+        }
+
+        if (matched) {
+            _demandQueue.push_back(w);
+            demanded = true;
+            _pendingWriters[i] = _pendingWriters.back();
+            _pendingWriters.pop_back();
+        } else {
+            ++i;
+        }
+    }
+
+    return demanded;
+}
+
+// Solve the demanded nodes and everything that they depend on.
+void PointerAnalysisFI::diffDemandFixpoint() {
+    do {
+        do {
+            if (!diffDemandOperands()) {
+                DBG(pta, "Demanded " << _demandedNodesNum << " nodes, "
+                         "the budget is exceeded");
+                diffDemandAll();
+                return;
+            }
+
+            // solving calls via pointers may demand new nodes
+            diffSolve();
+        } while (!_demandQueue.empty());
+    } while (diffDemandWriters());
+
+    diffFinish();
+}
+
+// solve the rest of the graph
+void PointerAnalysisFI::diffDemandAll() {
+    _demanding = false;
+    _demandQueue.clear();
+    _pendingWriters.clear();
+
+    PSNode *root = PS->getEntry()->getRoot();
+    assert(root && "Do not have root of PS");
+    diffScheduleReachable(root);
+    diffSolve();
+
+    diffFinish();
+    _solvedNodesNum = PS->size();
+}
+
+void PointerAnalysisFI::runDemand() {
+    DBG_SECTION_BEGIN(pta, "Running pointer analysis (on demand)");
+
+    preprocess();
+
+    // check that the current state of pointer analysis makes sense
+    sanityCheck();
+
+    _trackReaders = true;
+    _demanding = true;
+    processGlobals();
+
+    PSNode *root = PS->getEntry()->getRoot();
+    assert(root && "Do not have root of PS");
+    diffScheduleReachable(root);
+
+    // resolve the calls via pointers, so that the graph is complete
+    diffDemandFixpoint();
+
+    DBG_SECTION_END(pta, "Running pointer analysis (on demand) done");
+}
+
+void PointerAnalysisFI::demand(PSNode *n) {
+    if (!_demanding)
+        return;
+
+    diffResize();
+
+    // the node was solved already or it is not reachable
+    // (then it keeps its initial points-to set)
+    auto flags = _flags[n->getID()];
+    if ((flags & ACTIVE) || !(flags & REACHABLE))
+        return;
+
+    DBG_SECTION_BEGIN(pta, "Demanding the points-to set of node " << n->getID());
+
+    _demandQueue.push_back(n);
+    diffDemandFixpoint();
+
+    DBG_SECTION_END(pta, "Demanded " << _demandedNodesNum << " nodes in total");
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/PointsToSet.h"
+#include "dg/analysis/PointsTo/PointerGraph.h"
+#include "dg/analysis/PointsTo/PointerAnalysisFI.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+// The flow-insensitive analysis computes the least fixpoint, so the points-to
+// sets that do not depend on the removed nodes do not change when the graph
+// changes. The sets that may depend on them are the sets of the nodes
+// reachable from the removed nodes via the use edges and via the memory
+// objects that are written by the reached nodes (the readers of these objects
+// are reached too). Such nodes and objects are reset to the initial state
+// and only they (together with the new nodes and the nodes that write to
+// the reset objects) are processed by the difference propagation again.
+// Everything else is taken from the previous run.
+
+// the points-to sets of these nodes are set when building
+// the graph and the analysis does not change them
+static bool hasInitialPointsTo(PSNode *n) {
+    if (n->getOperandsNum() == 0)
+        return true;
+
+    switch (n->getType()) {
+        case PSNodeType::ALLOC:
+        case PSNodeType::FUNCTION:
+        case PSNodeType::CONSTANT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// the pointer to the memory that the node writes to
+static PSNode *getWrittenPointer(PSNode *n) {
+    if (n->getType() == PSNodeType::STORE)
+        return n->getOperand(1);
+    if (n->getType() == PSNodeType::MEMCPY)
+        return PSNodeMemcpy::get(n)->getDestination();
+    return nullptr;
+}
+
+// the pointer to the memory that the node reads from
+static PSNode *getReadPointer(PSNode *n) {
+    if (n->getType() == PSNodeType::LOAD)
+        return n->getOperand(0);
+    if (n->getType() == PSNodeType::MEMCPY)
+        return PSNodeMemcpy::get(n)->getSource();
+    return nullptr;
+}
+
+void PointerAnalysisFI::diffMarkActive() {
+    diffResize();
+
+    // the parallel solver does not keep the flags, so find the nodes
+    // that took part in the fixpoint (for the incremental analysis)
+    for (auto& flags : _flags)
+        flags &= ~ACTIVE;
+    for (PSNode *n : PS->getNodes(PS->getEntry()->getRoot()))
+        _flags[n->getID()] |= ACTIVE;
+
+    _solvedNodesNum = PS->size();
+}
+
+// Reset the nodes and memory objects that may depend on the nodes 'from'.
+// The nodes from 'removed' are going to be removed from the graph,
+// they are not reset.
+bool PointerAnalysisFI::diffRetract(const std::vector<PSNode *>& from,
+                                    const std::unordered_set<PSNode *>& removed) {
+    auto isActive = [this](PSNode *n) { return _flags[n->getID()] & ACTIVE; };
+
+    // the active nodes that read the memory of the given (memory) node
+    std::unordered_map<PSNode *, std::vector<PSNode *>> readers;
+    for (auto& nd : PS->getNodes()) {
+        PSNode *n = nd.get();
+        if (!n || !isActive(n))
+            continue;
+
+        if (PSNode *ptr = getReadPointer(n)) {
+            for (const Pointer& p : ptr->pointsTo) {
+                if (canBeDereferenced(p))
+                    readers[getMemoryNode(p.target)].push_back(n);
+            }
+        }
+    }
+
+    std::unordered_set<PSNode *> affected;
+    std::unordered_set<PSNode *> memory;
+    ADT::QueueFIFO<PSNode *> queue;
+    auto reach = [&affected, &queue](PSNode *n) {
+        if (affected.insert(n).second)
+            queue.push(n);
+    };
+
+    for (PSNode *n : from)
+        reach(n);
+
+    while (!queue.empty()) {
+        PSNode *n = queue.pop();
+
+        switch (n->getType()) {
+            case PSNodeType::FORK:
+            case PSNodeType::JOIN:
+                return false;
+            case PSNodeType::CALL_FUNCPTR:
+                // we cannot take back the subgraphs built for the call
+                if (!n->pointsTo.empty() && removed.count(n) == 0)
+                    return false;
+                break;
+            default:
+                break;
+        }
+
+        for (PSNode *user : n->getUsers())
+            reach(user);
+
+        // only the active nodes wrote to memory
+        PSNode *ptr = isActive(n) ? getWrittenPointer(n) : nullptr;
+        if (!ptr)
+            continue;
+
+        for (const Pointer& p : ptr->pointsTo) {
+            if (!canBeDereferenced(p))
+                continue;
+
+            PSNode *mem = getMemoryNode(p.target);
+            if (!memory.insert(mem).second)
+                continue;
+
+            auto it = readers.find(mem);
+            if (it == readers.end())
+                continue;
+
+            for (PSNode *reader : it->second)
+                reach(reader);
+        }
+    }
+
+    for (PSNode *n : affected) {
+        auto id = n->getID();
+        if (removed.count(n) > 0) {
+            _flags[id] = 0;
+            _delta[id].clear();
+            continue;
+        }
+
+        if (!hasInitialPointsTo(n))
+            n->pointsTo.clear();
+        _flags[id] |= RETRACTED;
+    }
+
+    for (PSNode *mem : memory) {
+        if (removed.count(mem) > 0)
+            continue;
+
+        if (MemoryObject *mo = mem->getData<MemoryObject>())
+            mo->pointsTo.clear();
+        _retractedMemory.insert(mem);
+    }
+
+    DBG(pta, "Retracted " << affected.size() << " nodes and "
+             << memory.size() << " memory objects");
+
+    return true;
+}
+
+bool PointerAnalysisFI::retract(const std::vector<PSNode *>& nodes) {
+    // the graph is not solved yet
+    if (_demanding)
+        return false;
+
+    diffResize();
+
+    std::unordered_set<PSNode *> removed(nodes.begin(), nodes.end());
+    return diffRetract(nodes, removed);
+}
+
+bool PointerAnalysisFI::reanalyze(const std::vector<PointerSubgraph *>& newSubgraphs) {
+    DBG_SECTION_BEGIN(pta, "Re-running pointer analysis (difference propagation)");
+
+    diffResize();
+
+    // the cycles may not exist anymore, so start collapsing
+    // from scratch (the collapsed nodes got the points-to
+    // sets of their cycles in diffFinish())
+    std::fill(_rep.begin(), _rep.end(), nullptr);
+    _collapsed.clear();
+    _checkedEdges.clear();
+
+    if (options.preprocessGeps) {
+        for (PointerSubgraph *sg : newSubgraphs)
+            preprocessGEPs(*sg);
+    }
+
+    PSNode *root = PS->getEntry()->getRoot();
+    assert(root && "Do not have root of PS");
+    auto nodes = PS->getNodes(root);
+
+    std::vector<bool> reachable(_flags.size(), false);
+    for (PSNode *n : nodes)
+        reachable[n->getID()] = true;
+
+    // the nodes that are not reachable anymore do not take part
+    // in the fixpoint, so retract what they contributed
+    std::vector<PSNode *> unreachable;
+    for (auto& nd : PS->getNodes()) {
+        if (nd && (_flags[nd->getID()] & ACTIVE) && !reachable[nd->getID()])
+            unreachable.push_back(nd.get());
+    }
+
+    if (!unreachable.empty() && !diffRetract(unreachable, {})) {
+        _retractedMemory.clear();
+        DBG_SECTION_END(pta, "Re-running pointer analysis failed");
+        return false;
+    }
+
+    for (auto& nd : PS->getNodes()) {
+        if (nd && !reachable[nd->getID()])
+            _flags[nd->getID()] = 0;
+    }
+
+    // new nodes, nodes that were not reachable before
+    // and the retracted nodes
+    std::vector<PSNode *> changed;
+    for (PSNode *n : nodes) {
+        auto& flags = _flags[n->getID()];
+        if (!(flags & ACTIVE) || (flags & RETRACTED))
+            changed.push_back(n);
+        flags = ACTIVE;
+    }
+
+    // the users of new nodes that are not reachable
+    // read the initial points-to sets of the nodes
+    for (auto& nd : PS->getNodes()) {
+        if (!nd || nd->getID() < _solvedNodesNum || reachable[nd->getID()])
+            continue;
+
+        for (PSNode *user : nd->getUsers()) {
+            if (_flags[user->getID()] & ACTIVE)
+                changed.push_back(user);
+        }
+    }
+
+    // gather the readers of memory objects again (the parallel
+    // solver does not track them and some of them were removed)
+    // and find the nodes that write to the retracted memory
+    _trackReaders = true;
+    _readers.clear();
+    std::vector<MemoryObject *> objects;
+    for (PSNode *n : nodes) {
+        if (PSNode *ptr = getReadPointer(n)) {
+            for (const Pointer& p : ptr->pointsTo) {
+                if (!canBeDereferenced(p))
+                    continue;
+                objects.clear();
+                getMemoryObjects(n, p, objects);
+            }
+        }
+
+        if (PSNode *ptr = getWrittenPointer(n)) {
+            for (const Pointer& p : ptr->pointsTo) {
+                if (canBeDereferenced(p) &&
+                    _retractedMemory.count(getMemoryNode(p.target)) > 0) {
+                    changed.push_back(n);
+                    break;
+                }
+            }
+        }
+    }
+
+    // the global nodes may write to the retracted memory too
+    processGlobals();
+
+    for (PSNode *n : changed) {
+        if (!n->pointsTo.empty())
+            _delta[n->getID()].add(n->pointsTo);
+        diffSchedule(n, true /* full */);
+    }
+
+    DBG(pta, "Re-processing " << changed.size() << " nodes");
+
+    while (!_worklist.empty()) {
+        diffProcess(_worklist.pop());
+        ++_processedNodesNum;
+    }
+
+    diffFinish();
+    _retractedMemory.clear();
+    _solvedNodesNum = PS->size();
+
+    sanityCheck();
+
+    DBG_SECTION_END(pta, "Re-running pointer analysis (difference propagation) done");
+    return true;
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
@@ -0,0 +1,465 @@
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/PointsToSet.h"
+#include "dg/analysis/PointsTo/PointerGraph.h"
+#include "dg/analysis/PointsTo/PointerAnalysisFI.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+// The parallel solver computes the same fixpoint as the difference
+// propagation: a node is processed again whenever the points-to set
+// of its operand or a memory object that it reads changes.
+// The nodes are processed with the whole points-to sets of the operands
+// (there are no deltas), so the order of processing does not matter.
+//
+// Every thread has its own queue of nodes. A thread takes the nodes
+// from the back of its queue and when the queue is empty, it steals
+// the nodes from the front of the queues of other threads.
+// The points-to sets of nodes and the contents of memory objects are
+// guarded by locks that are picked by the ID of the node (of the allocation).
+// A thread holds at most one of these locks at a time.
+//
+// Nodes that may change the graph (calls via pointers, forks and joins)
+// or that work with more memory objects at once (memcpy) are not processed
+// by the threads. These are processed when all the threads have finished
+// and then the threads are started again (if there is some work to do).
+class PointerAnalysisFI::ParallelSolver {
+    // the nodes queued by one thread
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<PSNode *> nodes;
+        size_t processed{0};
+    };
+
+    // the memory object of an allocation and the loads that read it
+    struct ObjectInfo {
+        MemoryObject *object{nullptr};
+        std::unordered_set<PSNode *> readers;
+    };
+
+    static const size_t LOCKS_NUM = 1024;
+
+    PointerAnalysisFI *PA;
+    PointerGraph *PS;
+    unsigned threadsNum;
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    // the number of queued nodes that have not been processed yet
+    std::atomic<size_t> pending{0};
+
+    // Indexed by the IDs of nodes. The vectors are resized only
+    // when the threads do not run (the graph does not change
+    // while the threads run).
+    //
+    // the node is reachable and takes part in the analysis
+    std::vector<bool> active;
+    // the node is in some queue (or among the deferred nodes)
+    std::deque<std::atomic<bool>> inQueue;
+    // indexed by the IDs of allocations
+    std::vector<ObjectInfo> objects;
+    // how many nodes and globals of the graph we have seen
+    size_t nodesNum{0};
+    size_t globalsNum{0};
+
+    std::vector<std::mutex> nodeLocks;
+    std::vector<std::mutex> objectLocks;
+
+    // nodes that must be processed when the threads do not run
+    std::mutex deferredLock;
+    std::vector<PSNode *> deferred;
+
+    std::mutex& lockOf(PSNode *n) {
+        return nodeLocks[n->getID() % LOCKS_NUM];
+    }
+
+    std::mutex& lockOf(ObjectInfo& info) {
+        return objectLocks[info.object->node->getID() % LOCKS_NUM];
+    }
+
+    PointsToSetT getPointsTo(PSNode *n) {
+        std::lock_guard<std::mutex> guard(lockOf(n));
+        return n->pointsTo;
+    }
+
+    void createObject(PSNode *mem) {
+        std::vector<MemoryObject *> objs;
+        PA->getMemoryObjects(mem, Pointer(mem, 0), objs);
+        assert(objs.size() == 1);
+        objects[mem->getID()].object = objs[0];
+    }
+
+    // the graph may have new nodes
+    void resize() {
+        size_t size = PS->size() + 1;
+        if (active.size() < size) {
+            active.resize(size, false);
+            objects.resize(size);
+            while (inQueue.size() < size)
+                inQueue.emplace_back(false);
+        }
+
+        // create the objects of new allocations now,
+        // so that the threads only look them up
+        auto update = [this](const PointerGraph::NodesT& nodes, size_t& num) {
+            for (; num < nodes.size(); ++num) {
+                PSNode *n = nodes[num].get();
+                if (n && (n->getType() == PSNodeType::ALLOC ||
+                          n->getType() == PSNodeType::UNKNOWN_MEM))
+                    createObject(n);
+            }
+        };
+
+        update(PS->getGlobals(), globalsNum);
+        update(PS->getNodes(), nodesNum);
+    }
+
+    void schedule(PSNode *n, unsigned thread) {
+        if (!active[n->getID()])
+            return;
+        if (inQueue[n->getID()].exchange(true))
+            return;
+
+        ++pending;
+        auto& queue = *queues[thread];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.nodes.push_back(n);
+    }
+
+    void scheduleReachable(PSNode *from) {
+        resize();
+
+        unsigned thread = 0;
+        for (PSNode *n : PS->getNodes(from)) {
+            active[n->getID()] = true;
+            schedule(n, thread);
+            thread = (thread + 1) % threadsNum;
+        }
+    }
+
+    void defer(PSNode *n) {
+        // the node may have been queued again meanwhile,
+        // then it gets deferred later
+        if (inQueue[n->getID()].exchange(true))
+            return;
+
+        std::lock_guard<std::mutex> guard(deferredLock);
+        deferred.push_back(n);
+    }
+
+    PSNode *take(unsigned thread) {
+        for (unsigned i = 0; i < threadsNum; ++i) {
+            auto& queue = *queues[(thread + i) % threadsNum];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (queue.nodes.empty())
+                continue;
+
+            PSNode *n;
+            if (i == 0) {
+                n = queue.nodes.back();
+                queue.nodes.pop_back();
+            } else {
+                n = queue.nodes.front();
+                queue.nodes.pop_front();
+            }
+            return n;
+        }
+
+        return nullptr;
+    }
+
+    bool addPointsTo(PSNode *n, const PointsToSetT& pointers, unsigned thread) {
+        bool changed;
+        {
+            std::lock_guard<std::mutex> guard(lockOf(n));
+            changed = n->addPointsTo(pointers);
+        }
+
+        if (changed) {
+            for (PSNode *user : n->getUsers())
+                schedule(user, thread);
+        }
+
+        return changed;
+    }
+
+    // can the memory that the pointer points to have a memory object?
+    static bool hasObject(const Pointer& ptr) {
+        return canBeDereferenced(ptr) &&
+               getMemoryNode(ptr.target)->getType() != PSNodeType::FUNCTION;
+    }
+
+    // get the object of the memory that 'target' points to,
+    // return nullptr if the object must be created first
+    // and we cannot do that now (the threads run)
+    ObjectInfo *getObject(PSNode *target, bool parallel) {
+        PSNode *mem = getMemoryNode(target);
+        assert(mem->getID() < objects.size());
+
+        auto& info = objects[mem->getID()];
+        if (!info.object) {
+            if (parallel)
+                return nullptr;
+            createObject(mem);
+        }
+
+        return &info;
+    }
+
+    bool processLoad(PSNode *n, bool parallel, unsigned thread) {
+        PointsToSetT pointers = getPointsTo(n->getOperand(0));
+        PointsToSetT out;
+
+        for (const Pointer& ptr : pointers) {
+            if (ptr.isUnknown()) {
+                // load from unknown pointer yields unknown pointer
+                out.add(UnknownPointer);
+                continue;
+            }
+
+            if (!hasObject(ptr))
+                continue;
+
+            ObjectInfo *info = getObject(ptr.target, parallel);
+            if (!info)
+                return false;
+
+            // register the reader together with reading the object,
+            // so that every later change of the object schedules the load
+            std::lock_guard<std::mutex> guard(lockOf(*info));
+            info->readers.insert(n);
+            PA->processLoad(n, ptr, info->object, true /* single */, out);
+        }
+
+        addPointsTo(n, out, thread);
+        return true;
+    }
+
+    bool processStore(PSNode *n, bool parallel, unsigned thread) {
+        PointsToSetT values = getPointsTo(n->getOperand(0));
+        PointsToSetT pointers = getPointsTo(n->getOperand(1));
+        std::vector<PSNode *> readers;
+
+        for (const Pointer& ptr : pointers) {
+            if (!hasObject(ptr))
+                continue;
+
+            ObjectInfo *info = getObject(ptr.target, parallel);
+            if (!info)
+                return false;
+
+            readers.clear();
+            {
+                std::lock_guard<std::mutex> guard(lockOf(*info));
+                if (info->object->addPointsTo(ptr.offset, values))
+                    readers.assign(info->readers.begin(), info->readers.end());
+            }
+
+            for (PSNode *reader : readers)
+                schedule(reader, thread);
+        }
+
+        return true;
+    }
+
+    // process the node, return false if the node
+    // cannot be processed while the threads run
+    bool process(PSNode *n, bool parallel, unsigned thread) {
+        PointsToSetT pointers;
+
+        switch (n->getType()) {
+            case PSNodeType::CAST:
+            case PSNodeType::PHI:
+            case PSNodeType::RETURN:
+            case PSNodeType::CALL_RETURN:
+                for (PSNode *op : n->getOperands()) {
+                    std::lock_guard<std::mutex> guard(lockOf(op));
+                    pointers.add(op->pointsTo);
+                }
+                addPointsTo(n, pointers, thread);
+                return true;
+            case PSNodeType::GEP:
+                {
+                    PSNode *op = n->getOperand(0);
+                    std::lock_guard<std::mutex> guard(lockOf(op));
+                    PA->processGep(n, op->pointsTo, pointers);
+                }
+                addPointsTo(n, pointers, thread);
+                return true;
+            case PSNodeType::LOAD:
+                return processLoad(n, parallel, thread);
+            case PSNodeType::STORE:
+                return processStore(n, parallel, thread);
+            case PSNodeType::ALLOC:
+            case PSNodeType::FUNCTION:
+            case PSNodeType::CONSTANT:
+            case PSNodeType::CALL:
+            case PSNodeType::ENTRY:
+            case PSNodeType::NOOP:
+            case PSNodeType::FREE:
+            case PSNodeType::INVALIDATE_OBJECT:
+                // nothing to do with these in the flow-insensitive analysis
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // process a node that cannot be processed while the threads run
+    void processSequential(PSNode *n) {
+        if (process(n, false /* parallel */, 0))
+            return;
+
+        // memcpy reads the source objects and writes the destination objects
+        std::vector<ObjectInfo *> written;
+        if (n->getType() == PSNodeType::MEMCPY) {
+            for (const Pointer& ptr : PSNodeMemcpy::get(n)->getSource()->pointsTo) {
+                if (hasObject(ptr))
+                    getObject(ptr.target, false)->readers.insert(n);
+            }
+            for (const Pointer& ptr : PSNodeMemcpy::get(n)->getDestination()->pointsTo) {
+                if (hasObject(ptr))
+                    written.push_back(getObject(ptr.target, false));
+            }
+        }
+
+        bool changed = PA->processNode(n);
+        // processing the node may have created new nodes
+        resize();
+
+        if (!changed)
+            return;
+
+        for (ObjectInfo *info : written) {
+            for (PSNode *reader : info->readers)
+                schedule(reader, 0);
+        }
+
+        switch (n->getType()) {
+            case PSNodeType::CALL_FUNCPTR:
+            case PSNodeType::FORK:
+            case PSNodeType::JOIN:
+                // the graph may have changed
+                scheduleReachable(n);
+                break;
+            default:
+                if (!n->pointsTo.empty()) {
+                    for (PSNode *user : n->getUsers())
+                        schedule(user, 0);
+                }
+        }
+    }
+
+    void work(unsigned thread) {
+        auto& processed = queues[thread]->processed;
+
+        while (true) {
+            PSNode *n = take(thread);
+            if (!n) {
+                // no work for us, but other threads may still create some
+                if (pending == 0)
+                    return;
+                std::this_thread::yield();
+                continue;
+            }
+
+            // clear the flag before reading the operands, so that
+            // any later change of the operands queues the node again
+            inQueue[n->getID()] = false;
+            if (!process(n, true /* parallel */, thread))
+                defer(n);
+
+            ++processed;
+            --pending;
+        }
+    }
+
+    void runThreads() {
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < threadsNum; ++i)
+            threads.emplace_back(&ParallelSolver::work, this, i);
+
+        // this thread is the first worker
+        work(0);
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+public:
+    ParallelSolver(PointerAnalysisFI *pa, unsigned threads)
+    : PA(pa), PS(pa->PS), threadsNum(threads),
+      nodeLocks(LOCKS_NUM), objectLocks(LOCKS_NUM) {
+        assert(threadsNum > 0);
+        for (unsigned i = 0; i < threadsNum; ++i)
+            queues.emplace_back(new WorkQueue());
+    }
+
+    void run() {
+        PSNode *root = PS->getEntry()->getRoot();
+        assert(root && "Do not have root of PS");
+        scheduleReachable(root);
+
+        while (true) {
+            runThreads();
+            assert(pending == 0);
+
+            if (deferred.empty())
+                break;
+
+            std::vector<PSNode *> nodes;
+            nodes.swap(deferred);
+            for (PSNode *n : nodes) {
+                inQueue[n->getID()] = false;
+                processSequential(n);
+                ++queues[0]->processed;
+            }
+        }
+
+        PA->_threadProcessedNodes.clear();
+        for (auto& queue : queues) {
+            PA->_threadProcessedNodes.push_back(queue->processed);
+            PA->_processedNodesNum += queue->processed;
+        }
+    }
+};
+
+void PointerAnalysisFI::runParallel() {
+    DBG_SECTION_BEGIN(pta, "Running pointer analysis (parallel)");
+
+    unsigned threads = options.solverThreads;
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    if (ChangesPointerIdTable<PointsToSetT>::value && threads > 1) {
+        // the threads would change the table of the graph at once
+        DBG(pta, "The points-to sets share the table of pointers, using one thread");
+        threads = 1;
+    }
+
+    preprocess();
+
+    // check that the current state of pointer analysis makes sense
+    sanityCheck();
+
+    processGlobals();
+
+    ParallelSolver(this, threads).run();
+
+    sanityCheck();
+
+    DBG_SECTION_END(pta, "Running pointer analysis (parallel) done");
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
@@ -0,0 +1,309 @@
+#include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/PointsToSet.h"
+#include "dg/analysis/PointsTo/PointerGraph.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+// The flow-sensitive phase follows the semantics of PointerAnalysisFS:
+// the contents of an object on a node is the union of the contents
+// on the predecessors of the node (including the call and return edges)
+// and a store to memory that is not allocated in a loop overwrites
+// the offsets that it stores to (strong update). Nodes that do not write
+// the object do not change its contents, so the contents on a node
+// is the union of the contents after the nearest writes of the object
+// on the paths to the node. These writes are found by searching
+// the control flow forward from every write until another write
+// of the same object is found.
+
+std::vector<PSNode *> PointerAnalysisSFS::sparseGetNodes() {
+    std::vector<PSNode *> nodes;
+    for (auto& glob : PS->getGlobals())
+        nodes.push_back(glob.get());
+
+    PSNode *root = PS->getEntry()->getRoot();
+    assert(root && "Do not have root of PS");
+    auto reachable = PS->getNodes(root);
+    nodes.insert(nodes.end(), reachable.begin(), reachable.end());
+    return nodes;
+}
+
+void PointerAnalysisSFS::sparseAddAccesses(PSNode *n, PSNode *ptrNode, bool def) {
+    auto& states = _states[n->getID()];
+    for (const Pointer& ptr : ptrNode->pointsTo) {
+        if (!canBeDereferenced(ptr))
+            continue;
+
+        auto& st = states[ptr.target];
+        st.isDef |= def;
+    }
+}
+
+// connect the write 'def' of 'target' with the reads
+// and writes of 'target' that the write reaches
+void PointerAnalysisSFS::sparseConnect(PSNode *def, PSNode *target,
+                                       std::vector<unsigned>& visited,
+                                       unsigned mark) {
+    auto& defState = _states[def->getID()][target];
+    std::vector<PSNode *> stack(_memSuccs[def->getID()]);
+    while (!stack.empty()) {
+        PSNode *cur = stack.back();
+        stack.pop_back();
+
+        if (visited[cur->getID()] == mark)
+            continue;
+        visited[cur->getID()] = mark;
+
+        auto& states = _states[cur->getID()];
+        auto it = states.find(target);
+        if (it != states.end()) {
+            it->second.defs.push_back(def);
+            defState.uses.push_back(cur);
+            ++_defUseEdgesNum;
+
+            // this write hides the previous writes
+            if (it->second.isDef)
+                continue;
+        }
+
+        for (PSNode *succ : _memSuccs[cur->getID()])
+            stack.push_back(succ);
+    }
+}
+
+void PointerAnalysisSFS::sparseBuildDefUse(const std::vector<PSNode *>& nodes) {
+    size_t size = PS->size() + 1;
+    _states.resize(size);
+    _memSuccs.resize(size);
+
+    PSNode *root = PS->getEntry()->getRoot();
+    auto addEdge = [this](PSNode *from, PSNode *to) {
+        _memSuccs[from->getID()].push_back(to);
+    };
+
+    // the same edges along which PointerAnalysisFS merges memory maps
+    for (PSNode *n : nodes) {
+        for (PSNode *pred : n->getPredecessors())
+            addEdge(pred, n);
+        if (auto CR = PSNodeCallRet::get(n)) {
+            for (PSNode *ret : CR->getReturns())
+                addEdge(ret, n);
+        }
+        if (auto E = PSNodeEntry::get(n)) {
+            for (PSNode *caller : E->getCallers())
+                addEdge(caller, n);
+        }
+    }
+
+    // the entry gets the state after the initialization of globals
+    for (auto& glob : PS->getGlobals())
+        addEdge(glob.get(), root);
+
+    // find out who reads and writes what (using the results
+    // of the flow-insensitive analysis)
+    for (PSNode *n : nodes) {
+        switch (n->getType()) {
+            case PSNodeType::STORE:
+                sparseAddAccesses(n, n->getOperand(1), true /* def */);
+                break;
+            case PSNodeType::LOAD:
+                sparseAddAccesses(n, n->getOperand(0), false /* def */);
+                break;
+            case PSNodeType::MEMCPY:
+                sparseAddAccesses(n, PSNodeMemcpy::get(n)->getSource(), false);
+                sparseAddAccesses(n, PSNodeMemcpy::get(n)->getDestination(), true);
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::vector<unsigned> visited(size, 0);
+    unsigned mark = 0;
+    for (PSNode *n : nodes) {
+        for (auto& it : _states[n->getID()]) {
+            if (it.second.isDef)
+                sparseConnect(n, it.first, visited, ++mark);
+        }
+    }
+
+    for (PSNode *n : nodes) {
+        for (auto& it : _states[n->getID()]) {
+            auto& st = it.second;
+            // a read reached by a single write uses the object of the write,
+            // memcpy must have an object to copy from (as in PointerAnalysisFS)
+            if (st.isDef || st.defs.size() > 1 ||
+                (st.defs.empty() && n->getType() == PSNodeType::MEMCPY))
+                st.object.reset(new MemoryObject(it.first));
+        }
+    }
+
+    DBG(pta, "Created " << _defUseEdgesNum << " def-use edges over memory");
+}
+
+// The flow-sensitive phase computes the points-to sets of the nodes
+// that read pointers again. Nodes whose points-to sets are set by the builder
+// or that resolve calls via function pointers keep their sets (the graph
+// was already built for all the called functions).
+void PointerAnalysisSFS::sparseResetPointsTo(const std::vector<PSNode *>& nodes) {
+    for (PSNode *n : nodes) {
+        switch (n->getType()) {
+            case PSNodeType::LOAD:
+            case PSNodeType::GEP:
+            case PSNodeType::CAST:
+            case PSNodeType::PHI:
+            case PSNodeType::RETURN:
+                n->pointsTo.clear();
+                break;
+            case PSNodeType::CALL_RETURN:
+                // calls of undefined functions via pointers
+                // add the unknown pointer here
+                if (n->getPairedNode()->getType() != PSNodeType::CALL_FUNCPTR)
+                    n->pointsTo.clear();
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+MemoryObject *PointerAnalysisSFS::sparseGetObject(PSNode *n, PSNode *target) {
+    auto& states = _states[n->getID()];
+    auto it = states.find(target);
+    if (it == states.end())
+        return nullptr;
+
+    auto& st = it->second;
+    if (st.object)
+        return st.object.get();
+    if (st.defs.empty())
+        return nullptr;
+
+    assert(st.defs.size() == 1);
+    return sparseGetObject(st.defs[0], target);
+}
+
+void PointerAnalysisSFS::getMemoryObjects(PSNode *where, const Pointer& pointer,
+                                          std::vector<MemoryObject *>& objects) {
+    if (!_sparse) {
+        PointerAnalysisFI::getMemoryObjects(where, pointer, objects);
+        return;
+    }
+
+    if (MemoryObject *mo = sparseGetObject(where, pointer.target)) {
+        objects.push_back(mo);
+        return;
+    }
+
+    // the flow-sensitive results are a subset of the flow-insensitive
+    // results, so every write must have been found in the first phase
+    assert(where->getType() != PSNodeType::STORE &&
+           where->getType() != PSNodeType::MEMCPY &&
+           "A write that the flow-insensitive analysis did not find");
+}
+
+void PointerAnalysisSFS::sparseSchedule(PSNode *n) {
+    auto& flags = _sparseFlags[n->getID()];
+    // process only the nodes that the flow-sensitive analysis would process
+    if ((flags & ACTIVE) && !(flags & IN_QUEUE)) {
+        flags |= IN_QUEUE;
+        _queue.push(n);
+    }
+}
+
+void PointerAnalysisSFS::sparseProcess(PSNode *n) {
+    auto& states = _states[n->getID()];
+
+    // gather the contents of objects for reads reached by more writes
+    for (auto& it : states) {
+        auto& st = it.second;
+        if (st.isDef || st.defs.size() < 2)
+            continue;
+        for (PSNode *def : st.defs)
+            st.object->merge(*sparseGetObject(def, it.first));
+    }
+
+    size_t ptsNum = n->pointsTo.size();
+    bool changed = processNode(n);
+    bool writes = n->getType() == PSNodeType::STORE ||
+                  n->getType() == PSNodeType::MEMCPY;
+    bool memChanged = writes && changed;
+
+    if (writes) {
+        PointsToSetT *overwritten = nullptr;
+        if (n->getType() == PSNodeType::STORE &&
+            !PointerAnalysisFS::pointsToAllocationInLoop(n->getOperand(1)))
+            overwritten = &n->getOperand(1)->pointsTo;
+
+        for (auto& it : states) {
+            auto& st = it.second;
+            if (!st.isDef)
+                continue;
+            for (PSNode *def : st.defs) {
+                memChanged |= PointerAnalysisFS::mergeObjects(
+                                it.first, st.object.get(),
+                                sparseGetObject(def, it.first), overwritten);
+            }
+        }
+    }
+
+    if (n->pointsTo.size() != ptsNum || (changed && !writes)) {
+        for (PSNode *user : n->getUsers())
+            sparseSchedule(user);
+    }
+
+    if (memChanged) {
+        for (auto& it : states) {
+            for (PSNode *use : it.second.uses)
+                sparseSchedule(use);
+        }
+
+        // memcpy reads what it writes
+        if (n->getType() == PSNodeType::MEMCPY)
+            sparseSchedule(n);
+    }
+}
+
+void PointerAnalysisSFS::runSparse() {
+    DBG_SECTION_BEGIN(pta, "Running sparse flow-sensitive pointer analysis");
+
+#ifndef NDEBUG
+    size_t graphSize = PS->size();
+#endif
+
+    // the graph is complete now
+    PS->computeLoops();
+
+    auto nodes = sparseGetNodes();
+    sparseBuildDefUse(nodes);
+    sparseResetPointsTo(nodes);
+
+    _sparse = true;
+    _sparseFlags.resize(PS->size() + 1, 0);
+    for (PSNode *n : nodes)
+        _sparseFlags[n->getID()] = ACTIVE;
+    for (PSNode *n : nodes)
+        sparseSchedule(n);
+
+    while (!_queue.empty()) {
+        PSNode *n = _queue.pop();
+        _sparseFlags[n->getID()] &= ~IN_QUEUE;
+        sparseProcess(n);
+        ++_processedNodesNum;
+    }
+
+    assert(PS->size() == graphSize &&
+           "The graph changed in the flow-sensitive phase");
+
+    sanityCheck();
+
+    DBG_SECTION_END(pta, "Running sparse flow-sensitive pointer analysis done");
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/analysis/PointsTo/PointerGraph.h"
+#include "dg/analysis/PointsTo/PointerGraphOptimizations.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+// the maximal number of the base labels in the label of a node,
+// the nodes with bigger unions get a new label (they are not merged)
+static const size_t LABEL_MAX_SIZE = 32;
+
+namespace {
+
+// The labels of the nodes. A label is a set of base labels,
+// the points-to set of a node is the union of the points-to sets
+// that the base labels stand for.
+class PointerLabels {
+    using BaseKeyT = std::tuple<unsigned, unsigned, Offset::type>;
+
+    std::vector<std::vector<unsigned>> _sets;
+    std::map<std::vector<unsigned>, unsigned> _labels;
+    std::map<BaseKeyT, unsigned> _bases;
+    unsigned _basesNum{0};
+
+    unsigned getLabel(std::vector<unsigned>&& set) {
+        auto it = _labels.find(set);
+        if (it != _labels.end())
+            return it->second;
+
+        unsigned label = _sets.size();
+        _labels.emplace(set, label);
+        _sets.push_back(std::move(set));
+        return label;
+    }
+
+public:
+    // a label that is not equal to any other label
+    unsigned fresh() { return getLabel({_basesNum++}); }
+
+    // the label of the pointers that are computed from the pointers
+    // with label 'label' by the operation 'kind' with 'offset'
+    unsigned get(PSNodeType kind, unsigned label, Offset offset = 0) {
+        BaseKeyT key{static_cast<unsigned>(kind), label, *offset};
+        auto it = _bases.find(key);
+        if (it == _bases.end())
+            it = _bases.emplace(key, _basesNum++).first;
+
+        return getLabel({it->second});
+    }
+
+    // the label of the union of the labels
+    unsigned join(const std::vector<unsigned>& labels) {
+        if (labels.empty())
+            return fresh();
+
+        std::vector<unsigned> set;
+        for (unsigned label : labels) {
+            const auto& s = _sets[label];
+            set.insert(set.end(), s.begin(), s.end());
+        }
+
+        std::sort(set.begin(), set.end());
+        set.erase(std::unique(set.begin(), set.end()), set.end());
+        if (set.size() > LABEL_MAX_SIZE)
+            return fresh();
+
+        return getLabel(std::move(set));
+    }
+};
+
+} // anonymous namespace
+
+static bool isCopy(PSNode *nd) {
+    if (nd->getType() == PSNodeType::CAST ||
+        nd->getType() == PSNodeType::PHI)
+        return true;
+
+    PSNodeGep *GEP = PSNodeGep::get(nd);
+    return GEP && GEP->getOffset().isZero();
+}
+
+unsigned PSPointerEquivalenceMerger::run() {
+    if (!PS->getEntry())
+        return 0;
+
+    DBG_SECTION_BEGIN(pta, "Merging equivalent pointers");
+
+    // the nodes that may be merged
+    auto nodes = PS->getNodes(PS->getEntry()->getRoot());
+
+    size_t size = PS->size() + 1;
+    std::vector<PSNode *> byId(size, nullptr);
+    for (PSNode *nd : nodes)
+        byId[nd->getID()] = nd;
+
+    auto inScope = [&byId, size](const PSNode *nd) {
+        return nd->getID() < size && byId[nd->getID()] == nd;
+    };
+
+    // find the SCCs of the graph of operands (Tarjan's algorithm).
+    // The SCCs are found in the topological order (operands first).
+    std::vector<std::vector<PSNode *>> sccs;
+    std::vector<unsigned> index(size, 0);
+    std::vector<unsigned> lowpt(size, 0);
+    std::vector<unsigned> scc(size, 0);
+    std::vector<bool> onStack(size, false);
+    std::vector<PSNode *> stack;
+    // the DFS stack of nodes and the index of the next operand to visit
+    std::vector<std::pair<PSNode *, size_t>> dfs;
+    unsigned dfsnum = 0;
+
+    auto visit = [&](PSNode *n) {
+        index[n->getID()] = lowpt[n->getID()] = ++dfsnum;
+        stack.push_back(n);
+        onStack[n->getID()] = true;
+        dfs.emplace_back(n, 0);
+    };
+
+    for (PSNode *start : nodes) {
+        if (index[start->getID()] != 0)
+            continue;
+
+        visit(start);
+        while (!dfs.empty()) {
+            PSNode *n = dfs.back().first;
+            unsigned id = n->getID();
+            const auto& operands = n->getOperands();
+            if (dfs.back().second < operands.size()) {
+                PSNode *op = operands[dfs.back().second++];
+                if (!inScope(op))
+                    continue;
+                if (index[op->getID()] == 0)
+                    visit(op);
+                else if (onStack[op->getID()])
+                    lowpt[id] = std::min(lowpt[id], index[op->getID()]);
+                continue;
+            }
+
+            dfs.pop_back();
+            if (!dfs.empty()) {
+                unsigned parent = dfs.back().first->getID();
+                lowpt[parent] = std::min(lowpt[parent], lowpt[id]);
+            }
+
+            if (lowpt[id] == index[id]) {
+                sccs.emplace_back();
+                PSNode *w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w->getID()] = false;
+                    scc[w->getID()] = sccs.size() - 1;
+                    sccs.back().push_back(w);
+                } while (w != n);
+            }
+        }
+    }
+
+    PointerLabels labels;
+    std::vector<unsigned> label(size, 0);
+    // the labels of the operands that are not merged
+    std::unordered_map<const PSNode *, unsigned> outLabels;
+
+    auto getLabel = [&](PSNode *op) -> unsigned {
+        if (inScope(op))
+            return label[op->getID()];
+
+        auto it = outLabels.find(op);
+        if (it == outLabels.end())
+            it = outLabels.emplace(op, labels.fresh()).first;
+        return it->second;
+    };
+
+    auto labelNode = [&](PSNode *nd) -> unsigned {
+        if (isPinned(nd))
+            return labels.fresh();
+
+        if (isCopy(nd)) {
+            std::vector<unsigned> ops;
+            for (PSNode *op : nd->getOperands())
+                ops.push_back(getLabel(op));
+            return labels.join(ops);
+        }
+
+        switch (nd->getType()) {
+            case PSNodeType::GEP:
+                return labels.get(PSNodeType::GEP, getLabel(nd->getOperand(0)),
+                                  PSNodeGep::get(nd)->getOffset());
+            case PSNodeType::LOAD:
+                return labels.get(PSNodeType::LOAD, getLabel(nd->getOperand(0)));
+            case PSNodeType::CONSTANT: {
+                // the constants pointing to the same memory
+                if (nd->pointsTo.size() != 1)
+                    return labels.fresh();
+                const Pointer ptr = *nd->pointsTo.begin();
+                return labels.get(PSNodeType::CONSTANT, getLabel(ptr.target),
+                                  ptr.offset);
+            }
+            default:
+                return labels.fresh();
+        }
+    };
+
+    // the first node with the label
+    std::unordered_map<unsigned, PSNode *> repr;
+
+    auto mergeTo = [this](PSNode *nd, PSNode *to) {
+        if (canRemove(nd))
+            merge(nd, to);
+    };
+
+    for (auto& component : sccs) {
+        PSNode *first = component.front();
+
+        bool cycle = component.size() > 1;
+        if (!cycle) {
+            for (PSNode *op : first->getOperands())
+                cycle |= op == first;
+        }
+
+        if (!cycle) {
+            unsigned l = labelNode(first);
+            label[first->getID()] = l;
+
+            auto it = repr.find(l);
+            if (it == repr.end())
+                repr.emplace(l, first);
+            else
+                mergeTo(first, it->second);
+            continue;
+        }
+
+        // a cycle of copies has the union of the pointers
+        // that come into the cycle
+        PSNode *phi = nullptr;
+        bool copies = true;
+        for (PSNode *nd : component) {
+            copies &= isCopy(nd) && !isPinned(nd);
+            if (!phi && nd->getType() == PSNodeType::PHI)
+                phi = nd;
+        }
+
+        if (!copies || !phi) {
+            for (PSNode *nd : component) {
+                label[nd->getID()] = labels.fresh();
+                repr.emplace(label[nd->getID()], nd);
+            }
+            continue;
+        }
+
+        std::vector<PSNode *> incoming;
+        std::vector<unsigned> incomingLabels;
+        for (PSNode *nd : component) {
+            for (PSNode *op : nd->getOperands()) {
+                if (inScope(op) && scc[op->getID()] == scc[nd->getID()])
+                    continue;
+                if (std::find(incoming.begin(), incoming.end(), op) != incoming.end())
+                    continue;
+                incoming.push_back(op);
+                incomingLabels.push_back(getLabel(op));
+            }
+        }
+
+        unsigned l = labels.join(incomingLabels);
+        for (PSNode *nd : component)
+            label[nd->getID()] = l;
+
+        auto it = repr.find(l);
+        if (it == repr.end()) {
+            // collapse the cycle to the phi node
+            phi->removeAllOperands();
+            for (PSNode *op : incoming)
+                phi->addOperand(op);
+            it = repr.emplace(l, phi).first;
+        }
+
+        for (PSNode *nd : component) {
+            if (nd != it->second)
+                mergeTo(nd, it->second);
+        }
+    }
+
+    DBG_SECTION_END(pta, "Merged " << getNumOfRemovedNodes() << " nodes");
+    return getNumOfRemovedNodes();
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
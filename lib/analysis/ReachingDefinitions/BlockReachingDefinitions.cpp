@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <unordered_set>
+
+#include "dg/analysis/ReachingDefinitions/RDMap.h"
+#include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
+#include "dg/ADT/Queue.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+// The map after a node contains the definitions of the node
+// and the definitions from the map before the node
+// that are not overwritten by the node.
+void BlockReachingDefinitionsAnalysis::transfer(RDNode *node, RDMap& map) {
+    RDMap after(node->def_map);
+    after.merge(&map, &node->overwrites,
+                options.strongUpdateUnknown,
+                *options.maxSetSize,
+                false /* merge unknown */);
+    map = std::move(after);
+}
+
+// Compute the definitions made in the block that reach
+// the end of the block (they are stored to the out map)
+// and the definitions overwritten in the block.
+void BlockReachingDefinitionsAnalysis::computeSummary(RDBBlock *block,
+                                                      BlockInfo& info) {
+    for (RDNode *node : block->getNodes()) {
+        transfer(node, info.out);
+        info.kill.insert(node->overwrites.begin(), node->overwrites.end());
+    }
+}
+
+bool BlockReachingDefinitionsAnalysis::processBlock(RDBBlock *block,
+                                                    BlockInfo& info) {
+    for (auto I = block->pred_begin(), E = block->pred_end(); I != E; ++I) {
+        // the nodes in dead code have no block
+        if (!*I)
+            continue;
+
+        auto it = _blocks.find(*I);
+        assert(it != _blocks.end() && "Block was not summarized");
+        info.in.merge(&it->second.out, nullptr,
+                      options.strongUpdateUnknown,
+                      *options.maxSetSize,
+                      false /* merge unknown */);
+    }
+
+    // the definitions that are overwritten anywhere in the block
+    // are overwritten also at the end of the block
+    return info.out.merge(&info.in, &info.kill,
+                          options.strongUpdateUnknown,
+                          *options.maxSetSize,
+                          false /* merge unknown */);
+}
+
+void BlockReachingDefinitionsAnalysis::run() {
+    DBG_SECTION_BEGIN(dda, "Starting block reaching definitions analysis");
+    assert(getRoot() && "Do not have root");
+
+    if (graph.getBBlocks().empty())
+        graph.buildBBlocks();
+
+    ADT::QueueFIFO<RDBBlock *> queue;
+    std::unordered_set<RDBBlock *> queued;
+
+    _blocks.reserve(graph.getBBlocks().size());
+    for (RDBBlock *block : graph.blocks()) {
+        computeSummary(block, _blocks[block]);
+        queue.push(block);
+        queued.insert(block);
+    }
+
+    DBG(dda, "Summarized " << _blocks.size() << " blocks");
+
+    // do fixpoint
+    while (!queue.empty()) {
+        RDBBlock *block = queue.pop();
+        queued.erase(block);
+
+        if (!processBlock(block, _blocks[block]))
+            continue;
+
+        for (auto I = block->succ_begin(), E = block->succ_end(); I != E; ++I) {
+            assert(*I && "Successor of a block has no block");
+            if (queued.insert(*I).second)
+                queue.push(*I);
+        }
+    }
+
+    DBG_SECTION_END(dda, "Finished block reaching definitions analysis");
+}
+
+RDMap& BlockReachingDefinitionsAnalysis::getDefinitionsMap(RDNode *where) {
+    RDBBlock *block = where->getBBlock();
+    // the node is not reachable, it has only its own definitions
+    if (!block)
+        return where->def_map;
+
+    if (block == _currentBlock && where == _currentNode)
+        return _current;
+
+    const auto& nodes = block->getNodes();
+    auto it = _nextNode;
+    // the queried node is not after the last queried node,
+    // start from the entry of the block
+    if (block != _currentBlock ||
+        std::find(it, nodes.end(), where) == nodes.end()) {
+        auto info = _blocks.find(block);
+        assert(info != _blocks.end() && "The analysis did not run");
+        _current = info->second.in;
+        _currentBlock = block;
+        it = nodes.begin();
+    }
+
+    for (; it != nodes.end(); ++it) {
+        transfer(*it, _current);
+        if (*it == where)
+            break;
+    }
+
+    assert(it != nodes.end() && "The node is not in its block");
+    _currentNode = where;
+    _nextNode = ++it;
+    return _current;
+}
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
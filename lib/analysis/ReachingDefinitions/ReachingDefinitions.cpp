@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <queue>
 #include <set>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
@@ -59,46 +65,90 @@ bool ReachingDefinitionsAnalysis::processNode(RDNode *node)
     return changed;
 }
 
+// get the nodes reachable from the root in reverse post-order
+static std::vector<RDNode *> reversePostOrder(RDNode *root)
+{
+    std::vector<RDNode *> order;
+    std::set<RDNode *> visited;
+    // the DFS stack of nodes and the index of the next successor to visit
+    std::vector<std::pair<RDNode *, size_t>> stack;
+
+    visited.insert(root);
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+        RDNode *cur = stack.back().first;
+        const auto& succs = cur->getSuccessors();
+        if (stack.back().second < succs.size()) {
+            RDNode *succ = succs[stack.back().second++];
+            if (visited.insert(succ).second)
+                stack.emplace_back(succ, 0);
+            continue;
+        }
+
+        order.push_back(cur);
+        stack.pop_back();
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
 void ReachingDefinitionsAnalysis::run()
 {
     DBG_SECTION_BEGIN(dda, "Starting reaching definitions analysis");
     assert(getRoot() && "Do not have root");
 
-    std::vector<RDNode *> to_process = getNodes(getRoot());
-    std::vector<RDNode *> changed;
-
-#ifdef DEBUG_ENABLED
-    int n = 0;
-#endif
+    std::vector<RDNode *> nodes = reversePostOrder(getRoot());
+    std::unordered_map<RDNode *, unsigned> priority;
+    priority.reserve(nodes.size());
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        priority[nodes[i]] = i;
+
+    // The nodes are processed in rounds in reverse post-order. A node
+    // is queued only when the map of its predecessor changed. If the node
+    // was already passed in this round (it is the target of a back edge),
+    // it is processed in the next round.
+    using QueueT = std::priority_queue<unsigned, std::vector<unsigned>,
+                                       std::greater<unsigned>>;
+    QueueT queue, next;
+    std::vector<bool> queued(nodes.size(), true);
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        queue.push(i);
 
     // do fixpoint
-    do {
-#ifdef DEBUG_ENABLED
-        if (n % 100 == 0) {
-            DBG(dda, "Iteration " << n << ", queued " << to_process.size() << " nodes");
-        }
-        ++n;
-#endif
-        unsigned last_processed_num = to_process.size();
-        changed.clear();
-
-        for (RDNode *cur : to_process) {
-            if (processNode(cur))
-                changed.push_back(cur);
-        }
+    while (!queue.empty()) {
+        ++_roundsNum;
+        DBG(dda, "Round " << _roundsNum << ", queued " << queue.size() << " nodes");
+
+        while (!queue.empty()) {
+            unsigned cur = queue.top();
+            queue.pop();
+            queued[cur] = false;
 
-        if (!changed.empty()) {
-            to_process.clear();
-            to_process = getNodes(changed /* starting set */,
-                                  last_processed_num /* expected num */);
+            ++_processedNodesNum;
+            if (!processNode(nodes[cur]))
+                continue;
 
-            // since changed was not empty,
-            // the to_process must not be empty too
-            assert(!to_process.empty());
+            for (RDNode *succ : nodes[cur]->getSuccessors()) {
+                assert(priority.count(succ) > 0);
+                unsigned idx = priority[succ];
+                if (queued[idx])
+                    continue;
+
+                queued[idx] = true;
+                if (idx > cur)
+                    queue.push(idx);
+                else
+                    next.push(idx);
+            }
         }
-    } while (!changed.empty());
 
-    DBG_SECTION_END(dda, "Finished reaching definitions analysis");
+        queue.swap(next);
+    }
+
+    DBG_SECTION_END(dda, "Finished reaching definitions analysis in "
+                         << _roundsNum << " rounds, processed "
+                         << _processedNodesNum << " nodes");
 }
 
 // return the reaching definitions of ('mem', 'off', 'len')
@@ -109,15 +159,16 @@ ReachingDefinitionsAnalysis::getReachingDefinitions(RDNode *where, RDNode *mem,
                                                     const Offset& len)
 {
     std::set<RDNode *> ret;
+    RDMap& map = getDefinitionsMap(where);
     if (mem->isUnknown()) {
         // gather all definitions of memory
-        for (auto& it : where->def_map) {
+        for (auto& it : map) {
             ret.insert(it.second.begin(), it.second.end());
         }
     } else {
         // gather all possible definitions of the memory
-        where->def_map.get(UNKNOWN_MEMORY, Offset::UNKNOWN, Offset::UNKNOWN, ret);
-        where->def_map.get(mem, off, len, ret);
+        map.get(UNKNOWN_MEMORY, Offset::UNKNOWN, Offset::UNKNOWN, ret);
+        map.get(mem, off, len, ret);
     }
 
     return std::vector<RDNode *>(ret.begin(), ret.end());
@@ -126,25 +177,32 @@ ReachingDefinitionsAnalysis::getReachingDefinitions(RDNode *where, RDNode *mem,
 std::vector<RDNode *>
 ReachingDefinitionsAnalysis::getReachingDefinitions(RDNode *use) {
     std::set<RDNode *> ret;
+    RDMap& map = getDefinitionsMap(use);
 
     // gather all possible definitions of the memory including the unknown mem
     for (auto& ds : use->uses) {
         if (ds.target->isUnknown()) {
             // gather all definitions of memory
-            for (auto& it : use->def_map) {
+            for (auto& it : map) {
                 ret.insert(it.second.begin(), it.second.end());
             }
             break; // we may bail out as we added everything
         }
 
-        use->def_map.get(ds.target, ds.offset, ds.len, ret);
+        map.get(ds.target, ds.offset, ds.len, ret);
     }
 
-    use->def_map.get(UNKNOWN_MEMORY, Offset::UNKNOWN, Offset::UNKNOWN, ret);
+    map.get(UNKNOWN_MEMORY, Offset::UNKNOWN, Offset::UNKNOWN, ret);
 
     return std::vector<RDNode *>(ret.begin(), ret.end());
 }
 
+static inline std::tuple<const RDBBlock *, const RDNode *,
+                         Offset::type, Offset::type>
+defSiteKey(const RDBBlock *block, const DefSite& ds) {
+    return std::make_tuple(block, ds.target, *ds.offset, *ds.len);
+}
+
 ///
 // Find the nodes that define the given def-site.
 // Create PHI nodes if needed.
@@ -162,24 +220,61 @@ SSAReachingDefinitionsAnalysis::findDefinitions(RDBBlock *block,
 
     assert(ds.target && "Target is null");
 
-    // Find known definitions.
-    auto defSet = block->definitions.get(ds);
-    std::vector<RDNode *> defs(defSet.begin(), defSet.end());
+    // Walk up the chain of single predecessors until the def-site
+    // is covered, we reach a block with several predecessors
+    // or a block that we have already searched.
+    // 'chain' contains the blocks and the definitions found in them.
+    std::vector<std::pair<RDBBlock *, std::vector<RDNode *>>> chain;
+    std::set<RDBBlock *> onChain;
+    // the definitions from the blocks above the chain
+    std::vector<RDNode *> above;
+    // the chain is a cycle from this index
+    size_t cycle = ~static_cast<size_t>(0);
+
+    RDBBlock *cur = block;
+    while (cur) {
+        ++_definitionsLookups;
+        auto it = _definitionsCache.find(defSiteKey(cur, ds));
+        if (it != _definitionsCache.end()) {
+            ++_definitionsHits;
+            above = it->second;
+            break;
+        }
 
-    // add definitions to unknown memory
-    auto unknown = block->definitions.get({UNKNOWN_MEMORY, 0, Offset::UNKNOWN});
-    defs.insert(defs.end(), unknown.begin(), unknown.end());
+        // a cycle of single predecessors, there is nothing above it
+        if (!onChain.insert(cur).second) {
+            for (size_t i = 0; i < chain.size(); ++i) {
+                if (chain[i].first == cur) {
+                    cycle = i;
+                    break;
+                }
+            }
+            break;
+        }
+
+        // Find known definitions.
+        auto defSet = cur->definitions.get(ds);
+        std::vector<RDNode *> defs(defSet.begin(), defSet.end());
+
+        // add definitions to unknown memory
+        auto unknown = cur->definitions.get({UNKNOWN_MEMORY, 0, Offset::UNKNOWN});
+        defs.insert(defs.end(), unknown.begin(), unknown.end());
+
+        // Find definitions that are not in this block (if any).
+        auto uncovered = cur->definitions.undefinedIntervals(ds);
+        chain.emplace_back(cur, std::move(defs));
+        if (uncovered.empty())
+            break;
 
-    // Find definitions that are not in this block (if any).
-    auto uncovered = block->definitions.undefinedIntervals(ds);
-    for (auto& interval : uncovered) {
         // if we have a unique predecessor, try finding definitions
         // and creating the new PHI nodes there.
-        if (auto pred = block->getSinglePredecessor()) {
-            auto pdefs = findDefinitions(pred, ds);
-            defs.insert(defs.end(), pdefs.begin(), pdefs.end());
-        } else {
-            // Several predecessors -- we must create a PHI.
+        if (auto pred = cur->getSinglePredecessor()) {
+            cur = pred;
+            continue;
+        }
+
+        // Several predecessors -- we must create a PHI.
+        for (auto& interval : uncovered) {
             // This phi is the definition that we are looking for.
             _phis.emplace_back(graph.create(RDNodeType::PHI));
             _phis.back()->addOverwrites(ds.target,
@@ -187,22 +282,44 @@ SSAReachingDefinitionsAnalysis::findDefinitions(RDBBlock *block,
                                        interval.length());
             // update definitions in the block -- this
             // phi node defines previously uncovered memory
-            assert(block->definitions.get({ds.target,
-                                           interval.start, interval.length()}
-                                         ).empty());
-            block->definitions.update({ds.target, interval.start, interval.length()},
-                                      _phis.back());
+            assert(cur->definitions.get({ds.target,
+                                         interval.start, interval.length()}
+                                       ).empty());
+            cur->definitions.update({ds.target, interval.start, interval.length()},
+                                    _phis.back());
 
             // Inserting at the beginning of the block should not
             // invalidate the iterator
-            block->prependAndUpdateCFG(_phis.back());
+            cur->prependAndUpdateCFG(_phis.back());
 
             // this represents the sought definition
-            defs.push_back(_phis.back());
+            chain.back().second.push_back(_phis.back());
         }
+        break;
     }
 
-    return defs;
+    // all blocks on the cycle reach each other
+    if (cycle < chain.size()) {
+        for (size_t i = cycle; i < chain.size(); ++i)
+            above.insert(above.end(), chain[i].second.begin(),
+                         chain[i].second.end());
+    }
+
+    // the definitions of a block are its own definitions
+    // and the definitions of its predecessor
+    for (size_t i = chain.size(); i > 0; --i) {
+        auto& defs = chain[i - 1].second;
+        if (i - 1 < cycle)
+            defs.insert(defs.end(), above.begin(), above.end());
+        else
+            defs = above;
+
+        above = defs;
+        _definitionsCache.emplace(defSiteKey(chain[i - 1].first, ds),
+                                  std::move(defs));
+    }
+
+    return above;
 }
 
 ///
@@ -210,7 +327,9 @@ SSAReachingDefinitionsAnalysis::findDefinitions(RDBBlock *block,
 // Create PHI nodes if needed. For LVN only.
 std::vector<RDNode *>
 SSAReachingDefinitionsAnalysis::findDefinitionsInBlock(RDBBlock *block,
-                                                       const DefSite& ds) {
+                                                       const DefSite& ds,
+                                                       NodesArena& arena,
+                                                       std::vector<RDNode *>& phis) {
     // get defs of known definitions
     auto defSet = block->definitions.get(ds);
     std::vector<RDNode *> defs(defSet.begin(), defSet.end());
@@ -223,27 +342,26 @@ SSAReachingDefinitionsAnalysis::findDefinitionsInBlock(RDBBlock *block,
     // and create phi nodes for these intervals
     auto uncovered = block->definitions.undefinedIntervals(ds);
     for (auto& interval : uncovered) {
-        _phis.emplace_back(graph.create(RDNodeType::PHI));
-        _phis.back()->addOverwrites(ds.target,
-                                    interval.start,
-                                    interval.length());
+        // the phi is inserted to the block when all blocks are processed
+        phis.push_back(arena.create(RDNodeType::PHI));
+        phis.back()->addOverwrites(ds.target,
+                                   interval.start,
+                                   interval.length());
         // update definitions in the block -- this
         // phi node defines previously uncovered memory
         assert(block->definitions.get({ds.target, interval.start, interval.length()}).empty());
         block->definitions.update({ds.target, interval.start, interval.length()},
-                                  _phis.back());
-
-        // Inserting at the beginning of the block should not
-        // invalidate the iterator
-        block->prependAndUpdateCFG(_phis.back());
+                                  phis.back());
 
-        defs.push_back(_phis.back());
+        defs.push_back(phis.back());
     }
 
     return defs;
 }
 
-void SSAReachingDefinitionsAnalysis::performLvn(RDBBlock *block) {
+void SSAReachingDefinitionsAnalysis::performLvn(RDBBlock *block,
+                                                NodesArena& arena,
+                                                std::vector<RDNode *>& phis) {
     // perform Lvn for one block
     for (RDNode *node : block->getNodes()) {
         // strong update
@@ -270,7 +388,7 @@ void SSAReachingDefinitionsAnalysis::performLvn(RDBBlock *block) {
             // since this is just weak update,
             // look for the previous definitions of 'ds'
             // and if there are none, add a PHI node
-            node->defuse.add(findDefinitionsInBlock(block, ds));
+            node->defuse.add(findDefinitionsInBlock(block, ds, arena, phis));
 
             // NOTE: this must be after findDefinitionsInBlock, otherwise
             // also this definition will be found
@@ -279,22 +397,63 @@ void SSAReachingDefinitionsAnalysis::performLvn(RDBBlock *block) {
 
         // use
         for (auto& ds : node->uses) {
-            node->defuse.add(findDefinitionsInBlock(block, ds));
+            node->defuse.add(findDefinitionsInBlock(block, ds, arena, phis));
         }
     }
 }
 
 void SSAReachingDefinitionsAnalysis::performLvn() {
     DBG_SECTION_BEGIN(dda, "Starting LVN");
-    for (RDBBlock *block : graph.blocks()) {
-        performLvn(block);
+    const auto& blocks = graph.getBBlocks();
+
+    size_t threadsNum = options.lvnThreads;
+    if (threadsNum == 0)
+        threadsNum = std::thread::hardware_concurrency();
+    threadsNum = std::max<size_t>(1, std::min(threadsNum, blocks.size()));
+
+    // LVN of a block touches only the block and its nodes
+    // (the phi nodes are created in the arena of the thread)
+    std::vector<std::vector<RDNode *>> phis(blocks.size());
+    std::vector<NodesArena> arenas(threadsNum);
+    std::atomic<size_t> next{0};
+
+    auto work = [&](unsigned thread) {
+        size_t i;
+        while ((i = next++) < blocks.size()) {
+            performLvn(blocks[i].get(), arenas[thread], phis[i]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadsNum; ++t)
+        threads.emplace_back(work, t);
+    work(0);
+    for (auto& thread : threads)
+        thread.join();
+
+    DBG(dda, "LVN used " << threadsNum << " threads");
+
+    // add the phi nodes to the graph in the order of blocks
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        for (RDNode *phi : phis[i]) {
+            graph.addNode(phi);
+            _phis.push_back(phi);
+            blocks[i]->prependAndUpdateCFG(phi);
+        }
     }
+
+    for (auto& arena : arenas)
+        graph.merge(std::move(arena));
+
     DBG_SECTION_END(dda, "LVN finished");
 }
 
 void SSAReachingDefinitionsAnalysis::performGvn() {
     DBG_SECTION_BEGIN(dda, "Starting GVN");
-    std::set<RDNode *> phis(_phis.begin(), _phis.end());
+    // process the phi nodes in the order of their IDs, so that the new
+    // phi nodes get the same IDs no matter where the nodes were allocated
+    auto cmp = [](const RDNode *a, const RDNode *b) { return a->getID() < b->getID(); };
+    std::set<RDNode *, decltype(cmp)> phis(_phis.begin(), _phis.end(), cmp);
 
     while(!phis.empty()) {
         RDNode *phi = *(phis.begin());
@@ -321,34 +480,67 @@ void SSAReachingDefinitionsAnalysis::performGvn() {
             }
         }
     }
-    DBG_SECTION_END(dda, "GVN finished");
+    DBG_SECTION_END(dda, "GVN finished (cache hits: " << _definitionsHits
+                         << "/" << _definitionsLookups << ")");
 }
 
-static void recGatherNonPhisDefs(RDNode *phi, std::set<RDNode *>& phis, std::set<RDNode *>& ret) {
+// return the non-phi definitions that reach the phi node
+// (the phi nodes that reach the phi node are replaced
+// by their definitions)
+const std::vector<RDNode *>&
+SSAReachingDefinitionsAnalysis::getNonPhisDefs(RDNode *phi) {
     assert(phi->getType() == RDNodeType::PHI);
-    if (!phis.insert(phi).second)
-        return; // we already visited this phi
 
-    for (auto n : phi->defuse) {
-        if (n->getType() != RDNodeType::PHI) {
-            ret.insert(n);
-        } else {
-            recGatherNonPhisDefs(n, phis, ret);
+    ++_phiDefsLookups;
+    auto it = _phiDefsCache.find(phi);
+    if (it != _phiDefsCache.end()) {
+        ++_phiDefsHits;
+        return it->second;
+    }
+
+    std::set<RDNode *> ret; // use set to get rid of duplicates
+    std::set<RDNode *> phis{phi}; // set of visited phi nodes - to check the fixpoint
+    std::vector<RDNode *> stack{phi};
+    while (!stack.empty()) {
+        RDNode *cur = stack.back();
+        stack.pop_back();
+
+        for (auto n : cur->defuse) {
+            if (n->getType() != RDNodeType::PHI) {
+                ret.insert(n);
+                continue;
+            }
+
+            // we already know the definitions of this phi
+            auto cached = _phiDefsCache.find(n);
+            if (cached != _phiDefsCache.end()) {
+                ret.insert(cached->second.begin(), cached->second.end());
+                continue;
+            }
+
+            if (phis.insert(n).second)
+                stack.push_back(n);
         }
     }
+
+    // NOTE: cache only the definitions of the queried phi, the other
+    // phi nodes on a cycle may have not been searched completely
+    return _phiDefsCache.emplace(phi, std::vector<RDNode *>(ret.begin(), ret.end()))
+                                .first->second;
 }
 
-// recursivelu replace all phi values with its non-phi definitions
+// replace all phi values with its non-phi definitions
 template <typename ContT>
-std::vector<RDNode *> gatherNonPhisDefs(const ContT& nodes) {
+std::vector<RDNode *>
+SSAReachingDefinitionsAnalysis::gatherNonPhisDefs(const ContT& nodes) {
     std::set<RDNode *> ret; // use set to get rid of duplicates
-    std::set<RDNode *> phis; // set of visited phi nodes - to check the fixpoint
 
     for (auto n : nodes) {
         if (n->getType() != RDNodeType::PHI) {
             ret.insert(n);
         } else {
-            recGatherNonPhisDefs(n, phis, ret);
+            const auto& defs = getNonPhisDefs(n);
+            ret.insert(defs.begin(), defs.end());
         }
     }
 
@@ -357,8 +549,17 @@ std::vector<RDNode *> gatherNonPhisDefs(const ContT& nodes) {
 
 std::vector<RDNode *>
 SSAReachingDefinitionsAnalysis::getReachingDefinitions(RDNode *use) {
-    if (use->usesUnknown())
-        return findAllReachingDefinitions(use);
+    if (use->usesUnknown()) {
+        ++_unknownUsesLookups;
+        auto it = _unknownUsesCache.find(use);
+        if (it != _unknownUsesCache.end()) {
+            ++_unknownUsesHits;
+            return it->second;
+        }
+
+        return _unknownUsesCache.emplace(use, findAllReachingDefinitions(use))
+                                        .first->second;
+    }
 
     return gatherNonPhisDefs(use->defuse);
 }
@@ -368,7 +569,7 @@ SSAReachingDefinitionsAnalysis::findAllReachingDefinitions(RDNode *from) {
     DBG_SECTION_BEGIN(dda, "MemorySSA - finding all definitions");
     assert(from->getBBlock() && "The node has no BBlock");
 
-    DefinitionsMap<RDNode> defs; // auxiliary map for finding defintions
+    RDDefinitionsMap defs; // auxiliary map for finding defintions
     std::set<RDNode *> foundDefs; // definitions that we found
 
     ///
@@ -406,68 +607,82 @@ SSAReachingDefinitionsAnalysis::findAllReachingDefinitions(RDNode *from) {
     ///
     // get the definitions from predecessors
     ///
-    std::set<RDBBlock *> visitedBlocks; // for terminating the search
-    // NOTE: do not add block to visitedBlocks, it may be its own predecessor,
+    // NOTE: do not mark the block as visited, it may be its own predecessor,
     // in which case we want to process it
-    if (auto singlePred = block->getSinglePredecessor()) {
-        findAllReachingDefinitions(defs, singlePred, foundDefs, visitedBlocks);
-    } else {
-        // for multiple predecessors, we must create a copy of the
-        // definitions that we have not found yet
-        for (auto I = block->pred_begin(), E = block->pred_end(); I != E; ++I) {
-            auto tmpDefs = defs;
-            findAllReachingDefinitions(tmpDefs, *I, foundDefs, visitedBlocks);
-        }
-    }
+    findAllReachingDefinitions(std::move(defs), block, foundDefs);
 
     ///
     // Gather all the defintions
     ///
-    DBG_SECTION_END(dda, "MemorySSA - finding all definitions done");
-    return gatherNonPhisDefs(foundDefs);
+    auto ret = gatherNonPhisDefs(foundDefs);
+    DBG_SECTION_END(dda, "MemorySSA - finding all definitions done (cache hits: "
+                         << "uses of unknown memory " << _unknownUsesHits << "/"
+                         << _unknownUsesLookups << ", phi nodes " << _phiDefsHits
+                         << "/" << _phiDefsLookups << ")");
+    return ret;
 }
 
 void
-SSAReachingDefinitionsAnalysis::findAllReachingDefinitions(DefinitionsMap<RDNode>& defs,
+SSAReachingDefinitionsAnalysis::findAllReachingDefinitions(RDDefinitionsMap&& defs,
                                                            RDBBlock *from,
-                                                           std::set<RDNode *>& foundDefs,
-                                                           std::set<RDBBlock *>& visitedBlocks) {
-    if (!from)
-        return;
+                                                           std::set<RDNode *>& foundDefs) {
+    std::set<RDBBlock *> visitedBlocks; // for terminating the search
+    // the blocks to search with the definitions found on the path to them,
+    // the blocks are searched in the same order as by a recursive DFS
+    std::vector<std::pair<RDBBlock *, RDDefinitionsMap>> stack;
+
+    auto pushPredecessors = [&stack](RDBBlock *block, RDDefinitionsMap&& defs) {
+        if (auto singlePred = block->getSinglePredecessor()) {
+            stack.emplace_back(singlePred, std::move(defs));
+            return;
+        }
 
-    if (!visitedBlocks.insert(from).second)
-        return;
+        // for multiple predecessors, we must create a copy of the
+        // definitions that we have not found yet
+        std::vector<RDBBlock *> preds;
+        for (auto I = block->pred_begin(), E = block->pred_end(); I != E; ++I)
+            preds.push_back(*I);
+        for (auto I = preds.rbegin(), E = preds.rend(); I != E; ++I) {
+            stack.emplace_back(*I, defs);
+        }
+    };
 
-    // get the definitions from this block
-    for (auto& it : from->definitions) {
-        if (!defs.definesTarget(it.first)) {
-            // just copy the definitions
-            defs.add(it.first, it.second);
-            for (auto& nds : it.second) {
-                foundDefs.insert(nds.second.begin(), nds.second.end());
-            }
+    pushPredecessors(from, std::move(defs));
+    while (!stack.empty()) {
+        RDBBlock *block = stack.back().first;
+        RDDefinitionsMap blockDefs = std::move(stack.back().second);
+        stack.pop_back();
+
+        if (!block)
+            continue;
+
+        if (!visitedBlocks.insert(block).second)
             continue;
-        }
 
-        for (auto& it2 : it.second) {
-            auto& interv = it2.first;
-            auto uncovered
-                = defs.undefinedIntervals({it.first, interv.start, interv.length()});
-            for (auto& undefInterv : uncovered) {
-                // we still do not have definitions for these bytes, add it
-                defs.add({it.first, undefInterv.start, undefInterv.length()}, it2.second);
+        // get the definitions from this block
+        for (auto& it : block->definitions) {
+            if (!blockDefs.definesTarget(it.first)) {
+                // just copy the definitions
+                blockDefs.add(it.first, it.second);
+                for (auto& nds : it.second) {
+                    foundDefs.insert(nds.second.begin(), nds.second.end());
+                }
+                continue;
             }
-        }
-    }
 
-    // recurs into predecessors
-    if (auto singlePred = from->getSinglePredecessor()) {
-        findAllReachingDefinitions(defs, singlePred, foundDefs, visitedBlocks);
-    } else {
-        for (auto I = from->pred_begin(), E = from->pred_end(); I != E; ++I) {
-            auto tmpDefs = defs;
-            findAllReachingDefinitions(tmpDefs, *I, foundDefs, visitedBlocks);
+            for (auto& it2 : it.second) {
+                auto& interv = it2.first;
+                auto uncovered
+                    = blockDefs.undefinedIntervals({it.first, interv.start, interv.length()});
+                for (auto& undefInterv : uncovered) {
+                    // we still do not have definitions for these bytes, add it
+                    blockDefs.add({it.first, undefInterv.start, undefInterv.length()}, it2.second);
+                }
+            }
         }
+
+        // continue to predecessors
+        pushPredecessors(block, std::move(blockDefs));
     }
 }
 
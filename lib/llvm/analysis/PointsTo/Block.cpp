@@ -54,9 +54,17 @@ LLVMPointerGraphBuilder::buildPointerGraphBlock(const llvm::BasicBlock& block,
         if (!isRelevantInstruction(Inst)) {
             // check if it is a zeroing of memory,
             // if so, set the corresponding memory to zeroed
-            if (llvm::isa<llvm::MemSetInst>(&Inst))
+            if (llvm::isa<llvm::MemSetInst>(&Inst)) {
                 checkMemSet(&Inst);
 
+                // the memset may have been built as a store,
+                // its nodes belong to this function too
+                if (auto seq = getNodes(&Inst)) {
+                    for (auto nd : *seq)
+                        nd->setParent(parent);
+                }
+            }
+
             continue;
         }
 
@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_os_ostream.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/analysis/PointsTo/PointerAnalysisFI.h"
+#include "dg/llvm/analysis/PointsTo/PointerGraph.h"
+#include "dg/llvm/analysis/PointsTo/PointerAnalysis.h"
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+// The subgraph of a changed function is removed and built again the same way
+// as when building the whole graph: first the nodes (building also
+// the functions that are newly called) and then the CFG edges and
+// the interprocedural operands. The analysis then takes back the points-to
+// information that depended on the removed nodes (see PointerAnalysisFI).
+
+bool LLVMPointerGraphBuilder::canRebuild(const llvm::Function *F) const {
+    // nothing to rebuild
+    if (subgraphs_map.find(F) == subgraphs_map.end())
+        return true;
+
+    // the threads and the optimized graph are not supported
+    if (threads_ || mapping.size() > 0)
+        return false;
+
+    if (F->isDeclaration())
+        return false;
+
+    // the subgraph may be connected to calls via pointers
+    if (F->hasAddressTaken() || _adHocFunctions.count(F) > 0)
+        return false;
+
+    // the new body calls a function that was built ad hoc
+    for (const llvm::BasicBlock& B : *F) {
+        for (const llvm::Instruction& I : B) {
+            const llvm::CallInst *CI = llvm::dyn_cast<llvm::CallInst>(&I);
+            if (!CI)
+                continue;
+
+            const llvm::Function *called = CI->getCalledFunction();
+            if (called && _adHocFunctions.count(called) > 0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<PSNode *>
+LLVMPointerGraphBuilder::getFunctionsNodes(const std::vector<const llvm::Function *>& functions) const {
+    std::unordered_set<const PointerSubgraph *> subgraphs;
+    for (const llvm::Function *F : functions) {
+        auto it = subgraphs_map.find(F);
+        if (it != subgraphs_map.end())
+            subgraphs.insert(it->second);
+    }
+
+    std::vector<PSNode *> nodes;
+    if (subgraphs.empty())
+        return nodes;
+
+    for (const auto& nd : PS.getNodes()) {
+        if (nd && subgraphs.count(nd->getParent()) > 0)
+            nodes.push_back(nd.get());
+    }
+
+    return nodes;
+}
+
+void LLVMPointerGraphBuilder::removeFunctions(const std::vector<const llvm::Function *>& functions) {
+    auto nodes = getFunctionsNodes(functions);
+    std::unordered_set<PSNode *> removed(nodes.begin(), nodes.end());
+
+    // the instructions of the functions may have been deleted already,
+    // so do not touch the keys, search for the entries by the nodes
+    for (auto it = nodes_map.begin(); it != nodes_map.end();) {
+        bool isRemoved = std::any_of(it->second.begin(), it->second.end(),
+                                     [&removed](PSNode *n) {
+                                         return removed.count(n) > 0;
+                                     });
+        if (isRemoved)
+            it = nodes_map.erase(it);
+        else
+            ++it;
+    }
+
+    for (PSNode *nd : nodes)
+        PS.erase(nd);
+
+    for (const llvm::Function *F : functions) {
+        auto it = subgraphs_map.find(F);
+        if (it == subgraphs_map.end())
+            continue;
+
+        PS.removeSubgraph(it->second);
+        subgraphs_map.erase(it);
+        _funcInfo.erase(F);
+        _adHocFunctions.erase(F);
+    }
+
+    DBG(pta, "Removed " << functions.size() << " functions with "
+             << nodes.size() << " nodes");
+}
+
+std::vector<PointerSubgraph *>
+LLVMPointerGraphBuilder::rebuildFunctions(const std::vector<const llvm::Function *>& functions) {
+    using namespace llvm;
+
+    assert(ad_hoc_building && "The graph is not built yet");
+
+    std::unordered_set<const Function *> oldFunctions;
+    for (auto& it : subgraphs_map)
+        oldFunctions.insert(it.first);
+
+    // build the nodes the same way as when building the whole graph
+    ad_hoc_building = false;
+    for (const Function *F : functions) {
+        // it may have been built as a callee of other function
+        if (!getSubgraph(F))
+            buildFunction(*F);
+    }
+
+    std::vector<const Function *> newFunctions;
+    std::vector<PointerSubgraph *> newSubgraphs;
+    for (auto& it : subgraphs_map) {
+        if (oldFunctions.count(it.first) == 0) {
+            newFunctions.push_back(it.first);
+            newSubgraphs.push_back(it.second);
+        }
+    }
+
+    // the old functions that are called from the new ones
+    std::unordered_set<const Function *> callees;
+
+    for (const Function *F : newFunctions) {
+        PointerSubgraph *subg = subgraphs_map[F];
+        addProgramStructure(F, *subg);
+
+        // connect the calls from the old functions,
+        // the calls from the new ones are connected already
+        for (auto I = F->use_begin(), E = F->use_end(); I != E; ++I) {
+#if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR < 5))
+            const Value *use = *I;
+#else
+            const Value *use = I->getUser();
+#endif
+            const CallInst *CI = dyn_cast<CallInst>(use);
+            if (!CI || CI->getCalledFunction() != F)
+                continue;
+
+            auto *nodes = getNodes(CI);
+            if (!nodes)
+                continue;
+
+            PSNodeCall *callNode = PSNodeCall::get(nodes->getFirst());
+            if (!callNode || !callNode->addCallee(subg))
+                continue;
+
+            PSNodeEntry::cast(subg->root)->addCaller(callNode);
+            PS.registerCall(getSubgraph(CI->getParent()->getParent())->root,
+                            subg->root);
+        }
+
+        for (const BasicBlock& B : *F) {
+            for (const Instruction& I : B) {
+                const CallInst *CI = dyn_cast<CallInst>(&I);
+                if (!CI)
+                    continue;
+
+                const Function *called = CI->getCalledFunction();
+                if (called && oldFunctions.count(called) > 0)
+                    callees.insert(called);
+            }
+        }
+    }
+
+    // add the missing operands (to arguments and return nodes)
+    for (const Function *F : newFunctions)
+        addInterproceduralOperands(F, *subgraphs_map[F]);
+    for (const Function *F : callees)
+        addInterproceduralOperands(F, *subgraphs_map[F]);
+
+    ad_hoc_building = true;
+
+    // the entry function was rebuilt
+    if (!PS.getEntry()) {
+        auto entry = getSubgraph(M->getFunction(_options.entryFunction));
+        assert(entry && "Did not rebuild the entry function");
+        PS.setEntry(entry);
+    }
+
+#ifndef NDEBUG
+    if (!validateSubgraph(true)) {
+        llvm::errs() << "Pointer Subgraph is broken!\n";
+        llvm::errs() << "This happend after rebuilding changed functions\n";
+        abort();
+    }
+#endif // NDEBUG
+
+    DBG(pta, "Rebuilt " << functions.size() << " functions, built "
+             << newFunctions.size() << " subgraphs");
+
+    return newSubgraphs;
+}
+
+std::vector<const llvm::Function *>
+LLVMPointerGraphBuilder::getUnreachableFunctions() const {
+    std::unordered_map<const PointerSubgraph *, std::vector<PSNodeCall *>> calls;
+    for (const auto& nd : PS.getNodes()) {
+        if (!nd)
+            continue;
+        if (PSNodeCall *C = PSNodeCall::get(nd.get()))
+            calls[C->getParent()].push_back(C);
+    }
+
+    std::unordered_set<const PointerSubgraph *> reachable{PS.getEntry()};
+    std::vector<const PointerSubgraph *> queue{PS.getEntry()};
+    while (!queue.empty()) {
+        const PointerSubgraph *subg = queue.back();
+        queue.pop_back();
+
+        for (PSNodeCall *C : calls[subg]) {
+            for (PointerSubgraph *callee : C->getCallees()) {
+                if (reachable.insert(callee).second)
+                    queue.push_back(callee);
+            }
+        }
+    }
+
+    std::vector<const llvm::Function *> unreachable;
+    for (auto& it : subgraphs_map) {
+        if (reachable.count(it.second) == 0)
+            unreachable.push_back(it.first);
+    }
+
+    return unreachable;
+}
+
+} // namespace pta
+} // namespace analysis
+
+bool LLVMPointerAnalysis::updateFI(const std::vector<const llvm::Function *>& changed)
+{
+    using analysis::pta::PointerAnalysisFI;
+    using analysis::pta::PointerSubgraph;
+
+    // only the difference propagation can take back the results
+    if (!_pta || !_ptaName ||
+        strcmp(_ptaName, getCacheName(static_cast<PointerAnalysisFI *>(nullptr))) != 0 ||
+        !(_options.isDiffPropagation() || _options.isParallel()))
+        return false;
+
+    std::vector<const llvm::Function *> functions;
+    std::unordered_set<const llvm::Function *> seen;
+    for (const llvm::Function *F : changed) {
+        if (!_builder->canRebuild(F))
+            return false;
+        // the functions that were not built are not reachable
+        // from the entry, the change does not matter
+        if (_builder->getSubgraph(F) && seen.insert(F).second)
+            functions.push_back(F);
+    }
+
+    // the stored results are not valid anymore
+    _cache.reset();
+    _fromCache = false;
+
+    auto *PTA = static_cast<PointerAnalysisFI *>(_pta.get());
+    if (!PTA->retract(_builder->getFunctionsNodes(functions)))
+        return false;
+
+    _builder->removeFunctions(functions);
+    auto newSubgraphs = _builder->rebuildFunctions(functions);
+
+    // the functions that are not called anymore would not be built
+    auto unreachable = _builder->getUnreachableFunctions();
+    if (!unreachable.empty()) {
+        if (!PTA->retract(_builder->getFunctionsNodes(unreachable)))
+            return false;
+
+        std::unordered_set<PointerSubgraph *> removed;
+        for (const llvm::Function *F : unreachable)
+            removed.insert(_builder->getSubgraph(F));
+        newSubgraphs.erase(std::remove_if(newSubgraphs.begin(), newSubgraphs.end(),
+                                          [&removed](PointerSubgraph *subg) {
+                                              return removed.count(subg) > 0;
+                                          }),
+                           newSubgraphs.end());
+
+        _builder->removeFunctions(unreachable);
+    }
+
+    return PTA->reanalyze(newSubgraphs);
+}
+
+template <>
+void LLVMPointerAnalysis::update<analysis::pta::PointerAnalysisFI>(
+                const std::vector<const llvm::Function *>& changed)
+{
+    if (!updateFI(changed))
+        rerun<analysis::pta::PointerAnalysisFI>();
+}
+
+} // namespace dg
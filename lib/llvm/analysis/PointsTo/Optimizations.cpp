@@ -0,0 +1,160 @@
+#include <cassert>
+#include <vector>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/Function.h>
+#include <llvm/Support/raw_os_ostream.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/analysis/PointsTo/PointerGraphOptimizations.h"
+#include "dg/llvm/analysis/PointsTo/PointerGraph.h"
+
+#include "llvm/analysis/PointsTo/PointerGraphValidator.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+// The reduction of the built graph. The pipeline removes the noops,
+// merges the casts (and other copies) with their operands and, for
+// the flow-insensitive analysis, replaces the loads of memory that
+// contains only unknown pointers by the unknown memory. When the
+// flow-insensitive analysis propagates the changes along the uses,
+// the pointers with the same points-to sets are merged too
+// (see PSPointerEquivalenceMerger).
+//
+// The values whose nodes were removed are then mapped to the equivalent
+// nodes, so getPointsTo() returns the same points-to sets as without
+// the reduction (or more precise sets, as some pointers are not
+// shifted by zero anymore).
+//
+// The nodes that get new operands while the analysis is running
+// (the arguments of the functions that may be called via pointers
+// and the variadic arguments) are kept. The graph is not reduced when
+// it is going to be rebuilt incrementally.
+void LLVMPointerGraphBuilder::optimizeGraph() {
+    if (!_options.optimizeGraph || _options.incremental)
+        return;
+
+    DBG_SECTION_BEGIN(pta, "Optimizing the pointer graph");
+
+#ifndef NDEBUG
+    // the subgraphs of the summarized functions are not connected
+    bool no_connectivity = !_summarizedFunctions.empty();
+    bool valid = !debug::LLVMPointerGraphValidator(&PS, no_connectivity).validate();
+#endif // NDEBUG
+
+    PointerGraphOptimizer optimizer(&PS);
+    for (const auto& it : subgraphs_map) {
+        const llvm::Function *F = it.first;
+        PointerSubgraph *subg = it.second;
+
+        if (subg->vararg)
+            optimizer.pin(subg->vararg);
+
+        if (!F->hasAddressTaken())
+            continue;
+
+        for (const llvm::Argument& A : F->args()) {
+            if (auto nds = getNodes(&A)) {
+                for (PSNode *nd : *nds)
+                    optimizer.pin(nd);
+            }
+        }
+    }
+
+    optimizer.removeNoops();
+    optimizer.removeEquivalentNodes();
+    if (_options.isFI()) {
+        optimizer.removeUnknowns();
+
+        // the graph with summaries is solved by the difference
+        // propagation too (see LLVMPointerAnalysisImpl)
+        if (_options.isDiffPropagation() || _options.isParallel() ||
+            _options.isDemandDriven() || !_summarizedFunctions.empty())
+            optimizer.removeEquivalentPointers();
+    }
+    // the merging may have created phi nodes with the same operands
+    optimizer.removeEquivalentNodes();
+
+    _removedNodesNum = optimizer.getNumOfRemovedNodes();
+    if (_removedNodesNum > 0)
+        composeMapping(std::move(optimizer.getMapping()),
+                       optimizer.getRemovedNodes());
+
+#ifndef NDEBUG
+    debug::LLVMPointerGraphValidator validator(&PS, no_connectivity);
+    if (valid && validator.validate()) {
+        llvm::errs() << "Pointer Subgraph is broken!\n";
+        llvm::errs() << "This happend after optimizing the graph.\n";
+        assert(!validator.getErrors().empty());
+        llvm::errs() << validator.getErrors();
+        abort();
+    }
+#endif // NDEBUG
+
+    DBG_SECTION_END(pta, "Optimizing the pointer graph removed "
+                         << _removedNodesNum << " nodes");
+}
+
+void LLVMPointerGraphBuilder::composeMapping(PointsToMapping<PSNode *>&& rhs,
+                                             const PSNodesSetT& removed) {
+    for (auto& it : nodes_map) {
+        PSNodesSeq& seq = it.second;
+        PSNode *repr = seq.getRepresentant();
+        if (repr && removed.count(repr) > 0) {
+            repr = rhs.resolve(repr);
+            // the node was removed without a replacement
+            // (e.g., a store), the value has no node now
+            if (!repr) {
+                seq.clear();
+                continue;
+            }
+
+            seq.setRepresentant(repr);
+        }
+
+        seq.erase(removed);
+    }
+
+    // the removed instances of the nodes of summarized functions
+    // are replaced by their equivalent nodes. The removed nodes
+    // of summarized functions have their equivalent nodes filled.
+    std::vector<std::pair<PSNode *, PSNode *>> instances;
+    instances.reserve(_summaryInstances.size());
+    for (auto& it : _summaryInstances) {
+        if (removed.count(it.first) > 0)
+            continue;
+
+        PSNode *inst = it.second;
+        if (removed.count(inst) > 0) {
+            inst = rhs.resolve(inst);
+            if (!inst)
+                continue;
+        }
+
+        instances.emplace_back(it.first, inst);
+    }
+    _summaryInstances.swap(instances);
+
+    mapping.compose(std::move(rhs));
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
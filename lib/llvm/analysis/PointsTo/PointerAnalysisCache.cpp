@@ -0,0 +1,444 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/Config/llvm-config.h>
+#if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR < 5))
+#include <llvm/ADT/OwningPtr.h>
+#endif
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/analysis/PointsTo/PointerAnalysis.h"
+#include "dg/llvm/analysis/PointsTo/PointerAnalysisCache.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+namespace {
+
+static const char MAGIC[8] = {'D', 'G', 'P', 'T', 'A', 'C', 'C', 'H'};
+
+// FNV-1a
+class Hasher {
+    uint64_t _hash{14695981039346656037ULL};
+
+public:
+    void add(const void *data, size_t len) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < len; ++i) {
+            _hash ^= bytes[i];
+            _hash *= 1099511628211ULL;
+        }
+    }
+
+    void add(uint64_t val) { add(&val, sizeof(val)); }
+
+    uint64_t get() const { return _hash; }
+};
+
+// hash everything that is written to the stream
+class HashingStream : public llvm::raw_ostream {
+    Hasher& _hasher;
+    uint64_t _pos{0};
+
+    void write_impl(const char *ptr, size_t size) override {
+        _hasher.add(ptr, size);
+        _pos += size;
+    }
+
+    uint64_t current_pos() const override { return _pos; }
+
+public:
+    HashingStream(Hasher& hasher) : _hasher(hasher) {}
+    ~HashingStream() override { flush(); }
+};
+
+std::string getOptionsKey(const LLVMPointerAnalysisOptions& opts,
+                          const std::string& analysis) {
+    std::ostringstream key;
+    key << analysis
+        << " entry:" << opts.entryFunction
+        << " fs:" << *opts.fieldSensitivity
+        << " threads:" << opts.threads
+        << " geps:" << opts.preprocessGeps
+        << " inv:" << opts.invalidateNodes
+        << " solver:" << static_cast<int>(opts.solverType)
+        << " collapse:" << opts.collapseCycles
+        << " order:" << static_cast<int>(opts.worklistOrder)
+        << " summaries:" << opts.functionSummaries << "/" << opts.summaryMaxNodes
+        << " optimize:" << opts.optimizeGraph
+        << " heap:" << opts.heapCloning << " wrappers:";
+    for (const auto& it : opts.allocationWrappers)
+        key << it << ",";
+    key << " alloc:";
+    for (const auto& it : opts.allocationFunctions)
+        key << it.first << "=" << static_cast<int>(it.second) << ",";
+    return key.str();
+}
+
+size_t getChangesSize(size_t changesNum) {
+    size_t size = changesNum * sizeof(LLVMPointerGraphBuilder::AdHocChange);
+    // keep the following arrays aligned
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+uint32_t getTargetId(const PSNode *target) {
+    if (target == NULLPTR)
+        return LLVMPointerAnalysisCache::NULLPTR_ID;
+    if (target == UNKNOWN_MEMORY)
+        return LLVMPointerAnalysisCache::UNKNOWN_MEMORY_ID;
+    if (target == INVALIDATED)
+        return LLVMPointerAnalysisCache::INVALIDATED_ID;
+    return target->getID();
+}
+
+PSNode *getTarget(uint32_t id, const std::vector<PSNode *>& nodesById) {
+    switch (id) {
+        case LLVMPointerAnalysisCache::NULLPTR_ID: return NULLPTR;
+        case LLVMPointerAnalysisCache::UNKNOWN_MEMORY_ID: return UNKNOWN_MEMORY;
+        case LLVMPointerAnalysisCache::INVALIDATED_ID: return INVALIDATED;
+        default:
+            return id < nodesById.size() ? nodesById[id] : nullptr;
+    }
+}
+
+// Nodes of the graph indexed by their IDs. The graph only grows
+// while replaying the changes, so update() scans only the new nodes.
+class NodesById {
+    const PointerGraph *_PS;
+    std::vector<PSNode *> _nodes;
+    size_t _globalsDone{0};
+    size_t _nodesDone{0};
+
+    void add(PSNode *n) {
+        if (!n)
+            return;
+        if (_nodes.size() <= n->getID())
+            _nodes.resize(n->getID() + 1, nullptr);
+        _nodes[n->getID()] = n;
+    }
+
+public:
+    NodesById(const PointerGraph *PS) : _PS(PS) { update(); }
+
+    void update() {
+        const auto& globals = _PS->getGlobals();
+        for (; _globalsDone < globals.size(); ++_globalsDone)
+            add(globals[_globalsDone].get());
+        const auto& nodes = _PS->getNodes();
+        for (; _nodesDone < nodes.size(); ++_nodesDone)
+            add(nodes[_nodesDone].get());
+    }
+
+    const std::vector<PSNode *>& get() const { return _nodes; }
+};
+
+std::string toHex(uint64_t val) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(val));
+    return buf;
+}
+
+} // anonymous namespace
+
+LLVMPointerAnalysisCache::LLVMPointerAnalysisCache(
+                                const LLVMPointerAnalysisOptions& opts,
+                                const std::string& analysis,
+                                const llvm::Module *M,
+                                const LLVMPointerGraphBuilder *builder) {
+    Hasher moduleHasher;
+    {
+        HashingStream stream(moduleHasher);
+        M->print(stream, nullptr);
+    }
+    _moduleHash = moduleHasher.get();
+
+    Hasher optionsHasher;
+    std::string key = getOptionsKey(opts, analysis);
+    optionsHasher.add(key.data(), key.size());
+    _optionsHash = optionsHasher.get();
+
+    numberValues(M);
+
+    NodesById table(builder->getPS());
+    _initialNodesNum = static_cast<uint32_t>(table.get().size());
+    _initialGraphHash = hashGraph(table.get());
+
+    _path = opts.cacheDir + "/" + toHex(_moduleHash) + "-"
+            + toHex(_optionsHash) + ".pta";
+}
+
+void LLVMPointerAnalysisCache::numberValues(const llvm::Module *M) {
+    uint32_t id = 0;
+    for (auto I = M->global_begin(), E = M->global_end(); I != E; ++I)
+        _valueIds[&*I] = id++;
+
+    for (const llvm::Function& F : *M) {
+        _valueIds[&F] = id++;
+        for (auto A = F.arg_begin(), E = F.arg_end(); A != E; ++A)
+            _valueIds[&*A] = id++;
+        for (const llvm::BasicBlock& B : F) {
+            for (const llvm::Instruction& I : B)
+                _valueIds[&I] = id++;
+        }
+    }
+}
+
+uint64_t
+LLVMPointerAnalysisCache::hashGraph(const std::vector<PSNode *>& nodesById) const {
+    Hasher hasher;
+    for (PSNode *n : nodesById) {
+        if (!n) {
+            hasher.add(0);
+            continue;
+        }
+
+        uint64_t valueId = ~static_cast<uint64_t>(0);
+        if (auto val = n->getUserData<llvm::Value>()) {
+            auto it = _valueIds.find(val);
+            // values that are not numbered (e.g., constant expressions)
+            valueId = it == _valueIds.end() ? valueId - 1 : it->second;
+        }
+
+        hasher.add(static_cast<uint64_t>(n->getType()));
+        hasher.add(valueId);
+        hasher.add(n->getOperandsNum());
+    }
+
+    return hasher.get();
+}
+
+// Map the file into memory (LLVM reads small files instead).
+// The file is not a text, so it does not need the terminating zero
+// (requiring it could make LLVM read the file instead of mapping it).
+static std::unique_ptr<llvm::MemoryBuffer> mapFile(const std::string& path) {
+#if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR < 5))
+    llvm::OwningPtr<llvm::MemoryBuffer> buf;
+    if (llvm::MemoryBuffer::getFile(path, buf, -1,
+                                    /* RequiresNullTerminator = */ false))
+        return nullptr;
+    return std::unique_ptr<llvm::MemoryBuffer>(buf.take());
+#else
+#if LLVM_VERSION_MAJOR < 13
+    auto buf = llvm::MemoryBuffer::getFile(path, -1,
+                                           /* RequiresNullTerminator = */ false);
+#else
+    auto buf = llvm::MemoryBuffer::getFile(path, /* IsText = */ false,
+                                           /* RequiresNullTerminator = */ false);
+#endif
+    if (!buf)
+        return nullptr;
+    return std::move(*buf);
+#endif
+}
+
+LLVMPointerAnalysisCache::LoadResult
+LLVMPointerAnalysisCache::load(LLVMPointerGraphBuilder *builder) {
+    using AdHocChange = LLVMPointerGraphBuilder::AdHocChange;
+
+    auto buf = mapFile(_path);
+    if (!buf || buf->getBufferSize() < sizeof(Header))
+        return LoadResult::NOT_FOUND;
+
+    const char *data = buf->getBufferStart();
+    const size_t size = buf->getBufferSize();
+
+    // the arrays of the file are aligned to 8 bytes in the file,
+    // we read them in place only if the buffer is aligned too
+    // (mapped files are aligned to pages)
+    std::vector<uint64_t> aligned;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0) {
+        aligned.resize((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        memcpy(aligned.data(), data, size);
+        data = reinterpret_cast<const char *>(aligned.data());
+    }
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION ||
+        header.moduleHash != _moduleHash ||
+        header.optionsHash != _optionsHash ||
+        header.initialNodesNum != _initialNodesNum ||
+        header.initialGraphHash != _initialGraphHash) {
+        DBG(pta, "The cached results in " << _path << " do not fit");
+        return LoadResult::NOT_FOUND;
+    }
+
+    size_t changesPos = sizeof(Header);
+    size_t offsetsPos = changesPos + getChangesSize(header.changesNum);
+    size_t pointersPos = offsetsPos + (header.nodesNum + 1) * sizeof(uint64_t);
+    if (size != pointersPos + header.pointersNum * sizeof(StoredPointer))
+        return LoadResult::NOT_FOUND;
+
+    Hasher dataHasher;
+    dataHasher.add(data + changesPos, size - changesPos);
+    if (dataHasher.get() != header.dataHash) {
+        DBG(pta, "The cached results in " << _path << " are corrupted");
+        return LoadResult::NOT_FOUND;
+    }
+
+    // build the parts of the graph that the analysis built
+    NodesById table(builder->getPS());
+    const auto& nodesById = table.get();
+    for (uint32_t i = 0; i < header.changesNum; ++i) {
+        AdHocChange change;
+        memcpy(&change, data + changesPos + i * sizeof(change),
+               sizeof(change));
+        if (!builder->replayAdHocChange(change, nodesById))
+            return i == 0 ? LoadResult::NOT_FOUND : LoadResult::GRAPH_CHANGED;
+
+        // the change may have created new nodes
+        table.update();
+    }
+
+    auto failed = header.changesNum == 0 ? LoadResult::NOT_FOUND
+                                         : LoadResult::GRAPH_CHANGED;
+    if (nodesById.size() != header.nodesNum ||
+        hashGraph(nodesById) != header.graphHash)
+        return failed;
+
+    const uint64_t *offsets
+        = reinterpret_cast<const uint64_t *>(data + offsetsPos);
+    const StoredPointer *pointers
+        = reinterpret_cast<const StoredPointer *>(data + pointersPos);
+
+    // check everything before we change any points-to set
+    for (uint32_t id = 0; id < header.nodesNum; ++id) {
+        if (offsets[id] > offsets[id + 1] ||
+            offsets[id + 1] > header.pointersNum)
+            return failed;
+        for (uint64_t i = offsets[id]; i < offsets[id + 1]; ++i) {
+            if (!nodesById[id] || !getTarget(pointers[i].target, nodesById))
+                return failed;
+        }
+    }
+
+    for (uint32_t id = 0; id < header.nodesNum; ++id) {
+        PSNode *node = nodesById[id];
+        if (!node)
+            continue;
+
+        node->pointsTo.clear();
+        for (uint64_t i = offsets[id]; i < offsets[id + 1]; ++i) {
+            node->pointsTo.add(Pointer(getTarget(pointers[i].target, nodesById),
+                                       pointers[i].offset));
+        }
+    }
+
+    DBG(pta, "Loaded the results of pointer analysis from " << _path);
+    return LoadResult::LOADED;
+}
+
+bool LLVMPointerAnalysisCache::store(const LLVMPointerGraphBuilder *builder) const {
+    NodesById table(builder->getPS());
+    const auto& nodesById = table.get();
+
+    const auto& changes = builder->getAdHocChanges();
+
+    std::vector<uint64_t> offsets;
+    std::vector<StoredPointer> pointers;
+    offsets.reserve(nodesById.size() + 1);
+    offsets.push_back(0);
+    for (PSNode *n : nodesById) {
+        if (n) {
+            for (const Pointer& ptr : n->pointsTo)
+                pointers.push_back({getTargetId(ptr.target), 0, *ptr.offset});
+        }
+        offsets.push_back(pointers.size());
+    }
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.initialNodesNum = _initialNodesNum;
+    header.nodesNum = static_cast<uint32_t>(nodesById.size());
+    header.changesNum = static_cast<uint32_t>(changes.size());
+    header.moduleHash = _moduleHash;
+    header.optionsHash = _optionsHash;
+    header.initialGraphHash = _initialGraphHash;
+    header.graphHash = hashGraph(nodesById);
+    header.pointersNum = pointers.size();
+
+    size_t padding = getChangesSize(changes.size())
+                        - changes.size() * sizeof(changes[0]);
+    const char zeros[8] = {0};
+
+    Hasher dataHasher;
+    dataHasher.add(changes.data(), changes.size() * sizeof(changes[0]));
+    dataHasher.add(zeros, padding);
+    dataHasher.add(offsets.data(), offsets.size() * sizeof(offsets[0]));
+    dataHasher.add(pointers.data(), pointers.size() * sizeof(pointers[0]));
+    header.dataHash = dataHasher.get();
+
+    size_t dirSepPos = _path.rfind('/');
+    if (llvm::sys::fs::create_directories(_path.substr(0, dirSepPos)))
+        return false;
+
+    // write a temporary file and rename it, so that other processes
+    // that use the same cache never see a half-written file
+    llvm::SmallString<128> tmpPath;
+    int fd;
+    if (llvm::sys::fs::createUniqueFile(_path + ".tmp-%%%%%%", fd, tmpPath))
+        return false;
+
+    {
+        llvm::raw_fd_ostream out(fd, /* shouldClose = */ true);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (!changes.empty()) {
+            out.write(reinterpret_cast<const char *>(changes.data()),
+                      changes.size() * sizeof(changes[0]));
+        }
+        out.write(zeros, padding);
+        out.write(reinterpret_cast<const char *>(offsets.data()),
+                  offsets.size() * sizeof(offsets[0]));
+        if (!pointers.empty()) {
+            out.write(reinterpret_cast<const char *>(pointers.data()),
+                      pointers.size() * sizeof(pointers[0]));
+        }
+
+        out.close();
+        if (out.has_error()) {
+            out.clear_error();
+            llvm::sys::fs::remove(tmpPath);
+            return false;
+        }
+    }
+
+    if (llvm::sys::fs::rename(tmpPath, _path)) {
+        llvm::sys::fs::remove(tmpPath);
+        return false;
+    }
+
+    DBG(pta, "Stored the results of pointer analysis to " << _path);
+    return true;
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
@@ -202,6 +202,67 @@ LLVMPointerGraphBuilder::insertFunctionCall(PSNode *callsite, PSNode *called) {
     addInterproceduralOperands(F, subg, CI, callsite);
 }
 
+bool
+LLVMPointerGraphBuilder::replayAdHocChange(const AdHocChange& change,
+                                           const std::vector<PSNode *>& nodesById) {
+    auto getNode = [&nodesById](uint32_t id, PSNodeType type) -> PSNode * {
+        if (id >= nodesById.size() || !nodesById[id] ||
+            nodesById[id]->getType() != type)
+            return nullptr;
+        return nodesById[id];
+    };
+
+    assert(ad_hoc_building && "The graph is not built yet");
+
+    switch (change.kind) {
+        case AdHocChange::Kind::CALL: {
+            PSNode *callsite = getNode(change.node, PSNodeType::CALL_FUNCPTR);
+            PSNode *called = getNode(change.arg, PSNodeType::FUNCTION);
+            if (!callsite || !called)
+                return false;
+            insertFunctionCall(callsite, called);
+            return true;
+        }
+        case AdHocChange::Kind::PTHREAD_CREATE:
+        case AdHocChange::Kind::PTHREAD_JOIN: {
+            PSNode *callsite = getNode(change.node, PSNodeType::CALL_FUNCPTR);
+            if (!callsite)
+                return false;
+            if (change.kind == AdHocChange::Kind::PTHREAD_CREATE)
+                insertPthreadCreateByPtrCall(callsite);
+            else
+                insertPthreadJoinByPtrCall(callsite);
+            return true;
+        }
+        case AdHocChange::Kind::FORK_FUNCTION: {
+            PSNode *fork = getNode(change.node, PSNodeType::FORK);
+            PSNode *function = getNode(change.arg, PSNodeType::FUNCTION);
+            if (!fork || !function)
+                return false;
+            addFunctionToFork(function, PSNodeFork::get(fork));
+            return true;
+        }
+        case AdHocChange::Kind::JOIN_FUNCTION: {
+            PSNode *join = getNode(change.node, PSNodeType::JOIN);
+            PSNode *function = getNode(change.arg, PSNodeType::FUNCTION);
+            if (!join || !function)
+                return false;
+            addFunctionToJoin(function, PSNodeJoin::get(join));
+            return true;
+        }
+        case AdHocChange::Kind::JOIN_FORK: {
+            PSNode *join = getNode(change.node, PSNodeType::JOIN);
+            PSNode *fork = getNode(change.arg, PSNodeType::FORK);
+            if (!join || !fork)
+                return false;
+            PSNodeJoin::get(join)->addFork(PSNodeFork::get(fork));
+            return true;
+        }
+    }
+
+    return false;
+}
+
 std::vector<PSNode *>
 LLVMPointerGraphBuilder::getPointsToFunctions(const llvm::Value *calledValue)
 {
@@ -246,6 +307,7 @@ LLVMPointerGraphBuilder::createOrGetSubgraph(const llvm::Function *F)
 
         if (ad_hoc_building) {
             addProgramStructure(F, subg);
+            _adHocFunctions.insert(F);
         }
 
         return subg;
@@ -673,6 +735,18 @@ PointerGraph *LLVMPointerGraphBuilder::buildLLVMPointerGraph()
     }
 #endif // NDEBUG
 
+    // replace the calls of the small functions by the instances
+    // of their summaries (if the options say so)
+    instantiateSummaries();
+
+    // remove the nodes that are not needed (if the options say so)
+    optimizeGraph();
+
+    // the graph is built, pack the edges of the nodes.
+    // The nodes that are changed by the ad hoc building
+    // of subgraphs use their own edges again.
+    PS.freezeEdges();
+
     // set this flag to true, so that createCallToFunction
     // (and all recursive calls to this function)
     // will also add the program structure instead of only
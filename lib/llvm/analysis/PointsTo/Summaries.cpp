@@ -0,0 +1,446 @@
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Function.h>
+#include <llvm/Support/raw_os_ostream.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/llvm/analysis/PointsTo/PointerGraph.h"
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+// Function summaries. The summary of a function is the part of its subgraph
+// that works with pointers: the loads, stores, memcpys, GEPs and PHIs.
+// The casts (and GEPs with zero offset) are left out and the formal
+// arguments are replaced by the actual arguments of the call.
+// The allocations and the constants of the function are shared
+// by all the instances of the summary.
+//
+// The functions are summarized bottom-up over the strongly connected
+// components of the call graph, so the calls in the body of a function
+// are replaced by the instances of the summaries of the callees before
+// the function itself is summarized. The instance of the summary is
+// a new sequence of nodes after the call node and the call-return
+// node gets the returned values of the instance. The call is not connected
+// to the subgraph of the function anymore, so the pointers in the function
+// are computed separately for each call site and the analysis does not
+// walk through the subgraph shared by all calls.
+// The sequence is not on the CFG paths to the call-return node (and its
+// nodes need not follow their operands), so the analysis must propagate
+// the changes along the uses. The iterative solver follows only the CFG,
+// thus the graph with summaries is solved by the difference propagation
+// (see LLVMPointerAnalysisImpl).
+//
+// The subgraph of the summarized function is disconnected from the graph.
+// After the analysis, its nodes get the union of the points-to sets
+// of their instances (fillSummarizedFunctions()).
+//
+// Heap cloning: the instances of the allocator wrappers get their own copies
+// of the allocations. The copies in the instances of the callers of a wrapper
+// are copied again, up to the given number of call sites. The copies have
+// the same user data as the original allocation, so the clients that map
+// the pointers back to LLVM values see them as the original allocation.
+
+namespace {
+
+// the instance of the summary of a function at one call site
+class SummaryInstance {
+    PointerGraph& PS;
+    // the subgraph of the summarized function
+    const PointerSubgraph *subg;
+    // the subgraph where the instance is inserted
+    PointerSubgraph *parent;
+
+    std::unordered_map<PSNode *, PSNode *> _instances;
+    // the new nodes in the order of creation
+    std::vector<PSNode *> _created;
+    // the PHI nodes whose instances do not have the operands yet
+    std::vector<PSNode *> _phis;
+
+    // copy the allocations that are distinguished
+    // by less than this number of call sites
+    unsigned _cloneDepth;
+    std::unordered_map<const PSNode *, unsigned>& _allocDepth;
+    unsigned _clonedAllocsNum{0};
+
+    PSNode *cloneAlloc(PSNode *n) {
+        unsigned depth = _allocDepth[n];
+        if (depth >= _cloneDepth)
+            return n;
+
+        PSNodeAlloc *orig = PSNodeAlloc::get(n);
+        PSNodeAlloc *alloc = PSNodeAlloc::get(PS.create(PSNodeType::ALLOC));
+        alloc->setSize(orig->getSize());
+        if (orig->isHeap())
+            alloc->setIsHeap();
+        if (orig->isZeroInitialized())
+            alloc->setZeroInitialized();
+        if (orig->isTemporary())
+            alloc->setIsTemporary();
+
+        _allocDepth[alloc] = depth + 1;
+        ++_clonedAllocsNum;
+        return create(n, alloc);
+    }
+
+    PSNode *create(PSNode *orig, PSNode *nd) {
+        nd->setParent(parent);
+        nd->setUserData(orig->getUserData<void>());
+        _created.push_back(nd);
+        _instances[orig] = nd;
+        return nd;
+    }
+
+public:
+    SummaryInstance(PointerGraph& ps, const PointerSubgraph *s,
+                    PointerSubgraph *p, unsigned cloneDepth,
+                    std::unordered_map<const PSNode *, unsigned>& allocDepth)
+    : PS(ps), subg(s), parent(p), _cloneDepth(cloneDepth),
+      _allocDepth(allocDepth) {}
+
+    // the formal argument is replaced by the actual argument
+    // (or by an empty PHI node if the actual argument is not a pointer)
+    void setArgument(PSNode *arg, PSNode *actual) {
+        if (actual)
+            _instances[arg] = actual;
+        else
+            create(arg, PS.create(PSNodeType::PHI, nullptr));
+    }
+
+    // get the instance of the node of the summarized function
+    PSNode *get(PSNode *n) {
+        // globals, constants and the nodes of the caller
+        if (n->getParent() != subg)
+            return n;
+
+        auto it = _instances.find(n);
+        if (it != _instances.end())
+            return it->second;
+
+        PSNode *inst;
+        switch (n->getType()) {
+            case PSNodeType::CAST:
+                inst = get(n->getOperand(0));
+                break;
+            case PSNodeType::GEP:
+                if (PSNodeGep::get(n)->getOffset().isZero())
+                    inst = get(n->getOperand(0));
+                else
+                    inst = create(n, PS.create(PSNodeType::GEP,
+                                               get(n->getOperand(0)),
+                                               *PSNodeGep::get(n)->getOffset()));
+                break;
+            case PSNodeType::LOAD:
+                inst = create(n, PS.create(PSNodeType::LOAD,
+                                           get(n->getOperand(0))));
+                break;
+            case PSNodeType::STORE:
+                inst = create(n, PS.create(PSNodeType::STORE,
+                                           get(n->getOperand(0)),
+                                           get(n->getOperand(1))));
+                break;
+            case PSNodeType::MEMCPY:
+                inst = create(n, PS.create(PSNodeType::MEMCPY,
+                                           get(PSNodeMemcpy::get(n)->getSource()),
+                                           get(PSNodeMemcpy::get(n)->getDestination()),
+                                           *PSNodeMemcpy::get(n)->getLength()));
+                break;
+            case PSNodeType::RETURN:
+                if (n->getOperandsNum() == 1) {
+                    inst = get(n->getOperand(0));
+                    break;
+                }
+                // fall-through
+            case PSNodeType::PHI:
+            case PSNodeType::CALL_RETURN:
+                // the operands may use this node, they are added later
+                inst = create(n, PS.create(PSNodeType::PHI, nullptr));
+                _phis.push_back(n);
+                break;
+            case PSNodeType::ALLOC:
+                inst = cloneAlloc(n);
+                break;
+            default:
+                // the constants and calls of undefined functions are shared
+                return n;
+        }
+
+        _instances[n] = inst;
+        return inst;
+    }
+
+    void addPhiOperands() {
+        // the instances of the operands may add new PHI nodes
+        for (size_t i = 0; i < _phis.size(); ++i) {
+            PSNode *phi = _phis[i];
+            PSNode *inst = _instances[phi];
+            for (PSNode *op : phi->getOperands()) {
+                PSNode *opInst = get(op);
+                if (!inst->hasOperand(opInst))
+                    inst->addOperand(opInst);
+            }
+        }
+    }
+
+    const std::vector<PSNode *>& getCreated() const { return _created; }
+    unsigned getNumOfClonedAllocations() const { return _clonedAllocsNum; }
+};
+
+} // anonymous namespace
+
+bool LLVMPointerGraphBuilder::canSummarize(const llvm::Function *F,
+                                           PointerSubgraph *subg,
+                                           const std::vector<PSNode *>& nodes,
+                                           unsigned maxNodes) const {
+    // the functions that may be called via pointers
+    // must keep the subgraph connected to the calls
+    if (subg == PS.getEntry() || F->isVarArg() || F->hasAddressTaken())
+        return false;
+
+    if (nodes.size() > maxNodes)
+        return false;
+
+    const auto& callers = PSNodeEntry::cast(subg->root)->getCallers();
+    if (callers.empty())
+        return false;
+
+    for (PSNode *call : callers) {
+        if (call->getType() != PSNodeType::CALL || !call->getParent())
+            return false;
+    }
+
+    for (PSNode *nd : nodes) {
+        switch (nd->getType()) {
+            case PSNodeType::ENTRY:
+            case PSNodeType::NOOP:
+            case PSNodeType::ALLOC:
+            case PSNodeType::CONSTANT:
+            case PSNodeType::CAST:
+            case PSNodeType::GEP:
+            case PSNodeType::LOAD:
+            case PSNodeType::STORE:
+            case PSNodeType::MEMCPY:
+            case PSNodeType::PHI:
+            case PSNodeType::RETURN:
+            case PSNodeType::CALL_RETURN:
+                break;
+            case PSNodeType::CALL:
+                // a call of a function that was not summarized
+                if (!PSNodeCall::cast(nd)->getCallees().empty())
+                    return false;
+                break;
+            default:
+                // calls via pointers, threads and invalidating memory
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool LLVMPointerGraphBuilder::isAllocationWrapper(const llvm::Function *F,
+                                                  const std::vector<PSNode *>& nodes) const {
+    const std::string name = F->getName().str();
+    if (_options.allocationWrappers.count(name) > 0 ||
+        _options.isAllocationFunction(name))
+        return true;
+
+    // a small function that returns a pointer to memory allocated on heap
+    // (by itself or by the instance of another wrapper)
+    if (!F->getReturnType()->isPointerTy() ||
+        nodes.size() > _options.summaryMaxNodes)
+        return false;
+
+    for (PSNode *nd : nodes) {
+        PSNodeAlloc *alloc = PSNodeAlloc::get(nd);
+        if (alloc && alloc->isHeap())
+            return true;
+    }
+
+    return false;
+}
+
+void LLVMPointerGraphBuilder::instantiateSummary(const llvm::Function *F,
+                                                 PointerSubgraph *subg,
+                                                 const std::vector<PSNode *>& nodes,
+                                                 PSNodeCall *callNode,
+                                                 std::vector<PSNode *>& callerNodes,
+                                                 bool cloneAllocs,
+                                                 std::unordered_map<const PSNode *, unsigned>& allocDepth) {
+    PSNode *retNode = callNode->getPairedNode();
+    const llvm::CallInst *CI = retNode->getUserData<llvm::CallInst>();
+    assert(CI && "The call-return node has no call instruction");
+
+    SummaryInstance inst(PS, subg, callNode->getParent(),
+                         cloneAllocs ? _options.heapCloning : 0, allocDepth);
+
+    unsigned idx = 0;
+    for (auto A = F->arg_begin(), E = F->arg_end(); A != E; ++A, ++idx) {
+        auto *seq = getNodes(&*A);
+        if (!seq)
+            continue;
+
+        PSNode *actual = nullptr;
+        if (idx < CI->getNumArgOperands())
+            actual = tryGetOperand(CI->getArgOperand(idx));
+        inst.setArgument(seq->getSingleNode(), actual);
+    }
+
+    for (PSNode *nd : nodes) {
+        // the return from a function that returns no pointer
+        if (nd->getType() == PSNodeType::RETURN && nd->getOperandsNum() == 0)
+            continue;
+
+        PSNode *ndInst = inst.get(nd);
+        // the allocation points to itself, not to its copies
+        if (ndInst != nd && nd->getType() != PSNodeType::ALLOC)
+            _summaryInstances.emplace_back(nd, ndInst);
+    }
+    inst.addPhiOperands();
+    _clonedAllocationsNum += inst.getNumOfClonedAllocations();
+
+    // The instance hangs on the call node, so that it is reachable,
+    // but it is not on the loops of the caller (the GEPs on loops
+    // get unknown offsets, see PointerAnalysisFI::preprocessGEPs()).
+    const auto& created = inst.getCreated();
+    PSNode *last = callNode;
+    for (PSNode *nd : created) {
+        last->addSuccessor(nd);
+        last = nd;
+    }
+    callerNodes.insert(callerNodes.end(), created.begin(), created.end());
+
+    // disconnect the call from the subgraph
+    callNode->removeCallee(subg);
+    PSNodeEntry::cast(subg->root)->removeCaller(callNode);
+
+    PSNodeCallRet *callRet = PSNodeCallRet::cast(retNode);
+    retNode->removeAllOperands();
+    for (PSNode *r : subg->returnNodes) {
+        PSNodeRet::get(r)->removeReturnSite(retNode);
+        callRet->removeReturn(r);
+
+        if (r->getOperandsNum() == 0)
+            continue;
+
+        PSNode *op = inst.get(r);
+        if (!retNode->hasOperand(op))
+            retNode->addOperand(op);
+    }
+}
+
+void LLVMPointerGraphBuilder::instantiateSummaries() {
+    // the instances are not ordered in the CFG like the instructions,
+    // so only the flow-insensitive analysis can use them. The analyses that
+    // change the graph after it was analyzed need the calls connected.
+    if ((!_options.functionSummaries && _options.heapCloning == 0) ||
+        !_options.isFI() || _options.isDemandDriven() ||
+        _options.incremental || threads_)
+        return;
+
+    DBG_SECTION_BEGIN(pta, "Instantiating function summaries");
+
+    std::unordered_map<const PointerSubgraph *, const llvm::Function *> functions;
+    for (auto& it : subgraphs_map)
+        functions[it.second] = it.first;
+
+    std::unordered_map<const PointerSubgraph *, std::vector<PSNode *>> nodes;
+    for (const auto& nd : PS.getNodes()) {
+        if (nd && nd->getParent())
+            nodes[nd->getParent()].push_back(nd.get());
+    }
+
+    // how many call sites distinguish the copies of allocations
+    std::unordered_map<const PSNode *, unsigned> allocDepth;
+    size_t instancesNum = 0;
+    // the callees go before the callers
+    for (const auto& scc : PS.getCallGraph().getSCCs()) {
+        // recursive functions are not summarized
+        if (scc.size() != 1 || scc[0]->calls(scc[0]))
+            continue;
+
+        PSNode *root = scc[0]->value;
+        PointerSubgraph *subg = root->getParent();
+        auto fit = functions.find(subg);
+        if (fit == functions.end())
+            continue;
+
+        const llvm::Function *F = fit->second;
+        const auto& funNodes = nodes[subg];
+        bool wrapper = _options.heapCloning > 0 && isAllocationWrapper(F, funNodes);
+        if (!wrapper && !_options.functionSummaries)
+            continue;
+        // the allocator wrappers are summarized whatever size they have
+        if (!canSummarize(F, subg, funNodes,
+                          wrapper ? ~0U : _options.summaryMaxNodes))
+            continue;
+
+        // the callers are removed while instantiating
+        auto callers = PSNodeEntry::cast(root)->getCallers();
+        for (PSNode *call : callers) {
+            PointerSubgraph *callerSubg = call->getParent();
+            instantiateSummary(F, subg, funNodes, PSNodeCall::cast(call),
+                               nodes[callerSubg], wrapper, allocDepth);
+            PS.unregisterCall(callerSubg->root, root);
+        }
+
+        // no call passes the arguments anymore
+        for (auto A = F->arg_begin(), E = F->arg_end(); A != E; ++A) {
+            if (auto *seq = getNodes(&*A))
+                seq->getSingleNode()->removeAllOperands();
+        }
+
+        _summarizedFunctions.insert(F);
+        instancesNum += callers.size();
+        DBG(pta, "Summarized " << (wrapper ? "allocator wrapper " : "")
+                 << F->getName().str() << " (" << funNodes.size() << " nodes, "
+                 << callers.size() << " call sites)");
+    }
+
+#ifndef NDEBUG
+    // the subgraphs of the summarized functions are not connected anymore
+    if (!validateSubgraph(true)) {
+        llvm::errs() << "Pointer Subgraph is broken!\n";
+        llvm::errs() << "This happend after instantiating the function summaries\n";
+        abort();
+    }
+#endif // NDEBUG
+
+    DBG_SECTION_END(pta, "Instantiated summaries of " << _summarizedFunctions.size()
+                         << " functions at " << instancesNum << " call sites, "
+                         << "cloned " << _clonedAllocationsNum << " allocations");
+}
+
+void LLVMPointerGraphBuilder::fillSummarizedFunctions() {
+    // the instances of the nodes of a function that were created
+    // when summarizing a caller of the function go after them,
+    // so they are filled before they are used
+    for (auto it = _summaryInstances.rbegin(), et = _summaryInstances.rend();
+         it != et; ++it) {
+        it->first->addPointsTo(it->second->pointsTo);
+    }
+}
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
@@ -226,10 +226,13 @@ bool LLVMPointerGraphBuilder::matchJoinToRightCreate(PSNode *joinNode) {
             auto oldFunctions = join->functions();
             for (auto function : pointsToFunctions) {
                 if (join->functions().count(function) == 0) {
+                    recordAdHocChange(AdHocChange::Kind::JOIN_FUNCTION,
+                                      join, function);
                     changed |= addFunctionToJoin(function, join); 
                 }
             }
             if (changed) {
+                recordAdHocChange(AdHocChange::Kind::JOIN_FORK, join, fork);
                 join->addFork(fork);
             }
         }
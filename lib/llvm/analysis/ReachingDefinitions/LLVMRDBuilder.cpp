@@ -1113,6 +1113,10 @@ ReachingDefinitionsGraph&& LLVMRDBuilder::build()
     // only when we have no dead code
     //graph.eliminateDeadCode();
 
+    // the graph is built, pack the edges of the nodes
+    // (the analyses may still change the graph, e.g., add phi nodes)
+    graph.freezeEdges();
+
     return std::move(graph);
 }
 
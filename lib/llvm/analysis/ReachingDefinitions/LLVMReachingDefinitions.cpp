@@ -33,15 +33,19 @@ void LLVMReachingDefinitions::initializeSparseRDA() {
     auto graph = builder->build();
 
     RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(
-                    new SSAReachingDefinitionsAnalysis(std::move(graph)));
+                    new SSAReachingDefinitionsAnalysis(std::move(graph), _options));
 }
 
-void LLVMReachingDefinitions::initializeDenseRDA() {
+void LLVMReachingDefinitions::initializeDenseRDA(bool blocks) {
     builder = new LLVMRDBuilder(m, pta, _options,
                                 true /* forget locals at return */);
     auto graph = builder->build();
 
-    RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(
+    if (blocks)
+        RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(
+                    new BlockReachingDefinitionsAnalysis(std::move(graph)));
+    else
+        RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(
                     new ReachingDefinitionsAnalysis(std::move(graph)));
 }
 
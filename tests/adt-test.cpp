@@ -5,7 +5,10 @@
 #include "test-runner.h"
 
 #include "dg/ADT/Queue.h"
+#include "dg/ADT/Arena.h"
 #include "dg/ADT/Bitvector.h"
+#include "dg/ADT/SmallSortedSet.h"
+#include "dg/analysis/CallGraph.h"
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
 
 using namespace dg::ADT;
@@ -74,6 +77,130 @@ struct mycomp
     }
 };
 
+class TestArena : public Test
+{
+    struct Counted {
+        int& destroyed;
+        uint64_t value;
+        Counted(int& d, uint64_t v) : destroyed(d), value(v) {}
+        ~Counted() { ++destroyed; }
+    };
+
+public:
+    TestArena() : Test("arena test")
+    {}
+
+    void test()
+    {
+        int destroyed = 0;
+        {
+            Arena arena(64);
+            std::vector<ArenaPtr<Counted>> objects;
+            for (uint64_t i = 0; i < 1000; ++i)
+                objects.emplace_back(arena.create<Counted>(destroyed, i));
+
+            for (uint64_t i = 0; i < 1000; ++i) {
+                check(objects[i]->value == i, "Wrong value in the arena");
+                check(reinterpret_cast<uintptr_t>(objects[i].get())
+                        % alignof(Counted) == 0, "Misaligned object");
+            }
+
+            // objects bigger than the chunk get their own chunk
+            char *big = static_cast<char *>(arena.allocate(10000, 1));
+            big[9999] = 1;
+
+            check(arena.getAllocatedBytes() == 1000 * sizeof(Counted) + 10000,
+                  "Wrong number of allocated bytes");
+
+            objects.resize(10);
+            check(destroyed == 990, "Did not destroy the objects");
+        }
+        check(destroyed == 1000, "Did not destroy the objects");
+
+        blocks();
+        allocator();
+    }
+
+    void blocks()
+    {
+        Arena arena(64);
+        void *a = arena.allocateBlock(20, 8);
+        void *b = arena.allocateBlock(24, 8);
+        check(a != b, "Got the same block twice");
+
+        // the released blocks are reused for the blocks of the same size class
+        arena.releaseBlock(a, 20);
+        check(arena.allocateBlock(32, 8) == a, "Did not reuse the released block");
+        check(arena.allocateBlock(20, 8) != a, "Reused the allocated block");
+        arena.releaseBlock(b, 24);
+        check(arena.allocateBlock(64, 8) != b, "Reused the block of smaller size");
+
+        // the big blocks go to the heap
+        size_t bytes = arena.getAllocatedBytes();
+        void *big = arena.allocateBlock(100000, 8);
+        check(arena.getAllocatedBytes() == bytes, "Allocated a big block in the arena");
+        arena.releaseBlock(big, 100000);
+
+        arena.stopRecycling();
+        void *c = arena.allocateBlock(128, 8);
+        arena.releaseBlock(c, 128);
+        check(arena.allocateBlock(128, 8) != c, "Reused a block after stopping recycling");
+    }
+
+    void allocator()
+    {
+        Arena arena;
+        using VecT = std::vector<uint64_t, ArenaAllocator<uint64_t>>;
+        VecT vec{ArenaAllocator<uint64_t>(&arena)};
+        for (uint64_t i = 0; i < 10000; ++i)
+            vec.push_back(i);
+
+        bool ok = true;
+        for (uint64_t i = 0; i < 10000; ++i)
+            ok &= vec[i] == i;
+        check(ok, "Wrong values in the vector");
+
+        // the swapped vectors keep their allocators
+        VecT heap;
+        heap.push_back(1);
+        heap.swap(vec);
+        check(heap.get_allocator().getArena() == &arena, "The allocator was not swapped");
+        check(vec.get_allocator().getArena() == nullptr, "The allocator was not swapped");
+        check(heap.size() == 10000 && vec.size() == 1, "Wrong size after swap");
+    }
+};
+
+class TestSmallSortedSet : public Test
+{
+public:
+    TestSmallSortedSet() : Test("small sorted set test")
+    {}
+
+    void test()
+    {
+        SmallSortedSet<int, 2> S{3, 1};
+        check(S.size() == 2, "Wrong size");
+        check(!S.insert(3).second, "Inserted an element twice");
+
+        // the third element moves the set to the heap
+        check(S.insert(2).second, "Did not insert an element");
+        check(S.insert(0).second, "Did not insert an element");
+        check(S.size() == 4, "Wrong size");
+        int expected = 0;
+        for (int x : S)
+            check(x == expected++, "The set is not sorted");
+        check(S.count(2) == 1 && S.count(5) == 0, "Wrong count");
+
+        SmallSortedSet<int, 2> copy = S;
+        check(copy == S, "The copy differs");
+
+        S.clear();
+        check(S.empty(), "The cleared set is not empty");
+        check(S.insert(7).second && S.size() == 1, "Wrong insert after clear");
+        check(copy.size() == 4, "Clear changed the copy");
+    }
+};
+
 class TestPrioritySet : public Test
 {
 public:
@@ -150,6 +277,47 @@ public:
     }
 };
 
+class TestCallGraphSCCs : public Test
+{
+public:
+    TestCallGraphSCCs() : Test("call graph SCCs test")
+    {}
+
+    void test()
+    {
+        // 1 -> 2 -> 3 -> 2, 1 -> 4, 3 -> 5, 5 -> 5
+        int f[6] = {0, 1, 2, 3, 4, 5};
+        GenericCallGraph<int> CG;
+        CG.addCall(f[1], f[2]);
+        CG.addCall(f[2], f[3]);
+        CG.addCall(f[3], f[2]);
+        CG.addCall(f[1], f[4]);
+        CG.addCall(f[3], f[5]);
+        CG.addCall(f[5], f[5]);
+
+        auto SCCs = CG.getSCCs();
+        check(SCCs.size() == 4, "Wrong number of SCCs");
+
+        std::map<int, size_t> pos;
+        for (size_t i = 0; i < SCCs.size(); ++i) {
+            for (auto *fn : SCCs[i])
+                pos[fn->value] = i;
+        }
+
+        check(pos.size() == 5, "Not all functions are in SCCs");
+        check(pos[2] == pos[3], "Recursive functions are not in one SCC");
+        check(SCCs[pos[2]].size() == 2, "Wrong size of the recursive SCC");
+        // the callees go before the callers
+        check(pos[5] < pos[3], "Wrong order of SCCs");
+        check(pos[3] < pos[1], "Wrong order of SCCs");
+        check(pos[4] < pos[1], "Wrong order of SCCs");
+
+        check(CG.removeCall(f[3], f[2]), "Did not remove the call");
+        check(!CG.removeCall(f[3], f[2]), "Removed the call twice");
+        check(CG.getSCCs().size() == 5, "Wrong number of SCCs");
+    }
+};
+
 }; // namespace tests
 }; // namespace dg
 
@@ -160,8 +328,11 @@ int main()
 
     Runner.add(new TestLIFO());
     Runner.add(new TestFIFO());
+    Runner.add(new TestArena());
+    Runner.add(new TestSmallSortedSet());
     Runner.add(new TestPrioritySet());
     Runner.add(new TestIntervalsHandling());
+    Runner.add(new TestCallGraphSCCs());
 
     return Runner();
 }
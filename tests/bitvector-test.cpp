@@ -2,10 +2,13 @@
 #include "catch.hpp"
 
 #include <random>
+#include <set>
 
 #include "dg/ADT/Bitvector.h"
+#include "dg/ADT/DenseBitvector.h"
 
 using dg::ADT::SparseBitvector;
+using dg::ADT::DenseBitvector;
 
 TEST_CASE("Querying empty set", "SparseBitvector") {
     SparseBitvector B;
@@ -205,3 +208,184 @@ TEST_CASE("Merge random bitvectors (union)", "SparseBitvector") {
 //    B2.merge(B1);
 //    REQUIRE(B1 == B2);
 }
+
+TEST_CASE("Size and unset", "SparseBitvector") {
+    SparseBitvector B;
+    std::set<size_t> numbers;
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, 10000);
+
+    for (int i = 0; i < 1000; ++i) {
+        auto x = distribution(generator);
+        REQUIRE(B.set(x) == (numbers.count(x) > 0));
+        numbers.insert(x);
+        REQUIRE(B.size() == numbers.size());
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        auto x = distribution(generator);
+        REQUIRE(B.unset(x) == (numbers.count(x) > 0));
+        numbers.erase(x);
+        REQUIRE(B.size() == numbers.size());
+    }
+
+    // the iteration goes in the increasing order
+    auto it = numbers.begin();
+    for (auto x : B) {
+        REQUIRE(it != numbers.end());
+        REQUIRE(x == *it);
+        ++it;
+    }
+    REQUIRE(it == numbers.end());
+
+    for (auto x : numbers)
+        REQUIRE(B.unset(x) == true);
+    REQUIRE(B.empty());
+    REQUIRE(B.size() == 0);
+    REQUIRE(B.begin() == B.end());
+}
+
+TEST_CASE("Union of overlapping bitvectors", "SparseBitvector") {
+    SparseBitvector B1;
+    SparseBitvector B2;
+
+    B1.set(1);
+    B1.set(200);
+    B2.set(1);
+    B2.set(200);
+
+    // no new element
+    REQUIRE(B1.set(B2) == false);
+    REQUIRE(B1.size() == 2);
+
+    B2.set(2);
+    B2.set(1000);
+    B2.set(64);
+    REQUIRE(B1.set(B2) == true);
+    REQUIRE(B1.size() == 5);
+    REQUIRE(B1.set(B2) == false);
+
+    size_t expected[] = {1, 2, 64, 200, 1000};
+    size_t i = 0;
+    for (auto x : B1) {
+        REQUIRE(i < 5);
+        REQUIRE(x == expected[i++]);
+    }
+    REQUIRE(i == 5);
+}
+
+TEST_CASE("Copy, move and swap", "SparseBitvector") {
+    SparseBitvector Small;
+    SparseBitvector Big;
+
+    Small.set(3);
+    for (size_t i = 0; i < 100; ++i)
+        Big.set(i * 100);
+
+    SparseBitvector C1(Small);
+    SparseBitvector C2(Big);
+    REQUIRE(C1.size() == 1);
+    REQUIRE(C2.size() == 100);
+    REQUIRE(C2.get(9900));
+
+    C1.swap(C2);
+    REQUIRE(C1.size() == 100);
+    REQUIRE(C2.size() == 1);
+    REQUIRE(C1.get(9900));
+    REQUIRE(C2.get(3));
+
+    SparseBitvector M(std::move(C1));
+    REQUIRE(M.size() == 100);
+    REQUIRE(C1.empty());
+
+    C1 = M;
+    M.reset();
+    REQUIRE(M.empty());
+    REQUIRE(C1.size() == 100);
+    for (size_t i = 0; i < 100; ++i)
+        REQUIRE(C1.get(i * 100));
+}
+
+TEST_CASE("Dense bitvector agrees with sparse bitvector", "DenseBitvector") {
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, 3000);
+
+    for (int round = 0; round < 100; ++round) {
+        SparseBitvector S1, S2;
+        DenseBitvector D1, D2;
+
+        for (int i = 0; i < 200; ++i) {
+            auto x = distribution(generator) + round * 10;
+            auto y = distribution(generator);
+            REQUIRE(D1.set(x) == S1.set(x));
+            REQUIRE(D2.set(y) == S2.set(y));
+        }
+
+        for (int i = 0; i < 50; ++i) {
+            auto x = distribution(generator);
+            REQUIRE(D1.unset(x) == S1.unset(x));
+        }
+
+        REQUIRE(D1.set(D2) == S1.set(S2));
+        REQUIRE(D1.set(D2) == false);
+        REQUIRE(D1.size() == S1.size());
+
+        auto it = S1.begin();
+        for (auto x : D1) {
+            REQUIRE(it != S1.end());
+            REQUIRE(x == *it);
+            ++it;
+        }
+        REQUIRE(it == S1.end());
+    }
+}
+
+TEST_CASE("Dense bitvector intersection", "DenseBitvector") {
+    DenseBitvector A, B;
+    for (size_t i = 0; i < 1000; i += 2)
+        A.set(i);
+    for (size_t i = 500; i < 2000; i += 3)
+        B.set(i);
+
+    REQUIRE(A.intersect(B) == true);
+    REQUIRE(A.intersect(B) == false);
+
+    size_t n = 0;
+    for (auto x : A) {
+        REQUIRE(x >= 500);
+        REQUIRE(x < 1000);
+        REQUIRE(x % 6 == 2); // even and 500 + 3k
+        ++n;
+    }
+    REQUIRE(n == A.size());
+
+    DenseBitvector E;
+    REQUIRE(A.intersect(E) == true);
+    REQUIRE(A.empty());
+    REQUIRE(A.begin() == A.end());
+}
+
+TEST_CASE("Vector kernels agree with scalar kernels", "DenseBitvector") {
+    using namespace dg::ADT::dense_bits;
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, ~static_cast<uint64_t>(0));
+
+    for (size_t n = 0; n < 20; ++n) {
+        std::vector<WordT> L(n), R(n);
+        for (size_t i = 0; i < n; ++i) {
+            L[i] = distribution(generator) & distribution(generator);
+            R[i] = distribution(generator) & distribution(generator);
+        }
+
+        auto L1 = L, L2 = L;
+        REQUIRE(orWords(L1.data(), R.data(), n) ==
+                orWordsScalar(L2.data(), R.data(), n));
+        REQUIRE(L1 == L2);
+
+        L1 = L; L2 = L;
+        REQUIRE(andWords(L1.data(), R.data(), n) ==
+                andWordsScalar(L2.data(), R.data(), n));
+        REQUIRE(L1 == L2);
+    }
+}
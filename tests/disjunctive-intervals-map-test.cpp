@@ -9,6 +9,7 @@
 
 #include "dg/analysis/Offset.h"
 #include "dg/analysis/ReachingDefinitions/DisjunctiveIntervalMap.h"
+#include "dg/analysis/ReachingDefinitions/FlatDisjunctiveIntervalMap.h"
 
 using namespace dg::analysis::rd;
 using dg::analysis::Offset;
@@ -27,13 +28,14 @@ static std::ostream& operator<<(std::ostream& os, const std::vector<std::tuple<i
 }
 
 
-template<typename ValueT, typename IntervalValueT>
-class DisjunctiveIntervalMapMatcher : public Catch::MatcherBase<DisjunctiveIntervalMap<ValueT, IntervalValueT>> {
+template<typename ValueT, typename IntervalValueT,
+         typename MapT = DisjunctiveIntervalMap<ValueT, IntervalValueT>>
+class DisjunctiveIntervalMapMatcher : public Catch::MatcherBase<MapT> {
     std::vector<std::tuple<IntervalValueT, IntervalValueT, ValueT>> structure;
 public:
     DisjunctiveIntervalMapMatcher(std::vector<std::tuple<IntervalValueT, IntervalValueT, ValueT>> s) : structure(std::move(s)) { }
 
-    bool match(const DisjunctiveIntervalMap<ValueT, IntervalValueT>& M) const override {
+    bool match(const MapT& M) const override {
         if (M.size() != structure.size()) {
             return false;
         }
@@ -67,8 +69,9 @@ public:
     }
 };
 
-static inline DisjunctiveIntervalMapMatcher<int, int> HasStructure(std::initializer_list<std::tuple<int, int, int>> structure) {
-    return DisjunctiveIntervalMapMatcher<int, int>(structure);
+template <typename MapT = DisjunctiveIntervalMap<int, int>>
+static inline DisjunctiveIntervalMapMatcher<int, int, MapT> HasStructure(std::initializer_list<std::tuple<int, int, int>> structure) {
+    return DisjunctiveIntervalMapMatcher<int, int, MapT>(structure);
 }
 
 TEST_CASE("Querying empty set", "DisjunctiveIntervalMap") {
@@ -577,3 +580,121 @@ TEST_CASE("Uncovered - regression 1", "DisjunctiveIntervalMap") {
     ret = M.uncovered(0,3);
     REQUIRE(ret.size() == 0);
 }
+
+TEST_CASE("Overlaps the previous interval", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int, int> M;
+    M.add(0,10, 0);
+    M.add(30,40, 0);
+
+    REQUIRE(M.overlaps(5,20));
+    REQUIRE(M.overlapsFull(5,8));
+    REQUIRE(!M.overlapsFull(5,20));
+    REQUIRE(!M.overlaps(11,29));
+}
+
+TEST_CASE("Uncovered - regression 2", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int> M;
+    using IntT = decltype(M)::IntervalT;
+
+    M.update(2,4, 0);
+    M.update(8,9, 0);
+
+    // the gap before the next interval must not exceed the queried interval
+    auto ret = M.uncovered(1,5);
+    REQUIRE(ret.size() == 2);
+    REQUIRE(ret[0] == IntT{1,1});
+    REQUIRE(ret[1] == IntT{5,5});
+}
+
+TEST_CASE("Flat split", "FlatDisjunctiveIntervalMap") {
+    using MapT = FlatDisjunctiveIntervalMap<int, int>;
+    MapT M;
+
+    M.update(0,4, 1);
+    M.update(0,1, 2);
+    M.update(1,2, 3);
+    M.update(2,3, 4);
+    M.update(3,4, 5);
+
+    REQUIRE_THAT(M, HasStructure<MapT>({
+        std::make_tuple(0,0, 2),
+        std::make_tuple(1,1, 3),
+        std::make_tuple(2,2, 4),
+        std::make_tuple(3,3, 5),
+        std::make_tuple(4,4, 5)
+    }));
+}
+
+TEST_CASE("Flat many values", "FlatDisjunctiveIntervalMap") {
+    // more values than is stored inline
+    FlatDisjunctiveIntervalMap<int, int, 2> M;
+    for (int i = 10; i > 0; --i)
+        REQUIRE(M.add(0,3, i));
+    REQUIRE(!M.add(0,3, 5));
+    REQUIRE(M.size() == 1);
+
+    auto values = M.gather(0,3);
+    REQUIRE(values.size() == 10);
+    REQUIRE(std::is_sorted(M.begin()->second.begin(), M.begin()->second.end()));
+
+    // the values are copied on split
+    REQUIRE(M.update(2,5, 0));
+    REQUIRE(M.size() == 3);
+    REQUIRE(M.gather(0,1).size() == 10);
+    REQUIRE(M.gather(2,2) == std::set<int>{0});
+    REQUIRE(M.gather(1,2).size() == 11);
+}
+
+// do the same random operations on both maps and compare the results
+template <typename IntervalValueT>
+static void crossCheck(unsigned seed) {
+    DisjunctiveIntervalMap<int, IntervalValueT> M1;
+    FlatDisjunctiveIntervalMap<int, IntervalValueT> M2;
+    using IntT = typename decltype(M1)::IntervalT;
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> start(0, 30);
+    std::uniform_int_distribution<int> length(0, 8);
+    std::uniform_int_distribution<int> value(0, 6);
+
+    auto randomInterval = [&]() {
+        IntervalValueT s = start(generator);
+        return IntT(s, s + length(generator));
+    };
+
+    for (int i = 0; i < 40; ++i) {
+        auto I = randomInterval();
+        int val = value(generator);
+        switch (generator() % 5) {
+        case 0:
+            REQUIRE(M1.update(I, val) == M2.update(I, val));
+            break;
+        case 1:
+            REQUIRE(M1.addAll(val) == M2.addAll(val));
+            break;
+        default:
+            REQUIRE(M1.add(I, val) == M2.add(I, val));
+        }
+
+        REQUIRE(M1.size() == M2.size());
+        auto it = M2.begin();
+        for (const auto& pair : M1) {
+            REQUIRE(pair.first == it->first);
+            REQUIRE(pair.second == std::set<int>(it->second.begin(), it->second.end()));
+            ++it;
+        }
+
+        auto Q = randomInterval();
+        REQUIRE(M1.overlaps(Q) == M2.overlaps(Q));
+        REQUIRE(M1.overlapsFull(Q) == M2.overlapsFull(Q));
+        REQUIRE(M1.gather(Q) == M2.gather(Q));
+        REQUIRE(M1.uncovered(Q) == M2.uncovered(Q));
+    }
+}
+
+TEST_CASE("Flat map cross-check", "FlatDisjunctiveIntervalMap") {
+    for (unsigned seed = 0; seed < 500; ++seed) {
+        crossCheck<int>(seed);
+        crossCheck<Offset>(seed);
+    }
+}
@@ -18,6 +18,7 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
         S.insert(numbers[i]);
     }
 
+    assert(B.size() == S.size());
     for (auto x : S) {
         assert(B.get(x));
     }
@@ -7,10 +7,29 @@
 #endif
 
 #include "dg/analysis/ReachingDefinitions/DisjunctiveIntervalMap.h"
+#include "dg/analysis/ReachingDefinitions/FlatDisjunctiveIntervalMap.h"
+
+using dg::analysis::rd::DisjunctiveIntervalMap;
+using dg::analysis::rd::FlatDisjunctiveIntervalMap;
+
+// check that both implementations of the map have the same intervals
+static void checkSame(const DisjunctiveIntervalMap<int, int>& M,
+                      const FlatDisjunctiveIntervalMap<int, int>& F) {
+    assert(M.size() == F.size());
+    auto it = F.begin();
+    for (const auto& pair : M) {
+        assert(pair.first == it->first);
+        assert(pair.second == std::set<int>(it->second.begin(), it->second.end()));
+        ++it;
+        (void)pair;
+    }
+    (void)it;
+}
 
 extern "C"
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
-    dg::analysis::rd::DisjunctiveIntervalMap<int, int> M;
+    DisjunctiveIntervalMap<int, int> M;
+    FlatDisjunctiveIntervalMap<int, int> F;
 
     const auto elems = size / sizeof(int);
     if (elems == 0)
@@ -26,9 +45,24 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
         printf("Adding [%d, %d]\n", a, b);
         fflush(stdout);
 #endif
-        M.add(a, b, 0);
+        // use also updates and more values, so that the intervals
+        // have different sets of values
+        const int val = i % 3;
+        bool changed, flatChanged;
+        if (i % 4 == 2) {
+            changed = M.update(a, b, val);
+            flatChanged = F.update(a, b, val);
+        } else {
+            changed = M.add(a, b, val);
+            flatChanged = F.add(a, b, val);
+        }
+        assert(changed == flatChanged);
+        (void)changed;
+        (void)flatChanged;
+
+        checkSame(M, F);
+        assert(M.gather(a, b) == F.gather(a, b));
     }
 
     return 0;
 }
-
@@ -16,7 +16,9 @@ using dg::analysis::pta::SeparateOffsetsPointsToSet;
 using dg::analysis::pta::SmallOffsetsPointsToSet;
 using dg::analysis::pta::AlignedSmallOffsetsPointsToSet;
 using dg::analysis::pta::PointerIdPointsToSet;
+using dg::analysis::pta::DensePointerIdPointsToSet;
 using dg::analysis::pta::AlignedPointerIdPointsToSet;
+using dg::analysis::pta::HashConsedPointsToSet;
 
 template<typename PTSetT>
 void queryingEmptySet() {
@@ -256,14 +258,102 @@ void testSmallOverflowBehavior() { //only works for SmallOffsetsPTSet
     REQUIRE(S.overflowSetSize() == 0);
 }
 
+template<typename PTSetT>
+void multipleGraphsTest() {
+    // the nodes of both graphs have the same IDs,
+    // the sets must not mix them up
+    PointerGraph PS1;
+    PointerGraph PS2;
+    PSNode* A1 = PS1.create(PSNodeType::ALLOC);
+    PSNode* B1 = PS1.create(PSNodeType::ALLOC);
+    PSNode* A2 = PS2.create(PSNodeType::ALLOC);
+    PSNode* B2 = PS2.create(PSNodeType::ALLOC);
+    REQUIRE(A1->getID() == A2->getID());
+
+    PTSetT S1;
+    PTSetT S2;
+    REQUIRE(S1.add(Pointer(B1, 8)) == true);
+    REQUIRE(S2.add(Pointer(A2, 0)) == true);
+    REQUIRE(S2.add(Pointer(B2, 16)) == true);
+    REQUIRE(S1.add(Pointer(A1, 4)) == true);
+    REQUIRE(S1.add(Pointer(dg::analysis::pta::NULLPTR, 0)) == true);
+    REQUIRE(S2.add(Pointer(dg::analysis::pta::UNKNOWN_MEMORY,
+                           dg::analysis::Offset::UNKNOWN)) == true);
+
+    REQUIRE(S1.pointsTo(Pointer(A1, 4)));
+    REQUIRE(S1.pointsTo(Pointer(B1, 8)));
+    REQUIRE(!S1.pointsTo(Pointer(A2, 0)));
+    REQUIRE(S1.hasNull());
+    REQUIRE(!S1.hasUnknown());
+    REQUIRE(S2.pointsTo(Pointer(A2, 0)));
+    REQUIRE(S2.pointsTo(Pointer(B2, 16)));
+    REQUIRE(!S2.pointsTo(Pointer(B1, 8)));
+    REQUIRE(S2.hasUnknown());
+    REQUIRE(!S2.hasNull());
+
+    for (const auto& ptr : S1)
+        REQUIRE((ptr.target == A1 || ptr.target == B1 ||
+                 ptr.target == dg::analysis::pta::NULLPTR));
+    for (const auto& ptr : S2)
+        REQUIRE((ptr.target == A2 || ptr.target == B2 ||
+                 ptr.target == dg::analysis::pta::UNKNOWN_MEMORY));
+
+    // a set with only special nodes can be merged into a set of any graph
+    PTSetT S3;
+    REQUIRE(S3.add(Pointer(dg::analysis::pta::NULLPTR, 0)) == true);
+    REQUIRE(S2.add(S3) == true);
+    REQUIRE(S2.hasNull());
+    REQUIRE(S2.size() == 4);
+}
+
+// the same sets are shared and the unions are memoized
+void hashConsingTest() {
+    PointerGraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+    auto& pool = PS.create(PSNodeType::ALLOC)->getIdTable()->getSetPool();
+
+    HashConsedPointsToSet S1;
+    HashConsedPointsToSet S2;
+    REQUIRE(S1.add(Pointer(A, 0)) == true);
+    REQUIRE(S1.add(Pointer(B, 8)) == true);
+    REQUIRE(S2.add(Pointer(B, 8)) == true);
+    REQUIRE(S2.add(Pointer(A, 0)) == true);
+    REQUIRE(S1 == S2);
+
+    auto sets = pool.size();
+    HashConsedPointsToSet S3;
+    REQUIRE(S3.add(Pointer(A, 4)) == true);
+    HashConsedPointsToSet S4 = S1;
+    REQUIRE(S1.add(S3) == true);
+    auto misses = pool.getMisses();
+    REQUIRE(S4.add(S3) == true);
+    REQUIRE(pool.getMisses() == misses);
+    REQUIRE(S1 == S4);
+    REQUIRE(S1.size() == 3);
+    REQUIRE(pool.size() == sets + 2);
+
+    // the unknown offset subsumes the other offsets also in unions
+    HashConsedPointsToSet S5;
+    REQUIRE(S5.add(Pointer(A, dg::analysis::Offset::UNKNOWN)) == true);
+    REQUIRE(S1.add(S5) == true);
+    REQUIRE(S1.size() == 2);
+    REQUIRE(S1.pointsTo(Pointer(A, dg::analysis::Offset::UNKNOWN)));
+    REQUIRE(!S1.pointsTo(Pointer(A, 0)));
+    REQUIRE(S1.add(Pointer(A, 8)) == false);
+    REQUIRE(S1 != S4);
+}
+
 TEST_CASE("Querying empty set", "PointsToSet") {
     queryingEmptySet<OffsetsSetPointsToSet>();
     queryingEmptySet<SimplePointsToSet>();
     queryingEmptySet<SeparateOffsetsPointsToSet>();
     queryingEmptySet<PointerIdPointsToSet>();
+    queryingEmptySet<DensePointerIdPointsToSet>();
     queryingEmptySet<SmallOffsetsPointsToSet>();
     queryingEmptySet<AlignedSmallOffsetsPointsToSet>();
     queryingEmptySet<AlignedPointerIdPointsToSet>();
+    queryingEmptySet<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Add an element", "PointsToSet") {
@@ -271,9 +361,11 @@ TEST_CASE("Add an element", "PointsToSet") {
     addAnElement<SimplePointsToSet>();
     addAnElement<SeparateOffsetsPointsToSet>();
     addAnElement<PointerIdPointsToSet>();
+    addAnElement<DensePointerIdPointsToSet>();
     addAnElement<SmallOffsetsPointsToSet>();
     addAnElement<AlignedSmallOffsetsPointsToSet>();
     addAnElement<AlignedPointerIdPointsToSet>();
+    addAnElement<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Add few elements", "PointsToSet") {
@@ -281,9 +373,11 @@ TEST_CASE("Add few elements", "PointsToSet") {
     addFewElements<SimplePointsToSet>();
     addFewElements<SeparateOffsetsPointsToSet>();
     addFewElements<PointerIdPointsToSet>();
+    addFewElements<DensePointerIdPointsToSet>();
     addFewElements<SmallOffsetsPointsToSet>();
     addFewElements<AlignedSmallOffsetsPointsToSet>();
     addFewElements<AlignedPointerIdPointsToSet>();
+    addFewElements<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Add few elements 2", "PointsToSet") {
@@ -291,9 +385,11 @@ TEST_CASE("Add few elements 2", "PointsToSet") {
     addFewElements2<SimplePointsToSet>();
     addFewElements2<SeparateOffsetsPointsToSet>();
     addFewElements2<PointerIdPointsToSet>();
+    addFewElements2<DensePointerIdPointsToSet>();
     addFewElements2<SmallOffsetsPointsToSet>();
     addFewElements2<AlignedSmallOffsetsPointsToSet>();
     addFewElements2<AlignedPointerIdPointsToSet>();
+    addFewElements2<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Merge points-to sets", "PointsToSet") {
@@ -301,36 +397,44 @@ TEST_CASE("Merge points-to sets", "PointsToSet") {
     mergePointsToSets<SimplePointsToSet>();
     mergePointsToSets<SeparateOffsetsPointsToSet>();
     mergePointsToSets<PointerIdPointsToSet>();
+    mergePointsToSets<DensePointerIdPointsToSet>();
     mergePointsToSets<SmallOffsetsPointsToSet>();
     mergePointsToSets<AlignedSmallOffsetsPointsToSet>();
     mergePointsToSets<AlignedPointerIdPointsToSet>();
+    mergePointsToSets<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Remove element", "PointsToSet") { //SeparateOffsetsPointsToSet has different remove behavior, it isn't tested here
     removeElement<OffsetsSetPointsToSet>();
     removeElement<SimplePointsToSet>();
     removeElement<PointerIdPointsToSet>();
+    removeElement<DensePointerIdPointsToSet>();
     removeElement<SmallOffsetsPointsToSet>();
     removeElement<AlignedSmallOffsetsPointsToSet>();
     removeElement<AlignedPointerIdPointsToSet>();   
+    removeElement<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Remove few elements", "PointsToSet") { //SeparateOffsetsPointsToSet has different remove behavior, it isn't tested here
     removeFewElements<OffsetsSetPointsToSet>();
     removeFewElements<SimplePointsToSet>();
     removeFewElements<PointerIdPointsToSet>();
+    removeFewElements<DensePointerIdPointsToSet>();
     removeFewElements<SmallOffsetsPointsToSet>();
     removeFewElements<AlignedSmallOffsetsPointsToSet>();
     removeFewElements<AlignedPointerIdPointsToSet>();
+    removeFewElements<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Remove all elements pointing to a target", "PointsToSet") { //SeparateOffsetsPointsToSet has different behavior, it isn't tested here
     removeAnyTest<OffsetsSetPointsToSet>();
     removeAnyTest<SimplePointsToSet>();
     removeAnyTest<PointerIdPointsToSet>();
+    removeAnyTest<DensePointerIdPointsToSet>();
     removeAnyTest<SmallOffsetsPointsToSet>();
     removeAnyTest<AlignedSmallOffsetsPointsToSet>();
     removeAnyTest<AlignedPointerIdPointsToSet>();
+    removeAnyTest<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Test various points-to functions", "PointsToSet") {
@@ -338,9 +442,11 @@ TEST_CASE("Test various points-to functions", "PointsToSet") {
     pointsToTest<SimplePointsToSet>();
     pointsToTest<SeparateOffsetsPointsToSet>();
     pointsToTest<PointerIdPointsToSet>();
+    pointsToTest<DensePointerIdPointsToSet>();
     pointsToTest<SmallOffsetsPointsToSet>();
     pointsToTest<AlignedSmallOffsetsPointsToSet>();
     pointsToTest<AlignedPointerIdPointsToSet>();
+    pointsToTest<HashConsedPointsToSet>();
 }
 
 TEST_CASE("Test small overflow set behavior", "PointsToSet") {
@@ -351,3 +457,18 @@ TEST_CASE("Test aligned overflow set behavior", "PointsToSet") {
     testAlignedOverflowBehavior<AlignedSmallOffsetsPointsToSet>();
     testAlignedOverflowBehavior<AlignedPointerIdPointsToSet>();
 }
+
+TEST_CASE("Points-to sets of different graphs", "PointsToSet") {
+    multipleGraphsTest<OffsetsSetPointsToSet>();
+    multipleGraphsTest<SimplePointsToSet>();
+    multipleGraphsTest<PointerIdPointsToSet>();
+    multipleGraphsTest<DensePointerIdPointsToSet>();
+    multipleGraphsTest<SmallOffsetsPointsToSet>();
+    multipleGraphsTest<AlignedSmallOffsetsPointsToSet>();
+    multipleGraphsTest<AlignedPointerIdPointsToSet>();
+    multipleGraphsTest<HashConsedPointsToSet>();
+}
+
+TEST_CASE("Hash-consed points-to sets", "PointsToSet") {
+    hashConsingTest();
+}
@@ -2,6 +2,9 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <map>
+#include <set>
+#include <string>
 
 #include "test-runner.h"
 #include "test-dg.h"
@@ -9,6 +12,8 @@
 #include "dg/analysis/PointsTo/PointerGraph.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFS.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
+#include "dg/analysis/PointsTo/PointerGraphOptimizations.h"
 #include "dg/analysis/PointsTo/InvalidatedAnalysis.h"
 
 namespace dg {
@@ -934,6 +939,106 @@ public:
         check(L3->doesPointsTo(NULLPTR), "L3 does not point to NULL");
     }
 
+    void copy_cycle()
+    {
+        using namespace analysis;
+
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *D = PS.create(PSNodeType::ALLOC);
+        PSNode *P = PS.create(PSNodeType::PHI, A, nullptr);
+        PSNode *C1 = PS.create(PSNodeType::CAST, P);
+        PSNode *C2 = PS.create(PSNodeType::CAST, C1);
+        PSNode *S = PS.create(PSNodeType::STORE, C2, B);
+        PSNode *S2 = PS.create(PSNodeType::STORE, D, B);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+        PSNode *GEP = PS.create(PSNodeType::GEP, L, 0);
+        // P -> C1 -> C2 -> P and P -> ... -> L -> GEP -> P are cycles
+        P->addOperand(C2);
+        P->addOperand(GEP);
+
+        A->addSuccessor(B);
+        B->addSuccessor(D);
+        D->addSuccessor(P);
+        P->addSuccessor(C1);
+        C1->addSuccessor(C2);
+        C2->addSuccessor(S);
+        S->addSuccessor(S2);
+        S2->addSuccessor(L);
+        L->addSuccessor(GEP);
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+        PTStoT PA(&PS);
+        PA.run();
+
+        for (PSNode *n : {P, C1, C2}) {
+            check(n->doesPointsTo(A), "node in cycle do not points to A");
+            check(n->doesPointsTo(D), "node in cycle do not points to D");
+        }
+        check(L->doesPointsTo(D), "L do not points to D");
+        check(GEP->doesPointsTo(D), "GEP do not points to D");
+    }
+
+    // the analysis that builds the "called function" on calls via pointers:
+    // parameters that take the called pointer as the argument
+    class FuncPtrPTA : public PTStoT
+    {
+    public:
+        std::vector<PSNode *> params;
+
+        FuncPtrPTA(PointerGraph *ps) : PTStoT(ps) {}
+
+        bool functionPointerCall(PSNode *call, PSNode *func) override {
+            PSNode *last = call;
+            // more users than the vector of users of the pointer
+            // and its hash table can hold without growing
+            for (unsigned i = 0; i < 40; ++i) {
+                PSNode *param = this->PS->create(PSNodeType::PHI,
+                                                 call->getOperand(0), nullptr);
+                last->addSuccessor(param);
+                last = param;
+                params.push_back(param);
+            }
+
+            PTStoT::functionPointerCall(call, func);
+            return true;
+        }
+    };
+
+    void funcptr_call_adds_users(bool freeze)
+    {
+        using namespace analysis;
+
+        PointerGraph PS;
+        PSNode *F = PS.create(PSNodeType::FUNCTION);
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *P = PS.create(PSNodeType::PHI, F, nullptr);
+        PSNode *CALL = PS.create(PSNodeType::CALL_FUNCPTR, P);
+        // the user of P that comes after the call
+        PSNode *C = PS.create(PSNodeType::CAST, P);
+
+        F->addSuccessor(A);
+        A->addSuccessor(P);
+        P->addSuccessor(CALL);
+        CALL->addSuccessor(C);
+
+        auto subg = PS.createSubgraph(F);
+        PS.setEntry(subg);
+        if (freeze)
+            PS.freezeEdges();
+
+        FuncPtrPTA PA(&PS);
+        PA.run();
+
+        check(CALL->doesPointsTo(F), "call does not point to the function");
+        check(C->doesPointsTo(F), "cast does not point to the function");
+        check(PA.params.size() == 40, "the function was not called");
+        for (PSNode *param : PA.params)
+            check(param->doesPointsTo(F), "parameter does not point to F");
+    }
+
     void test()
     {
         store_load();
@@ -960,6 +1065,9 @@ public:
         memcpy_test6();
         memcpy_test7();
         memcpy_test8();
+        copy_cycle();
+        funcptr_call_adds_users(false);
+        funcptr_call_adds_users(true);
     }
 };
 
@@ -972,6 +1080,197 @@ public:
           ("flow-insensitive points-to test") {}
 };
 
+// flow-insensitive analysis that uses the difference propagation solver
+class PointerAnalysisFIDiffProp : public analysis::pta::PointerAnalysisFI
+{
+public:
+    PointerAnalysisFIDiffProp(PointerGraph *ps)
+        : PointerAnalysisFI(ps, analysis::PointerAnalysisOptions().setSolverType(
+                            analysis::PointerAnalysisOptions::SolverType::diffprop)) {}
+};
+
+class FlowInsensitiveDiffPropPointsToTest
+    : public PointsToTest<PointerAnalysisFIDiffProp>
+{
+public:
+    FlowInsensitiveDiffPropPointsToTest()
+        : PointsToTest<PointerAnalysisFIDiffProp>
+          ("flow-insensitive points-to test (difference propagation)") {}
+};
+
+// flow-insensitive analysis that processes the nodes in topological order
+class PointerAnalysisFITopological : public analysis::pta::PointerAnalysisFI
+{
+public:
+    PointerAnalysisFITopological(PointerGraph *ps)
+        : PointerAnalysisFI(ps, analysis::PointerAnalysisOptions().setWorklistOrder(
+                            analysis::PointerAnalysisOptions::WorklistOrder::topological)) {}
+};
+
+class FlowInsensitiveTopologicalPointsToTest
+    : public PointsToTest<PointerAnalysisFITopological>
+{
+public:
+    FlowInsensitiveTopologicalPointsToTest()
+        : PointsToTest<PointerAnalysisFITopological>
+          ("flow-insensitive points-to test (topological order)") {}
+};
+
+// flow-insensitive analysis that uses the parallel solver
+class PointerAnalysisFIParallel : public analysis::pta::PointerAnalysisFI
+{
+public:
+    PointerAnalysisFIParallel(PointerGraph *ps)
+        : PointerAnalysisFI(ps, analysis::PointerAnalysisOptions()
+                            .setSolverType(analysis::PointerAnalysisOptions::SolverType::parallel)
+                            .setSolverThreads(4)) {}
+};
+
+class FlowInsensitiveParallelPointsToTest
+    : public PointsToTest<PointerAnalysisFIParallel>
+{
+public:
+    FlowInsensitiveParallelPointsToTest()
+        : PointsToTest<PointerAnalysisFIParallel>
+          ("flow-insensitive points-to test (parallel)") {}
+
+    // many chains of stores and loads that the threads
+    // can take from each other
+    void many_chains(PointerGraph& PS, std::vector<PSNode *>& loads,
+                     std::vector<PSNode *>& allocs)
+    {
+        PSNode *last = PS.create(PSNodeType::NOOP);
+        PS.setEntry(PS.createSubgraph(last));
+        for (unsigned i = 0; i < 200; ++i) {
+            PSNode *A = PS.create(PSNodeType::ALLOC);
+            PSNode *B = PS.create(PSNodeType::ALLOC);
+            PSNode *C = PS.create(PSNodeType::CAST, A);
+            PSNode *S = PS.create(PSNodeType::STORE, C, B);
+            PSNode *L = PS.create(PSNodeType::LOAD, B);
+            // a copy of the loaded pointer that has the pointers
+            // of the previous chain too
+            PSNode *P = PS.create(PSNodeType::PHI, L,
+                                  loads.empty() ? nullptr : loads.back(), nullptr);
+
+            last->addSuccessor(A);
+            A->addSuccessor(B);
+            B->addSuccessor(C);
+            C->addSuccessor(S);
+            S->addSuccessor(L);
+            L->addSuccessor(P);
+            last = P;
+
+            loads.push_back(P);
+            allocs.push_back(A);
+        }
+    }
+
+    void threads1()
+    {
+        PointerGraph PS;
+        std::vector<PSNode *> loads, allocs;
+        many_chains(PS, loads, allocs);
+
+        auto opts = analysis::PointerAnalysisOptions()
+                        .setSolverType(analysis::PointerAnalysisOptions::SolverType::parallel)
+                        .setSolverThreads(4);
+        PointerAnalysisFI PA(&PS, opts);
+        PA.run();
+
+        // the sets that share a table of the graph are changed by one thread
+        unsigned threads = ChangesPointerIdTable<PointsToSetT>::value ? 1 : 4;
+        check(PA.getNumOfProcessedNodesPerThread().size() == threads,
+              "the solver did not run with all threads");
+
+        for (size_t i = 0; i < loads.size(); ++i) {
+            check(loads[i]->pointsTo.size() == i + 1, "wrong size of points-to set");
+            for (size_t j = 0; j <= i; ++j)
+                check(loads[i]->doesPointsTo(allocs[j]), "load does not point to alloc");
+        }
+    }
+
+    void test()
+    {
+        PointsToTest<PointerAnalysisFIParallel>::test();
+        threads1();
+    }
+};
+
+// demand-driven flow-insensitive analysis, run() demands all
+// reachable nodes (the last nodes first, so that the first demands
+// need to solve the nodes that they depend on)
+template <unsigned Budget>
+class PointerAnalysisFIDemand : public analysis::pta::PointerAnalysisFI
+{
+public:
+    PointerAnalysisFIDemand(PointerGraph *ps)
+        : PointerAnalysisFI(ps, analysis::PointerAnalysisOptions()
+                            .setDemandDriven(true).setDemandBudget(Budget)) {}
+
+    void run() override {
+        PointerAnalysisFI::run();
+
+        auto nodes = PS->getNodes(PS->getEntry()->getRoot());
+        for (auto it = nodes.rbegin(), et = nodes.rend(); it != et; ++it)
+            demand(*it);
+    }
+};
+
+template <unsigned Budget>
+class FlowInsensitiveDemandPointsToTest
+    : public PointsToTest<PointerAnalysisFIDemand<Budget>>
+{
+public:
+    FlowInsensitiveDemandPointsToTest(const char *n)
+        : PointsToTest<PointerAnalysisFIDemand<Budget>>(n) {}
+
+    using PointsToTest<PointerAnalysisFIDemand<Budget>>::fail;
+
+    // the demanded nodes must not be solved again
+    // and the budget decides whether the whole graph is solved
+    void demand_budget() {
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *S = PS.create(PSNodeType::STORE, A, B);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+        PSNode *C = PS.create(PSNodeType::CAST, L);
+
+        A->addSuccessor(B);
+        B->addSuccessor(S);
+        S->addSuccessor(L);
+        L->addSuccessor(C);
+        PS.setEntry(PS.createSubgraph(A));
+
+        PointerAnalysisFI PA(&PS, analysis::PointerAnalysisOptions()
+                                  .setDemandDriven(true).setDemandBudget(Budget));
+        PA.run();
+        check(PA.isDemanding(), "the analysis solved the graph before demands");
+        check(C->pointsTo.empty(), "C was solved before demanded");
+
+        PA.demand(C);
+        check(C->doesPointsTo(A), "C does not point to A");
+        check(L->doesPointsTo(A), "L does not point to A");
+
+        auto demanded = PA.getNumOfDemandedNodes();
+        PA.demand(L);
+        check(PA.getNumOfDemandedNodes() == demanded,
+                    "the demanded node was solved again");
+
+        if (Budget == 1) {
+            check(!PA.isDemanding(), "the budget was not exceeded");
+        } else {
+            check(PA.isDemanding(), "the analysis solved the whole graph");
+        }
+    }
+
+    void test()
+    {
+        PointsToTest<PointerAnalysisFIDemand<Budget>>::test();
+        demand_budget();
+    }
+};
+
 class FlowSensitivePointsToTest
     : public PointsToTest<analysis::pta::PointerAnalysisFS>
 {
@@ -981,6 +1280,346 @@ public:
           ("flow-sensitive points-to test") {}
 };
 
+// flow-sensitive analysis that processes the nodes in topological order
+class PointerAnalysisFSTopological : public analysis::pta::PointerAnalysisFS
+{
+public:
+    PointerAnalysisFSTopological(PointerGraph *ps)
+        : PointerAnalysisFS(ps, analysis::PointerAnalysisOptions().setWorklistOrder(
+                            analysis::PointerAnalysisOptions::WorklistOrder::topological)) {}
+};
+
+class FlowSensitiveTopologicalPointsToTest
+    : public PointsToTest<PointerAnalysisFSTopological>
+{
+public:
+    FlowSensitiveTopologicalPointsToTest()
+        : PointsToTest<PointerAnalysisFSTopological>
+          ("flow-sensitive points-to test (topological order)") {}
+};
+
+class SparseFlowSensitivePointsToTest
+    : public PointsToTest<analysis::pta::PointerAnalysisSFS>
+{
+public:
+    SparseFlowSensitivePointsToTest()
+        : PointsToTest<analysis::pta::PointerAnalysisSFS>
+          ("sparse flow-sensitive points-to test") {}
+};
+
+// the incremental flow-insensitive analysis (PointerAnalysisFI::retract()
+// and reanalyze()) must give the same results as the analysis that runs
+// on the changed graph from scratch
+class FlowInsensitiveIncrementalTest : public Test
+{
+    using SolverType = analysis::PointerAnalysisOptions::SolverType;
+    // the nodes of the graph by names, the same node of the changed graph
+    // and of the graph built from scratch has the same name
+    using Nodes = std::map<std::string, PSNode *>;
+
+    SolverType solver{SolverType::diffprop};
+
+public:
+    FlowInsensitiveIncrementalTest()
+        : Test("flow-insensitive incremental points-to test") {}
+
+    analysis::PointerAnalysisOptions getOptions() const {
+        auto opts = analysis::PointerAnalysisOptions().setSolverType(solver);
+        if (solver == SolverType::parallel)
+            opts.setSolverThreads(4);
+        return opts;
+    }
+
+    static std::string getName(const Nodes& nodes, PSNode *n) {
+        if (n == NULLPTR)
+            return "null";
+        if (n == UNKNOWN_MEMORY)
+            return "unknown";
+        if (n == INVALIDATED)
+            return "invalidated";
+        for (const auto& it : nodes) {
+            if (it.second == n)
+                return it.first;
+        }
+        return "<not in the graph>";
+    }
+
+    static std::set<std::pair<std::string, Offset::type>>
+    getPointsTo(const Nodes& nodes, PSNode *n) {
+        std::set<std::pair<std::string, Offset::type>> ret;
+        for (const Pointer& ptr : n->pointsTo)
+            ret.emplace(getName(nodes, ptr.target), *ptr.offset);
+        return ret;
+    }
+
+    void checkSame(const char *test, const Nodes& incremental, const Nodes& scratch) {
+        check(incremental.size() == scratch.size(),
+              "[%s] the graphs have different nodes", test);
+
+        for (const auto& it : scratch) {
+            auto inc = incremental.find(it.first);
+            if (inc == incremental.end()) {
+                check(false, "[%s] node %s is not in the changed graph",
+                      test, it.first.c_str());
+                continue;
+            }
+
+            check(getPointsTo(incremental, inc->second) == getPointsTo(scratch, it.second),
+                  "[%s] node %s has different points-to set than after running "
+                  "the analysis from scratch", test, it.first.c_str());
+        }
+    }
+
+    // A = alloc, B = alloc, G = alloc, S1 = store A -> G,
+    // [S2 = store B -> G], L = load G, C = cast L
+    void store_graph(PointerGraph& PS, Nodes& N, bool withStore) {
+        N["A"] = PS.create(PSNodeType::ALLOC);
+        N["B"] = PS.create(PSNodeType::ALLOC);
+        N["G"] = PS.create(PSNodeType::ALLOC);
+        N["S1"] = PS.create(PSNodeType::STORE, N["A"], N["G"]);
+        N["L"] = PS.create(PSNodeType::LOAD, N["G"]);
+        N["C"] = PS.create(PSNodeType::CAST, N["L"]);
+
+        N["A"]->addSuccessor(N["B"]);
+        N["B"]->addSuccessor(N["G"]);
+        N["G"]->addSuccessor(N["S1"]);
+        N["S1"]->addSuccessor(N["L"]);
+        N["L"]->addSuccessor(N["C"]);
+
+        if (withStore) {
+            N["S2"] = PS.create(PSNodeType::STORE, N["B"], N["G"]);
+            N["S2"]->insertAfter(N["S1"]);
+        }
+
+        PS.setEntry(PS.createSubgraph(N["A"]));
+    }
+
+    void remove_store() {
+        PointerGraph PS;
+        Nodes N;
+        store_graph(PS, N, true);
+
+        PointerAnalysisFI PA(&PS, getOptions());
+        PA.run();
+        check(N["C"]->doesPointsTo(N["B"]), "[remove_store] C does not point to B");
+
+        check(PA.retract({N["S2"]}), "[remove_store] retract failed");
+        N["S2"]->isolate();
+        PS.erase(N["S2"]);
+        N.erase("S2");
+        check(PA.reanalyze(), "[remove_store] reanalyze failed");
+
+        PointerGraph PS2;
+        Nodes N2;
+        store_graph(PS2, N2, false);
+        PointerAnalysisFI PA2(&PS2, getOptions());
+        PA2.run();
+
+        check(!N["C"]->doesPointsTo(N["B"]), "[remove_store] C points to B");
+        checkSame("remove_store", N, N2);
+    }
+
+    void add_store() {
+        PointerGraph PS;
+        Nodes N;
+        store_graph(PS, N, false);
+
+        PointerAnalysisFI PA(&PS, getOptions());
+        PA.run();
+
+        N["S2"] = PS.create(PSNodeType::STORE, N["B"], N["G"]);
+        N["S2"]->insertAfter(N["S1"]);
+        check(PA.reanalyze(), "[add_store] reanalyze failed");
+
+        PointerGraph PS2;
+        Nodes N2;
+        store_graph(PS2, N2, true);
+        PointerAnalysisFI PA2(&PS2, getOptions());
+        PA2.run();
+
+        check(N["C"]->doesPointsTo(N["B"]), "[add_store] C does not point to B");
+        checkSame("add_store", N, N2);
+    }
+
+    // the function f(): f.entry, f.store = store X -> G, f.ret = return X
+    // where X is A or B (the version of the function)
+    PointerSubgraph *function_graph(PointerGraph& PS, Nodes& N, bool storesA) {
+        PSNode *X = storesA ? N["A"] : N["B"];
+        N["f.entry"] = PS.create(PSNodeType::ENTRY);
+        N["f.store"] = PS.create(PSNodeType::STORE, X, N["G"]);
+        N["f.ret"] = PS.create(PSNodeType::RETURN, X, nullptr);
+
+        N["f.entry"]->addSuccessor(N["f.store"]);
+        N["f.store"]->addSuccessor(N["f.ret"]);
+
+        auto subg = PS.createSubgraph(N["f.entry"]);
+        for (const char *name : {"f.entry", "f.store", "f.ret"})
+            N[name]->setParent(subg);
+
+        PSNodeCall::cast(N["call"])->addCallee(subg);
+        PSNodeEntry::cast(N["f.entry"])->addCaller(N["call"]);
+        PSNodeRet::get(N["f.ret"])->addReturnSite(N["callret"]);
+        PSNodeCallRet::cast(N["callret"])->addReturn(N["f.ret"]);
+        N["callret"]->addOperand(N["f.ret"]);
+
+        return subg;
+    }
+
+    // main(): A = alloc, B = alloc, G = alloc, call f(), callret,
+    // L = load G, C = cast callret
+    void call_graph(PointerGraph& PS, Nodes& N, bool storesA) {
+        N["A"] = PS.create(PSNodeType::ALLOC);
+        N["B"] = PS.create(PSNodeType::ALLOC);
+        N["G"] = PS.create(PSNodeType::ALLOC);
+        N["call"] = PS.create(PSNodeType::CALL);
+        N["callret"] = PS.create(PSNodeType::CALL_RETURN, nullptr);
+        N["L"] = PS.create(PSNodeType::LOAD, N["G"]);
+        N["C"] = PS.create(PSNodeType::CAST, N["callret"]);
+
+        PSNodeCall::cast(N["call"])->setCallReturn(N["callret"]);
+        N["A"]->addSuccessor(N["B"]);
+        N["B"]->addSuccessor(N["G"]);
+        N["G"]->addSuccessor(N["call"]);
+        N["call"]->addSuccessor(N["callret"]);
+        N["callret"]->addSuccessor(N["L"]);
+        N["L"]->addSuccessor(N["C"]);
+
+        auto subg = PS.createSubgraph(N["A"]);
+        for (const char *name : {"A", "B", "G", "call", "callret", "L", "C"})
+            N[name]->setParent(subg);
+        PS.setEntry(subg);
+
+        function_graph(PS, N, storesA);
+    }
+
+    // replace the body of the called function
+    void replace_function() {
+        PointerGraph PS;
+        Nodes N;
+        call_graph(PS, N, true);
+
+        PointerAnalysisFI PA(&PS, getOptions());
+        PA.run();
+        check(N["L"]->doesPointsTo(N["A"]), "[replace_function] L does not point to A");
+        check(N["C"]->doesPointsTo(N["A"]), "[replace_function] C does not point to A");
+
+        auto *oldSubg = N["f.entry"]->getParent();
+        std::vector<PSNode *> removed{N["f.entry"], N["f.store"], N["f.ret"]};
+        check(PA.retract(removed), "[replace_function] retract failed");
+        for (PSNode *n : removed)
+            PS.erase(n);
+        PS.removeSubgraph(oldSubg);
+
+        auto *newSubg = function_graph(PS, N, false);
+        check(PA.reanalyze({newSubg}), "[replace_function] reanalyze failed");
+
+        PointerGraph PS2;
+        Nodes N2;
+        call_graph(PS2, N2, false);
+        PointerAnalysisFI PA2(&PS2, getOptions());
+        PA2.run();
+
+        check(!N["L"]->doesPointsTo(N["A"]), "[replace_function] L points to A");
+        check(!N["C"]->doesPointsTo(N["A"]), "[replace_function] C points to A");
+        checkSame("replace_function", N, N2);
+    }
+
+    // A = alloc, B = alloc, M = alloc, CB = cast B,
+    // Q1 = phi(A, [Q3]), Q2 = phi(Q1, CB), [Q3 = cast Q2],
+    // S = store Q2 -> M, L = load M
+    void cycle_graph(PointerGraph& PS, Nodes& N, bool withCycle) {
+        N["A"] = PS.create(PSNodeType::ALLOC);
+        N["B"] = PS.create(PSNodeType::ALLOC);
+        N["M"] = PS.create(PSNodeType::ALLOC);
+        N["CB"] = PS.create(PSNodeType::CAST, N["B"]);
+        N["Q1"] = PS.create(PSNodeType::PHI, N["A"], nullptr);
+        N["Q2"] = PS.create(PSNodeType::PHI, N["Q1"], N["CB"], nullptr);
+        N["S"] = PS.create(PSNodeType::STORE, N["Q2"], N["M"]);
+        N["L"] = PS.create(PSNodeType::LOAD, N["M"]);
+
+        N["A"]->addSuccessor(N["B"]);
+        N["B"]->addSuccessor(N["M"]);
+        N["M"]->addSuccessor(N["CB"]);
+        N["CB"]->addSuccessor(N["Q1"]);
+        N["Q1"]->addSuccessor(N["Q2"]);
+        N["Q2"]->addSuccessor(N["S"]);
+        N["S"]->addSuccessor(N["L"]);
+
+        if (withCycle) {
+            N["Q3"] = PS.create(PSNodeType::CAST, N["Q2"]);
+            N["Q1"]->addOperand(N["Q3"]);
+            N["Q3"]->insertAfter(N["Q2"]);
+        }
+
+        PS.setEntry(PS.createSubgraph(N["A"]));
+    }
+
+    // remove a node of a cycle, the nodes of the cycle
+    // do not share their points-to sets anymore
+    void break_cycle() {
+        PointerGraph PS;
+        Nodes N;
+        cycle_graph(PS, N, true);
+
+        PointerAnalysisFI PA(&PS, getOptions());
+        PA.run();
+        check(N["Q1"]->doesPointsTo(N["B"]), "[break_cycle] Q1 does not point to B");
+
+        check(PA.retract({N["Q3"]}), "[break_cycle] retract failed");
+        N["Q3"]->isolate();
+        PS.erase(N["Q3"]);
+        N.erase("Q3");
+        check(PA.reanalyze(), "[break_cycle] reanalyze failed");
+
+        PointerGraph PS2;
+        Nodes N2;
+        cycle_graph(PS2, N2, false);
+        PointerAnalysisFI PA2(&PS2, getOptions());
+        PA2.run();
+
+        check(!N["Q1"]->doesPointsTo(N["B"]), "[break_cycle] Q1 points to B");
+        check(N["L"]->doesPointsTo(N["B"]), "[break_cycle] L does not point to B");
+        checkSame("break_cycle", N, N2);
+    }
+
+    // close a cycle in the graph
+    void make_cycle() {
+        PointerGraph PS;
+        Nodes N;
+        cycle_graph(PS, N, false);
+
+        PointerAnalysisFI PA(&PS, getOptions());
+        PA.run();
+
+        // the new edges go from or to the new node,
+        // so nothing needs to be retracted
+        N["Q3"] = PS.create(PSNodeType::CAST, N["Q2"]);
+        N["Q1"]->addOperand(N["Q3"]);
+        N["Q3"]->insertAfter(N["Q2"]);
+        check(PA.reanalyze(), "[make_cycle] reanalyze failed");
+
+        PointerGraph PS2;
+        Nodes N2;
+        cycle_graph(PS2, N2, true);
+        PointerAnalysisFI PA2(&PS2, getOptions());
+        PA2.run();
+
+        check(N["Q1"]->doesPointsTo(N["B"]), "[make_cycle] Q1 does not point to B");
+        checkSame("make_cycle", N, N2);
+    }
+
+    void test() {
+        for (auto s : {SolverType::diffprop, SolverType::parallel}) {
+            solver = s;
+            remove_store();
+            add_store();
+            replace_function();
+            break_cycle();
+            make_cycle();
+        }
+    }
+};
+
 class PSNodeTest : public Test
 {
 
@@ -1004,9 +1643,223 @@ public:
         check(N2->addPointsTo(N1, 3) == false);
     }
 
+    // many operands and users are kept also in hash tables
+    void many_operands1()
+    {
+        using namespace dg::analysis::pta;
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *PHI = PS.create(PSNodeType::PHI, nullptr);
+        std::vector<PSNode *> ops;
+        for (int i = 0; i < 100; ++i) {
+            ops.push_back(PS.create(PSNodeType::CAST, A));
+            PHI->addOperand(ops.back());
+        }
+
+        check(PHI->getOperandsNum() == 100);
+        check(A->getUsers().size() == 100);
+        check(PHI->hasOperand(ops[0]) && PHI->hasOperand(ops[99]));
+        check(!PHI->hasOperand(A));
+
+        PHI->addOperand(ops[0]);
+        PHI->setOperand(0, A);
+        check(PHI->hasOperand(ops[0]) && PHI->hasOperand(A));
+        PHI->setOperand(100, A);
+        check(!PHI->hasOperand(ops[0]));
+
+        PS.erase(ops[50]);
+        check(!PHI->hasOperand(ops[50]));
+        check(A->getUsers().size() == 99);
+
+        PHI->removeAllOperands();
+        check(!PHI->hasOperand(A) && PHI->getOperandsNum() == 0);
+        check(A->getUsers().size() == 99);
+    }
+
+    // the memory of the removed nodes is used for new nodes
+    void reuse_removed1()
+    {
+        using namespace dg::analysis::pta;
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *L = PS.create(PSNodeType::LOAD, A);
+        PSNode *G = PS.create(PSNodeType::GEP, A, 4);
+        L->addPointsTo(A, 0);
+        unsigned id = L->getID();
+
+        PS.erase(L);
+        check(A->getUsers().size() == 1, "Erased node is still a user");
+
+        // a node of other type does not get the memory
+        PSNode *C = PS.create(PSNodeType::CAST, G);
+        check(C != L, "Reused the memory of a node of other type");
+
+        PSNode *L2 = PS.create(PSNodeType::LOAD, G);
+        check(L2 == L, "Did not reuse the memory of the erased node");
+        check(L2->getID() > id, "Reused the ID of the erased node");
+        check(L2->pointsTo.empty(), "Got the points-to set of the erased node");
+        check(L2->getOperandsNum() == 1 && L2->getOperand(0) == G);
+        check(A->getUsers().size() == 1 && G->getUsers().size() == 2);
+
+        unsigned found = 0;
+        for (auto& nd : PS.getNodes()) {
+            if (nd && nd.get() == L2)
+                ++found;
+        }
+        check(found == 1, "The new node is not in the graph once");
+    }
+
     void test()
     {
         unknown_offset1();
+        many_operands1();
+        reuse_removed1();
+    }
+};
+
+class PointerGraphOptimizationsTest : public Test
+{
+
+public:
+    PointerGraphOptimizationsTest()
+          : Test("pointer graph optimizations test") {}
+
+    // the nodes with the same points-to sets are merged
+    void equivalent_pointers1()
+    {
+        using namespace dg::analysis::pta;
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *G1 = PS.create(PSNodeType::GEP, A, 4);
+        PSNode *G2 = PS.create(PSNodeType::GEP, A, 4);
+        PSNode *C = PS.create(PSNodeType::CAST, G1);
+        PSNode *S = PS.create(PSNodeType::STORE, B, C);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, C);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, G2);
+        PSNode *PHI = PS.create(PSNodeType::PHI, L1, L2, nullptr);
+
+        A->addSuccessor(B);
+        B->addSuccessor(G1);
+        G1->addSuccessor(G2);
+        G2->addSuccessor(C);
+        C->addSuccessor(S);
+        S->addSuccessor(L1);
+        L1->addSuccessor(L2);
+        L2->addSuccessor(PHI);
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+
+        PSPointerEquivalenceMerger merger(&PS);
+        check(merger.run() == 4, "Did not merge the equivalent nodes");
+        check(merger.getMapping().resolve(G2) == G1);
+        check(merger.getMapping().resolve(C) == G1);
+        check(merger.getMapping().resolve(L2) == L1);
+        check(merger.getMapping().resolve(PHI) == L1);
+        check(S->getOperand(1) == G1);
+        check(S->getSingleSuccessor() == L1);
+        check(L1->getSuccessors().empty());
+
+        PointerAnalysisFI PA(&PS);
+        PA.run();
+        check(L1->doesPointsTo(B), "L1 do not points to B");
+    }
+
+    // a cycle of copies is merged with the pointer that comes into it
+    void equivalent_pointers2()
+    {
+        using namespace dg::analysis::pta;
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *PHI1 = PS.create(PSNodeType::PHI, A, nullptr);
+        PSNode *C = PS.create(PSNodeType::CAST, PHI1);
+        PSNode *PHI2 = PS.create(PSNodeType::PHI, C, B, nullptr);
+        PSNode *C2 = PS.create(PSNodeType::CAST, PHI2);
+        PSNode *L = PS.create(PSNodeType::LOAD, C2);
+        PHI1->addOperand(C);
+        PHI2->addOperand(C2);
+
+        A->addSuccessor(B);
+        B->addSuccessor(PHI1);
+        PHI1->addSuccessor(C);
+        C->addSuccessor(PHI2);
+        PHI2->addSuccessor(C2);
+        C2->addSuccessor(L);
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+
+        // the second cycle is kept in the pinned phi
+        PSNodesSetT pinned{PHI2};
+        PSPointerEquivalenceMerger merger(&PS, &pinned);
+        check(merger.run() == 2, "Did not merge the cycle");
+        check(merger.getMapping().resolve(PHI1) == A);
+        check(merger.getMapping().resolve(C) == A);
+        check(merger.getMapping().get(PHI2) == nullptr);
+        check(PHI2->hasOperand(A) && PHI2->hasOperand(B));
+        check(C2->getOperand(0) == PHI2);
+    }
+
+    // the loads of memory that contains only unknown pointers
+    void unknowns_reducer1()
+    {
+        using namespace dg::analysis::pta;
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *S = PS.create(PSNodeType::STORE, UNKNOWN_MEMORY, A);
+        PSNode *L = PS.create(PSNodeType::LOAD, A);
+        PSNode *C = PS.create(PSNodeType::CAST, L);
+
+        A->addSuccessor(S);
+        S->addSuccessor(L);
+        L->addSuccessor(C);
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+
+        PSUnknownsReducer reducer(&PS);
+        check(reducer.run() == 2, "Did not remove the load and store");
+        check(reducer.getRemovedNodes().count(S) == 1);
+        check(reducer.getMapping().get(L) == UNKNOWN_MEMORY);
+        check(C->getOperand(0) == UNKNOWN_MEMORY);
+        check(A->getSingleSuccessor() == C);
+        check(A->getUsers().empty());
+
+        // UNKNOWN_MEMORY is shared by all graphs
+        C->removeAllOperands();
+    }
+
+    void mapping_compose1()
+    {
+        using namespace dg::analysis::pta;
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::CAST, A);
+        PSNode *C = PS.create(PSNodeType::CAST, B);
+
+        PointsToMapping<PSNode *> first, second;
+        int val;
+        PointsToMapping<const int *> values;
+        values.add(&val, C);
+
+        first.add(C, B);
+        second.add(B, A);
+        first.merge(std::move(second));
+        check(first.resolve(C) == A);
+        check(first.resolve(A) == nullptr);
+
+        values.compose(std::move(first));
+        check(values.get(&val) == A);
+    }
+
+    void test()
+    {
+        equivalent_pointers1();
+        equivalent_pointers2();
+        unknowns_reducer1();
+        mapping_compose1();
     }
 };
 
@@ -1146,12 +1999,12 @@ public:
          */
 
         PSNodeEntry* entryMain = PSNodeEntry::cast(PS.create(PSNodeType::ENTRY));
-        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL));
+        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL, nullptr));
         PSNodeEntry* entryFoo = PSNodeEntry::cast(PS.create(PSNodeType::ENTRY));
         PSNodeAlloc* malloc = PSNodeAlloc::cast(PS.create(PSNodeType::ALLOC));
         PSNode* free = PS.create(PSNodeType::FREE, static_cast<PSNode*>(malloc));
-        PSNodeRet* ret = PSNodeRet::get(PS.create(PSNodeType::RETURN, static_cast<PSNode*>(entryFoo)));
-        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, static_cast<PSNode*>(call)));
+        PSNodeRet* ret = PSNodeRet::get(PS.create(PSNodeType::RETURN, static_cast<PSNode*>(entryFoo), nullptr));
+        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, static_cast<PSNode*>(call), nullptr));
         PSNode* test_load = PS.create(PSNodeType::LOAD, malloc);
 
         entryMain->addSuccessor(call);
@@ -1214,13 +2067,13 @@ public:
          */
 
 
-        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL));
+        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL, nullptr));
         PSNodeEntry* entryFoo = PSNodeEntry::cast(PS.create(PSNodeType::ENTRY));
         PSNodeAlloc* malloc = PSNodeAlloc::cast(PS.create(PSNodeType::ALLOC));
         PSNode* free = PS.create(PSNodeType::FREE, malloc);
         PSNode* load = PS.create(PSNodeType::LOAD, malloc);
-        PSNodeRet* ret = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryFoo));
-        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, call));
+        PSNodeRet* ret = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryFoo, nullptr));
+        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, call, nullptr));
         PSNode* test_load = PS.create(PSNodeType::LOAD, malloc);
 
         call->addSuccessor(callRet);
@@ -1290,12 +2143,12 @@ public:
          */
 
         PSNodeEntry* entryMain = PSNodeEntry::cast(PS.create(PSNodeType::ENTRY));
-        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL));
+        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL, nullptr));
         PSNodeEntry* entryFoo = PSNodeEntry::cast(PS.create(PSNodeType::ENTRY));
         PSNodeAlloc* alloc = PSNodeAlloc::cast(PS.create(PSNodeType::ALLOC));
         PSNode* loadFoo = PS.create(PSNodeType::LOAD, alloc);
-        PSNodeRet* ret = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryFoo));
-        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, call));
+        PSNodeRet* ret = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryFoo, nullptr));
+        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, call, nullptr));
         PSNode* loadMain = PS.create(PSNodeType::LOAD, alloc);
 
         entryMain->addSuccessor(call);
@@ -1364,14 +2217,14 @@ public:
          */
 
         PSNodeEntry* entryMain = PSNodeEntry::cast(PS.create(PSNodeType::ENTRY));
-        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL));
+        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL, nullptr));
         PSNodeEntry* entryFoo = PSNodeEntry::cast(PS.create(PSNodeType::ENTRY));
         PSNodeAlloc* alloc = PSNodeAlloc::cast(PS.create(PSNodeType::ALLOC));
         PSNode* loadFoo = PS.create(PSNodeType::LOAD, alloc);
-        PSNodeRet* retFoo = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryFoo));
-        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, call));
+        PSNodeRet* retFoo = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryFoo, nullptr));
+        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, call, nullptr));
         PSNode* loadMain = PS.create(PSNodeType::LOAD, alloc);
-        PSNodeRet* retMain = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryMain));
+        PSNodeRet* retMain = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryMain, nullptr));
 
         entryMain->addSuccessor(call);
         entryMain->addSuccessor(loadMain);
@@ -1475,19 +2328,20 @@ public:
         global->addPointsTo(global, 0);
 
         PSNodeEntry* entryMain = PSNodeEntry::cast(PS.create(PSNodeType::ENTRY));
-        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL));
+        PSNodeCall* call = PSNodeCall::cast(PS.create(PSNodeType::CALL, nullptr));
         PSNodeEntry* entryFoo = PSNodeEntry::cast(PS.create(PSNodeType::ENTRY));
         PSNodeAlloc* alloc = PSNodeAlloc::cast(PS.create(PSNodeType::ALLOC));
         PSNode* store = PS.create(PSNodeType::STORE, alloc, global);
         PSNode* loadFoo = PS.create(PSNodeType::LOAD, global);
-        PSNodeRet* retFoo = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryFoo));
-        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, call));
+        PSNodeRet* retFoo = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryFoo, nullptr));
+        PSNodeCallRet* callRet = PSNodeCallRet::cast(PS.create(PSNodeType::CALL_RETURN, call, nullptr));
         PSNode* loadMain = PS.create(PSNodeType::LOAD, global);
-        PSNode* retMain = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryMain));
+        PSNode* retMain = PSNodeRet::get(PS.create(PSNodeType::RETURN, entryMain, nullptr));
 
         entryMain->addSuccessor(call);
         call->addSuccessor(callRet);
-        callRet->addSuccessor(retMain);
+        callRet->addSuccessor(loadMain);
+        loadMain->addSuccessor(retMain);
 
         entryFoo->addSuccessor(alloc);
         alloc->addSuccessor(store);
@@ -1513,8 +2367,9 @@ public:
         loadFoo->setParent(fooSubG);
         retFoo->setParent(fooSubG);
 
-        loadFoo->addPointsTo(global, 0);
-        loadMain->addPointsTo(global, 0);
+        // PTR points to x
+        loadFoo->addPointsTo(alloc, 0);
+        loadMain->addPointsTo(alloc, 0);
 
         global->addOperand(alloc);
 
@@ -1559,9 +2414,20 @@ int main(void)
     using namespace dg::tests;
     TestRunner Runner;
 
-    //Runner.add(new FlowInsensitivePointsToTest());
-    //Runner.add(new FlowSensitivePointsToTest());
-    //Runner.add(new PSNodeTest());
+    Runner.add(new FlowInsensitivePointsToTest());
+    Runner.add(new FlowInsensitiveDiffPropPointsToTest());
+    Runner.add(new FlowInsensitiveTopologicalPointsToTest());
+    Runner.add(new FlowInsensitiveParallelPointsToTest());
+    Runner.add(new FlowInsensitiveDemandPointsToTest<~0U>(
+                    "flow-insensitive points-to test (demand-driven)"));
+    Runner.add(new FlowInsensitiveDemandPointsToTest<1>(
+                    "flow-insensitive points-to test (demand-driven, budget exceeded)"));
+    Runner.add(new FlowSensitivePointsToTest());
+    Runner.add(new FlowSensitiveTopologicalPointsToTest());
+    Runner.add(new SparseFlowSensitivePointsToTest());
+    Runner.add(new FlowInsensitiveIncrementalTest());
+    Runner.add(new PSNodeTest());
+    Runner.add(new PointerGraphOptimizationsTest());
     Runner.add(new InvalidatedAnalysisTest("Invalidated analysis test"));
     return Runner();
 }
@@ -0,0 +1,102 @@
+#!/bin/bash
+
+# Check that llvm-pta-dump gives the same results when it computes them
+# and when it loads them from the cache (see llvm-pta-dump -cache-dir)
+# and that it does not use a stale or corrupted cache file
+
+set -e
+
+TESTS_DIR=`dirname $0`
+source "$TESTS_DIR/test-runner.sh"
+
+PTA_DUMP=$1
+
+if [ -z "$PTA_DUMP" ]; then
+	errmsg "Usage: $0 path/to/llvm-pta-dump"
+fi
+
+# do not put the compiled files and the cache among the sources
+OUTDIR=`mktemp -d`
+trap "rm -rf \"$OUTDIR\"" EXIT
+
+# dump_cached BCFILE CACHE computed|loaded FLAGS...
+#
+# Run llvm-pta-dump with the cache, check that it computed or loaded
+# the results and that they are the same as the results without the cache
+dump_cached()
+{
+	FILE="$1"
+	CACHE="$2"
+	EXPECTED="$3"
+	shift 3
+
+	"$PTA_DUMP" "$@" -cache-dir "$CACHE" "$FILE" \
+		> "$OUTDIR/cached.out" 2> "$OUTDIR/cached.err" \
+		|| { cat "$OUTDIR/cached.err"; errmsg "llvm-pta-dump failed"; }
+
+	if grep -q 'Loaded the results from the cache' "$OUTDIR/cached.err"; then
+		GOT=loaded
+	else
+		GOT=computed
+	fi
+
+	if [ "$GOT" != "$EXPECTED" ]; then
+		errmsg "The results were $GOT, but they should be $EXPECTED"
+	fi
+
+	diff "$OUTDIR/expected.out" "$OUTDIR/cached.out" \
+		|| errmsg "The results with the cache differ"
+}
+
+for PTA in fi fs; do
+	PREV_CACHE_FILE=
+
+	# calls via function pointers and threads change the graph
+	# while the analysis is running, these changes are cached too
+	for NAME in funcptr1 funcptr2 funcptr3 threads1; do
+		BCFILE="$OUTDIR/$NAME.bc"
+		CACHE="$OUTDIR/cache-$NAME-$PTA"
+		FLAGS="-pta $PTA"
+		if [ "$NAME" = "threads1" ]; then
+			FLAGS="$FLAGS -threads"
+		fi
+
+		echo "Test $NAME ($PTA)"
+		compile "$TESTS_DIR/sources/$NAME.c" "$BCFILE"
+		"$PTA_DUMP" $FLAGS "$BCFILE" > "$OUTDIR/expected.out" \
+			|| errmsg "llvm-pta-dump failed"
+
+		dump_cached "$BCFILE" "$CACHE" computed $FLAGS
+		dump_cached "$BCFILE" "$CACHE" loaded $FLAGS
+
+		CACHE_FILE=`ls "$CACHE"/*.pta`
+		SIZE=`stat -c %s "$CACHE_FILE"`
+
+		# a corrupted points-to set (change the last byte)
+		LAST=`tail -c 1 "$CACHE_FILE" | od -An -tu1`
+		if [ $LAST -eq 255 ]; then
+			BYTE='\001'
+		else
+			BYTE='\377'
+		fi
+		printf "$BYTE" | dd of="$CACHE_FILE" bs=1 seek=$(($SIZE - 1)) \
+				   conv=notrunc 2>/dev/null
+		dump_cached "$BCFILE" "$CACHE" computed $FLAGS
+		dump_cached "$BCFILE" "$CACHE" loaded $FLAGS
+
+		# a truncated file
+		head -c $(($SIZE / 2)) "$CACHE_FILE" > "$OUTDIR/truncated.pta"
+		mv "$OUTDIR/truncated.pta" "$CACHE_FILE"
+		dump_cached "$BCFILE" "$CACHE" computed $FLAGS
+		dump_cached "$BCFILE" "$CACHE" loaded $FLAGS
+
+		# a stale file (the results of other module)
+		if [ ! -z "$PREV_CACHE_FILE" ]; then
+			cp "$PREV_CACHE_FILE" "$CACHE_FILE"
+			dump_cached "$BCFILE" "$CACHE" computed $FLAGS
+			dump_cached "$BCFILE" "$CACHE" loaded $FLAGS
+		fi
+
+		PREV_CACHE_FILE="$CACHE_FILE"
+	done
+done
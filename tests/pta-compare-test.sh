@@ -0,0 +1,112 @@
+#!/bin/bash
+
+# Compare the results of the pointer analysis computed in two ways
+# on the test sources (see llvm-pta-compare). The mode is one of:
+#
+#  -incremental    the incrementally updated flow-insensitive analysis
+#                  gives the same results as the analysis running from scratch
+#  -demand         the demand-driven flow-insensitive analysis gives
+#                  the same results as the analysis solving the whole graph
+#  -summaries      the flow-insensitive analysis with the function summaries
+#                  (and with the heap cloning) gives a subset of the results
+#                  of the analysis without them that does not miss pointers,
+#                  and the same results as the analysis of the sources
+#                  with the functions inlined by hand (NAME_inlined.c);
+#                  the heap cloning gives every call of an allocator
+#                  wrapper its own allocations
+#  -optimizations  the reduction of the pointer graph does not change
+#                  the results of the analysis
+
+set -e
+
+TESTS_DIR=`dirname $0`
+source "$TESTS_DIR/test-runner.sh"
+
+MODE=$1
+PTA_COMPARE=$2
+
+usage()
+{
+	errmsg "Usage: $0 -incremental|-demand|-summaries|-optimizations path/to/llvm-pta-compare"
+}
+
+# the modes of llvm-pta-compare to run on every source
+MODES="$MODE"
+
+case "$MODE" in
+	-incremental)
+		SOURCES="interprocedural1 interprocedural2 interprocedural3
+			 interprocedural4 interprocedural5 interprocedural6
+			 interprocedural7 interprocedural8 interprocedural9
+			 recursive1 recursive2 recursive3 recursive4 recursive5
+			 alias_of_return dynalloc1 dynalloc2 dynalloc3 global1
+			 globalptr1 list1 list2 memcpy1 vararg1 funcptr1"
+		;;
+	-demand)
+		SOURCES="interprocedural1 interprocedural2 interprocedural3
+			 interprocedural4 interprocedural5 recursive1 recursive2
+			 alias_of_return dynalloc1 dynalloc2 global1 globalptr1
+			 list1 list2 memcpy1 memcpy2 vararg1 funcptr1 funcptr2
+			 funcptr3 phi1 phi2"
+		;;
+	-summaries)
+		SOURCES="interprocedural1 interprocedural2 interprocedural3
+			 interprocedural4 interprocedural5 interprocedural6
+			 interprocedural7 interprocedural8 interprocedural9
+			 recursive1 recursive2 recursive3 recursive4 recursive5
+			 alias_of_return dynalloc1 dynalloc2 dynalloc3 global1
+			 globalptr1 list1 list2 memcpy1 vararg1 funcptr1
+			 heap_cloning1"
+		MODES="-summaries -heap-cloning"
+		;;
+	-optimizations)
+		SOURCES="bitcast1 bitcast2 bitcast3 bitcast4 bitcast5
+			 interprocedural1 interprocedural2 interprocedural3
+			 interprocedural4 interprocedural5 recursive1 recursive2
+			 alias_of_return dynalloc1 dynalloc2 global1 globalptr1
+			 list1 list2 loop1 loop2 loop3 memcpy1 phi1 phi2 vararg1
+			 funcptr1 funcptr2 funcptr3 heap_cloning1"
+		;;
+	*)
+		usage
+		;;
+esac
+
+if [ -z "$PTA_COMPARE" ]; then
+	usage
+fi
+
+# do not put the compiled files among the sources
+OUTDIR=`mktemp -d`
+trap "rm -rf \"$OUTDIR\"" EXIT
+
+# compare_inlined NAME FLAGS...
+#
+# Compare the results on the compiled source NAME with the results
+# on the source with the functions inlined by hand
+compare_inlined()
+{
+	NAME="$1"
+	shift
+
+	echo "Test $NAME (inlined)"
+	compile "$TESTS_DIR/sources/${NAME}_inlined.c" "$OUTDIR/${NAME}_inlined.bc"
+	"$PTA_COMPARE" "$@" -inlined "$OUTDIR/${NAME}_inlined.bc" "$OUTDIR/$NAME.bc"
+}
+
+for NAME in $SOURCES; do
+	BCFILE="$OUTDIR/$NAME.bc"
+
+	echo "Test $NAME"
+	compile "$TESTS_DIR/sources/$NAME.c" "$BCFILE"
+	for M in $MODES; do
+		"$PTA_COMPARE" $M "$BCFILE"
+	done
+done
+
+if [ "$MODE" = "-summaries" ]; then
+	compare_inlined interprocedural3 -summaries
+	# the two calls of the allocator wrapper new_item
+	# must get their own (cloned) allocations
+	compare_inlined heap_cloning1 -heap-cloning -cloned-calls new_item
+fi
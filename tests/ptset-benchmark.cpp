@@ -3,6 +3,7 @@
 #include <random>
 
 #include "dg/analysis/PointsTo/PointsToSet.h"
+#include "dg/analysis/PointsTo/PointerGraph.h"
 #include "../tools/TimeMeasure.h"
 
 using namespace dg::analysis::pta;
@@ -10,6 +11,11 @@ using namespace dg::analysis::pta;
 std::default_random_engine generator;
 std::uniform_int_distribution<uint64_t> distribution(0, ~static_cast<uint64_t>(0));
 
+// the points-to sets may number the nodes using the graph,
+// so the nodes must be real nodes of a graph
+PointerGraph PG;
+std::vector<PSNode *> nodes;
+
 #define run(func, msg) do { \
     std::cout << "Running " << msg << "\n"; \
     dg::debug::TimeMeasure tm; \
@@ -17,20 +23,35 @@ std::uniform_int_distribution<uint64_t> distribution(0, ~static_cast<uint64_t>(0
     for (int i = 0; i < times; ++i) \
         func<PointsToSetT>(); \
     tm.stop(); \
-    tm.report(" -- PointsToSet bitvector took"); \
+    tm.report(std::string(" -- ") + getPointsToSetName() + " took"); \
     tm.start(); \
     for (int i = 0; i < times; ++i) \
         func<SimplePointsToSet>(); \
     tm.stop(); \
     tm.report(" -- PointsToSet std::set took"); \
+    tm.start(); \
+    for (int i = 0; i < times; ++i) \
+        func<PointerIdPointsToSet>(); \
+    tm.stop(); \
+    tm.report(" -- PointerIdPointsToSet took"); \
+    tm.start(); \
+    for (int i = 0; i < times; ++i) \
+        func<DensePointerIdPointsToSet>(); \
+    tm.stop(); \
+    tm.report(" -- DensePointerIdPointsToSet took"); \
+    tm.start(); \
+    for (int i = 0; i < times; ++i) \
+        func<HashConsedPointsToSet>(); \
+    tm.stop(); \
+    tm.report(" -- HashConsedPointsToSet took"); \
     } while(0);
 
 template <typename PTSetT>
 void test1() {
     PTSetT S;
-    PSNode *x = reinterpret_cast<PSNode *>(0x1);
-    PSNode *y = reinterpret_cast<PSNode *>(0x2);
-    PSNode *z = reinterpret_cast<PSNode *>(0x3);
+    PSNode *x = nodes[1];
+    PSNode *y = nodes[2];
+    PSNode *z = nodes[3];
 
     S.add({x, 0});
     S.add({y, 0});
@@ -40,7 +61,7 @@ void test1() {
 template <typename PTSetT>
 void test2() {
     PTSetT S;
-    PSNode *x = reinterpret_cast<PSNode *>(0x1);
+    PSNode *x = nodes[1];
 
     S.add({x, 0});
 }
@@ -51,13 +72,13 @@ void test3() {
 
     PTSetT S;
     PSNode * pointers[] {
-        reinterpret_cast<PSNode *>(0x1),
-        reinterpret_cast<PSNode *>(0x2),
-        reinterpret_cast<PSNode *>(0x3),
-        reinterpret_cast<PSNode *>(0x4),
-        reinterpret_cast<PSNode *>(0x5),
-        reinterpret_cast<PSNode *>(0x6),
-        reinterpret_cast<PSNode *>(0x7)
+        nodes[1],
+        nodes[2],
+        nodes[3],
+        nodes[4],
+        nodes[5],
+        nodes[6],
+        nodes[7]
     };
 
     for (int i = 0; i < 1000; ++i) {
@@ -72,7 +93,7 @@ void test4() {
 
     PTSetT S;
     for (int i = 0; i < 1000; ++i) {
-        S.add(reinterpret_cast<PSNode *>(1), i);
+        S.add(nodes[1], i);
     }
 }
 
@@ -82,13 +103,35 @@ void test5() {
 
     PTSetT S;
     for (int i = 0; i < 1000; ++i) {
-        S.add(reinterpret_cast<PSNode *>(i), i);
+        S.add(nodes[i], i);
     }
 }
 
+template <typename PTSetT>
+void test6() {
+    // union of sets that mostly contain the same pointers
+    // (as in the fixpoint computation of the analysis)
+    std::vector<PTSetT> sets(50);
+    for (unsigned i = 0; i < sets.size(); ++i) {
+        for (unsigned j = 0; j < 1000; j += (i % 3) + 1)
+            sets[i].add(nodes[j], 0);
+    }
+
+    PTSetT S;
+    for (int r = 0; r < 10; ++r) {
+        for (auto& T : sets)
+            S.add(T);
+    }
+}
 
 int main()
 {
+    for (int i = 0; i < 1000; ++i)
+        nodes.push_back(PG.create(PSNodeType::ALLOC));
+
+    std::cout << "Points-to sets representation: "
+              << getPointsToSetName() << "\n";
+
     int times;
     times = 100000;
     run(test1, "Adding three elements");
@@ -104,4 +147,7 @@ int main()
 
     times = 10000;
     run(test5, "Adding 1000 different pointers");
+
+    times = 100;
+    run(test6, "Union of 50 large overlapping sets 10 times");
 }
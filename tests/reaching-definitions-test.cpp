@@ -1,6 +1,8 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <algorithm>
+
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
 
@@ -276,6 +278,364 @@ TEST_CASE("Basic4 data-flow", "[data-flow]") {
     basic4<ReachingDefinitionsAnalysis>();
 }
 
+// a branching and a loop
+//
+//   AL -> S1 -> B -> S2 -> J -> S4 -> U2 -> U3
+//               |           ^         |
+//               +--> S3 ----+         |
+//               ^                     |
+//               +---------------------+
+template <typename RDType>
+void blocks1()
+{
+    ReachingDefinitionsGraph graph;
+
+    RDNode *AL = graph.create(RDNodeType::ALLOC);
+    RDNode *S1 = graph.create(RDNodeType::STORE);
+    RDNode *B = graph.create(RDNodeType::NOOP);
+    RDNode *S2 = graph.create(RDNodeType::STORE);
+    RDNode *S3 = graph.create(RDNodeType::STORE);
+    RDNode *J = graph.create(RDNodeType::LOAD);
+    RDNode *S4 = graph.create(RDNodeType::STORE);
+    RDNode *U2 = graph.create(RDNodeType::LOAD);
+    RDNode *U3 = graph.create(RDNodeType::LOAD);
+
+    S1->addDef(AL, 0, 4, true /* strong update */);
+    S2->addDef(AL, 0, 4, true /* strong update */);
+    S3->addDef(AL, 0, 4);
+    S4->addDef(AL, 4, 4);
+    J->addUse(AL, 0, 4);
+    U2->addUse(AL, 0, 8);
+    U3->addUse(AL, 4, 4);
+
+    AL->addSuccessor(S1);
+    S1->addSuccessor(B);
+    B->addSuccessor(S2);
+    B->addSuccessor(S3);
+    S2->addSuccessor(J);
+    S3->addSuccessor(J);
+    J->addSuccessor(S4);
+    S4->addSuccessor(U2);
+    U2->addSuccessor(U3);
+    U2->addSuccessor(B);
+    graph.setRoot(AL);
+
+    RDType RD(std::move(graph));
+    RD.run();
+
+    auto rd = RD.getReachingDefinitions(U2);
+    CHECK(rd.size() == 4);
+    CHECK(std::find(rd.begin(), rd.end(), S4) != rd.end());
+
+    // a node before the last queried node in the same block
+    rd = RD.getReachingDefinitions(J);
+    CHECK(rd.size() == 3);
+    CHECK(std::find(rd.begin(), rd.end(), S1) != rd.end());
+    CHECK(std::find(rd.begin(), rd.end(), S2) != rd.end());
+    CHECK(std::find(rd.begin(), rd.end(), S3) != rd.end());
+
+    rd = RD.getReachingDefinitions(U3);
+    CHECK(rd.size() == 1);
+    CHECK(*(rd.begin()) == S4);
+
+    // S2 overwrites the definitions from the loop
+    rd = RD.getReachingDefinitions(S2, AL, 0, 4);
+    CHECK(rd.size() == 1);
+    CHECK(*(rd.begin()) == S2);
+
+    rd = RD.getReachingDefinitions(S3, AL, 0, 8);
+    CHECK(rd.size() == 4);
+}
+
+TEST_CASE("Blocks1 data-flow", "[data-flow]") {
+    blocks1<ReachingDefinitionsAnalysis>();
+}
+
+TEST_CASE("Blocks1 block data-flow", "[data-flow]") {
+    blocks1<BlockReachingDefinitionsAnalysis>();
+}
+
+TEST_CASE("Block data-flow keeps no node maps", "[data-flow]") {
+    ReachingDefinitionsGraph graph;
+
+    RDNode *AL = graph.create(RDNodeType::ALLOC);
+    graph.setRoot(AL);
+
+    std::vector<RDNode *> stores;
+    RDNode *last = AL;
+    for (unsigned i = 0; i < 50; ++i) {
+        RDNode *S = graph.create(RDNodeType::STORE);
+        S->addDef(AL, 4*i, 4);
+        last->addSuccessor(S);
+        stores.push_back(S);
+        last = S;
+    }
+
+    RDNode *U = graph.create(RDNodeType::LOAD);
+    U->addUse(AL, 0, dg::analysis::Offset::UNKNOWN);
+    last->addSuccessor(U);
+
+    BlockReachingDefinitionsAnalysis RD(std::move(graph));
+    RD.run();
+
+    // the stores are in one block and have only their own definitions
+    CHECK(stores.front()->getBBlock() == U->getBBlock());
+    for (RDNode *S : stores) {
+        unsigned num = 0;
+        for (auto& it : S->def_map) {
+            (void) it;
+            ++num;
+        }
+        CHECK(num == 1);
+    }
+
+    auto rd = RD.getReachingDefinitions(U);
+    CHECK(rd.size() == 50);
+}
+
+TEST_CASE("Worklist data-flow", "[data-flow]") {
+    ReachingDefinitionsGraph graph;
+
+    RDNode *AL = graph.create(RDNodeType::ALLOC);
+    RDNode *S1 = graph.create(RDNodeType::STORE);
+    RDNode *H = graph.create(RDNodeType::NOOP);
+    RDNode *S2 = graph.create(RDNodeType::STORE);
+    RDNode *U = graph.create(RDNodeType::LOAD);
+
+    S1->addDef(AL, 0, 4, true /* strong update */);
+    S2->addDef(AL, 4, 4);
+    U->addUse(AL, 0, 8);
+
+    // AL -> S1 -> H -> U, H -> S2 -> H
+    AL->addSuccessor(S1);
+    S1->addSuccessor(H);
+    H->addSuccessor(S2);
+    S2->addSuccessor(H);
+    H->addSuccessor(U);
+    graph.setRoot(AL);
+
+    ReachingDefinitionsAnalysis RD(std::move(graph));
+    RD.run();
+
+    auto rd = RD.getReachingDefinitions(U);
+    CHECK(rd.size() == 2);
+    CHECK(std::find(rd.begin(), rd.end(), S1) != rd.end());
+    CHECK(std::find(rd.begin(), rd.end(), S2) != rd.end());
+
+    // the second round processes only the head of the loop
+    // (its map does not change, so nothing else is queued)
+    CHECK(RD.getNumOfRounds() == 2);
+    CHECK(RD.getNumOfProcessedNodes() == 6);
+}
+
+TEST_CASE("Frozen edges", "[data-flow]") {
+    ReachingDefinitionsGraph graph;
+
+    RDNode *AL = graph.create(RDNodeType::ALLOC);
+    RDNode *S1 = graph.create(RDNodeType::STORE);
+    RDNode *S2 = graph.create(RDNodeType::STORE);
+    RDNode *U = graph.create(RDNodeType::LOAD);
+
+    S1->addDef(AL, 0, 4, true /* strong update */);
+    S2->addDef(AL, 0, 4, true /* strong update */);
+    U->addUse(AL, 0, 4);
+
+    // AL -> S1 -> U, AL -> S2 -> U
+    AL->addSuccessor(S1);
+    AL->addSuccessor(S2);
+    S1->addSuccessor(U);
+    S2->addSuccessor(U);
+    graph.setRoot(AL);
+
+    graph.freezeEdges();
+    CHECK(graph.edgesFrozen());
+    CHECK(AL->isFrozen());
+    CHECK(U->isFrozen());
+
+    REQUIRE(AL->successorsNum() == 2);
+    CHECK(AL->getSuccessors()[0] == S1);
+    CHECK(AL->getSuccessors()[1] == S2);
+    REQUIRE(U->predecessorsNum() == 2);
+    CHECK(U->getPredecessors()[0] == S1);
+    CHECK(U->getPredecessors()[1] == S2);
+    CHECK(S1->getSingleSuccessor() == U);
+    CHECK(S2->getSinglePredecessor() == AL);
+
+    // changing the edges thaws only the changed nodes
+    RDNode *S3 = graph.create(RDNodeType::STORE);
+    S3->addDef(AL, 0, 4, true /* strong update */);
+    S3->insertAfter(S2);
+    CHECK(AL->isFrozen());
+    CHECK(S1->isFrozen());
+    CHECK(!S2->isFrozen());
+    CHECK(!U->isFrozen());
+    CHECK(S2->getSingleSuccessor() == S3);
+    CHECK(S3->getSingleSuccessor() == U);
+    REQUIRE(U->predecessorsNum() == 2);
+    CHECK(U->getPredecessors()[1] == S3);
+
+    ReachingDefinitionsAnalysis RD(std::move(graph));
+    RD.run();
+
+    auto rd = RD.getReachingDefinitions(U);
+    CHECK(rd.size() == 2);
+    CHECK(std::find(rd.begin(), rd.end(), S1) != rd.end());
+    CHECK(std::find(rd.begin(), rd.end(), S3) != rd.end());
+
+    // freezing again packs also the changed nodes
+    RD.getGraph()->freezeEdges();
+    CHECK(S2->isFrozen());
+    CHECK(S3->isFrozen());
+    CHECK(S3->getSingleSuccessor() == U);
+
+    RD.getGraph()->unfreezeEdges();
+    CHECK(!RD.getGraph()->edgesFrozen());
+    CHECK(!AL->isFrozen());
+    CHECK(AL->successorsNum() == 2);
+    CHECK(U->getPredecessors()[0] == S1);
+}
+
+// a sequence of branchings with definitions and uses of two objects
+static ReachingDefinitionsGraph lvnGraph()
+{
+    ReachingDefinitionsGraph graph;
+
+    RDNode *AL1 = graph.create(RDNodeType::ALLOC);
+    RDNode *AL2 = graph.create(RDNodeType::ALLOC);
+    AL1->addSuccessor(AL2);
+    graph.setRoot(AL1);
+
+    RDNode *last = AL2;
+    for (unsigned i = 0; i < 20; ++i) {
+        RDNode *S1 = graph.create(RDNodeType::STORE);
+        RDNode *S2 = graph.create(RDNodeType::STORE);
+        RDNode *U1 = graph.create(RDNodeType::LOAD);
+        RDNode *U2 = graph.create(RDNodeType::LOAD);
+        RDNode *J = graph.create(RDNodeType::LOAD);
+
+        S1->addDef(AL1, i % 8, 4, true /* strong update */);
+        S2->addDef(i % 3 ? AL1 : AL2, 0, 2 + i % 4);
+        U1->addUse(AL2, 0, 8);
+        U2->addUse(AL1, 2, 4);
+        J->addUse(AL1, 0, 8);
+        J->addUse(AL2, 4, 4);
+
+        last->addSuccessor(S1);
+        last->addSuccessor(S2);
+        S1->addSuccessor(U1);
+        S2->addSuccessor(U2);
+        U1->addSuccessor(J);
+        U2->addSuccessor(J);
+        last = J;
+    }
+
+    return graph;
+}
+
+// the IDs of the nodes and of their reaching definitions
+static std::vector<std::vector<unsigned>> lvnResults(unsigned threads)
+{
+    dg::analysis::ReachingDefinitionsAnalysisOptions opts;
+    opts.setLvnThreads(threads);
+    SSAReachingDefinitionsAnalysis RD(lvnGraph(), opts);
+    RD.run();
+
+    auto nodes = RD.getNodes(RD.getRoot());
+    std::sort(nodes.begin(), nodes.end(),
+              [](RDNode *a, RDNode *b) { return a->getID() < b->getID(); });
+
+    std::vector<std::vector<unsigned>> results;
+    for (RDNode *n : nodes) {
+        std::vector<unsigned> ids{n->getID(),
+                                  static_cast<unsigned>(n->getType())};
+        for (RDNode *def : n->defuse)
+            ids.push_back(def->getID());
+        if (n->isUse()) {
+            for (RDNode *def : RD.getReachingDefinitions(n))
+                ids.push_back(def->getID());
+        }
+        std::sort(ids.begin() + 2, ids.end());
+        results.push_back(std::move(ids));
+    }
+
+    return results;
+}
+
+TEST_CASE("Parallel LVN", "[memory-ssa]") {
+    auto serial = lvnResults(1);
+
+    // LVN created some phi nodes
+    auto phi = std::find_if(serial.begin(), serial.end(),
+                            [](const std::vector<unsigned>& n) {
+                                return n[1] == static_cast<unsigned>(RDNodeType::PHI);
+                            });
+    CHECK(phi != serial.end());
+
+    CHECK(serial == lvnResults(2));
+    CHECK(serial == lvnResults(4));
+    CHECK(serial == lvnResults(0));
+}
+
+// a long sequence of branchings, every branching
+// is preceded by a definition of another byte of AL
+template <typename RDType>
+void
+chain1()
+{
+    const unsigned N = 64;
+    ReachingDefinitionsGraph graph;
+
+    RDNode *AL = graph.create(RDNodeType::ALLOC);
+    graph.setRoot(AL);
+
+    std::vector<RDNode *> defs;
+    RDNode *last = AL;
+    for (unsigned i = 0; i < N; ++i) {
+        RDNode *S = graph.create(RDNodeType::STORE);
+        RDNode *B1 = graph.create(RDNodeType::NOOP);
+        RDNode *B2 = graph.create(RDNodeType::NOOP);
+        RDNode *J = graph.create(RDNodeType::NOOP);
+        S->addDef(AL, i, 1);
+        defs.push_back(S);
+
+        last->addSuccessor(S);
+        S->addSuccessor(B1);
+        S->addSuccessor(B2);
+        B1->addSuccessor(J);
+        B2->addSuccessor(J);
+        last = J;
+    }
+
+    RDNode *U1 = graph.create(RDNodeType::LOAD);
+    RDNode *U2 = graph.create(RDNodeType::LOAD);
+    U1->addUse(AL, 0, N);
+    U2->addUse(UNKNOWN_MEMORY);
+    last->addSuccessor(U1);
+    U1->addSuccessor(U2);
+
+    RDType RD(std::move(graph));
+    RD.run();
+
+    auto rd = RD.getReachingDefinitions(U1);
+    std::sort(rd.begin(), rd.end());
+    std::sort(defs.begin(), defs.end());
+    CHECK(rd == defs);
+    CHECK(rd == RD.getReachingDefinitions(U1));
+
+    // the definitions of the use of unknown memory are found only once
+    auto rdu = RD.getReachingDefinitions(U2);
+    CHECK(!rdu.empty());
+    CHECK(rdu == RD.getReachingDefinitions(U2));
+}
+
+TEST_CASE("Chain1 data-flow", "[data-flow]") {
+    chain1<ReachingDefinitionsAnalysis>();
+}
+
+TEST_CASE("Chain1 memory-ssa", "[memory-ssa]") {
+    chain1<SSAReachingDefinitionsAnalysis>();
+}
+
 /*
 TEST_CASE("Basic1 memory-ssa", "[memory-ssa]") {
     basic1<SSAReachingDefinitionsAnalysis>();
@@ -10,6 +10,12 @@ DG_TESTS_PTA=fi DG_TESTS_RDA=dataflow ./$TEST
 echo "Test with PTA FS & RDA data-flow"
 DG_TESTS_PTA=fs DG_TESTS_RDA=dataflow ./$TEST
 
+echo "Test with PTA FI & RDA data-flow on blocks"
+DG_TESTS_PTA=fi DG_TESTS_RDA=dataflow-blocks ./$TEST
+
+echo "Test with PTA FS & RDA data-flow on blocks"
+DG_TESTS_PTA=fs DG_TESTS_RDA=dataflow-blocks ./$TEST
+
 echo "Test with PTA FI & RDA ssa"
 DG_TESTS_PTA=fi DG_TESTS_RDA=ssa ./$TEST
 
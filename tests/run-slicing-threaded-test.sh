@@ -7,6 +7,9 @@ TEST=$1
 echo "Test with PTA FI & RDA data-flow"
 DG_TESTS_PTA=fi DG_TESTS_RDA=dataflow ./$TEST
 
+echo "Test with PTA FI & RDA data-flow on blocks"
+DG_TESTS_PTA=fi DG_TESTS_RDA=dataflow-blocks ./$TEST
+
 echo "Test with PTA FI & RDA ssa"
 DG_TESTS_PTA=fi DG_TESTS_RDA=ssa ./$TEST
 
@@ -0,0 +1,7 @@
+#!/bin/bash
+
+TESTS_DIR=`dirname $0`
+source "$TESTS_DIR/test-runner.sh"
+
+export DG_TESTS_SLICER_FLAGS="-pta-heap-cloning=2"
+run_test "sources/heap_cloning1.c"
@@ -0,0 +1,28 @@
+struct item {
+	int a;
+	struct item *next;
+};
+
+void *xmalloc(unsigned long size)
+{
+	void *mem = malloc(size);
+	return mem;
+}
+
+struct item *new_item(int a)
+{
+	struct item *i = xmalloc(sizeof(struct item));
+	i->a = a;
+	i->next = 0;
+	return i;
+}
+
+int main(void)
+{
+	struct item *i1 = new_item(1);
+	struct item *i2 = new_item(2);
+	i1->next = i2;
+	i2->a = 3;
+	test_assert(i1->next->a == 3);
+	return 0;
+}
@@ -0,0 +1,48 @@
+/* heap_cloning1.c with the functions inlined by hand
+ * (see pta-compare-test.sh -summaries) */
+
+struct item {
+	int a;
+	struct item *next;
+};
+
+int main(void)
+{
+	struct item *i1;
+	struct item *i2;
+
+	/* i1 = new_item(1) */
+	{
+		int a = 1;
+		struct item *i;
+		/* i = xmalloc(sizeof(struct item)) */
+		{
+			unsigned long size = sizeof(struct item);
+			void *mem = malloc(size);
+			i = mem;
+		}
+		i->a = a;
+		i->next = 0;
+		i1 = i;
+	}
+
+	/* i2 = new_item(2) */
+	{
+		int a = 2;
+		struct item *i;
+		/* i = xmalloc(sizeof(struct item)) */
+		{
+			unsigned long size = sizeof(struct item);
+			void *mem = malloc(size);
+			i = mem;
+		}
+		i->a = a;
+		i->next = 0;
+		i2 = i;
+	}
+
+	i1->next = i2;
+	i2->a = 3;
+	test_assert(i1->next->a == 3);
+	return 0;
+}
@@ -0,0 +1,23 @@
+/* interprocedural3.c with the function inlined by hand
+ * (see pta-compare-test.sh -summaries) */
+
+int main(void)
+{
+	int a, b, c;
+	a = 0;
+	b = 1;
+	c = 3;
+
+	int *p;
+	/* p = pick(&a, &b) */
+	{
+		int *pick_a = &a;
+		int *pick_b = &b;
+		(void) pick_a;
+		p = pick_b;
+	}
+	*p = 13;
+
+	test_assert(b == 13);
+	return 0;
+}
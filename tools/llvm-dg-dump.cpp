@@ -162,19 +162,25 @@ int main(int argc, char *argv[])
     } else if (strcmp(pts, "inv") == 0) {
         options.PTAOptions.analysisType
             = LLVMPointerAnalysisOptions::AnalysisType::inv;
+    } else if (strcmp(pts, "sfs") == 0) {
+        options.PTAOptions.analysisType
+            = LLVMPointerAnalysisOptions::AnalysisType::sfs;
     } else {
-        llvm::errs() << "Unknown points to analysis, try: fs, fi, inv\n";
+        llvm::errs() << "Unknown points to analysis, try: fs, fi, inv, sfs\n";
         abort();
     }
 
     if (strcmp(rda, "dataflow") == 0) {
         options.RDAOptions.analysisType
             = analysis::LLVMReachingDefinitionsAnalysisOptions::AnalysisType::dataflow;
+    } else if (strcmp(rda, "dataflow-blocks") == 0) {
+        options.RDAOptions.analysisType
+            = analysis::LLVMReachingDefinitionsAnalysisOptions::AnalysisType::dataflow_blocks;
     } else if (strcmp(rda, "ssa") == 0) {
         options.RDAOptions.analysisType
             = analysis::LLVMReachingDefinitionsAnalysisOptions::AnalysisType::ssa;
     } else {
-        llvm::errs() << "Unknown reaching definitions analysis, try: dataflow, ssa\n";
+        llvm::errs() << "Unknown reaching definitions analysis, try: dataflow, dataflow-blocks, ssa\n";
         abort();
     }
 
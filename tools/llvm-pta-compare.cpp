@@ -7,6 +7,8 @@
 #include <sstream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <memory>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -128,6 +130,13 @@ static bool verify_ptsets(const llvm::Value *val,
     PSNode *finode = fi->getPointsTo(val);
     PSNode *fsnode = fs->getPointsTo(val);
 
+    // the nodes without pointers may be removed from the graph
+    // (see LLVMPointerAnalysisOptions::optimizeGraph)
+    if (finode && !fsnode && finode->pointsTo.empty())
+        return true;
+    if (fsnode && !finode && fsnode->pointsTo.empty())
+        return true;
+
     if (!finode) {
         if (fsnode) {
             llvm::errs() << "FI don't have points-to for: " << *val << "\n"
@@ -200,6 +209,671 @@ static bool verify_ptsets(llvm::Module *M,
     return ret;
 }
 
+// the points-to set as (value, offset) pairs,
+// so that the sets from different graphs can be compared
+static std::set<std::pair<const void *, uint64_t>>
+getValuesSet(PSNode *node)
+{
+    std::set<std::pair<const void *, uint64_t>> ret;
+    for (const Pointer& ptr : node->pointsTo) {
+        const void *target = ptr.target->getUserData<llvm::Value>();
+        // unknown memory and null are shared by all graphs
+        if (!target && (ptr.target == UNKNOWN_MEMORY || ptr.target == NULLPTR))
+            target = ptr.target;
+        ret.emplace(target, *ptr.offset);
+    }
+
+    return ret;
+}
+
+// compare the results of the updated analysis
+// with the results of the analysis running from scratch
+static bool verify_incremental(llvm::Module *M,
+                               LLVMPointerAnalysis *inc,
+                               const LLVMPointerAnalysisOptions& opts)
+{
+    using namespace llvm;
+
+    LLVMPointerAnalysis full(M, opts);
+    full.run<analysis::pta::PointerAnalysisFI>();
+
+    bool ret = true;
+    for (Function& F : *M) {
+        for (BasicBlock& B : F) {
+            for (Instruction& I : B) {
+                PSNode *incnode = inc->getPointsTo(&I);
+                PSNode *fullnode = full.getPointsTo(&I);
+                if (!incnode && !fullnode)
+                    continue;
+
+                if (!incnode || !fullnode) {
+                    llvm::errs() << (incnode ? "Full" : "Incremental")
+                                 << " don't have points-to for: " << I << "\n";
+                    ret = false;
+                    continue;
+                }
+
+                if (getValuesSet(incnode) != getValuesSet(fullnode)) {
+                    llvm::errs() << "Incremental differs from full: " << I << "\n";
+                    llvm::errs() << "INC ";
+                    dumpPSNode(incnode);
+                    llvm::errs() << "FULL ";
+                    dumpPSNode(fullnode);
+                    llvm::errs() << " ---- \n";
+                    ret = false;
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+static llvm::Instruction *findPointerStore(llvm::Function& F)
+{
+    for (llvm::BasicBlock& B : F) {
+        for (llvm::Instruction& I : B) {
+            auto SI = llvm::dyn_cast<llvm::StoreInst>(&I);
+            if (SI && SI->getValueOperand()->getType()->isPointerTy())
+                return SI;
+        }
+    }
+
+    return nullptr;
+}
+
+static llvm::Instruction *findDefinedCall(llvm::Function& F)
+{
+    for (llvm::BasicBlock& B : F) {
+        for (llvm::Instruction& I : B) {
+            auto CI = llvm::dyn_cast<llvm::CallInst>(&I);
+            if (!CI || !CI->use_empty())
+                continue;
+
+            auto called = CI->getCalledFunction();
+            if (called && !called->isDeclaration())
+                return CI;
+        }
+    }
+
+    return nullptr;
+}
+
+// Edit the functions of the module one by one (remove a store of a pointer
+// and a call of a defined function) and check that the incrementally
+// updated results are the same as the results of a full run
+static bool verify_incremental(llvm::Module *M)
+{
+    using namespace llvm;
+    using analysis::pta::PointerAnalysisFI;
+
+    LLVMPointerAnalysisOptions opts;
+    opts.threads = false;
+    opts.setEntryFunction("main");
+    opts.setFieldSensitivity(Offset::UNKNOWN);
+    opts.setSolverType(LLVMPointerAnalysisOptions::SolverType::diffprop);
+
+    // the graph of the incremental analysis is not reduced,
+    // compare it with the same graph
+    opts.optimizeGraph = false;
+
+    LLVMPointerAnalysisOptions incOpts = opts;
+    incOpts.incremental = true;
+
+    LLVMPointerAnalysis PTA(M, incOpts);
+    PTA.run<PointerAnalysisFI>();
+
+    std::vector<Function *> functions;
+    for (Function& F : *M) {
+        if (!F.isDeclaration() && !PTA.getFunctionNodes(&F).empty())
+            functions.push_back(&F);
+    }
+
+    bool ret = true;
+    unsigned edits = 0;
+    for (Function *F : functions) {
+        // nothing changed
+        PTA.update<PointerAnalysisFI>({F});
+        ret &= verify_incremental(M, &PTA, opts);
+
+        if (Instruction *I = findPointerStore(*F)) {
+            I->eraseFromParent();
+            PTA.update<PointerAnalysisFI>({F});
+            ret &= verify_incremental(M, &PTA, opts);
+            ++edits;
+        }
+
+        if (Instruction *I = findDefinedCall(*F)) {
+            I->eraseFromParent();
+            PTA.update<PointerAnalysisFI>({F});
+            ret &= verify_incremental(M, &PTA, opts);
+            ++edits;
+        }
+    }
+
+    llvm::errs() << "Checked " << functions.size() << " functions and "
+                 << edits << " edits\n";
+    return ret;
+}
+
+// compare the points-to set of the value with the results
+// of the analysis that solved the whole graph
+static bool verify_demand(const llvm::Value *val,
+                          LLVMPointerAnalysis *dem,
+                          LLVMPointerAnalysis *full)
+{
+    PSNode *demnode = dem->getPointsTo(val);
+    PSNode *fullnode = full->getPointsTo(val);
+    if (!demnode && !fullnode)
+        return true;
+
+    if (!demnode || !fullnode) {
+        llvm::errs() << (demnode ? "Full" : "Demand-driven")
+                     << " don't have points-to for: " << *val << "\n";
+        return false;
+    }
+
+    if (getValuesSet(demnode) != getValuesSet(fullnode)) {
+        llvm::errs() << "Demand-driven differs from full: " << *val << "\n";
+        llvm::errs() << "DEMAND ";
+        dumpPSNode(demnode);
+        llvm::errs() << "FULL ";
+        dumpPSNode(fullnode);
+        llvm::errs() << " ---- \n";
+        return false;
+    }
+
+    return true;
+}
+
+// Ask the demand-driven analysis for the points-to set of every instruction
+// (every one alone and then all of them one by one) and check that the results
+// are the same as the results of the analysis that solves the whole graph.
+// When the demanded nodes exceed the 'budget', the analysis falls back
+// to solving the whole graph.
+static bool verify_demand(llvm::Module *M, unsigned budget)
+{
+    using namespace llvm;
+    using analysis::pta::PointerAnalysisFI;
+
+    LLVMPointerAnalysisOptions opts;
+    opts.threads = false;
+    opts.setEntryFunction("main");
+    opts.setFieldSensitivity(Offset::UNKNOWN);
+    opts.setSolverType(LLVMPointerAnalysisOptions::SolverType::diffprop);
+
+    LLVMPointerAnalysis full(M, opts);
+    full.run<PointerAnalysisFI>();
+
+    LLVMPointerAnalysisOptions demOpts = opts;
+    demOpts.setDemandDriven(true);
+    demOpts.setDemandBudget(budget);
+
+    bool ret = true;
+    unsigned queries = 0;
+    for (Function& F : *M) {
+        for (BasicBlock& B : F) {
+            for (Instruction& I : B) {
+                if (!full.getPointsTo(&I))
+                    continue;
+
+                LLVMPointerAnalysis dem(M, demOpts);
+                dem.run<PointerAnalysisFI>();
+                ret &= verify_demand(&I, &dem, &full);
+                ++queries;
+            }
+        }
+    }
+
+    LLVMPointerAnalysis dem(M, demOpts);
+    dem.run<PointerAnalysisFI>();
+    for (Function& F : *M) {
+        for (BasicBlock& B : F) {
+            for (Instruction& I : B)
+                ret &= verify_demand(&I, &dem, &full);
+        }
+    }
+
+    llvm::errs() << "Checked " << queries << " queries (budget " << budget << ")\n";
+    return ret;
+}
+
+// the targets of the pointers as LLVM values (without the offsets,
+// the copies of an allocation made by the heap cloning are one value)
+static std::set<const void *> getTargetsSet(PSNode *node)
+{
+    std::set<const void *> ret;
+    for (const auto& it : getValuesSet(node))
+        ret.insert(it.first);
+    return ret;
+}
+
+// does the pointer point to some memory (not only to null or unknown memory)?
+static bool hasValidTarget(PSNode *node)
+{
+    for (const Pointer& ptr : node->pointsTo) {
+        if (ptr.isValid() && !ptr.isInvalidated())
+            return true;
+    }
+
+    return false;
+}
+
+// The results with the summaries may be a subset of the full results even
+// when they miss pointers (e.g., empty), so check that they did not lose any:
+// a pointer that points to some memory in the full results must point
+// somewhere with the summaries too, and the nodes of a summarized function
+// (they have the union of the points-to sets of its instances) must have
+// all the targets that they have in the full results.
+static bool verify_summaries_sound(llvm::Module *M,
+                                   LLVMPointerAnalysis *full,
+                                   LLVMPointerAnalysis *sum)
+{
+    using namespace llvm;
+    bool ret = true;
+
+    for (Function& F : *M) {
+        for (BasicBlock& B : F) {
+            for (Instruction& I : B) {
+                PSNode *fullnode = full->getPointsTo(&I);
+                if (!fullnode || !hasValidTarget(fullnode))
+                    continue;
+
+                PSNode *sumnode = sum->getPointsTo(&I);
+                if (!sumnode || sumnode->pointsTo.empty()) {
+                    llvm::errs() << "Summaries lost all pointers of: " << I << "\n";
+                    llvm::errs() << "FULL ";
+                    dumpPSNode(fullnode);
+                    ret = false;
+                    continue;
+                }
+
+                if (!sum->isSummarized(&F))
+                    continue;
+
+                auto sumTargets = getTargetsSet(sumnode);
+                for (const void *target : getTargetsSet(fullnode)) {
+                    if (sumTargets.count(target) == 0) {
+                        llvm::errs() << "Instances of " << F.getName()
+                                     << " miss pointers of: " << I << "\n";
+                        llvm::errs() << "SUM ";
+                        dumpPSNode(sumnode);
+                        llvm::errs() << "FULL ";
+                        dumpPSNode(fullnode);
+                        llvm::errs() << " ---- \n";
+                        ret = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+// Check that the analysis with the function summaries is at least as precise
+// as the analysis that connects all calls of a function to one subgraph
+// and that it is sound (see verify_summaries_sound()).
+// With 'heapCloning', the allocator wrappers are cloned too.
+static bool verify_summaries(llvm::Module *M, unsigned heapCloning)
+{
+    using analysis::pta::PointerAnalysisFI;
+
+    LLVMPointerAnalysisOptions opts;
+    opts.threads = false;
+    opts.setEntryFunction("main");
+    opts.setFieldSensitivity(Offset::UNKNOWN);
+
+    LLVMPointerAnalysis full(M, opts);
+    full.run<PointerAnalysisFI>();
+
+    LLVMPointerAnalysisOptions sumOpts = opts;
+    sumOpts.functionSummaries = true;
+    sumOpts.heapCloning = heapCloning;
+
+    LLVMPointerAnalysis sum(M, sumOpts);
+    sum.run<PointerAnalysisFI>();
+
+    llvm::errs() << "Summarized " << sum.getNumOfSummarizedFunctions()
+                 << " functions\n";
+    if (heapCloning > 0)
+        llvm::errs() << "Cloned " << sum.getNumOfClonedAllocations()
+                     << " allocations\n";
+    bool ret = verify_ptsets(M, &full, &sum);
+    ret &= verify_summaries_sound(M, &full, &sum);
+    return ret;
+}
+
+// Check that the calls of the allocator wrapper 'name' (made at different
+// call sites) got their own copies of the allocations from the heap cloning:
+// every call points to some heap memory and no two calls point to the same.
+static bool verify_cloned_calls(llvm::Module *M, unsigned heapCloning,
+                                const char *name)
+{
+    using namespace llvm;
+    using analysis::pta::PointerAnalysisFI;
+
+    LLVMPointerAnalysisOptions opts;
+    opts.threads = false;
+    opts.setEntryFunction("main");
+    opts.setFieldSensitivity(Offset::UNKNOWN);
+    opts.heapCloning = heapCloning;
+
+    LLVMPointerAnalysis PTA(M, opts);
+    PTA.run<PointerAnalysisFI>();
+
+    bool ret = true;
+    std::vector<std::pair<const Instruction *, PSNode *>> calls;
+    for (Function& F : *M) {
+        for (BasicBlock& B : F) {
+            for (Instruction& I : B) {
+                auto *CI = dyn_cast<CallInst>(&I);
+                if (!CI || !CI->getCalledFunction() ||
+                    CI->getCalledFunction()->getName() != name)
+                    continue;
+
+                PSNode *node = PTA.getPointsTo(CI);
+                bool heap = false;
+                if (node) {
+                    for (const Pointer& ptr : node->pointsTo) {
+                        PSNodeAlloc *alloc = PSNodeAlloc::get(ptr.target);
+                        heap |= alloc && alloc->isHeap();
+                    }
+                }
+
+                if (!heap) {
+                    llvm::errs() << "The call does not point to heap: " << I << "\n";
+                    ret = false;
+                    continue;
+                }
+
+                for (const auto& other : calls) {
+                    for (const Pointer& ptr : node->pointsTo) {
+                        if (ptr.isValid() && other.second->doesPointsTo(ptr.target)) {
+                            llvm::errs() << "The calls share an allocation: " << I
+                                         << " and " << *other.first << "\n";
+                            dumpPSNode(node);
+                            dumpPSNode(other.second);
+                            ret = false;
+                            break;
+                        }
+                    }
+                }
+
+                calls.emplace_back(&I, node);
+            }
+        }
+    }
+
+    if (calls.size() < 2) {
+        llvm::errs() << "Found " << calls.size() << " calls of " << name
+                     << ", expected at least two\n";
+        ret = false;
+    }
+
+    return ret;
+}
+
+// the memory of the local variables of main (the allocas in the order
+// in which they were created)
+static std::vector<const llvm::AllocaInst *> getMainVariables(llvm::Module *M)
+{
+    std::vector<const llvm::AllocaInst *> ret;
+    llvm::Function *F = M->getFunction("main");
+    if (!F)
+        return ret;
+
+    for (llvm::BasicBlock& B : *F) {
+        for (llvm::Instruction& I : B) {
+            if (auto *AI = llvm::dyn_cast<llvm::AllocaInst>(&I))
+                ret.push_back(AI);
+        }
+    }
+
+    return ret;
+}
+
+// the pointers stored in the variable as the loads of the variable see them
+static std::set<PSNode *> getVariableContents(const llvm::AllocaInst *AI,
+                                              LLVMPointerAnalysis *PTA)
+{
+    std::set<PSNode *> ret;
+    for (const llvm::BasicBlock& B : *AI->getParent()->getParent()) {
+        for (const llvm::Instruction& I : B) {
+            auto *LI = llvm::dyn_cast<llvm::LoadInst>(&I);
+            if (!LI || LI->getPointerOperand() != AI)
+                continue;
+
+            if (PSNode *node = PTA->getPointsTo(LI)) {
+                for (const Pointer& ptr : node->pointsTo)
+                    ret.insert(ptr.target);
+            }
+        }
+    }
+
+    return ret;
+}
+
+// describe the target so that the targets from different modules
+// can be compared: the first 'shared' variables of main are the same
+// in both modules, the other memory is described only by its kind
+static std::string describeTarget(PSNode *target,
+                                  const std::vector<const llvm::AllocaInst *>& vars,
+                                  size_t shared)
+{
+    if (target == NULLPTR)
+        return "null";
+    if (target == UNKNOWN_MEMORY)
+        return "unknown";
+    if (target == INVALIDATED)
+        return "invalidated";
+
+    const llvm::Value *val = target->getUserData<llvm::Value>();
+    if (auto *GV = llvm::dyn_cast_or_null<llvm::GlobalValue>(val))
+        return GV->getName().str();
+
+    for (size_t i = 0; i < shared; ++i) {
+        if (vars[i] == val)
+            return "main variable " + std::to_string(i);
+    }
+
+    PSNodeAlloc *alloc = PSNodeAlloc::get(target);
+    if (alloc && alloc->isHeap())
+        return "heap";
+    if (val && llvm::isa<llvm::AllocaInst>(val))
+        return "stack";
+    return "other";
+}
+
+// Compare the results of the analysis with the summaries on the module 'M'
+// with the results of the analysis without them on the module 'inlinedM',
+// which is the same program with the (summarized) functions inlined by hand.
+// The summaries must give the same results as inlining. The modules share
+// the first local variables of main (the inlined module has only more of
+// them), so compare what these variables contain and how they alias.
+static bool verify_inlined(llvm::Module *M, llvm::Module *inlinedM,
+                           unsigned heapCloning)
+{
+    using analysis::pta::PointerAnalysisFI;
+
+    LLVMPointerAnalysisOptions opts;
+    opts.threads = false;
+    opts.setEntryFunction("main");
+    opts.setFieldSensitivity(Offset::UNKNOWN);
+
+    LLVMPointerAnalysis inl(inlinedM, opts);
+    inl.run<PointerAnalysisFI>();
+
+    LLVMPointerAnalysisOptions sumOpts = opts;
+    sumOpts.functionSummaries = true;
+    sumOpts.heapCloning = heapCloning;
+
+    LLVMPointerAnalysis sum(M, sumOpts);
+    sum.run<PointerAnalysisFI>();
+
+    auto vars = getMainVariables(M);
+    auto inlVars = getMainVariables(inlinedM);
+    if (vars.empty() || inlVars.size() < vars.size()) {
+        llvm::errs() << "The inlined module does not have the variables of main\n";
+        return false;
+    }
+
+    size_t shared = vars.size();
+    std::vector<std::set<PSNode *>> contents, inlContents;
+    for (size_t i = 0; i < shared; ++i) {
+        contents.push_back(getVariableContents(vars[i], &sum));
+        inlContents.push_back(getVariableContents(inlVars[i], &inl));
+    }
+
+    bool ret = true;
+    for (size_t i = 0; i < shared; ++i) {
+        std::multiset<std::string> targets, inlTargets;
+        for (PSNode *target : contents[i])
+            targets.insert(describeTarget(target, vars, shared));
+        for (PSNode *target : inlContents[i])
+            inlTargets.insert(describeTarget(target, inlVars, shared));
+
+        if (targets != inlTargets) {
+            llvm::errs() << "Summaries differ from inlining in: " << *vars[i] << "\n";
+            for (const auto& target : targets)
+                llvm::errs() << "SUM -> " << target << "\n";
+            for (const auto& target : inlTargets)
+                llvm::errs() << "INLINED -> " << target << "\n";
+            ret = false;
+        }
+
+        for (size_t j = i + 1; j < shared; ++j) {
+            auto alias = [](const std::set<PSNode *>& a, const std::set<PSNode *>& b) {
+                for (PSNode *n : a) {
+                    if (n != NULLPTR && b.count(n) > 0)
+                        return true;
+                }
+                return false;
+            };
+
+            if (alias(contents[i], contents[j]) != alias(inlContents[i], inlContents[j])) {
+                llvm::errs() << "Summaries and inlining differ in aliasing of: "
+                             << *vars[i] << " and " << *vars[j] << "\n";
+                ret = false;
+            }
+        }
+    }
+
+    return ret;
+}
+
+// compare the results of the analysis of the reduced graph ('opt') with the
+// results of the analysis of the whole graph. The pointers must have the same
+// targets, the offsets may be more precise in the reduced graph (the GEPs
+// with zero offset are merged with their operands, so they do not change
+// the offsets). The values without pointers may have no node.
+static bool verify_optimizations(const llvm::Value *val,
+                                 LLVMPointerAnalysis *opt,
+                                 LLVMPointerAnalysis *full)
+{
+    PSNode *optnode = opt->getPointsTo(val);
+    PSNode *fullnode = full->getPointsTo(val);
+    if (!optnode && !fullnode)
+        return true;
+
+    std::set<std::pair<const void *, uint64_t>> optset, fullset;
+    if (optnode)
+        optset = getValuesSet(optnode);
+    if (fullnode)
+        fullset = getValuesSet(fullnode);
+
+    auto hasTarget = [](const std::set<std::pair<const void *, uint64_t>>& set,
+                        const std::pair<const void *, uint64_t>& ptr,
+                        bool anyOffset) {
+        auto it = set.lower_bound({ptr.first, 0});
+        if (it == set.end() || it->first != ptr.first)
+            return false;
+        return anyOffset || set.count(ptr) > 0 ||
+               set.count({ptr.first, Offset::UNKNOWN}) > 0;
+    };
+
+    bool ok = true;
+    for (const auto& ptr : optset)
+        ok &= hasTarget(fullset, ptr, false);
+    for (const auto& ptr : fullset)
+        ok &= hasTarget(optset, ptr, true);
+
+    if (!ok) {
+        llvm::errs() << "Reduced graph differs from full: " << *val << "\n";
+        if (optnode) {
+            llvm::errs() << "REDUCED ";
+            dumpPSNode(optnode);
+        }
+        if (fullnode) {
+            llvm::errs() << "FULL ";
+            dumpPSNode(fullnode);
+        }
+        llvm::errs() << " ---- \n";
+    }
+
+    return ok;
+}
+
+template <typename PTType>
+static bool verify_optimizations(llvm::Module *M,
+                                 const LLVMPointerAnalysisOptions& opts)
+{
+    using namespace llvm;
+
+    LLVMPointerAnalysisOptions fullOpts = opts;
+    fullOpts.optimizeGraph = false;
+
+    LLVMPointerAnalysis full(M, fullOpts);
+    full.run<PTType>();
+
+    LLVMPointerAnalysis opt(M, opts);
+    opt.run<PTType>();
+
+    llvm::errs() << "Removed " << opt.getNumOfRemovedNodes() << " nodes\n";
+
+    bool ret = true;
+    for (Function& F : *M) {
+        for (BasicBlock& B : F) {
+            for (Instruction& I : B)
+                ret &= verify_optimizations(&I, &opt, &full);
+        }
+    }
+
+    return ret;
+}
+
+// Check that the reduction of the pointer graph (see
+// LLVMPointerAnalysisOptions::optimizeGraph) does not change the results
+static bool verify_optimizations(llvm::Module *M)
+{
+    using analysis::pta::PointerAnalysisFI;
+    using analysis::pta::PointerAnalysisFS;
+
+    LLVMPointerAnalysisOptions opts;
+    opts.threads = false;
+    opts.setEntryFunction("main");
+    opts.setFieldSensitivity(Offset::UNKNOWN);
+    assert(opts.optimizeGraph && "The graph is not reduced by default");
+
+    bool ret = verify_optimizations<PointerAnalysisFI>(M, opts);
+
+    LLVMPointerAnalysisOptions fsOpts = opts;
+    fsOpts.analysisType = LLVMPointerAnalysisOptions::AnalysisType::fs;
+    ret &= verify_optimizations<PointerAnalysisFS>(M, fsOpts);
+
+    // the equivalent pointers are merged only with these solvers
+    LLVMPointerAnalysisOptions diffOpts = opts;
+    diffOpts.setSolverType(LLVMPointerAnalysisOptions::SolverType::diffprop);
+    ret &= verify_optimizations<PointerAnalysisFI>(M, diffOpts);
+
+    LLVMPointerAnalysisOptions sumOpts = opts;
+    sumOpts.functionSummaries = true;
+    ret &= verify_optimizations<PointerAnalysisFI>(M, sumOpts);
+
+    return ret;
+}
+
 int main(int argc, char *argv[])
 {
     llvm::Module *M;
@@ -207,6 +881,13 @@ int main(int argc, char *argv[])
     llvm::SMDiagnostic SMD;
     const char *module = nullptr;
     unsigned type = FLOW_SENSITIVE | FLOW_INSENSITIVE;
+    bool incremental = false;
+    bool demand = false;
+    bool summaries = false;
+    unsigned heapCloning = 0;
+    const char *inlined = nullptr;
+    const char *clonedCalls = nullptr;
+    bool optimizations = false;
 
     // parse options
     for (int i = 1; i < argc; ++i) {
@@ -220,6 +901,21 @@ int main(int argc, char *argv[])
                 errs() << "Unknown PTA type" << argv[i + 1] << "\n";
                 abort();
             }
+        } else if (strcmp(argv[i], "-incremental") == 0) {
+            incremental = true;
+        } else if (strcmp(argv[i], "-demand") == 0) {
+            demand = true;
+        } else if (strcmp(argv[i], "-summaries") == 0) {
+            summaries = true;
+        } else if (strcmp(argv[i], "-heap-cloning") == 0) {
+            summaries = true;
+            heapCloning = 2;
+        } else if (strcmp(argv[i], "-inlined") == 0) {
+            inlined = argv[++i];
+        } else if (strcmp(argv[i], "-cloned-calls") == 0) {
+            clonedCalls = argv[++i];
+        } else if (strcmp(argv[i], "-optimizations") == 0) {
+            optimizations = true;
         /*} else if (strcmp(argv[i], "-v") == 0) {
             verbose = true;*/
         } else {
@@ -228,7 +924,7 @@ int main(int argc, char *argv[])
     }
 
     if (!module) {
-        errs() << "Usage: % llvm-pta-compare [-pta fs|fi] IR_module\n";
+        errs() << "Usage: % llvm-pta-compare [-pta fs|fi] [-incremental] [-demand] [-summaries] [-heap-cloning] [-inlined IR_module] [-cloned-calls FUNCTION] [-optimizations] IR_module\n";
         return 1;
     }
 
@@ -246,6 +942,53 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (incremental) {
+        bool ok = verify_incremental(M);
+        if (ok)
+            llvm::errs() << "Incremental results are the same as full results, all OK\n";
+        return !ok;
+    }
+
+    if (demand) {
+        // do not fall back to solving the whole graph
+        bool ok = verify_demand(M, ~0U);
+        // exceed the budget with the first demanded operand
+        ok &= verify_demand(M, 1);
+        if (ok)
+            llvm::errs() << "Demand-driven results are the same as full results, all OK\n";
+        return !ok;
+    }
+
+    if (summaries) {
+        bool ok = verify_summaries(M, heapCloning);
+        if (inlined) {
+#if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR <= 5))
+            std::unique_ptr<llvm::Module> inlinedM(llvm::ParseIRFile(inlined, SMD, context));
+#else
+            auto inlinedM = llvm::parseIRFile(inlined, SMD, context);
+#endif
+            if (!inlinedM) {
+                llvm::errs() << "Failed parsing '" << inlined << "' file:\n";
+                SMD.print(argv[0], errs());
+                return 1;
+            }
+
+            ok &= verify_inlined(M, inlinedM.get(), heapCloning);
+        }
+        if (clonedCalls)
+            ok &= verify_cloned_calls(M, heapCloning, clonedCalls);
+        if (ok)
+            llvm::errs() << "Results with summaries are a sound subset of full results, all OK\n";
+        return !ok;
+    }
+
+    if (optimizations) {
+        bool ok = verify_optimizations(M);
+        if (ok)
+            llvm::errs() << "Results of the reduced graph are the same as full results, all OK\n";
+        return !ok;
+    }
+
     dg::debug::TimeMeasure tm;
 
     LLVMPointerAnalysis *PTAfs = nullptr;
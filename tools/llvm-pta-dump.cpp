@@ -9,8 +9,12 @@
 #include <sstream>
 #include <fstream>
 #include <cassert>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -24,6 +28,9 @@
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
 #include <llvm/Support/SourceMgr.h>
 #include <llvm/Support/raw_os_ostream.h>
 #include <llvm/IRReader/IRReader.h>
@@ -44,6 +51,7 @@
 #include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFS.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFSInv.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
 #include "dg/analysis/PointsTo/Pointer.h"
 
 #include "TimeMeasure.h"
@@ -62,6 +70,7 @@ static bool names_with_funs = false;
 static bool callgraph = false;
 static uint64_t dump_iteration = 0;
 static const char *entry_func = "main";
+static const char *cache_dir = nullptr;
 
 static char *display_only = nullptr;
 static std::vector<const llvm::Function *> display_only_func;
@@ -72,6 +81,7 @@ enum PTType {
     FLOW_SENSITIVE = 1,
     FLOW_INSENSITIVE,
     WITH_INVALIDATE,
+    SPARSE_FLOW_SENSITIVE,
 };
 
 static std::string
@@ -180,7 +190,7 @@ static void dumpPointer(const Pointer& ptr, bool dot)
 }
 
 static void
-dumpMemoryObject(MemoryObject *mo, int ind, bool dot)
+dumpMemoryObject(const MemoryObject *mo, int ind, bool dot)
 {
     bool printed_multi = false;
     for (auto& it : mo->pointsTo) {
@@ -261,6 +271,10 @@ static void
 dumpPointerGraphData(PSNode *n, PTType type, bool dot = false)
 {
     assert(n && "No node given");
+    // the sparse analysis has no memory maps on nodes
+    if (type == SPARSE_FLOW_SENSITIVE)
+        return;
+
     if (type == FLOW_INSENSITIVE) {
         MemoryObject *mo = n->getData<MemoryObject>();
         if (!mo)
@@ -425,7 +439,7 @@ dumpNodeEdgesToDot(PSNode *node)
 }
 
 PSNode *getNodePtr(PSNode *ptr) { return ptr; }
-PSNode *getNodePtr(const std::unique_ptr<PSNode>& ptr) { return ptr.get(); }
+PSNode *getNodePtr(const ADT::ArenaPtr<PSNode>& ptr) { return ptr.get(); }
 
 
 template <typename ContT> static void
@@ -558,6 +572,7 @@ static void
 dumpStats(LLVMPointerAnalysis *pta)
 {
     const auto& nodes = pta->getNodes();
+    printf("Points-to sets representation: %s\n", getPointsToSetName());
     printf("Pointer subgraph size: %lu\n", nodes.size()-1);
 
     size_t nonempty_size = 0; // number of nodes with non-empty pt-set
@@ -712,6 +727,31 @@ dumpStats(LLVMPointerAnalysis *pta)
     printf("Maximum pt-set size: %lu\n", maximum);
 }
 
+// Run the llvm-pta-dump that uses the representation of points-to sets
+// 'ptset' (they are built with cmake -DPTA_EXTRA_POINTS_TO_SETS).
+// It gets the same arguments, -pta-set is its own representation,
+// so it does not run any other llvm-pta-dump. Returns only on error.
+static int runWithPointsToSet(const char *ptset, char *argv[])
+{
+    static int anchor;
+    std::string self = llvm::sys::fs::getMainExecutable(argv[0], &anchor);
+    llvm::SmallString<256> path(llvm::sys::path::parent_path(self));
+    llvm::sys::path::append(path, std::string("llvm-pta-dump-") + ptset);
+
+    if (!llvm::sys::fs::exists(path.str())) {
+        errs() << "No llvm-pta-dump for points-to sets " << ptset
+               << " (" << path << "), build it with "
+               << "cmake -DPTA_EXTRA_POINTS_TO_SETS=" << ptset << "\n";
+        return 1;
+    }
+
+    argv[0] = const_cast<char *>(path.c_str());
+    execv(path.c_str(), argv);
+
+    errs() << "Failed running " << path << ": " << strerror(errno) << "\n";
+    return 1;
+}
+
 int main(int argc, char *argv[])
 {
     llvm::Module *M;
@@ -720,8 +760,12 @@ int main(int argc, char *argv[])
     bool todot = false;
     bool stats = false;
     const char *module = nullptr;
+    const char *pta_set = nullptr;
     PTType type = FLOW_INSENSITIVE;
     uint64_t field_senitivity = Offset::UNKNOWN;
+    auto solver = analysis::PointerAnalysisOptions::SolverType::iterative;
+    auto order = analysis::PointerAnalysisOptions::WorklistOrder::bfs;
+    unsigned solver_threads = 0;
 
     // parse options
     for (int i = 1; i < argc; ++i) {
@@ -731,6 +775,18 @@ int main(int argc, char *argv[])
                 type = FLOW_SENSITIVE;
             else if (strcmp(argv[i+1], "inv") == 0)
                 type = WITH_INVALIDATE;
+            else if (strcmp(argv[i+1], "sfs") == 0)
+                type = SPARSE_FLOW_SENSITIVE;
+        } else if (strcmp(argv[i], "-pta-solver") == 0) {
+            if (strcmp(argv[i+1], "diffprop") == 0)
+                solver = analysis::PointerAnalysisOptions::SolverType::diffprop;
+            else if (strcmp(argv[i+1], "parallel") == 0)
+                solver = analysis::PointerAnalysisOptions::SolverType::parallel;
+        } else if (strcmp(argv[i], "-pta-solver-threads") == 0) {
+            solver_threads = static_cast<unsigned>(atoi(argv[i + 1]));
+        } else if (strcmp(argv[i], "-pta-order") == 0) {
+            if (strcmp(argv[i+1], "topo") == 0)
+                order = analysis::PointerAnalysisOptions::WorklistOrder::topological;
         } else if (strcmp(argv[i], "-pta-field-sensitive") == 0) {
             field_senitivity = static_cast<uint64_t>(atoll(argv[i + 1]));
         } else if (strcmp(argv[i], "-dot") == 0) {
@@ -758,6 +814,10 @@ int main(int argc, char *argv[])
             entry_func = argv[i + 1];
         } else if (strcmp(argv[i], "-display-only") == 0) {
             display_only = argv[i + 1];
+        } else if (strcmp(argv[i], "-cache-dir") == 0) {
+            cache_dir = argv[i + 1];
+        } else if (strcmp(argv[i], "-pta-set") == 0) {
+            pta_set = argv[i + 1];
         } else {
             module = argv[i];
         }
@@ -768,6 +828,9 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (pta_set && strcmp(pta_set, getPointsToSetName()) != 0)
+        return runWithPointsToSet(pta_set, argv);
+
 #if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR <= 5))
     M = llvm::ParseIRFile(module, SMD, context);
 #else
@@ -795,7 +858,17 @@ int main(int argc, char *argv[])
         }
     }
 
-    LLVMPointerAnalysis PTA(M, entry_func, field_senitivity, threads);
+    analysis::LLVMPointerAnalysisOptions opts;
+    opts.threads = threads;
+    opts.setFieldSensitivity(field_senitivity);
+    opts.setEntryFunction(entry_func);
+    opts.setSolverType(solver);
+    opts.setWorklistOrder(order);
+    opts.setSolverThreads(solver_threads);
+    if (cache_dir)
+        opts.cacheDir = cache_dir;
+
+    LLVMPointerAnalysis PTA(M, opts);
 
     tm.start();
 
@@ -809,6 +882,10 @@ int main(int argc, char *argv[])
         PA = std::unique_ptr<PointerAnalysis>(
             PTA.createPTA<analysis::pta::PointerAnalysisFSInv>()
             );
+    } else if (type == SPARSE_FLOW_SENSITIVE) {
+        PA = std::unique_ptr<PointerAnalysis>(
+            PTA.createPTA<analysis::pta::PointerAnalysisSFS>()
+            );
     } else {
         PA = std::unique_ptr<PointerAnalysis>(
             PTA.createPTA<analysis::pta::PointerAnalysisFS>()
@@ -821,7 +898,9 @@ int main(int argc, char *argv[])
     }
 
     // run the analysis
-    if (dump_iteration > 0) {
+    if (PTA.resultsFromCache()) {
+        errs() << "INFO: Loaded the results from the cache\n";
+    } else if (dump_iteration > 0) {
         // do preprocessing and queue the nodes
         PA->preprocess();
         PA->initialize_queue();
@@ -834,6 +913,7 @@ int main(int argc, char *argv[])
         }
     } else {
         PA->run();
+        PTA.storeCachedResults();
     }
 
     tm.stop();
@@ -841,6 +921,20 @@ int main(int argc, char *argv[])
 
     if (stats) {
         dumpStats(&PTA);
+        printf("Iterations: %u\n", PA->getNumOfIterations());
+        printf("Processed nodes: %lu\n", PA->getNumOfProcessedNodes());
+        if (type == FLOW_INSENSITIVE) {
+            auto FI = static_cast<PointerAnalysisFI *>(PA.get());
+            printf("Nodes collapsed on cycles: %u\n",
+                   FI->getNumOfCollapsedNodes());
+            const auto& perThread = FI->getNumOfProcessedNodesPerThread();
+            for (unsigned i = 0; i < perThread.size(); ++i)
+                printf("Processed nodes by thread %u: %lu\n", i, perThread[i]);
+        } else if (type == SPARSE_FLOW_SENSITIVE) {
+            auto SFS = static_cast<PointerAnalysisSFS *>(PA.get());
+            printf("Def-use edges over memory: %lu\n",
+                   SFS->getNumOfDefUseEdges());
+        }
         return 0;
     }
 
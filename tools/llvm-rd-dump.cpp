@@ -141,9 +141,9 @@ printName(RDNode *node, bool dot)
 }
 
 static void
-dumpMap(RDNode *node, bool dot = false)
+dumpMap(LLVMReachingDefinitions *RD, RDNode *node, bool dot = false)
 {
-    RDMap& map = node->def_map;
+    RDMap& map = RD->getDefinitionsMap(node);
     for (const auto& it : map) {
         for (RDNode *site : it.second) {
             printName(it.first.target, dot);
@@ -258,18 +258,18 @@ dumpUses(RDNode *node, bool dot = false)
 }
 
 static void
-dumpRDNode(RDNode *n)
+dumpRDNode(LLVMReachingDefinitions *RD, RDNode *n)
 {
     printf("NODE: ");
     printName(n, false);
     if (n->getSize() > 0)
         printf(" [size: %lu]", n->getSize());
     putchar('\n');
-    dumpMap(n);
+    dumpMap(RD, n);
     printf("---\n");
 }
 
-static void nodeToDot(RDNode *node) {
+static void nodeToDot(LLVMReachingDefinitions *RD, RDNode *node) {
     printf("\tNODE%p [label=\"%u ", static_cast<void*>(node), node->getID());
     printName(node, true);
     if (node->getSize() > 0) {
@@ -287,7 +287,7 @@ static void nodeToDot(RDNode *node) {
         printf("\\n-------------\\n");
     }
 
-    dumpMap(node, true /* dot */);
+    dumpMap(RD, node, true /* dot */);
 
     printf("\" shape=box]\n");
 
@@ -298,7 +298,7 @@ static void dumpDotOnlyNodes(LLVMReachingDefinitions *RD)
     const auto& nodes = RD->getNodes();
     // dump nodes
     for(RDNode *node : nodes) {
-        nodeToDot(node);
+        nodeToDot(RD, node);
     }
 
     // dump def-use edges
@@ -319,7 +319,7 @@ static void dumpDotWithBlocks(LLVMReachingDefinitions *RD) {
         printf("subgraph cluster_%p {\n", *I);
         /* dump nodes */
         for(RDNode *node : I->getNodes()) {
-            nodeToDot(node);
+            nodeToDot(RD, node);
         }
 
         // dump def-use edges
@@ -383,7 +383,7 @@ dumpRD(LLVMReachingDefinitions *RD, bool todot)
         dumpRDdot(RD);
     else {
         for (RDNode *node : RD->getNodes())
-            dumpRDNode(node);
+            dumpRDNode(RD, node);
     }
 }
 
@@ -394,6 +394,7 @@ int main(int argc, char *argv[])
     llvm::SMDiagnostic SMD;
     bool todot = false;
     bool threads = false;
+    bool stats = false;
     const char *module = nullptr;
     Offset::type field_senitivity = Offset::UNKNOWN;
     bool rd_strong_update_unknown = false;
@@ -406,6 +407,7 @@ int main(int argc, char *argv[])
 
     enum class RdaType {
         DATAFLOW,
+        DATAFLOW_BLOCKS,
         SSA
     } rda = RdaType::DATAFLOW;
 
@@ -418,6 +420,8 @@ int main(int argc, char *argv[])
         } else if (strcmp(argv[i], "-rda") == 0) {
             if (strcmp(argv[i+1], "ssa") == 0)
                 rda = RdaType::SSA;
+            else if (strcmp(argv[i+1], "dataflow-blocks") == 0)
+                rda = RdaType::DATAFLOW_BLOCKS;
         } else if (strcmp(argv[i], "-pta-field-sensitive") == 0) {
             field_senitivity = static_cast<Offset::type>(atoll(argv[i + 1]));
         } else if (strcmp(argv[i], "-rd-max-set-size") == 0) {
@@ -430,6 +434,8 @@ int main(int argc, char *argv[])
             rd_strong_update_unknown = true;
         } else if (strcmp(argv[i], "-dot") == 0) {
             todot = true;
+        } else if (strcmp(argv[i], "-stats") == 0) {
+            stats = true;
         } else if (strcmp(argv[i], "-threads") == 0) {
             threads = true;
         } else if (strcmp(argv[i], "-v") == 0) {
@@ -442,7 +448,7 @@ int main(int argc, char *argv[])
     }
 
     if (!module) {
-        errs() << "Usage: % IR_module [-pts fs|fi] [-dot] [-v] [output_file]\n";
+        errs() << "Usage: % IR_module [-pts fs|fi] [-dot] [-stats] [-v] [output_file]\n";
         return 1;
     }
 
@@ -486,6 +492,9 @@ int main(int argc, char *argv[])
     if (rda == RdaType::SSA) {
         llvm::errs() << "INFO: Running SSA RD analysis\n";
         RD.run<dg::analysis::rd::SSAReachingDefinitionsAnalysis>();
+    } else if (rda == RdaType::DATAFLOW_BLOCKS) {
+        llvm::errs() << "INFO: Running data-flow RD analysis on basic blocks\n";
+        RD.run<dg::analysis::rd::BlockReachingDefinitionsAnalysis>();
     } else {
         llvm::errs() << "INFO: Running data-flow RD analysis\n";
         RD.run<dg::analysis::rd::ReachingDefinitionsAnalysis>();
@@ -493,6 +502,12 @@ int main(int argc, char *argv[])
     tm.stop();
     tm.report("INFO: Reaching definitions analysis took");
 
+    if (stats) {
+        printf("Rounds: %u\n", RD.getNumOfRounds());
+        printf("Processed nodes: %lu\n", RD.getNumOfProcessedNodes());
+        return 0;
+    }
+
     dumpRD(&RD, todot);
 
     return 0;
@@ -128,6 +128,12 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
                        "the whole memory. May be unsound for out-of-bound access\n"),
                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<unsigned> rdaLvnThreads("rd-lvn-threads",
+        llvm::cl::desc("The number of threads of the local value numbering\n"
+                       "in the SSA reaching definitions analysis\n"
+                       "(default: the number of hardware threads)."),
+                       llvm::cl::init(0), llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<bool> undefinedArePure("undefined-are-pure",
         llvm::cl::desc("Assume that undefined functions have no side-effects\n"),
                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
@@ -157,6 +163,7 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
         llvm::cl::values(
             clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::fi, "fi", "Flow-insensitive PTA (default)"),
             clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::fs, "fs", "Flow-sensitive PTA"),
+            clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::sfs, "sfs", "Sparse flow-sensitive PTA"),
             clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::inv, "inv", "PTA with invalidate nodes")
     #if LLVM_VERSION_MAJOR < 4
             , nullptr
@@ -164,11 +171,94 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
             ),
         llvm::cl::init(LLVMPointerAnalysisOptions::AnalysisType::fi), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<LLVMPointerAnalysisOptions::SolverType> ptaSolver("pta-solver",
+        llvm::cl::desc("Choose how to compute the fixpoint of flow-insensitive PTA:"),
+        llvm::cl::values(
+            clEnumValN(LLVMPointerAnalysisOptions::SolverType::iterative,
+                       "iterative", "Re-process the nodes reachable from changed nodes (default)"),
+            clEnumValN(LLVMPointerAnalysisOptions::SolverType::diffprop,
+                       "diffprop", "Propagate only the new pointers along def-use edges"),
+            clEnumValN(LLVMPointerAnalysisOptions::SolverType::parallel,
+                       "parallel", "Compute the fixpoint of diffprop with more threads")
+    #if LLVM_VERSION_MAJOR < 4
+            , nullptr
+    #endif
+            ),
+        llvm::cl::init(LLVMPointerAnalysisOptions::SolverType::iterative),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaSolverThreads("pta-solver-threads",
+        llvm::cl::desc("The number of threads of the parallel PTA solver\n"
+                       "(default: the number of hardware threads)."),
+                       llvm::cl::value_desc("N"), llvm::cl::init(0),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaDemand("pta-demand",
+        llvm::cl::desc("Compute the points-to sets of flow-insensitive PTA only\n"
+                       "for the pointers that are needed (default=false)."),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaDemandBudget("pta-demand-budget",
+        llvm::cl::desc("Solve the whole graph when -pta-demand needs more nodes\n"
+                       "(default: a half of the nodes)."),
+                       llvm::cl::value_desc("N"), llvm::cl::init(0),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaSummaries("pta-summaries",
+        llvm::cl::desc("Instantiate the summaries of small functions at call sites\n"
+                       "in flow-insensitive PTA (default=false)."),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaSummaryMaxNodes("pta-summary-max-nodes",
+        llvm::cl::desc("The maximal size of a function summarized by -pta-summaries\n"
+                       "(default=32)."),
+                       llvm::cl::value_desc("N"), llvm::cl::init(32),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaHeapCloning("pta-heap-cloning",
+        llvm::cl::desc("Clone the allocator wrappers and their allocations at call sites\n"
+                       "in flow-insensitive PTA up to the depth K (default=0, off)."),
+                       llvm::cl::value_desc("K"), llvm::cl::init(0),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<std::string> ptaAllocationWrappers("pta-allocation-wrappers",
+        llvm::cl::desc("Comma-separated list of functions that -pta-heap-cloning\n"
+                       "clones in addition to the detected allocator wrappers."),
+                       llvm::cl::value_desc("f1,f2,..."), llvm::cl::init(""),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaNoGraphOptimizations("pta-no-graph-optimizations",
+        llvm::cl::desc("Do not reduce the pointer graph before running PTA\n"
+                       "(default=false)."),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<LLVMPointerAnalysisOptions::WorklistOrder> ptaOrder("pta-order",
+        llvm::cl::desc("Choose the order in which the iterative PTA processes nodes:"),
+        llvm::cl::values(
+            clEnumValN(LLVMPointerAnalysisOptions::WorklistOrder::bfs,
+                       "bfs", "The order of the control flow (default)"),
+            clEnumValN(LLVMPointerAnalysisOptions::WorklistOrder::topological,
+                       "topo", "Definitions of pointers before their uses")
+    #if LLVM_VERSION_MAJOR < 4
+            , nullptr
+    #endif
+            ),
+        llvm::cl::init(LLVMPointerAnalysisOptions::WorklistOrder::bfs),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<std::string> ptaCacheDir("pta-cache-dir",
+        llvm::cl::desc("Cache the results of pointer analysis in the given\n"
+                       "directory and reuse them when the module did not change."),
+                       llvm::cl::value_desc("dir"), llvm::cl::init(""),
+                       llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<LLVMReachingDefinitionsAnalysisOptions::AnalysisType> rdaType("rda",
         llvm::cl::desc("Choose reaching definitions analysis to use:"),
         llvm::cl::values(
             clEnumValN(LLVMReachingDefinitionsAnalysisOptions::AnalysisType::dataflow,
                        "dataflow", "Classical data-flow RDA (default)"),
+            clEnumValN(LLVMReachingDefinitionsAnalysisOptions::AnalysisType::dataflow_blocks,
+                       "dataflow-blocks", "Data-flow RDA that keeps the maps only for basic blocks"),
             clEnumValN(LLVMReachingDefinitionsAnalysisOptions::AnalysisType::ssa,
                        "ssa", "MemorySSA-based RDA")
     #if LLVM_VERSION_MAJOR < 4
@@ -223,6 +313,18 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
     options.dgOptions.PTAOptions.fieldSensitivity
                                     = dg::analysis::Offset(ptaFieldSensitivity);
     options.dgOptions.PTAOptions.analysisType = ptaType;
+    options.dgOptions.PTAOptions.solverType = ptaSolver;
+    options.dgOptions.PTAOptions.worklistOrder = ptaOrder;
+    options.dgOptions.PTAOptions.solverThreads = ptaSolverThreads;
+    options.dgOptions.PTAOptions.demandDriven = ptaDemand;
+    options.dgOptions.PTAOptions.demandBudget = ptaDemandBudget;
+    options.dgOptions.PTAOptions.functionSummaries = ptaSummaries;
+    options.dgOptions.PTAOptions.summaryMaxNodes = ptaSummaryMaxNodes;
+    options.dgOptions.PTAOptions.heapCloning = ptaHeapCloning;
+    for (auto& w : splitList(ptaAllocationWrappers))
+        options.dgOptions.PTAOptions.allocationWrappers.insert(w);
+    options.dgOptions.PTAOptions.optimizeGraph = !ptaNoGraphOptimizations;
+    options.dgOptions.PTAOptions.cacheDir = ptaCacheDir;
 
     options.dgOptions.threads = threads;
     options.dgOptions.PTAOptions.threads = threads;
@@ -230,6 +332,7 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
 
     options.dgOptions.RDAOptions.entryFunction = entryFunction;
     options.dgOptions.RDAOptions.strongUpdateUnknown = rdaStrongUpdateUnknown;
+    options.dgOptions.RDAOptions.lvnThreads = rdaLvnThreads;
     options.dgOptions.RDAOptions.undefinedArePure = undefinedArePure;
     options.dgOptions.RDAOptions.analysisType = rdaType;
 
@@ -377,6 +377,9 @@ public:
         else if (options.dgOptions.PTAOptions.analysisType
                     == LLVMPointerAnalysisOptions::AnalysisType::fs)
             module_comment += "flow-sensitive\n";
+        else if (options.dgOptions.PTAOptions.analysisType
+                    == LLVMPointerAnalysisOptions::AnalysisType::sfs)
+            module_comment += "sparse flow-sensitive\n";
         else if (options.dgOptions.PTAOptions.analysisType
                     == LLVMPointerAnalysisOptions::AnalysisType::inv)
             module_comment += "flow-sensitive with invalidate\n";